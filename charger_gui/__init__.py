@@ -2,6 +2,11 @@
 __version__ = "1.0.0"
 __author__ = "Alessandro Zingaretti"
 
-from .main import main
+
+def main():
+    # Import ritardato: gli strumenti senza GUI (simulator, ...) non devono richiedere PyQt6
+    from .main import main as _main
+    return _main()
+
 
 __all__ = ['main']
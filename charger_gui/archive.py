@@ -0,0 +1,466 @@
+"""Archivio compresso delle sessioni registrate (.evarc), con accesso per tempo
+
+    python -m charger_gui.archive train season/*.evlog -o evo.dict     # dizionario condiviso
+    python -m charger_gui.archive pack session.evlog --dict evo.dict   # -> session.evarc
+    python -m charger_gui.archive unpack session.evarc                 # -> session.evlog
+    python -m charger_gui.archive info session.evarc
+    python -m charger_gui.archive bench                                # carica simulata
+
+I record di un .evlog si tagliano in chunk di al massimo CHUNK_US di tempo
+di bus; ogni chunk si comprime da solo con deflate e un dizionario
+preimpostato addestrato sul traffico EVO, così qualsiasi intervallo di tempo
+si legge decomprimendo solo i chunk che lo coprono (indice in fondo al file,
+trovato dall'header). I timestamp non decrescono mai dentro un chunk (un
+passo indietro ne apre uno nuovo): un intervallo si ritaglia dai suoi chunk
+per bisezione e si restituisce come viste di record impacchettati
+(RecordSlice), i frame si estraggono solo su richiesta.
+
+Il dizionario è fatto di inizi di chunk (record già nel layout del chunk,
+timestamp relativi al chunk) distribuiti uniformemente sulle sessioni di
+addestramento: deflate vi trova le raffiche periodiche di ogni ID EVO con i
+loro payload e intervalli tipici. È salvato nell'archivio: un archivio non
+dipende mai da un file esterno.
+
+    Header (48 byte)
+        0  char[8]  magic "EVOCANAR"
+        8  u16      versione (1)
+       10  u16      codec (1 = zlib + dizionario)
+       12  u32      dimensione del dizionario
+       16  u64      inizio sessione, tempo unix [us]
+       24  u64      offset dell'indice
+       32  u32      numero di chunk
+       36  u32      CRC32 del dizionario
+       40  u8[8]    riservato
+    Dizionario, chunk, indice
+
+    Voce dell'indice (32 byte)
+        0  u64      primo timestamp [us]
+        8  u64      ultimo timestamp [us]
+       16  u64      offset del chunk
+       24  u32      dimensione compressa
+       28  u32      record
+
+    Record del chunk (20 byte, prima della compressione)
+        0  u32      timestamp [us] dal primo timestamp del chunk
+        4  u32      ID CAN | flag (come in .evlog)
+        8  u8       DLC
+        9  u8       canale
+       10  u16      riservato
+       12  u8[8]    payload
+
+zstd non fa parte della libreria standard: zlib con zdict dà la stessa
+struttura (dizionario addestrato, chunk indipendenti) senza dipendenze.
+"""
+
+import bisect
+import os
+import struct
+import sys
+import time
+import zlib
+from array import array
+from typing import BinaryIO, Iterable, Iterator, List, NamedTuple, Optional, Sequence, Tuple
+
+from .recording import (Frame, Recording, RecordingWriter, RECORD_EXTENDED, RECORD_ID_MASK,
+                        RECORD_TX)
+
+MAGIC = b"EVOCANAR"
+VERSION = 1
+CODEC_ZLIB_DICT = 1
+
+HEADER = struct.Struct('<8sHHIQQII8x')
+INDEX = struct.Struct('<QQQII')
+CHUNK_RECORD = struct.Struct('<IIBBH8s')
+
+CHUNK_US = 5_000_000                # Tempo di bus per chunk (un minuto = al massimo 13 chunk)
+CHUNK_MAX_RECORDS = 65536
+DICT_SIZE = 32768                   # Finestra di deflate: un dizionario più grande non viene mai usato
+DICT_SEGMENT = 4096                 # Byte presi dall'inizio di un chunk di addestramento
+LEVEL = 9
+
+
+class ArchiveError(Exception):
+    """File non valido o versione non supportata"""
+
+
+class ChunkInfo(NamedTuple):
+    first_us: int
+    last_us: int
+    offset: int
+    size: int
+    records: int
+
+
+class RecordSlice:
+    """Record consecutivi di un chunk, ancora impacchettati (CHUNK_RECORD, timestamp da first_us)"""
+    __slots__ = ("first_us", "records")
+
+    def __init__(self, first_us: int, records: memoryview):
+        self.first_us = first_us
+        self.records = records
+
+    def __len__(self) -> int:
+        return len(self.records) // CHUNK_RECORD.size
+
+    def raw(self) -> Iterator[Tuple[int, int, int, int, int, bytes]]:
+        """(dt_us, id|flag, dlc, canale, riservato, payload8) per record"""
+        return CHUNK_RECORD.iter_unpack(self.records)
+
+    def frames(self) -> List[Frame]:
+        first = self.first_us
+        return [Frame(first + dt, key & RECORD_ID_MASK, key & RECORD_EXTENDED != 0,
+                      key & RECORD_TX != 0, data[:dlc])
+                for dt, key, dlc, _ch, _res, data in CHUNK_RECORD.iter_unpack(self.records)]
+
+
+# ============================================================================
+# Dizionario
+# ============================================================================
+
+def _chunk_heads(frames: Iterable[Frame], chunk_us: int) -> Iterator[bytes]:
+    """Primi DICT_SEGMENT byte di ogni chunk, record impacchettati come nell'archivio"""
+    buf = bytearray()
+    first = last = None
+    for fr in frames:
+        if first is None or fr.timestamp_us < last or fr.timestamp_us - first >= chunk_us:
+            if buf:
+                yield bytes(buf)
+            buf.clear()
+            first = fr.timestamp_us
+        last = fr.timestamp_us
+        if len(buf) < DICT_SEGMENT:
+            buf += _pack_record(fr.timestamp_us - first, fr)
+    if buf:
+        yield bytes(buf)
+
+
+def train_dictionary(sessions: Iterable[Iterable[Frame]], size: int = DICT_SIZE,
+                     chunk_us: int = CHUNK_US) -> bytes:
+    """Inizi di chunk distribuiti uniformemente sulle sessioni di addestramento"""
+    heads = [h[:DICT_SEGMENT] for frames in sessions for h in _chunk_heads(frames, chunk_us)]
+    n = min(len(heads), size // DICT_SEGMENT)
+    return b"".join(heads[i * len(heads) // n] for i in range(n)) if n else b""
+
+
+def _pack_record(dt_us: int, fr: Frame, channel: int = 0) -> bytes:
+    key = fr.can_id & RECORD_ID_MASK
+    if fr.extended:
+        key |= RECORD_EXTENDED
+    if fr.tx:
+        key |= RECORD_TX
+    return CHUNK_RECORD.pack(dt_us, key, len(fr.data), channel, 0, bytes(fr.data))
+
+
+# ============================================================================
+# Writer
+# ============================================================================
+
+class ArchiveWriter:
+    """Stessa write() di RecordingWriter; un chunk si comprime appena viene chiuso"""
+
+    def __init__(self, path: str, dictionary: bytes, start_unix_us: int = 0,
+                 chunk_us: int = CHUNK_US):
+        if len(dictionary) > DICT_SIZE:
+            raise ArchiveError(f"dictionary too large ({len(dictionary)} > {DICT_SIZE} byte)")
+        self.path = path
+        self.dictionary = dictionary
+        self.start_unix_us = start_unix_us
+        self.chunk_us = chunk_us
+        self.count = 0
+        self.chunks: List[ChunkInfo] = []
+        self._file: BinaryIO = open(path, 'wb')
+        self._file.write(HEADER.pack(MAGIC, VERSION, CODEC_ZLIB_DICT, len(dictionary),
+                                     start_unix_us, 0, 0, zlib.crc32(dictionary)))
+        self._file.write(dictionary)
+        self._buf = bytearray()
+        self._first = 0
+        self._last = 0
+        self._records = 0
+
+    def write(self, timestamp_us: int, can_id: int, data: Sequence[int],
+              extended: bool = False, tx: bool = False, channel: int = 0):
+        if self._records and (timestamp_us < self._last or timestamp_us - self._first >= self.chunk_us
+                              or self._records >= CHUNK_MAX_RECORDS):
+            self._close_chunk()
+        if not self._records:
+            self._first = timestamp_us
+        self._buf += _pack_record(timestamp_us - self._first,
+                                  Frame(timestamp_us, can_id, extended, tx, bytes(data)), channel)
+        self._last = timestamp_us
+        self._records += 1
+        self.count += 1
+
+    def _close_chunk(self):
+        comp = zlib.compressobj(LEVEL, zlib.DEFLATED, -15, zdict=self.dictionary) \
+            if self.dictionary else zlib.compressobj(LEVEL, zlib.DEFLATED, -15)
+        data = comp.compress(bytes(self._buf)) + comp.flush()
+        self.chunks.append(ChunkInfo(self._first, self._last, self._file.tell(), len(data), self._records))
+        self._file.write(data)
+        self._buf.clear()
+        self._records = 0
+
+    def close(self):
+        if self._file.closed:
+            return
+        if self._records:
+            self._close_chunk()
+        index_offset = self._file.tell()
+        for c in self.chunks:
+            self._file.write(INDEX.pack(*c))
+        self._file.seek(0)
+        self._file.write(HEADER.pack(MAGIC, VERSION, CODEC_ZLIB_DICT, len(self.dictionary),
+                                     self.start_unix_us, index_offset, len(self.chunks),
+                                     zlib.crc32(self.dictionary)))
+        self._file.close()
+
+    def __enter__(self) -> "ArchiveWriter":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+# ============================================================================
+# Reader
+# ============================================================================
+
+class Archive:
+    """Header, dizionario e indice in memoria; chunk letti e decompressi su richiesta"""
+
+    def __init__(self, path: str):
+        self.path = path
+        self._file: BinaryIO = open(path, 'rb')
+        head = self._file.read(HEADER.size)
+        if len(head) < HEADER.size:
+            raise ArchiveError(f"{path}: file too short")
+        magic, version, codec, dict_size, start, index_offset, chunks, crc = HEADER.unpack(head)
+        if magic != MAGIC:
+            raise ArchiveError(f"{path}: not an EVO archive")
+        if version != VERSION or codec != CODEC_ZLIB_DICT:
+            raise ArchiveError(f"{path}: unsupported version {version} (codec {codec})")
+        if not index_offset:
+            raise ArchiveError(f"{path}: archive not closed (no index)")
+        self.start_unix_us = start
+        self.dictionary = self._file.read(dict_size)
+        if zlib.crc32(self.dictionary) != crc:
+            raise ArchiveError(f"{path}: dictionary CRC mismatch")
+        self._file.seek(index_offset)
+        raw = self._file.read(chunks * INDEX.size)
+        self.chunks = [ChunkInfo(*e) for e in INDEX.iter_unpack(raw)]
+        self._last_us = [c.last_us for c in self.chunks]
+        self._cached = (-1, b"")
+
+    def __len__(self) -> int:
+        return sum(c.records for c in self.chunks)
+
+    @property
+    def duration_us(self) -> int:
+        return self.chunks[-1].last_us - self.chunks[0].first_us if self.chunks else 0
+
+    def chunk(self, i: int) -> bytes:
+        """Chunk i decompresso (record CHUNK_RECORD); l'ultimo resta in cache"""
+        if self._cached[0] == i:
+            return self._cached[1]
+        c = self.chunks[i]
+        self._file.seek(c.offset)
+        dec = zlib.decompressobj(-15, zdict=self.dictionary) if self.dictionary \
+            else zlib.decompressobj(-15)
+        data = dec.decompress(self._file.read(c.size)) + dec.flush()
+        if len(data) != c.records * CHUNK_RECORD.size:
+            raise ArchiveError(f"{self.path}: chunk {i} corrupted")
+        self._cached = (i, data)
+        return data
+
+    def slices(self, t0_us: int = 0, t1_us: Optional[int] = None) -> Iterator[RecordSlice]:
+        """Record con t0_us <= timestamp < t1_us (tempo di sessione), una vista per chunk
+
+        I bordi nel chunk si trovano per bisezione sulla colonna dei
+        timestamp: qui i record non si estraggono mai.
+        """
+        end = (1 << 64) if t1_us is None else t1_us
+        i = bisect.bisect_left(self._last_us, t0_us)
+        while i < len(self.chunks) and self.chunks[i].first_us < end:
+            c = self.chunks[i]
+            data = memoryview(self.chunk(i))
+            lo, hi = 0, c.records
+            if c.first_us < t0_us or c.last_us >= end:
+                dts = array('I')
+                dts.frombytes(data)
+                if sys.byteorder == 'big':
+                    dts.byteswap()
+                dts = dts[0::CHUNK_RECORD.size // 4]
+                lo = bisect.bisect_left(dts, t0_us - c.first_us)
+                hi = bisect.bisect_left(dts, end - c.first_us)
+            if hi > lo:
+                yield RecordSlice(c.first_us, data[lo * CHUNK_RECORD.size:hi * CHUNK_RECORD.size])
+            i += 1
+
+    def frames(self, t0_us: int = 0, t1_us: Optional[int] = None) -> Iterator[Frame]:
+        """Frame con t0_us <= timestamp < t1_us (tempo di sessione)"""
+        for s in self.slices(t0_us, t1_us):
+            yield from s.frames()
+
+    def minute(self, n: int) -> List[RecordSlice]:
+        """Minuto n della sessione come viste di record (RecordSlice.frames() per estrarli)"""
+        return list(self.slices(n * 60_000_000, (n + 1) * 60_000_000))
+
+    def __iter__(self) -> Iterator[Frame]:
+        return self.frames()
+
+    def close(self):
+        self._file.close()
+
+    def __enter__(self) -> "Archive":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+# ============================================================================
+# Pack / unpack
+# ============================================================================
+
+def pack(evlog_path: str, out_path: str, dictionary: Optional[bytes] = None,
+         chunk_us: int = CHUNK_US) -> int:
+    """.evlog -> .evarc; senza dizionario se ne addestra uno sulla sessione stessa"""
+    rec = Recording(evlog_path)
+    if dictionary is None:
+        dictionary = train_dictionary([rec])
+    with ArchiveWriter(out_path, dictionary, rec.start_unix_us, chunk_us) as w:
+        for ts, key, dlc, ch, _res, data in rec.raw():
+            w.write(ts, key & RECORD_ID_MASK, data[:dlc], bool(key & RECORD_EXTENDED),
+                    bool(key & RECORD_TX), ch)
+        return w.count
+
+
+def unpack(archive_path: str, out_path: str) -> int:
+    with Archive(archive_path) as arc, RecordingWriter(out_path, arc.start_unix_us) as w:
+        for i, c in enumerate(arc.chunks):
+            for dt, key, dlc, ch, _res, data in CHUNK_RECORD.iter_unpack(arc.chunk(i)):
+                w.write(c.first_us + dt, key & RECORD_ID_MASK, data[:dlc],
+                        bool(key & RECORD_EXTENDED), bool(key & RECORD_TX), ch)
+        return w.count
+
+
+# ============================================================================
+# Benchmark su una carica simulata
+# ============================================================================
+
+def _simulated_evlog(path: str, ambient_C: float, soc: float) -> int:
+    from .charge_sim import ChargeSimulation
+    with RecordingWriter(path, 0) as w:
+        for frames in ChargeSimulation(ambient_C=ambient_C, soc=soc).ticks():
+            for f in frames:
+                w.write(f.t_ms * 1000, f.can_id, f.data, f.extended, f.direction == "Tx")
+        return w.count
+
+
+ACCESS_LIMIT_MS = 10.0             # Minuto casuale, 99° percentile (il massimo include il jitter del sistema operativo)
+
+
+def bench(tmp_dir: str, ambient_C: float = 25.0, soc: float = 0.0, samples: int = 200) -> bool:
+    import random
+    log = os.path.join(tmp_dir, "bench.evlog")
+    n = _simulated_evlog(log, ambient_C, soc)
+    raw_size = os.path.getsize(log)
+
+    sizes = {}
+    for label, dictionary in (("no dictionary", b""), ("trained dictionary", None)):
+        out = os.path.join(tmp_dir, "bench.evarc")
+        start = time.perf_counter()
+        pack(log, out, dictionary)
+        sizes[label] = (os.path.getsize(out), time.perf_counter() - start)
+
+    with Archive(out) as arc:
+        if list(arc) != list(Recording(log)):
+            print("round trip FAILED")
+            return False
+        hours = arc.duration_us / 3.6e9
+        minutes = int(arc.duration_us // 60_000_000) + 1
+        by_minute: dict = {}
+        for fr in Recording(log):
+            by_minute.setdefault(fr.timestamp_us // 60_000_000, []).append(fr)
+        if any([f for s in arc.minute(m) for f in s.frames()] != by_minute.get(m, []) for m in range(minutes)):
+            print("minute slices FAILED")
+            return False
+        times = []
+        rnd = random.Random(1)
+        for _ in range(samples):
+            arc._cached = (-1, b"")
+            start = time.perf_counter()
+            arc.minute(rnd.randrange(minutes))
+            times.append(time.perf_counter() - start)
+        # Estrazione anche dei frame di un minuto (fuori dal limite di accesso)
+        start = time.perf_counter()
+        for _ in range(20):
+            arc._cached = (-1, b"")
+            [f for s in arc.minute(rnd.randrange(minutes)) for f in s.frames()]
+        unpack_ms = (time.perf_counter() - start) / 20 * 1000
+
+    print(f"{n} frames, {hours * 60:.1f} min, .evlog {raw_size / 1e6:.2f} MB")
+    for label, (size, wall) in sizes.items():
+        print(f"  {label:<20} {size / 1e6:6.2f} MB  {raw_size / size:5.1f}x  "
+              f"{size / hours / 1e6:6.2f} MB/h  pack {wall:.2f} s")
+    times.sort()
+    p99 = times[int(0.99 * (len(times) - 1))] * 1000
+    print(f"random minute ({samples}x): mean {sum(times) / len(times) * 1000:.2f} ms, "
+          f"p99 {p99:.2f} ms, max {times[-1] * 1000:.2f} ms (views), {unpack_ms:.2f} ms with frames")
+    return p99 < ACCESS_LIMIT_MS
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Compressed seekable archive of .evlog sessions")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("train", help="train a dictionary on recordings")
+    p.add_argument("files", nargs="+")
+    p.add_argument("-o", "--output", required=True)
+    p = sub.add_parser("pack", help=".evlog -> .evarc")
+    p.add_argument("files", nargs="+")
+    p.add_argument("--dict", help="dictionary file (default: trained on each session)")
+    p.add_argument("--chunk", type=float, default=CHUNK_US / 1e6, help="chunk length [s]")
+    p = sub.add_parser("unpack", help=".evarc -> .evlog")
+    p.add_argument("files", nargs="+")
+    p = sub.add_parser("info", help="chunks and compression of archives")
+    p.add_argument("files", nargs="+")
+    p = sub.add_parser("bench", help="pack a simulated charge, time random minutes")
+    p.add_argument("--ambient", type=float, default=25.0)
+    p.add_argument("--soc", type=float, default=0.0)
+    args = parser.parse_args(argv)
+
+    if args.cmd == "train":
+        dictionary = train_dictionary(Recording(f) for f in args.files)
+        with open(args.output, "wb") as f:
+            f.write(dictionary)
+        print(f"{args.output}: {len(dictionary)} byte from {len(args.files)} sessions")
+    elif args.cmd == "pack":
+        dictionary = None
+        if args.dict:
+            with open(args.dict, "rb") as f:
+                dictionary = f.read()
+        for path in args.files:
+            out = os.path.splitext(path)[0] + ".evarc"
+            n = pack(path, out, dictionary, int(args.chunk * 1e6))
+            print(f"{out}: {n} frames, {os.path.getsize(path) / os.path.getsize(out):.1f}x")
+    elif args.cmd == "unpack":
+        for path in args.files:
+            out = os.path.splitext(path)[0] + ".evlog"
+            print(f"{out}: {unpack(path, out)} frames")
+    elif args.cmd == "info":
+        for path in args.files:
+            with Archive(path) as arc:
+                raw = len(arc) * CHUNK_RECORD.size
+                comp = sum(c.size for c in arc.chunks)
+                print(f"{path}: {len(arc)} frames, {arc.duration_us / 6e7:.1f} min, "
+                      f"{len(arc.chunks)} chunks, dictionary {len(arc.dictionary)} byte, "
+                      f"records {raw / max(comp, 1):.1f}x")
+    else:
+        import tempfile
+        with tempfile.TemporaryDirectory() as tmp:
+            return 0 if bench(tmp, args.ambient, args.soc) else 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
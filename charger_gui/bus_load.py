@@ -0,0 +1,235 @@
+from collections import deque
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Sequence, Tuple
+
+from .can_decoder import BaudrateType, CANDecoder
+
+
+# ============================================================================
+# Bit rate (TST2 BaudrateType)
+# ============================================================================
+
+BITRATES = {
+    BaudrateType.BAUDRATE_125KBIT: 125_000,
+    BaudrateType.BAUDRATE_250KBIT: 250_000,
+    BaudrateType.BAUDRATE_500KBIT: 500_000,
+    BaudrateType.BAUDRATE_1MBIT: 1_000_000,
+}
+
+# Delimitatore CRC + slot ACK + delimitatore ACK + EOF (7) + intermission (3): mai stuffati
+FRAME_TAIL_BITS = 13
+
+
+# ============================================================================
+# Lunghezza del frame in bit
+# ============================================================================
+
+def _crc15(bits: Sequence[int]) -> int:
+    """CRC-15 CAN (polinomio 0x4599) sul flusso di bit senza stuffing"""
+    crc = 0
+    for bit in bits:
+        crc_next = bit ^ ((crc >> 14) & 1)
+        crc = (crc << 1) & 0x7FFF
+        if crc_next:
+            crc ^= 0x4599
+    return crc
+
+
+def _push(bits: List[int], value: int, width: int):
+    for i in range(width - 1, -1, -1):
+        bits.append((value >> i) & 1)
+
+
+def frame_bits(can_id: int, data: Sequence[int], extended: bool = False) -> int:
+    """Lunghezza esatta in bit di un data frame CAN 2.0 sul bus
+
+    La regione con stuffing (SOF .. CRC) viene costruita bit per bit dall'ID
+    e dal payload reali, quindi gli stuff bit dipendono dal contenuto.
+    """
+    dlc = len(data)
+    bits: List[int] = [0]                       # SOF
+    if extended:
+        _push(bits, (can_id >> 18) & 0x7FF, 11)  # ID base
+        bits += [1, 1]                          # SRR, IDE
+        _push(bits, can_id & 0x3FFFF, 18)       # Estensione ID
+        bits += [0, 0, 0]                       # RTR, r1, r0
+    else:
+        _push(bits, can_id & 0x7FF, 11)
+        bits += [0, 0, 0]                       # RTR, IDE, r0
+    _push(bits, dlc, 4)
+    for b in data:
+        _push(bits, b, 8)
+    _push(bits, _crc15(bits), 15)
+
+    # Stuff bit dopo 5 bit uguali consecutivi (gli stuff bit contano nella sequenza)
+    stuffed = 0
+    run_bit, run_len = bits[0], 0
+    for bit in bits:
+        if bit == run_bit:
+            run_len += 1
+        else:
+            run_bit, run_len = bit, 1
+        if run_len == 5:
+            stuffed += 1
+            run_bit, run_len = 1 - bit, 1
+
+    return len(bits) + stuffed + FRAME_TAIL_BITS
+
+
+def worst_case_frame_bits(dlc: int, extended: bool = False) -> int:
+    """Limite superiore da ISO 11898 (tutte le posizioni di stuffing usate)"""
+    header = 54 if extended else 34
+    stuffed_len = header + 8 * dlc
+    return stuffed_len + FRAME_TAIL_BITS + (stuffed_len - 1) // 4
+
+
+# ============================================================================
+# Stimatore in tempo reale
+# ============================================================================
+
+@dataclass
+class IdLoad:
+    """Occupazione del bus di un ID CAN nella finestra dello stimatore"""
+    can_id: int
+    extended: bool
+    frames: int
+    bits: int
+    rate_hz: float
+
+    def utilisation(self, bitrate: int, window_s: float) -> float:
+        """Frazione del tempo di bus (0-1)"""
+        return self.bits / (bitrate * window_s)
+
+
+class BusLoadEstimator:
+    """Occupazione del bus su finestra scorrevole dai frame ricevuti
+
+    add_frame() è O(1) ammortizzato: ogni frame viene aggiunto una volta e
+    scade una volta. La lunghezza del frame è in cache per (ID, payload).
+    """
+
+    def __init__(self, window_s: float = 1.0):
+        self.window_s = window_s
+        self._frames: deque = deque()                 # (timestamp, key, bits)
+        self._bits: Dict[int, int] = {}
+        self._count: Dict[int, int] = {}
+        self._last_payload: Dict[int, Tuple[int, ...]] = {}
+        self._length_cache: Dict[Tuple[int, Tuple[int, ...]], int] = {}
+        self.total_bits = 0
+
+    @staticmethod
+    def _key(can_id: int, extended: bool) -> int:
+        return can_id | (1 << 31) if extended else can_id
+
+    def add_frame(self, timestamp: float, can_id: int, data: Sequence[int], extended: bool = False):
+        key = self._key(can_id, extended)
+        payload = tuple(data)
+        bits = self._length_cache.get((key, payload))
+        if bits is None:
+            bits = frame_bits(can_id, payload, extended)
+            if len(self._length_cache) < 65536:
+                self._length_cache[(key, payload)] = bits
+
+        self._frames.append((timestamp, key, bits))
+        self._bits[key] = self._bits.get(key, 0) + bits
+        self._count[key] = self._count.get(key, 0) + 1
+        self._last_payload[key] = payload
+        self.total_bits += bits
+        self._expire(timestamp)
+
+    def _expire(self, now: float):
+        limit = now - self.window_s
+        frames = self._frames
+        while frames and frames[0][0] < limit:
+            _, key, bits = frames.popleft()
+            self._bits[key] -= bits
+            self._count[key] -= 1
+            self.total_bits -= bits
+
+    def per_id(self, now: Optional[float] = None) -> List[IdLoad]:
+        """Occupazione per ID nella finestra corrente, dalla più alta"""
+        if now is not None:
+            self._expire(now)
+        loads = [
+            IdLoad(key & 0x1FFFFFFF, bool(key >> 31), self._count[key], bits, self._count[key] / self.window_s)
+            for key, bits in self._bits.items() if self._count[key] > 0
+        ]
+        return sorted(loads, key=lambda l: l.bits, reverse=True)
+
+    def utilisation(self, bitrate: int, now: Optional[float] = None) -> float:
+        """Occupazione totale del bus (0-1) al bit rate indicato"""
+        if now is not None:
+            self._expire(now)
+        return self.total_bits / (bitrate * self.window_s)
+
+    def last_payload(self, can_id: int, extended: bool = False) -> Optional[Tuple[int, ...]]:
+        return self._last_payload.get(self._key(can_id, extended))
+
+
+# ============================================================================
+# Pianificatore what-if
+# ============================================================================
+
+@dataclass
+class PlannedMessage:
+    """Un messaggio periodico nel piano di traffico"""
+    can_id: int
+    name: str
+    period_ms: float
+    dlc: int = 8
+    enabled: bool = True
+    extended: bool = False
+
+
+# Traffico EVO nominale (periodi dal manuale, stream di livello 3 spenti di default)
+DEFAULT_PLAN = [
+    PlannedMessage(CANDecoder.CAN_ID_CTL, "CTL", 100),
+    PlannedMessage(CANDecoder.CAN_ID_STAT, "STAT", 1000, dlc=4),
+    PlannedMessage(CANDecoder.CAN_ID_ACT1, "ACT1", 100),
+    PlannedMessage(CANDecoder.CAN_ID_ACT2, "ACT2", 1000),
+    PlannedMessage(CANDecoder.CAN_ID_TST1, "TST1", 100),
+    PlannedMessage(CANDecoder.CAN_ID_ACT3, "ACT3", 100, enabled=False),
+    PlannedMessage(CANDecoder.CAN_ID_TEMP, "TEMP", 100, enabled=False),
+    PlannedMessage(CANDecoder.CAN_ID_ACT4, "ACT4", 100, enabled=False),
+    PlannedMessage(CANDecoder.CAN_ID_STST1, "STST1", 100, enabled=False),
+]
+
+
+class TrafficPlanner:
+    """Carico del bus previsto per un insieme di messaggi periodici
+
+    Le lunghezze dei frame usano l'ultimo payload visto dallo stimatore se
+    disponibile (stuff bit reali), altrimenti il caso peggiore.
+    """
+
+    def __init__(self, plan: Optional[List[PlannedMessage]] = None,
+                 estimator: Optional[BusLoadEstimator] = None):
+        self.plan = [PlannedMessage(**vars(m)) for m in (plan or DEFAULT_PLAN)]
+        self.estimator = estimator
+
+    def message_bits(self, msg: PlannedMessage) -> int:
+        payload = self.estimator.last_payload(msg.can_id, msg.extended) if self.estimator else None
+        if payload is not None:
+            return frame_bits(msg.can_id, payload, msg.extended)
+        return worst_case_frame_bits(msg.dlc, msg.extended)
+
+    def bits_per_second(self) -> List[Tuple[PlannedMessage, float]]:
+        return [
+            (m, self.message_bits(m) * 1000.0 / m.period_ms if m.enabled and m.period_ms > 0 else 0.0)
+            for m in self.plan
+        ]
+
+    def utilisation(self) -> Dict[BaudrateType, float]:
+        """Occupazione totale prevista (0-1) per ogni bit rate di TST2"""
+        total = sum(bps for _, bps in self.bits_per_second())
+        return {rate: total / bitrate for rate, bitrate in BITRATES.items()}
+
+    def set_enabled(self, name: str, enabled: bool):
+        for m in self.plan:
+            if m.name == name:
+                m.enabled = enabled
+
+    def set_period(self, name: str, period_ms: float):
+        for m in self.plan:
+            if m.name == name:
+                m.period_ms = period_ms
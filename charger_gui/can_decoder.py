@@ -1,12 +1,32 @@
 from dataclasses import dataclass
 from enum import Enum
-from typing import List, Optional
+from typing import Dict, List, Optional, Sequence, Tuple
+
+from .charger_ids import CHARGERS, SERVICE_IDS, charger_bus_id
 
 
 # ============================================================================
 # LEVEL 2 - Enums and Types
 # ============================================================================
 
+class RawEnum(Enum):
+    """Enum che accetta anche i valori non documentati, come il cast in C
+    
+    Un campo a N bit può contenere valori senza nome nel manuale (es. ID
+    setting 2..15 con più charger): invece di sollevare ValueError viene
+    creato un membro RAW_<n> con lo stesso valore numerico.
+    """
+    
+    @classmethod
+    def _missing_(cls, value):
+        if not isinstance(value, int):
+            return None
+        member = object.__new__(cls)
+        member._name_ = f"RAW_{value}"
+        member._value_ = value
+        return cls._value2member_map_.setdefault(value, member)
+
+
 class RequestType(Enum):
     """Request Types for Level 2"""
     FAULT_INACTIVE = 0x1C
@@ -22,7 +42,7 @@ class FailureLevel(Enum):
     HARD = 11        # Hard Failure - charger stops, needs AC disconnect/reconnect
 
 
-class FrameType(Enum):
+class FrameType(RawEnum):
     """Frame Type for Fault messages"""
     SINGLE = 1       # Single frame (only one fault)
     MULTI = 2        # Multi frame (more than one fault)
@@ -86,7 +106,7 @@ class EVCModelType(Enum):
     EVO22K = 1  # air cooled
 
 
-class IDSettingType(Enum):
+class IDSettingType(RawEnum):
     """ID Setting definitions"""
     SINGLE_CHARGER = 0
     RANGE_1_16 = 1
@@ -318,10 +338,10 @@ class CANDecoder:
     def decode_ctl(data: List[int]) -> CtlPacket:
         """Decode CTL packet - ID 0x618 (BMS → Charger)"""
         can_enable = bool(data[0] & 0x80)
-        led3_enable = bool(data[0] & 0x40)
-        iac_max_A = data[1] * 0.1
-        vout_max_V = ((data[2] << 8) | data[3]) * 0.1
-        iout_max_A = ((data[4] << 8) | data[5]) * 0.1
+        led3_enable = bool(data[0] & 0x08)
+        iac_max_A = ((data[1] << 8) | data[2]) * 0.1
+        vout_max_V = ((data[3] << 8) | data[4]) * 0.1
+        iout_max_A = ((data[5] << 8) | data[6]) * 0.1
         
         return CtlPacket(can_enable, led3_enable, iac_max_A, vout_max_V, iout_max_A)
     
@@ -362,7 +382,7 @@ class CANDecoder:
         
         return Act2Packet(
             temp_loglv_C=(temp_raw * 0.005188) - 40.0,
-            ac_power_kW=power_raw * 0.05,
+            ac_power_kW=power_raw * 0.01,
             prox_limit_A=prox_raw * 0.1,
             pilot_limit_A=pilot_raw * 0.1
         )
@@ -563,48 +583,125 @@ class CANDecoder:
     
     @classmethod
     def decode_message(cls, can_id: int, data: List[int]):
-        """Decode CAN message based on ID"""
-        decoders = {
-            cls.CAN_ID_CTL: cls.decode_ctl,
-            cls.CAN_ID_STAT: cls.decode_stat,
-            cls.CAN_ID_ACT1: cls.decode_act1,
-            cls.CAN_ID_ACT2: cls.decode_act2,
-            cls.CAN_ID_TST1: cls.decode_tst1,
-            cls.CAN_ID_REQ: cls.decode_req,
-            cls.CAN_ID_FLTP: cls.decode_fault,
-            cls.CAN_ID_FLTA: cls.decode_fault,
-            cls.CAN_ID_SW: cls.decode_software,
-            cls.CAN_ID_SN: cls.decode_serial_number,
-            cls.CAN_ID_TST2: cls.decode_tst2,
-            cls.CAN_ID_ACT3: cls.decode_act3,
-            cls.CAN_ID_TEMP: cls.decode_temp,
-            cls.CAN_ID_ACT4: cls.decode_act4,
-            cls.CAN_ID_STST1: cls.decode_stst1,
-        }
-        
-        decoder = decoders.get(can_id)
+        """Decode CAN message based on (base) ID"""
+        decoder = _DECODERS.get(can_id)
         if decoder:
             return decoder(data)
         return None
     
+    @classmethod
+    def decode_bus_message(cls, bus_id: int, extended: bool, data: List[int]):
+        """Decodifica un frame come visto sul bus (qualsiasi charger, 11 o 29 bit)
+        
+        Restituisce (base_id, charger, packet) o None se l'ID non è un ID EVO.
+        Solleva ValueError se il payload è più corto del messaggio (DLC < 8).
+        """
+        resolved = cls.id_map.resolve(bus_id, extended)
+        if resolved is None:
+            return None
+        base_id, charger = resolved
+        try:
+            return base_id, charger, _DECODERS[base_id](data)
+        except IndexError:
+            raise ValueError(f"{_MESSAGE_NAMES[base_id]}: {len(data)} byte payload too short") from None
+    
     @classmethod
     def get_message_name(cls, can_id: int) -> str:
         """Get message name from CAN ID"""
-        names = {
-            cls.CAN_ID_CTL: "CTL (Control)",
-            cls.CAN_ID_STAT: "STAT (Status)",
-            cls.CAN_ID_ACT1: "ACT1 (Actual Values 1)",
-            cls.CAN_ID_ACT2: "ACT2 (Actual Values 2)",
-            cls.CAN_ID_TST1: "TST1 (Test/Diagnostic)",
-            cls.CAN_ID_REQ: "REQ (Request)",
-            cls.CAN_ID_FLTP: "FLTP (Fault Passive)",
-            cls.CAN_ID_FLTA: "FLTA (Fault Active)",
-            cls.CAN_ID_SW: "SW (Software Version)",
-            cls.CAN_ID_SN: "SN (Serial Number)",
-            cls.CAN_ID_TST2: "TST2 (Configuration)",
-            cls.CAN_ID_ACT3: "ACT3 (AC Currents)",
-            cls.CAN_ID_TEMP: "TEMP (Temperatures)",
-            cls.CAN_ID_ACT4: "ACT4 (Temperature FAN)",
-            cls.CAN_ID_STST1: "STST1 (Real Time Diagnostic)",
-        }
-        return names.get(can_id, f"Unknown (0x{can_id:03X})")
+        return _MESSAGE_NAMES.get(can_id, f"Unknown (0x{can_id:03X})")
+
+
+# ============================================================================
+# Tabelle di lookup (costruite una volta)
+# ============================================================================
+
+_DECODERS = {
+    CANDecoder.CAN_ID_CTL: CANDecoder.decode_ctl,
+    CANDecoder.CAN_ID_STAT: CANDecoder.decode_stat,
+    CANDecoder.CAN_ID_ACT1: CANDecoder.decode_act1,
+    CANDecoder.CAN_ID_ACT2: CANDecoder.decode_act2,
+    CANDecoder.CAN_ID_TST1: CANDecoder.decode_tst1,
+    CANDecoder.CAN_ID_REQ: CANDecoder.decode_req,
+    CANDecoder.CAN_ID_FLTP: CANDecoder.decode_fault,
+    CANDecoder.CAN_ID_FLTA: CANDecoder.decode_fault,
+    CANDecoder.CAN_ID_SW: CANDecoder.decode_software,
+    CANDecoder.CAN_ID_SN: CANDecoder.decode_serial_number,
+    CANDecoder.CAN_ID_TST2: CANDecoder.decode_tst2,
+    CANDecoder.CAN_ID_ACT3: CANDecoder.decode_act3,
+    CANDecoder.CAN_ID_TEMP: CANDecoder.decode_temp,
+    CANDecoder.CAN_ID_ACT4: CANDecoder.decode_act4,
+    CANDecoder.CAN_ID_STST1: CANDecoder.decode_stst1,
+}
+
+_MESSAGE_NAMES = {
+    CANDecoder.CAN_ID_CTL: "CTL (Control)",
+    CANDecoder.CAN_ID_STAT: "STAT (Status)",
+    CANDecoder.CAN_ID_ACT1: "ACT1 (Actual Values 1)",
+    CANDecoder.CAN_ID_ACT2: "ACT2 (Actual Values 2)",
+    CANDecoder.CAN_ID_TST1: "TST1 (Test/Diagnostic)",
+    CANDecoder.CAN_ID_REQ: "REQ (Request)",
+    CANDecoder.CAN_ID_FLTP: "FLTP (Fault Passive)",
+    CANDecoder.CAN_ID_FLTA: "FLTA (Fault Active)",
+    CANDecoder.CAN_ID_SW: "SW (Software Version)",
+    CANDecoder.CAN_ID_SN: "SN (Serial Number)",
+    CANDecoder.CAN_ID_TST2: "TST2 (Configuration)",
+    CANDecoder.CAN_ID_ACT3: "ACT3 (AC Currents)",
+    CANDecoder.CAN_ID_TEMP: "TEMP (Temperatures)",
+    CANDecoder.CAN_ID_ACT4: "ACT4 (Temperature FAN)",
+    CANDecoder.CAN_ID_STST1: "STST1 (Real Time Diagnostic)",
+}
+
+
+# ============================================================================
+# MAPPA ID - ID estesi e ID per charger
+# ============================================================================
+
+# ID di bus di ogni charger: tabella del manuale in charger_ids.py (charger
+# 1-12, 15, 16). I frame estesi usano gli stessi ID numerici; gli ID di
+# LEVEL 3 sono uguali per tutti i charger (Service CAN) e vanno al charger 1.
+EXTENDED_FLAG = 1 << 31         # Bit della chiave per i frame a 29 bit nella tabella di lookup
+
+
+class CanIdMap:
+    """Lookup ID di bus -> (ID base, charger), O(1) per qualsiasi numero di charger
+    
+    Le chiavi sono bus_id | EXTENDED_FLAG per i frame a 29 bit, così lo stesso
+    ID numerico in formato standard ed esteso non collide mai.
+    """
+    
+    def __init__(self, chargers: Sequence[int] = CHARGERS, standard: bool = True, extended: bool = True):
+        self.chargers = tuple(chargers)
+        self._table: Dict[int, Tuple[int, int]] = {}
+        
+        formats = [ext for ext, on in ((False, standard), (True, extended)) if on]
+        for ext in formats:
+            for charger in self.chargers:
+                for base_id in _DECODERS:
+                    self._add(self.bus_id(base_id, charger, ext), ext, base_id, charger)
+    
+    def _add(self, bus_id: int, extended: bool, base_id: int, charger: int):
+        key = bus_id | EXTENDED_FLAG if extended else bus_id
+        other = self._table.get(key)
+        if other is not None:
+            if base_id in SERVICE_IDS and other[0] == base_id:
+                return                      # LEVEL 3: il primo charger (1) tiene l'ID
+            raise ValueError(f"ID 0x{bus_id:X} used by charger {other[1]} and charger {charger}")
+        self._table[key] = (base_id, charger)
+    
+    def bus_id(self, base_id: int, charger: int = 1, extended: bool = False) -> int:
+        """ID sul bus per un ID base di messaggio e un charger (1-12, 15, 16)"""
+        bus_id = charger_bus_id(base_id, charger)
+        if bus_id is None:
+            raise ValueError(f"Charger {charger}: no ID set in the manual (1-12, 15, 16)")
+        return bus_id
+    
+    def resolve(self, bus_id: int, extended: bool = False) -> Optional[Tuple[int, int]]:
+        """(ID base, charger) per un ID di bus, None se non è un messaggio EVO"""
+        return self._table.get(bus_id | EXTENDED_FLAG if extended else bus_id)
+
+    def keys(self) -> List[int]:
+        """Ogni ID di bus EVO come chiave di lookup (bus_id | EXTENDED_FLAG per 29 bit)"""
+        return list(self._table)
+
+
+CANDecoder.id_map = CanIdMap()
@@ -0,0 +1,190 @@
+import struct
+from typing import List
+
+from .can_decoder import (CtlPacket, StatPacket, Act1Packet, Act2Packet, Tst1Packet,
+                          ReqPacket, FaultPacket, FailureLevel, SoftwarePacket,
+                          SerialNumberPacket, Act3Packet, TempPacket, Stst1Packet,
+                          Act4Packet, Tst2Packet)
+
+
+# ============================================================================
+# Funzioni di supporto
+# ============================================================================
+
+def _u8(value: float, scale: float) -> int:
+    return max(0, min(0xFF, int(round(value / scale))))
+
+
+def _u16(value: float, scale: float, offset: float = 0.0) -> List[int]:
+    raw = int(round((value - offset) / scale))
+    if raw < 0:
+        raw = 0
+    elif raw > 0xFFFF:
+        raw = 0xFFFF
+    return [raw >> 8, raw & 0xFF]
+
+
+def _temp(temp_C: float) -> List[int]:
+    return _u16(temp_C, 0.005188, -40.0)
+
+
+def _raw16(value: float, scale: float, offset: float = 0.0) -> int:
+    raw = int(round((value - offset) / scale))
+    return 0 if raw < 0 else (0xFFFF if raw > 0xFFFF else raw)
+
+
+_PACK_4U16 = struct.Struct('>4H').pack
+
+
+def _bits(*flags) -> int:
+    """Byte da coppie (flag, bit)"""
+    byte = 0
+    for flag, bit in flags:
+        if flag:
+            byte |= 1 << bit
+    return byte
+
+
+def _ascii8(text: str) -> List[int]:
+    raw = [ord(c) & 0xFF for c in text[:8]]
+    return raw + [0x20] * (8 - len(raw))
+
+
+# Livello di guasto -> bit di D3 (inverso di CANDecoder.decode_fault)
+_LEVEL_BITS = {
+    FailureLevel.WARNING: 0x01,
+    FailureLevel.SOFT: 0x02,
+    FailureLevel.HARD: 0x03,
+}
+
+# D1..D7 = 0xFF: "No Fault Detected"
+NO_FAULT_FRAME = [0x00] + [0xFF] * 7
+
+
+# ============================================================================
+# CLASSE ENCODER
+# ============================================================================
+
+class CANEncoder:
+    """Encoder per i messaggi CAN (inverso di CANDecoder), usato dal simulatore"""
+
+    # ========================================================================
+    # LEVEL 1 - Encoder
+    # ========================================================================
+
+    @staticmethod
+    def encode_ctl(p: CtlPacket) -> List[int]:
+        """Codifica pacchetto CTL - ID 0x618 (BMS → Charger)"""
+        return ([_bits((p.can_enable, 7), (p.led3_enable, 3))] + _u16(p.iac_max_A, 0.1)
+                + _u16(p.vout_max_V, 0.1) + _u16(p.iout_max_A, 0.1) + [0])
+
+    @staticmethod
+    def encode_stat(p: StatPacket) -> List[int]:
+        """Codifica pacchetto STAT - ID 0x610 (Charger → BMS)"""
+        d0 = _bits((p.power_enable, 7), (p.error_latch, 6), (p.warn_limit, 5),
+                   (p.lim_temp, 3), (p.warning_hv, 1), (p.bulks, 0))
+        return [d0, 0, 0, 0, 0, 0, 0, 0]
+
+    @staticmethod
+    def encode_act1(p: Act1Packet) -> List[int]:
+        """Codifica pacchetto ACT1 - ID 0x611 (Charger → BMS)"""
+        return list(_PACK_4U16(_raw16(p.iac_A, 0.1), _raw16(p.temp_C, 0.005188, -40.0),
+                               _raw16(p.vout_V, 0.1), _raw16(p.iout_A, 0.1)))
+
+    @staticmethod
+    def encode_act2(p: Act2Packet) -> List[int]:
+        """Codifica pacchetto ACT2 - ID 0x614 (Charger → BMS)"""
+        return (_temp(p.temp_loglv_C) + _u16(p.ac_power_kW, 0.01)
+                + _u16(p.prox_limit_A, 0.1) + _u16(p.pilot_limit_A, 0.1))
+
+    @staticmethod
+    def encode_tst1(p: Tst1Packet) -> List[int]:
+        """Codifica pacchetto TST1 - ID 0x615 (Charger → BMS)"""
+        return [
+            _bits((p.ack, 7), (p.pr_compl, 6), (p.pwr_ok, 5), (p.vout_ok, 4),
+                  (p.neutral, 3), (p.led3, 2), (p.led618, 1)),
+            _bits((p.ovp, 7), (p.conn_open, 6), (p.ther_fail, 2), (p.rx618_fail, 0)),
+            _bits((p.bulk1_fail, 7), (p.bulk2_fail, 6), (p.bulk3_fail, 5), (p.pump_on, 4),
+                  (p.fan_on, 3), (p.hv_rx_fail, 2), (p.cooling_fail, 1), (p.rx619_fail, 0)),
+            _bits((p.neutro1, 7), (p.neutro2, 6), (p.three_phase, 5), (p.iac_fail, 2),
+                  (p.ignition, 1), (p.lv_battery_np, 0)),
+            _bits((p.prox_ok, 7), (p.pilot_ok, 5), (p.s2_ok, 3)),
+            0,
+        ] + _u16(p.cnt_hours, 1)
+
+    # ========================================================================
+    # LEVEL 2 - Encoder
+    # ========================================================================
+
+    @staticmethod
+    def encode_req(p: ReqPacket) -> List[int]:
+        """Codifica pacchetto REQ - ID 0x61B (BMS → Charger)"""
+        return [_bits((p.enable, 7)), 0] + _u16(p.id_requested, 1) + [0, 0, 0, 0]
+
+    @staticmethod
+    def encode_fault(p: FaultPacket) -> List[int]:
+        """Codifica pacchetto guasti - ID 0x61D (attivi) o 0x61C (passivi)"""
+        return ([((p.frame_type.value & 0x03) << 6) | (p.total_errors & 0x3F),
+                 (p.frame_number & 0x3F) << 2,
+                 p.fault_code & 0xFF,
+                 ((p.occurrence & 0x3F) << 2) | _LEVEL_BITS[p.failure_level]]
+                + _u16(p.first_time_h, 1) + _u16(p.last_time_h, 1))
+
+    @staticmethod
+    def encode_software(p: SoftwarePacket) -> List[int]:
+        """Codifica pacchetto versione software - ID 0x61E"""
+        return _ascii8(p.version)
+
+    @staticmethod
+    def encode_serial_number(p: SerialNumberPacket) -> List[int]:
+        """Codifica pacchetto numero di serie - ID 0x61F"""
+        return _ascii8(p.serial)
+
+    # ========================================================================
+    # LEVEL 3 - Encoder
+    # ========================================================================
+
+    @staticmethod
+    def encode_act3(p: Act3Packet) -> List[int]:
+        """Codifica pacchetto ACT3 - ID 0x712"""
+        return (_u16(p.fan_voltage_V, 0.1) + _u16(p.iacm1_A, 0.1)
+                + _u16(p.iacm2_A, 0.1) + _u16(p.iacm3_A, 0.1))
+
+    @staticmethod
+    def encode_temp(p: TempPacket) -> List[int]:
+        """Codifica pacchetto TEMP - ID 0x713"""
+        return (_temp(p.temp_loghv_C) + _temp(p.temp_power1_C)
+                + _temp(p.temp_power2_C) + _temp(p.temp_power3_C))
+
+    @staticmethod
+    def encode_stst1(p: Stst1Packet) -> List[int]:
+        """Codifica pacchetto STST1 - ID 0x715"""
+        return [
+            _bits((p.pfc_enable, 2)),
+            _bits((p.log_temp_high, 5), (p.log_temp_low, 4), (p.uvlo_log, 3),
+                  (p.ther_low_fail, 2), (p.rx618_fail, 0)),
+            _bits((p.bulk1_fail, 7), (p.bulk2_fail, 6), (p.bulk3_fail, 5),
+                  (p.cooling_fail1, 4), (p.cooling_fail2, 3), (p.cooling_fail3, 2)),
+            _bits((p.uvlo_log_lv, 3), (p.bat_over, 1), (p.bat_under, 0)),
+            0, 0, 0, 0,
+        ]
+
+    @staticmethod
+    def encode_act4(p: Act4Packet) -> List[int]:
+        """Codifica pacchetto ACT4 - ID 0x714"""
+        return (_temp(p.temp_logfan_C) + _u16(p.iout1_raw, 1)
+                + _u16(p.iout2_raw, 1) + _u16(p.iout3_raw, 1))
+
+    # ========================================================================
+    # LEVEL 4 - Encoder
+    # ========================================================================
+
+    @staticmethod
+    def encode_tst2(p: Tst2Packet) -> List[int]:
+        """Codifica pacchetto TST2 - ID 0x616"""
+        d0 = ((p.baudrate.value & 0x03) << 6) | ((p.id_type.value & 0x01) << 5) \
+            | ((p.iac_control.value & 0x03) << 2) | (p.range.value & 0x03)
+        d1 = _bits((p.slave, 7), (p.parallel_ctrl, 1), (p.air_cooler, 0)) \
+            | ((p.evc_model.value & 0x01) << 6) | ((p.id_setting.value & 0x0F) << 2)
+        return ([d0, d1, _u8(p.iacm_max_set_A, 0.2)] + _u16(p.vout_max_set_V, 0.1)
+                + _u16(p.iout_max_set_A, 0.1) + [p.password & 0xFF])
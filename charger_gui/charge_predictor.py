@@ -0,0 +1,563 @@
+"""Previsione del tempo a piena carica e piano CTL per la finestra di pit (un charger)
+
+    python -m charger_gui.charge_predictor sessione.evlog                    # replay, una riga al minuto
+    python -m charger_gui.charge_predictor sessione.evlog --capacity 16 --window 900
+    python -m charger_gui.charge_predictor --bench                           # validazione su charge_sim
+
+Alimentato con ogni frame decodificato come LifecycleTracker; i modelli si
+aggiornano una volta per secondo di tempo dei dati e si restituisce una
+nuova Prediction:
+
+    pack      vout = ocv + R * iout, R dal salto di tensione ai gradini di
+              corrente (> R_STEP_A entro un secondo). SOC = SOC iniziale
+              (tensione a riposo tramite la curva OCV di cella di charge_sim)
+              + Ah erogati / capacità; la differenza tra l'ocv misurata e la
+              curva si segue come offset lento
+    thermal   temperatura del charger (stadio di potenza TEMP più caldo,
+              temperatura del dissipatore di ACT1 se TEMP non arriva) come
+              sistema del primo ordine pilotato dalla potenza di uscita,
+              passi di 1 s, minimi quadrati ricorsivi:
+                  T[k+1] - Ta = a * (T[k] - Ta) + b * P[k]
+              Ta è la temperatura prima dell'accensione dell'uscita
+    derating  soglia = temperatura sul fronte di salita di STAT lim_temp /
+              warn_limit (valore a priori finché non osservata). In derating
+              il charger tiene la temperatura alla soglia
+
+Il tempo a piena carica è un'esecuzione in avanti di questi modelli dallo
+stato attuale, a passi di PREDICT_STEP_S: corrente di setpoint CTL (o il
+limite di potenza del charger), limitata alla potenza che tiene la
+temperatura alla soglia di derating, poi CV alla tensione obiettivo finché la
+corrente scende sotto il cutoff.
+
+Il piano per la finestra di pit è la corrente CTL, a passi di PLAN_STEP_S,
+che eroga più energia in una finestra fissa senza raggiungere la soglia di
+derating. Con un modello termico del primo ordine l'energia di una finestra è
+    (tau * (T_end - T_0) + integrale di (T - Ta) dt) / gain
+quindi il profilo migliore tiene la temperatura più alta possibile in ogni
+istante: corrente piena fino al margine sotto la soglia, poi la corrente che
+la tiene lì. Ogni passo prende la corrente più alta la cui temperatura a fine
+passo resta sotto il limite.
+"""
+
+import math
+import sys
+import time
+from typing import List, NamedTuple, Optional, Tuple
+
+from .can_decoder import CANDecoder
+from .charge_sim import cell_ocv, cell_soc
+
+C = CANDecoder
+
+PACK_CAPACITY_AH = 16.0         # Pacco dell'auto: 100s4p, celle da 4 Ah
+PACK_CELLS_SERIES = 100
+CUTOFF_A = 0.8                  # Fine carica del BMS in CV
+POWER_MAX_KW = 11.0             # Potenza di uscita nominale EVO11KA
+IOUT_MAX_A = 30.0               # ... e corrente (limite del piano prima di qualsiasi CTL)
+ACTIVE_A = 0.5                  # iout sopra questa soglia = in carica
+
+R_PRIOR_OHM = 0.5               # Fino al primo gradino di corrente
+R_STEP_A = 2.0
+OCV_OFFSET_RATE = 0.01          # Al secondo, ocv misurata - curva
+TAU_PRIOR_S = 240.0
+GAIN_PRIOR_K_KW = 4.0
+RLS_FORGET = 0.9995
+DERATE_TEMP_PRIOR_C = 70.0      # Soglia FAULT_A7 del charger
+TEMP_STALE_S = 5.0              # TEMP più vecchio di così: si usa la temperatura di ACT1
+
+PREDICT_STEP_S = 5.0
+PREDICT_MAX_S = 4 * 3600.0
+PLAN_STEP_S = 30.0
+PLAN_MARGIN_C = 0.5             # Il piano resta a questa distanza sotto la soglia di derating
+PIT_WINDOW_S = 900.0            # Finestra di default (tooltip della GUI)
+
+
+class Prediction(NamedTuple):
+    t: float                            # Tempo dei dati dell'aggiornamento [s]
+    charging: bool
+    cv: bool                            # Già alla tensione obiettivo
+    time_to_full_s: Optional[float]     # None: non in carica, o oltre PREDICT_MAX_S
+    energy_to_full_kWh: float
+    soc: float                          # Stima attuale, 0-1
+    derating_in_s: Optional[float]      # Primo derating previsto (0 = già in derating), None se mai
+    resistance_ohm: float
+    tau_s: float
+    gain_K_kW: float
+    derate_temp_C: float
+
+
+class PlanStep(NamedTuple):
+    t_s: float                          # Dall'inizio della finestra
+    iout_max_A: float                   # Setpoint di corrente CTL
+    vout_max_V: float                   # Limite di tensione CTL (l'obiettivo)
+    power_kW: float                     # Media prevista
+    temp_C: float                       # Prevista a fine passo
+
+
+class PitPlan(NamedTuple):
+    window_s: float
+    steps: List[PlanStep]
+    energy_kWh: float
+    peak_temp_C: float
+    baseline_kWh: float                 # Stessa finestra tenendo il setpoint attuale (derating incluso)
+    baseline_limited_s: float           # ... di cui tenuti alla soglia di derating
+
+
+class ThermalModel:
+    """T[k+1] - Ta = a (T[k] - Ta) + b P[k], passi di 1 s, P in kW; RLS con fattore di oblio"""
+
+    def __init__(self):
+        a = math.exp(-1.0 / TAU_PRIOR_S)
+        self.theta = [a, GAIN_PRIOR_K_KW * (1.0 - a)]
+        self.cov = [[1e-6, 0.0], [0.0, 1e-4]]
+
+    def update(self, dT0: float, p_kW: float, dT1: float):
+        (p00, p01), (p10, p11) = self.cov
+        px0, px1 = p00 * dT0 + p01 * p_kW, p10 * dT0 + p11 * p_kW
+        den = RLS_FORGET + dT0 * px0 + p_kW * px1
+        k0, k1 = px0 / den, px1 / den
+        err = dT1 - (self.theta[0] * dT0 + self.theta[1] * p_kW)
+        self.theta[0] = min(max(self.theta[0] + k0 * err, 0.9), 0.99999)
+        self.theta[1] = max(self.theta[1] + k1 * err, 1e-6)
+        lam = RLS_FORGET
+        self.cov = [[(p00 - k0 * px0) / lam, (p01 - k0 * px1) / lam],
+                    [(p10 - k1 * px0) / lam, (p11 - k1 * px1) / lam]]
+
+    @property
+    def tau_s(self) -> float:
+        return -1.0 / math.log(self.theta[0])
+
+    @property
+    def gain_K_kW(self) -> float:
+        return self.theta[1] / (1.0 - self.theta[0])
+
+    def step(self, temp_C: float, ambient_C: float, p_kW: float, dt: float) -> float:
+        """Temperatura dopo dt a potenza costante"""
+        final = ambient_C + self.gain_K_kW * p_kW
+        return final + (temp_C - final) * math.exp(-dt / self.tau_s)
+
+    def max_power(self, temp_C: float, ambient_C: float, limit_C: float, dt: float) -> float:
+        """Potenza costante più alta che termina il passo a o sotto limit_C [kW]"""
+        # limit = Ta + gain P + (T - Ta - gain P) e  ->  P
+        e = math.exp(-dt / self.tau_s)
+        return max(0.0, (limit_C - ambient_C - (temp_C - ambient_C) * e) / (self.gain_K_kW * (1.0 - e)))
+
+
+def _current_for(ocv: float, r: float, p_kW: float) -> float:
+    """Corrente che dà p_kW ai morsetti: (ocv + r i) i = P"""
+    return (-ocv + math.sqrt(ocv * ocv + 4.0 * r * p_kW * 1000.0)) / (2.0 * r)
+
+
+class ChargePredictor:
+    """Modelli appresi dai frame live, Prediction una volta al secondo"""
+
+    def __init__(self, capacity_Ah: float = PACK_CAPACITY_AH, target_V: Optional[float] = None,
+                 cells_series: int = PACK_CELLS_SERIES, cutoff_A: float = CUTOFF_A,
+                 power_max_kW: float = POWER_MAX_KW):
+        self.capacity_Ah = capacity_Ah
+        self.target_V = target_V                # None: CTL vout_max_V
+        self.cells_series = cells_series
+        self.cutoff_A = cutoff_A
+        self.power_max_kW = power_max_kW
+        self.thermal = ThermalModel()
+        self.resistance_ohm = R_PRIOR_OHM
+        self.derate_temp_C = DERATE_TEMP_PRIOR_C
+        self.ambient_C: Optional[float] = None
+        self.prediction: Optional[Prediction] = None
+        self.update_s = 0.0                     # Tempo speso nell'ultimo aggiornamento
+        # Ultimi valori dei frame
+        self.iout_A = self.vout_V = 0.0
+        self.act1_temp_C: Optional[float] = None
+        self.temp_C: Optional[float] = None     # Stadi di potenza TEMP
+        self.temp_t = -1e9
+        self.derating = False
+        self.iout_set_A: Optional[float] = None
+        self.vout_set_V: Optional[float] = None
+        # Al secondo
+        self._second: Optional[int] = None
+        self._energy_kWs = 0.0                  # Energia in uscita nel secondo corrente
+        self._last_act1_t: Optional[float] = None
+        self._prev: Optional[Tuple[float, float, float, float, bool]] = None    # iout, vout, temp, kW, derating
+        self._charged = False
+        self._rest_V: Optional[float] = None    # vout con l'uscita spenta
+        self._soc0: Optional[float] = None
+        self._charge_Ah = 0.0
+        self._ocv_offset = 0.0
+
+    # ------------------------------------------------------------------
+    # Frame
+    # ------------------------------------------------------------------
+
+    def feed(self, base_id: int, packet, t: float) -> Optional[Prediction]:
+        """Aggiorna con un frame decodificato (t in secondi); una nuova Prediction ogni secondo"""
+        out = None
+        second = int(t)
+        if self._second is None:
+            self._second = second
+        elif second > self._second:
+            out = self._update(float(second))
+            self._second = second
+        if base_id == C.CAN_ID_ACT1:
+            if self._last_act1_t is not None:
+                self._energy_kWs += self.vout_V * self.iout_A / 1000.0 * min(t - self._last_act1_t, 2.0)
+            self._last_act1_t = t
+            self.iout_A, self.vout_V, self.act1_temp_C = packet.iout_A, packet.vout_V, packet.temp_C
+        elif base_id == C.CAN_ID_TEMP:
+            self.temp_C = max(packet.temp_power1_C, packet.temp_power2_C, packet.temp_power3_C)
+            self.temp_t = t
+        elif base_id == C.CAN_ID_STAT:
+            self.derating = packet.lim_temp or packet.warn_limit
+        elif base_id == C.CAN_ID_CTL:
+            self.iout_set_A, self.vout_set_V = packet.iout_max_A, packet.vout_max_V
+        return out
+
+    def _temperature(self, t: float) -> Optional[float]:
+        if self.temp_C is not None and t - self.temp_t <= TEMP_STALE_S:
+            return self.temp_C
+        return self.act1_temp_C
+
+    @property
+    def target(self) -> Optional[float]:
+        return self.target_V if self.target_V is not None else self.vout_set_V
+
+    def ocv(self, soc: float) -> float:
+        return cell_ocv(soc) * self.cells_series + self._ocv_offset
+
+    @property
+    def soc(self) -> Optional[float]:
+        if self._soc0 is None:
+            # Prima della carica: tensione a riposo, se il charger la riporta
+            return None if self._rest_V is None else cell_soc(self._rest_V / self.cells_series)
+        return min(self._soc0 + self._charge_Ah / self.capacity_Ah, 1.0)
+
+    # ------------------------------------------------------------------
+    # Una volta al secondo
+    # ------------------------------------------------------------------
+
+    def _update(self, t: float) -> Optional[Prediction]:
+        start = time.perf_counter()
+        iout, vout = self.iout_A, self.vout_V
+        temp = self._temperature(t)
+        p_kW, self._energy_kWs = self._energy_kWs, 0.0
+        if temp is None:
+            return None
+        charging = iout > ACTIVE_A
+        if not self._charged:
+            if charging:
+                self._charged = True
+            else:
+                self.ambient_C = temp           # Uscita spenta: il charger resta a temperatura ambiente
+                if vout > 0.0:
+                    self._rest_V = vout
+        if self.ambient_C is None:
+            self.ambient_C = temp
+
+        prev = self._prev
+        if prev is not None and self._charged:
+            prev_iout, prev_vout, prev_temp, prev_kW, prev_derating = prev
+            self.thermal.update(prev_temp - self.ambient_C, prev_kW, temp - self.ambient_C)
+            di = iout - prev_iout
+            if abs(di) > R_STEP_A and iout > ACTIVE_A and prev_iout > ACTIVE_A:
+                r = (vout - prev_vout) / di
+                if 0.0 < r < 5.0:
+                    self.resistance_ohm += 0.3 * (r - self.resistance_ohm)
+            if self.derating and not prev_derating:
+                self.derate_temp_C += 0.3 * (prev_temp - self.derate_temp_C)
+        if charging:
+            measured = vout - self.resistance_ohm * iout
+            if self._soc0 is None:
+                rest = self._rest_V if self._rest_V is not None else measured
+                self._soc0 = cell_soc(rest / self.cells_series)
+            else:
+                self._charge_Ah += iout / 3600.0
+                self._ocv_offset += OCV_OFFSET_RATE * (measured - self.ocv(self.soc))
+        self._prev = (iout, vout, temp, p_kW, self.derating)
+
+        self.prediction = self._predict(t, temp, charging)
+        self.update_s = time.perf_counter() - start
+        return self.prediction
+
+    def _current(self, ocv: float, setpoint: float, target: float, p_max_kW: float) -> Tuple[float, bool]:
+        """(corrente di uscita, limitata in CV)"""
+        cv_limit = max((target - ocv) / self.resistance_ohm, 0.0)
+        current = min(setpoint, _current_for(ocv, self.resistance_ohm, p_max_kW))
+        if cv_limit <= current:
+            return cv_limit, True
+        return current, False
+
+    def _setpoint(self) -> float:
+        return self.iout_set_A if self.iout_set_A else self.iout_A
+
+    def _predict(self, t: float, temp: float, charging: bool) -> Prediction:
+        th = self.thermal
+        target = self.target
+        soc = self.soc
+        cv_now = target is not None and self.vout_V >= target - 1.0
+        model = (self.resistance_ohm, th.tau_s, th.gain_K_kW, self.derate_temp_C)
+        if not charging or target is None or soc is None:
+            return Prediction(t, charging, cv_now, None, 0.0, soc or 0.0,
+                              0.0 if self.derating else None, *model)
+
+        setpoint = self._setpoint()
+        r, ta, limit = self.resistance_ohm, self.ambient_C, self.derate_temp_C
+        dt = PREDICT_STEP_S
+        derating_in = 0.0 if self.derating else None
+        elapsed = energy = 0.0
+        s = soc
+        done = False
+        while elapsed < PREDICT_MAX_S:
+            ocv = self.ocv(s)
+            # In derating: il charger tiene la temperatura di soglia
+            p_max = min(self.power_max_kW, th.max_power(temp, ta, limit, dt)) \
+                if temp >= limit - 0.05 else self.power_max_kW
+            current, cv = self._current(ocv, setpoint, target, p_max)
+            if cv and current < self.cutoff_A:
+                done = True
+                break
+            p = (ocv + r * current) * current / 1000.0
+            temp_next = th.step(temp, ta, p, dt)
+            if derating_in is None and temp_next >= limit:
+                derating_in = elapsed + dt * (limit - temp) / max(temp_next - temp, 1e-9)
+            temp = temp_next
+            energy += p * dt / 3600.0
+            s = min(s + current * dt / 3600.0 / self.capacity_Ah, 1.0)
+            elapsed += dt
+        return Prediction(t, charging, cv_now, elapsed if done else None, energy, soc, derating_in, *model)
+
+    # ------------------------------------------------------------------
+    # Finestra di pit
+    # ------------------------------------------------------------------
+
+    def plan(self, window_s: float, iout_cap_A: Optional[float] = None, step_s: float = PLAN_STEP_S,
+             margin_C: float = PLAN_MARGIN_C) -> Optional[PitPlan]:
+        """Profilo CTL con più energia in window_s senza derating; None finché manca la tensione del pacco"""
+        p = self.prediction
+        target = self.target
+        if p is None or self.soc is None or target is None:
+            return None
+        th = self.thermal
+        temp0 = self._temperature(float(self._second))
+        ta, r = self.ambient_C, self.resistance_ohm
+        if iout_cap_A is not None:
+            cap = iout_cap_A
+        else:
+            cap = self._setpoint() if self._setpoint() > ACTIVE_A else IOUT_MAX_A
+        limit = self.derate_temp_C - margin_C
+        inner = PREDICT_STEP_S
+
+        steps: List[PlanStep] = []
+        soc, temp, energy, peak = self.soc, temp0, 0.0, temp0
+        t = 0.0
+        while t < window_s - 1e-9:
+            dt = min(step_s, window_s - t)
+            ocv = self.ocv(soc)
+            p_allowed = min(self.power_max_kW, th.max_power(temp, ta, limit, dt))
+            current, _cv = self._current(ocv, cap, target, p_allowed)
+            current = math.floor(current * 10.0) / 10.0         # Risoluzione CTL 0.1 A
+            e0 = energy
+            k = max(1, int(round(dt / inner)))
+            for _ in range(k):
+                ocv = self.ocv(soc)
+                i, _cv = self._current(ocv, current, target, self.power_max_kW)
+                pk = (ocv + r * i) * i / 1000.0
+                temp = th.step(temp, ta, pk, dt / k)
+                energy += pk * dt / k / 3600.0
+                soc = min(soc + i * dt / k / 3600.0 / self.capacity_Ah, 1.0)
+                peak = max(peak, temp)
+            steps.append(PlanStep(t, current, target, (energy - e0) * 3600.0 / dt, temp))
+            t += dt
+
+        # Riferimento: il setpoint attuale per tutta la finestra, derating incluso
+        soc, temp, base_e, base_limited = self.soc, temp0, 0.0, 0.0
+        t = 0.0
+        while t < window_s - 1e-9:
+            dt = min(inner, window_s - t)
+            derated = temp >= self.derate_temp_C - 0.05
+            p_max = min(self.power_max_kW, th.max_power(temp, ta, self.derate_temp_C, dt)) \
+                if derated else self.power_max_kW
+            ocv = self.ocv(soc)
+            i, _cv = self._current(ocv, cap, target, p_max)
+            pk = (ocv + r * i) * i / 1000.0
+            temp = th.step(temp, ta, pk, dt)
+            base_e += pk * dt / 3600.0
+            base_limited += dt if derated else 0.0
+            soc = min(soc + i * dt / 3600.0 / self.capacity_Ah, 1.0)
+            t += dt
+        return PitPlan(window_s, steps, energy, peak, base_e, base_limited)
+
+
+# ============================================================================
+# Report
+# ============================================================================
+
+def _fmt_min(s: Optional[float]) -> str:
+    return "-" if s is None else f"{s / 60:.1f} min"
+
+
+def format_prediction(p: Prediction) -> str:
+    if not p.charging:
+        return f"{p.t:7.0f} s  not charging"
+    derating = "now" if p.derating_in_s == 0 else _fmt_min(p.derating_in_s)
+    return (f"{p.t:7.0f} s  full in {_fmt_min(p.time_to_full_s):>10}  {p.energy_to_full_kWh:5.2f} kWh  "
+            f"SOC {p.soc * 100:5.1f}%  derating {derating}{'  CV' if p.cv else ''}  "
+            f"(R {p.resistance_ohm:.3f} ohm, tau {p.tau_s:.0f} s, {p.gain_K_kW:.2f} K/kW)")
+
+
+def format_plan(plan: PitPlan) -> List[str]:
+    lines = [f"pit window {plan.window_s / 60:.1f} min: {plan.energy_kWh:.3f} kWh, peak {plan.peak_temp_C:.1f} C "
+             f"(present setpoint: {plan.baseline_kWh:.3f} kWh, {plan.baseline_limited_s:.0f} s at the derating limit)"]
+    last = None
+    for s in plan.steps:
+        if last is None or abs(s.iout_max_A - last) >= 0.5 or s is plan.steps[-1]:
+            lines.append(f"  t {s.t_s:6.0f} s  CTL iout_max {s.iout_max_A:5.1f} A  vout_max {s.vout_max_V:5.1f} V  "
+                         f"~{s.power_kW:5.2f} kW  {s.temp_C:5.1f} C")
+            last = s.iout_max_A
+    return lines
+
+
+# ============================================================================
+# CLI
+# ============================================================================
+
+def _sim_run(ambient_C: float, cc_A: float, schedule=None, until_s: Optional[float] = None,
+             predictor: Optional[ChargePredictor] = None) -> List[Tuple[float, float, bool]]:
+    """Run di charge_sim, schedule(t) -> richiesta di corrente del BMS; per tick (t, kW in uscita, derating)"""
+    from .charge_sim import ChargeProfile, ChargeSimulation
+    from .lifecycle import _decoded
+    profile = ChargeProfile(cc_current_A=cc_A)
+    sim = ChargeSimulation(ambient_C=ambient_C, profile=profile)
+    log = []
+    for frames in sim.ticks():
+        t = frames[0].t_ms / 1000.0
+        if until_s is not None and t >= until_s:
+            break
+        if schedule is not None:
+            profile.cc_current_A = schedule(t)
+        if predictor is not None:
+            for base_id, packet, ft in _decoded((f.can_id, f.extended, f.data, f.t_ms / 1000.0) for f in frames):
+                predictor.feed(base_id, packet, ft)
+        s = sim.sim.state
+        log.append((t, s.vout_V * s.iout_A / 1000.0, s.derating))
+    return log
+
+
+def _window(log, t0: float, t1: float, tick_s: float = 0.1) -> Tuple[float, float]:
+    """(kWh, s in derating) di un log di _sim_run in [t0, t1)"""
+    e = d = 0.0
+    for t, p, derated in log:
+        if t0 <= t < t1:
+            e += p * tick_s / 3600.0
+            d += tick_s if derated else 0.0
+    return e, d
+
+
+def bench() -> bool:
+    """Errore di previsione su una carica simulata a 35 C; piano di pit riprodotto sulla simulazione"""
+    from .charge_sim import ChargeProfile, ChargeSimulation
+    from .lifecycle import _decoded
+    ambient, cc = 35.0, 24.0
+    predictor = ChargePredictor()
+    preds: List[Prediction] = []
+    costs: List[float] = []
+    sim = ChargeSimulation(ambient_C=ambient, profile=ChargeProfile(cc_current_A=cc))
+    for frames in sim.ticks():
+        for base_id, packet, t in _decoded((f.can_id, f.extended, f.data, f.t_ms / 1000.0) for f in frames):
+            p = predictor.feed(base_id, packet, t)
+            if p is not None:
+                costs.append(predictor.update_s)
+                if p.charging:
+                    preds.append(p)
+    start, end = preds[0].t, preds[-1].t
+    total = end - start
+    print(f"charge_sim {ambient:.0f} C, CC {cc:.0f} A: {total / 60:.1f} min, "
+          f"update {sum(costs) / len(costs) * 1e3:.2f} ms avg, {max(costs) * 1e3:.2f} ms max")
+    errors = []
+    for frac in (0.1, 0.25, 0.5, 0.75, 0.9):
+        p = min(preds, key=lambda q: abs(q.t - (start + frac * total)))
+        actual = end - p.t
+        err = (p.time_to_full_s - actual) if p.time_to_full_s is not None else float("inf")
+        errors.append(abs(err) / total)
+        print(f"  at {frac * 100:3.0f}%  predicted {_fmt_min(p.time_to_full_s):>10}  actual {_fmt_min(actual):>10}  "
+              f"error {err / 60:+5.1f} min ({err / total * 100:+5.1f}% of the charge)")
+    p = preds[-1]
+    cfg = sim.charger_cfg
+    print(f"  learned R {p.resistance_ohm:.3f} ohm (plant {sim.pack_cfg.resistance_ohm:.3f}), "
+          f"tau {p.tau_s:.0f} s (plant {cfg.thermal_tau_s:.0f}), gain {p.gain_K_kW:.2f} K/kW "
+          f"(plant {(1 / cfg.efficiency - 1) * cfg.thermal_resistance_K_W * 1000:.2f}), "
+          f"derating at {p.derate_temp_C:.1f} C")
+
+    # Finestra di pit: la stessa carica fino a t0, poi il piano o una richiesta costante per la finestra
+    t0, window = 600.0, 900.0
+    early = ChargePredictor()
+    _sim_run(ambient, cc, until_s=t0, predictor=early)
+    plan = early.plan(window, iout_cap_A=30.0)
+    for line in format_plan(plan):
+        print("  " + line)
+
+    def planned(t: float) -> float:
+        if t < t0:
+            return cc
+        return plan.steps[min(int((t - t0) // PLAN_STEP_S), len(plan.steps) - 1)].iout_max_A
+
+    def replay(schedule) -> Tuple[float, float]:
+        return _window(_sim_run(ambient, cc, schedule=schedule, until_s=t0 + window), t0, t0 + window)
+
+    e_plan, d_plan = replay(planned)
+    print(f"  replay plan           {e_plan:.3f} kWh, derated {d_plan:5.1f} s")
+    for amps in (cc, 30.0):
+        e, d = replay(lambda t, a=amps: cc if t < t0 else a)
+        print(f"  replay CC {amps:4.1f} A       {e:.3f} kWh, derated {d:5.1f} s")
+    # Migliore richiesta costante che non va mai in derating nella finestra (bisezione, 0.1 A)
+    lo, hi = 0.0, 30.0
+    best = (0.0, 0.0)
+    while hi - lo > 0.1:
+        mid = (lo + hi) / 2
+        e, d = replay(lambda t, a=mid: cc if t < t0 else a)
+        if d == 0.0:
+            lo, best = mid, (e, d)
+        else:
+            hi = mid
+    print(f"  replay CC {lo:4.1f} A       {best[0]:.3f} kWh, derated {best[1]:5.1f} s "
+          f"(highest constant request without derating)")
+    ok = all(e < 0.1 for e in errors) and d_plan == 0.0 and e_plan >= best[0]
+    print(f"plan vs best constant: {(e_plan / best[0] - 1) * 100:+.1f}%  {'OK' if ok else 'FAIL'}")
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    from .lifecycle import _decoded, _read_file
+    parser = argparse.ArgumentParser(description="Time to full and pit-window CTL plan")
+    parser.add_argument("files", nargs="*", help=".evlog recordings or gateway logs")
+    parser.add_argument("--capacity", type=float, default=PACK_CAPACITY_AH, help="pack capacity [Ah]")
+    parser.add_argument("--cells", type=int, default=PACK_CELLS_SERIES, help="cells in series")
+    parser.add_argument("--target", type=float, help="target voltage [V] (default: CTL vout_max)")
+    parser.add_argument("--window", type=float, help="pit window [s]: plan at the end of the file")
+    parser.add_argument("--every", type=float, default=60.0, help="print a prediction every N s")
+    parser.add_argument("--bench", action="store_true", help="validation on charge_sim")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        return 0 if bench() else 1
+    if not args.files:
+        parser.error("no input files")
+    for path in args.files:
+        predictor = ChargePredictor(args.capacity, args.target, args.cells)
+        shown = -1e9
+        try:
+            for base_id, packet, t in _decoded(_read_file(path)):
+                p = predictor.feed(base_id, packet, t)
+                if p is not None and p.t - shown >= args.every:
+                    print(format_prediction(p))
+                    shown = p.t
+        except (OSError, ValueError) as e:
+            print(f"{path}: {e}")
+            return 1
+        if args.window:
+            plan = predictor.plan(args.window)
+            print("\n".join(format_plan(plan)) if plan else "no charge data for a plan")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,386 @@
+"""Simulazione di carica a ciclo chiuso in tempo virtuale (pacco + charger + profilo BMS)
+
+    python -m charger_gui.charge_sim                               # una carica 0-100%
+    python -m charger_gui.charge_sim --ambient 40 --soc 20 -o charge.log
+    python -m charger_gui.charge_sim --sweep                       # batch su più condizioni
+    python -m charger_gui.charge_sim --realtime /dev/pts/3         # stessi frame, a tempo reale
+
+Il lato BMS (profilo di carica + derating) parla con il charger simulato
+solo tramite frame CAN: invia CTL a ogni tick e rilegge ACT1/STAT, proprio
+come sull'auto. Un tick = 100 ms, niente sleep: una carica completa gira in
+molto meno di un secondo di tempo reale.
+"""
+
+import bisect
+import itertools
+import sys
+import time
+from dataclasses import dataclass, field
+from typing import Iterator, List, Optional
+
+from .can_decoder import CANDecoder, CtlPacket
+from .can_encoder import CANEncoder
+from .simulator import ChargerSimulator, SimFrame, open_sink, play_realtime
+
+
+# ============================================================================
+# Modello del pacco
+# ============================================================================
+
+# Tensione a vuoto della cella (NMC), SOC 0-1 -> V
+_OCV_SOC = [0.00, 0.05, 0.10, 0.20, 0.30, 0.40, 0.50, 0.60, 0.70, 0.80, 0.90, 1.00]
+_OCV_V = [3.00, 3.30, 3.45, 3.56, 3.62, 3.67, 3.72, 3.80, 3.88, 3.96, 4.06, 4.18]
+
+
+def cell_ocv(soc: float) -> float:
+    if soc <= 0.0:
+        return _OCV_V[0]
+    if soc >= 1.0:
+        return _OCV_V[-1]
+    i = bisect.bisect_right(_OCV_SOC, soc)
+    s0, s1 = _OCV_SOC[i - 1], _OCV_SOC[i]
+    v0, v1 = _OCV_V[i - 1], _OCV_V[i]
+    return v0 + (v1 - v0) * (soc - s0) / (s1 - s0)
+
+
+def cell_soc(v: float) -> float:
+    """Inversa di cell_ocv (la tabella è monotona)"""
+    if v <= _OCV_V[0]:
+        return 0.0
+    if v >= _OCV_V[-1]:
+        return 1.0
+    i = bisect.bisect_right(_OCV_V, v)
+    s0, s1 = _OCV_SOC[i - 1], _OCV_SOC[i]
+    v0, v1 = _OCV_V[i - 1], _OCV_V[i]
+    return s0 + (s1 - s0) * (v - v0) / (v1 - v0)
+
+
+@dataclass
+class PackConfig:
+    cells_series: int = 100
+    cells_parallel: int = 4
+    cell_capacity_Ah: float = 4.0
+    cell_resistance_ohm: float = 0.022
+    cell_v_max: float = 4.18
+    heat_capacity_J_K: float = 40000.0      # pacco intero
+    cooling_W_K: float = 8.0
+
+    @property
+    def capacity_Ah(self) -> float:
+        return self.cell_capacity_Ah * self.cells_parallel
+
+    @property
+    def resistance_ohm(self) -> float:
+        return self.cell_resistance_ohm * self.cells_series / self.cells_parallel
+
+
+class PackModel:
+    def __init__(self, cfg: PackConfig, soc: float, temp_C: float):
+        self.cfg = cfg
+        self.soc = soc
+        self.temp_C = temp_C
+        self.resistance_ohm = cfg.resistance_ohm
+        self._series = cfg.cells_series
+        self._ah_per_As = 1.0 / 3600.0 / cfg.capacity_Ah
+        self.ocv_V = cell_ocv(soc) * self._series
+
+    def terminal_V(self, current_A: float) -> float:
+        return self.ocv_V + current_A * self.resistance_ohm
+
+    def step(self, current_A: float, dt: float, ambient_C: float):
+        cfg = self.cfg
+        if current_A:
+            self.soc = min(1.0, self.soc + current_A * dt * self._ah_per_As)
+            self.ocv_V = cell_ocv(self.soc) * self._series
+        heat = current_A * current_A * self.resistance_ohm - cfg.cooling_W_K * (self.temp_C - ambient_C)
+        self.temp_C += heat * dt / cfg.heat_capacity_J_K
+
+
+# ============================================================================
+# Impianto charger (EVO11K)
+# ============================================================================
+
+@dataclass
+class ChargerConfig:
+    power_max_W: float = 11000.0
+    iout_max_A: float = 30.0
+    vout_max_V: float = 500.0
+    efficiency: float = 0.94
+    derating_factor: float = 0.5            # limite di potenza con FAULT_A7 attivo
+    thermal_resistance_K_W: float = 0.06    # dissipatore verso liquido/ambiente
+    thermal_tau_s: float = 240.0
+    mains_V: float = 230.0
+    ramp_A_s: float = 5.0                   # soft start: salita massima della corrente
+
+
+# ============================================================================
+# Profilo di carica BMS (CC/CV + derating)
+# ============================================================================
+
+@dataclass
+class ChargeProfile:
+    cc_current_A: float = 24.0
+    cutoff_A: float = 0.8                   # fine della fase CV
+    iac_max_A: float = 16.0
+    derate_start_C: float = 45.0            # temperatura del pacco: riduzione lineare della corrente
+    derate_stop_C: float = 55.0             # ... fino a zero
+    charger_derate_factor: float = 0.7      # corrente richiesta con STAT lim_temp
+
+    def setpoint(self, cfg: PackConfig, pack_temp_C: float, lim_temp: bool) -> float:
+        current = self.cc_current_A
+        if pack_temp_C >= self.derate_stop_C:
+            return 0.0
+        if pack_temp_C > self.derate_start_C:
+            current *= (self.derate_stop_C - pack_temp_C) / (self.derate_stop_C - self.derate_start_C)
+        if lim_temp:
+            current *= self.charger_derate_factor
+        return current
+
+
+@dataclass
+class ChargeResult:
+    ambient_C: float
+    soc_start: float
+    soc_end: float
+    completed: bool
+    charge_time_s: float
+    max_charger_temp_C: float
+    max_pack_temp_C: float
+    derating_s: float
+    frames: int
+    wall_s: float
+    frame_log: List[SimFrame] = field(default_factory=list, repr=False)
+
+
+# ============================================================================
+# Simulazione
+# ============================================================================
+
+class ChargeSimulation:
+    """Pacco + charger + BMS a ciclo chiuso, in tempo virtuale"""
+
+    def __init__(self, pack: Optional[PackConfig] = None, charger: Optional[ChargerConfig] = None,
+                 profile: Optional[ChargeProfile] = None, ambient_C: float = 25.0,
+                 soc: float = 0.0, tick_ms: int = 100, charger_id: int = 1):
+        self.pack_cfg = pack or PackConfig()
+        self.charger_cfg = charger or ChargerConfig()
+        self.profile = profile or ChargeProfile()
+        self.ambient_C = ambient_C
+        self.soc_start = soc
+        self.pack = PackModel(self.pack_cfg, soc, ambient_C)
+        self.sim = ChargerSimulator(charger_id, tick_ms=tick_ms)
+        self.sim.state.pr_compl = False         # AC collegata a t = 0: parte dalla precarica
+        self.sim.state.iout_A = 0.0
+        self.sim.state.temp_C = ambient_C
+        self.sim.state.temp_loglv_C = ambient_C
+        self.dt = tick_ms / 1000.0
+        self.ctl_bus_id = self.sim.bus_id(CANDecoder.CAN_ID_CTL)
+        self.act1_bus_id = self.sim.bus_id(CANDecoder.CAN_ID_ACT1)
+        self.stat_bus_id = self.sim.bus_id(CANDecoder.CAN_ID_STAT)
+        self._vout_max = self.pack_cfg.cell_v_max * self.pack_cfg.cells_series
+        self._ctl_cache = {}
+        self._last_act1 = None
+        self.done = False
+        # Ultimi valori letti dal BMS sul charger
+        self.act1_iout_A = 0.0
+        self.lim_temp = False
+        self.cv_phase = False
+        # Statistiche
+        self.max_charger_temp_C = ambient_C
+        self.max_pack_temp_C = ambient_C
+        self.derating_ticks = 0
+        self.charge_ticks = 0
+
+    # ------------------------------------------------------------------
+    # Lato BMS: frame in ingresso, CTL in uscita
+    # ------------------------------------------------------------------
+
+    def _bms_ctl(self) -> List[int]:
+        vout_max = self._vout_max
+        if self.pack.terminal_V(self.act1_iout_A) >= vout_max - 0.5:
+            self.cv_phase = True
+        if self.cv_phase and self.act1_iout_A < self.profile.cutoff_A:
+            self.done = True
+        iout = 0.0 if self.done else self.profile.setpoint(self.pack_cfg, self.pack.temp_C, self.lim_temp)
+
+        # Stessa richiesta -> stesso frame: codifica solo quando cambia il setpoint (0.1 A)
+        key = (self.done, round(iout, 1))
+        ctl = self._ctl_cache.get(key)
+        if ctl is None:
+            ctl = self._ctl_cache[key] = CANEncoder.encode_ctl(
+                CtlPacket(not self.done, False, self.profile.iac_max_A, vout_max, iout))
+        return ctl
+
+    def _bms_receive(self, frames: List[SimFrame]):
+        for f in frames:
+            if f.can_id == self.act1_bus_id:
+                if f.data != self._last_act1:
+                    self._last_act1 = f.data
+                    self.act1_iout_A = CANDecoder.decode_act1(f.data).iout_A
+            elif f.can_id == self.stat_bus_id:
+                self.lim_temp = CANDecoder.decode_stat(f.data).lim_temp
+
+    # ------------------------------------------------------------------
+    # Impianto charger
+    # ------------------------------------------------------------------
+
+    def _plant(self):
+        s, c, pack = self.sim.state, self.charger_cfg, self.pack
+        current = 0.0
+        derating = s.derating
+        if s.charging:
+            power_max = c.power_max_W * (c.derating_factor if derating else 1.0)
+            v_limit = min(s.vout_max_V, c.vout_max_V)
+            i_cv = (v_limit - pack.ocv_V) / pack.resistance_ohm
+            current = min(s.iout_max_A, c.iout_max_A, i_cv, power_max / pack.ocv_V,
+                          s.iout_A + c.ramp_A_s * self.dt)
+            if current < 0.0:
+                current = 0.0
+
+        vout = pack.ocv_V + current * pack.resistance_ohm
+        p_out = vout * current
+        p_in = p_out / c.efficiency if current > 0 else 0.0
+        pack.step(current, self.dt, self.ambient_C)
+
+        # Dissipatore del charger: primo ordine verso l'ambiente + perdite * Rth
+        target = self.ambient_C + (p_in - p_out) * c.thermal_resistance_K_W
+        s.temp_C += (target - s.temp_C) * self.dt / c.thermal_tau_s
+        s.temp_loglv_C = self.ambient_C + (s.temp_C - self.ambient_C) * 0.5
+        s.vout_V = vout
+        s.iout_A = current
+        s.iac_A = min(s.iac_max_A, p_in / c.mains_V / (3 if s.three_phase else 1))
+
+        if s.temp_C > self.max_charger_temp_C:
+            self.max_charger_temp_C = s.temp_C
+        if pack.temp_C > self.max_pack_temp_C:
+            self.max_pack_temp_C = pack.temp_C
+        if derating:
+            self.derating_ticks += 1
+        if current > 0:
+            self.charge_ticks += 1
+
+    # ------------------------------------------------------------------
+    # Ciclo
+    # ------------------------------------------------------------------
+
+    def ticks(self, max_s: float = 4 * 3600.0) -> Iterator[List[SimFrame]]:
+        """Frame di ogni tick: CTL del BMS (Tx) + frame del charger (Rx)"""
+        sim = self.sim
+        max_ticks = int(max_s / self.dt)
+        for _ in range(max_ticks):
+            ctl = self._bms_ctl()
+            sim.receive(self.ctl_bus_id, ctl)
+            ctl_frame = SimFrame(sim.now_ms, self.ctl_bus_id, ctl, direction="Tx")
+            self._plant()
+            frames = sim.step()
+            self._bms_receive(frames)
+            frames.insert(0, ctl_frame)
+            yield frames
+            if self.done and not sim.state.enabled:
+                return
+
+    def run(self, max_s: float = 4 * 3600.0, keep_frames: bool = False) -> ChargeResult:
+        start = time.perf_counter()
+        log: List[SimFrame] = []
+        n = 0
+        for frames in self.ticks(max_s):
+            n += len(frames)
+            if keep_frames:
+                log.extend(frames)
+        return ChargeResult(
+            ambient_C=self.ambient_C, soc_start=self.soc_start, soc_end=self.pack.soc,
+            completed=self.done, charge_time_s=self.charge_ticks * self.dt,
+            max_charger_temp_C=self.max_charger_temp_C, max_pack_temp_C=self.max_pack_temp_C,
+            derating_s=self.derating_ticks * self.dt, frames=n,
+            wall_s=time.perf_counter() - start, frame_log=log)
+
+
+# ============================================================================
+# Sweep
+# ============================================================================
+
+SWEEP_AMBIENT_C = [-10, 0, 10, 20, 25, 30, 35, 40, 45, 50]
+SWEEP_SOC = [0.0, 0.2, 0.5, 0.8]
+SWEEP_PACKS = {
+    "100s4p": PackConfig(),
+    "96s5p": PackConfig(cells_series=96, cells_parallel=5),
+    "110s3p": PackConfig(cells_series=110, cells_parallel=3),
+}
+SWEEP_CC_A = [16.0, 24.0, 30.0]
+
+
+def _sweep_run(case: tuple) -> tuple:
+    name, cc, ambient, soc = case
+    result = ChargeSimulation(SWEEP_PACKS[name], profile=ChargeProfile(cc_current_A=cc),
+                              ambient_C=ambient, soc=soc).run()
+    return name, cc, result
+
+
+def sweep(jobs: int = 1) -> List[tuple]:
+    """Tutte le combinazioni di pacco, corrente CC, ambiente e SOC iniziale
+
+    Ogni run è una simulazione indipendente in un solo processo; jobs > 1
+    distribuisce solo i run su processi worker.
+    """
+    cases = list(itertools.product(SWEEP_PACKS, SWEEP_CC_A, SWEEP_AMBIENT_C, SWEEP_SOC))
+    if jobs <= 1:
+        return [_sweep_run(c) for c in cases]
+    from multiprocessing import Pool
+    with Pool(jobs) as pool:
+        return pool.map(_sweep_run, cases, chunksize=4)
+
+
+def _print_result(label: str, r: ChargeResult):
+    print(f"{label:<16} amb {r.ambient_C:5.1f} C  SOC {100 * r.soc_start:3.0f}->{100 * r.soc_end:5.1f}%  "
+          f"{r.charge_time_s / 60:6.1f} min  charger max {r.max_charger_temp_C:5.1f} C  "
+          f"pack max {r.max_pack_temp_C:5.1f} C  derating {r.derating_s / 60:5.1f} min  "
+          f"{'OK ' if r.completed else 'NOT COMPLETED'}  {r.frames} frames {r.wall_s * 1000:.0f} ms")
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Closed-loop charge simulation in virtual time")
+    parser.add_argument("--ambient", type=float, default=25.0, help="ambient temperature [C]")
+    parser.add_argument("--soc", type=float, default=0.0, help="start SOC [0-1]")
+    parser.add_argument("--cc", type=float, default=24.0, help="CC current request [A]")
+    parser.add_argument("--sweep", action="store_true", help="run the whole condition grid")
+    parser.add_argument("-j", "--jobs", type=int, default=1, help="worker processes for --sweep")
+    parser.add_argument("-o", "--output", help="write the frames in gateway format")
+    parser.add_argument("--realtime", metavar="TARGET",
+                        help="play in real time to '-', a serial port/pty or a file")
+    parser.add_argument("--speed", type=float, default=1.0, help="real-time speed factor")
+    args = parser.parse_args(argv)
+
+    if args.sweep:
+        start = time.perf_counter()
+        rows = sweep(args.jobs)
+        failed = 0
+        for name, cc, r in rows:
+            _print_result(f"{name} {cc:.0f}A", r)
+            failed += not r.completed
+        print(f"{len(rows)} runs, {failed} not completed, {time.perf_counter() - start:.1f} s")
+        return 1 if failed else 0
+
+    sim = ChargeSimulation(profile=ChargeProfile(cc_current_A=args.cc),
+                           ambient_C=args.ambient, soc=args.soc)
+    if args.realtime:
+        write, close = open_sink(args.realtime)
+        try:
+            play_realtime(sim.ticks(), write, args.speed, sim.sim.tick_ms)
+        except (KeyboardInterrupt, BrokenPipeError):
+            pass
+        finally:
+            close()
+        return 0
+
+    result = sim.run(keep_frames=bool(args.output))
+    _print_result("charge", result)
+    if args.output:
+        with open(args.output, "w") as f:
+            for fr in result.frame_log:
+                f.write(f"{fr.t_ms / 1000:.3f} {fr.to_line()}\n")
+    return 0 if result.completed else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
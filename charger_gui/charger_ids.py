@@ -0,0 +1,210 @@
+"""ID CAN per charger (tabelle ID del manuale di LEVEL 1 e LEVEL 2), condivisi tra Python e C
+
+    python -m charger_gui.charger_ids            # verifica che l'header C sia aggiornato
+    python -m charger_gui.charger_ids --write    # rigenera l'header C
+    python -m charger_gui.charger_ids --list     # stampa la tabella
+
+ID_SPECS è l'unico punto in cui sono scritti gli ID di bus dei charger.
+È la tabella del manuale: una colonna per ID charger (Setup.IDsetting
+0-11, 14, 15 -> charger 1-12, 15, 16; 13 e 14 non esistono). Gli ID non
+seguono un passo fisso (REQ dei charger 7-12 è 0x6xB, gli altri messaggi
+0x5xx), quindi niente è calcolato: CanIdMap in can_decoder.py e l'hash
+perfetto di utils_canBus_charger_ids.c leggono entrambi questa tabella, il
+lato C tramite il file generato utils_c_functions/utils_canBus_charger_id_table.h.
+
+    LEVEL 1, 4   STAT, ACT1, ACT2, TST1, CTL dalla tabella di LEVEL 1; TST2
+                 segue le stesse righe (charger 16: 0x026 è tra gli ID
+                 riservati del manuale, LEVEL 5)
+    LEVEL 2      REQ, FLTP, FLTA, SW, SN dalla tabella di LEVEL 2
+    LEVEL 3      ACT3, TEMP, ACT4, STST1: stessi ID per ogni charger, sulla
+                 Service CAN di ciascuno (un charger per bus). Sono
+                 attribuiti al charger 1
+
+I frame estesi (Setup.IDType = 29 bit) usano gli stessi ID numerici.
+"""
+
+import os
+import sys
+from typing import Dict, List, Optional, Tuple
+
+# Numeri di charger delle colonne del manuale (Setup.IDsetting = ID_SETTINGS[i])
+CHARGERS = (1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 15, 16)
+ID_SETTINGS = (0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 14, 15)
+
+# messaggio, ID di bus per ogni charger di CHARGERS (prima colonna = ID di default)
+ID_SPECS = (
+    ("STAT",  (0x610, 0x600, 0x5F0, 0x5E0, 0x5D0, 0x5C0, 0x5B0, 0x5A0, 0x590, 0x580, 0x570, 0x560, 0x030, 0x020)),
+    ("ACT1",  (0x611, 0x601, 0x5F1, 0x5E1, 0x5D1, 0x5C1, 0x5B1, 0x5A1, 0x591, 0x581, 0x571, 0x561, 0x031, 0x021)),
+    ("ACT2",  (0x614, 0x604, 0x5F4, 0x5E4, 0x5D4, 0x5C4, 0x5B4, 0x5A4, 0x594, 0x584, 0x574, 0x564, 0x034, 0x024)),
+    ("TST1",  (0x615, 0x605, 0x5F5, 0x5E5, 0x5D5, 0x5C5, 0x5B5, 0x5A5, 0x595, 0x585, 0x575, 0x565, 0x035, 0x025)),
+    ("TST2",  (0x616, 0x606, 0x5F6, 0x5E6, 0x5D6, 0x5C6, 0x5B6, 0x5A6, 0x596, 0x586, 0x576, 0x566, 0x036, 0x026)),
+    ("CTL",   (0x618, 0x608, 0x5F8, 0x5E8, 0x5D8, 0x5C8, 0x5B8, 0x5A8, 0x598, 0x588, 0x578, 0x568, 0x038, 0x028)),
+    ("REQ",   (0x61B, 0x60B, 0x5FB, 0x5EB, 0x5DB, 0x5CB, 0x6BB, 0x6AB, 0x69B, 0x68B, 0x67B, 0x66B, 0x03B, 0x02B)),
+    ("FLTP",  (0x61C, 0x60C, 0x5FC, 0x5EC, 0x5DC, 0x5CC, 0x5BC, 0x5AC, 0x59C, 0x58C, 0x57C, 0x56C, 0x03C, 0x02C)),
+    ("FLTA",  (0x61D, 0x60D, 0x5FD, 0x5ED, 0x5DD, 0x5CD, 0x5BD, 0x5AD, 0x59D, 0x58D, 0x57D, 0x56D, 0x03D, 0x02D)),
+    ("SW",    (0x61E, 0x60E, 0x5FE, 0x5EE, 0x5DE, 0x5CE, 0x5BE, 0x5AE, 0x59E, 0x58E, 0x57E, 0x56E, 0x03E, 0x02E)),
+    ("SN",    (0x61F, 0x60F, 0x5FF, 0x5EF, 0x5DF, 0x5CF, 0x5BF, 0x5AF, 0x59F, 0x58F, 0x57F, 0x56F, 0x03F, 0x02F)),
+)
+
+# LEVEL 3 (Service CAN): un ID per tutti i charger
+SERVICE_SPECS = (
+    ("ACT3",  0x712),
+    ("TEMP",  0x713),
+    ("ACT4",  0x714),
+    ("STST1", 0x715),
+)
+
+MESSAGES: Tuple[str, ...] = tuple(name for name, _ in ID_SPECS) + tuple(name for name, _ in SERVICE_SPECS)
+BASE_IDS: Dict[str, int] = {**{name: ids[0] for name, ids in ID_SPECS}, **dict(SERVICE_SPECS)}
+SERVICE_IDS = frozenset(bus_id for _, bus_id in SERVICE_SPECS)
+
+
+def _build() -> Dict[int, Dict[int, int]]:
+    """ID base -> {charger: ID di bus}"""
+    table: Dict[int, Dict[int, int]] = {}
+    for _name, ids in ID_SPECS:
+        table[ids[0]] = dict(zip(CHARGERS, ids))
+    for _name, bus_id in SERVICE_SPECS:
+        table[bus_id] = {charger: bus_id for charger in CHARGERS}
+    return table
+
+
+ID_TABLE: Dict[int, Dict[int, int]] = _build()
+
+
+def charger_bus_id(base_id: int, charger: int) -> Optional[int]:
+    """ID di bus di un messaggio (ID di default) per un charger, None se il charger non ha ID"""
+    return ID_TABLE[base_id].get(charger)
+
+
+def check() -> List[str]:
+    """Errori della tabella: ID duplicati tra charger/messaggi (LEVEL 3 escluso)"""
+    seen: Dict[int, Tuple[str, int]] = {}
+    errors = []
+    for name, ids in ID_SPECS:
+        if len(ids) != len(CHARGERS):
+            errors.append(f"{name}: {len(ids)} IDs for {len(CHARGERS)} chargers")
+        for charger, bus_id in zip(CHARGERS, ids):
+            other = seen.get(bus_id)
+            if other is not None:
+                errors.append(f"0x{bus_id:03X}: {other[0]} charger {other[1]} and {name} charger {charger}")
+            seen[bus_id] = (name, charger)
+    for name, bus_id in SERVICE_SPECS:
+        if bus_id in seen:
+            errors.append(f"0x{bus_id:03X}: {seen[bus_id][0]} and {name}")
+    return errors
+
+
+# ============================================================================
+# Generatore dell'header C
+# ============================================================================
+
+C_HEADER = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                        "utils_c_functions", "utils_canBus_charger_id_table.h")
+
+
+def generate_c_header() -> str:
+    out: List[str] = [
+        "/* =============================================================================",
+        " *  FILE: utils_canBus_charger_id_table.h",
+        " * =============================================================================",
+        " *",
+        " *  EVO Charger bus IDs per charger (manual ID tables of LEVEL 1 and LEVEL 2)",
+        " *",
+        " *  GENERATED by charger_gui/charger_ids.py (python -m charger_gui.charger_ids --write)",
+        " *  Do not edit: change ID_SPECS and regenerate.",
+        " *",
+        " * =============================================================================",
+        " */",
+        "",
+        "#ifndef UTILS_CANBUS_CHARGER_ID_TABLE_H",
+        "#define UTILS_CANBUS_CHARGER_ID_TABLE_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "/* EVO messages (default IDs = charger 1) */",
+        "typedef enum {",
+    ]
+    for i, name in enumerate(MESSAGES):
+        first = " = 0" if i == 0 else ""
+        out.append(f"    {'CAN_MSG_' + name + first + ',':<22}/* 0x{BASE_IDS[name]:03X} */")
+    out += [
+        "    CAN_MSG_COUNT",
+        "} CanMsg_t;",
+        "",
+        f"#define CAN_MSG_SERVICE_FIRST  CAN_MSG_{SERVICE_SPECS[0][0]}   /* LEVEL 3: same ID for every charger */",
+        f"#define CAN_CHARGER_SLOTS      {len(CHARGERS)}",
+        "#define CAN_CHARGER_NONE       0xFF",
+        "",
+        "static const uint16_t CAN_MSG_BASE_ID[CAN_MSG_COUNT] = {",
+        "    " + ", ".join(f"0x{BASE_IDS[name]:03X}" for name in MESSAGES),
+        "};",
+        "",
+        "static const char *const CAN_MSG_NAME[CAN_MSG_COUNT] = {",
+        "    " + ", ".join(f'"{name}"' for name in MESSAGES),
+        "};",
+        "",
+        "/* Charger number (1-16) and Setup.IDsetting of each column */",
+        "static const uint8_t CAN_CHARGER_NUMBER[CAN_CHARGER_SLOTS] = { "
+        + ", ".join(str(c) for c in CHARGERS) + " };",
+        "static const uint8_t CAN_CHARGER_ID_SETTING[CAN_CHARGER_SLOTS] = { "
+        + ", ".join(str(s) for s in ID_SETTINGS) + " };",
+        "",
+        "/* Charger number -> column (CAN_CHARGER_NONE: no ID set for the charger) */",
+        "static const uint8_t CAN_CHARGER_SLOT[17] = { "
+        + ", ".join(str(CHARGERS.index(c)) if c in CHARGERS else "CAN_CHARGER_NONE" for c in range(17)) + " };",
+        "",
+        "/* Bus ID: [message][column] */",
+        "static const uint16_t CAN_CHARGER_BUS_ID[CAN_MSG_COUNT][CAN_CHARGER_SLOTS] = {",
+    ]
+    for name in MESSAGES:
+        ids = ID_TABLE[BASE_IDS[name]]
+        out.append(f"    /* {name:<5} */ {{ " + ", ".join(f"0x{ids[c]:03X}" for c in CHARGERS) + " },")
+    out += [
+        "};",
+        "",
+        "#endif /* UTILS_CANBUS_CHARGER_ID_TABLE_H */",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Charger ID table: check or regenerate the C header")
+    parser.add_argument("--write", action="store_true", help="regenerate the C header")
+    parser.add_argument("--list", action="store_true", help="print the table")
+    parser.add_argument("--header", default=C_HEADER, help="header path")
+    args = parser.parse_args(argv)
+
+    errors = check()
+    for e in errors:
+        print(e)
+    if errors:
+        return 1
+
+    if args.list:
+        print("charger " + " ".join(f"{name:>5}" for name in MESSAGES))
+        for charger in CHARGERS:
+            print(f"{charger:7} " + " ".join(f"0x{ID_TABLE[BASE_IDS[name]][charger]:03X}" for name in MESSAGES))
+
+    text = generate_c_header()
+    if args.write:
+        with open(args.header, "w", newline="\n") as f:
+            f.write(text)
+        print(f"{args.header}: {len(CHARGERS)} chargers, {len(MESSAGES)} messages")
+        return 0
+    try:
+        with open(args.header) as f:
+            current = f.read()
+    except FileNotFoundError:
+        current = ""
+    if current != text:
+        print(f"{args.header} is out of date: run python -m charger_gui.charger_ids --write")
+        return 1
+    print(f"{args.header} up to date")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
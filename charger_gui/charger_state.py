@@ -0,0 +1,277 @@
+"""Stato aggregato dei charger, condiviso tra thread senza lock (seqlock)
+
+Un ChargerState per ID charger (1-16) tiene l'ultimo pacchetto decodificato
+di ogni messaggio di stato, il suo timestamp e un numero di sequenza per
+messaggio (frame ricevuti finora). Il thread di lettura è l'unico scrittore;
+la GUI e ogni altro consumatore (allarmi, export, supervisore) chiamano
+snapshot() e ottengono una vista coerente e immutabile senza bloccare lo
+scrittore.
+
+Seqlock: lo scrittore rende dispari la sequenza, scrive i campi, la rende di
+nuovo pari. Un lettore copia i campi tra due letture della sequenza e
+riprova se era dispari o è cambiata. Una raffica di frame pubblicata con
+publish() diventa visibile in modo atomico.
+
+I pacchetti sono condivisi, non copiati: i consumatori li trattano in sola
+lettura.
+
+    python -m charger_gui.charger_state --check 2      # verifica coerenza scrittore/lettori
+"""
+
+import sys
+import threading
+import time
+from typing import Dict, Iterable, List, NamedTuple, Optional, Tuple
+
+from .can_decoder import CANDecoder
+
+C = CANDecoder
+
+# Messaggi aggregati nello snapshot (ordine degli slot)
+STATE_IDS = (
+    C.CAN_ID_STAT, C.CAN_ID_ACT1, C.CAN_ID_ACT2, C.CAN_ID_ACT3, C.CAN_ID_ACT4,
+    C.CAN_ID_TST1, C.CAN_ID_TEMP, C.CAN_ID_STST1, C.CAN_ID_TST2, C.CAN_ID_SW, C.CAN_ID_SN,
+)
+_SLOT = {can_id: i for i, can_id in enumerate(STATE_IDS)}
+_EMPTY = (None,) * len(STATE_IDS)
+_ZEROS = (0,) * len(STATE_IDS)
+
+MAX_CHARGERS = 16
+
+
+class ChargerSnapshot(NamedTuple):
+    """Vista immutabile di un charger (tuple indicizzate come STATE_IDS)"""
+    charger: int
+    version: int                # Frame pubblicati finora (= somma dei conteggi)
+    packets: tuple              # Ultimo pacchetto per messaggio, None se mai ricevuto
+    counts: tuple               # Numero di sequenza per messaggio
+    timestamps: tuple           # Istante dell'ultimo frame [s, monotonic], 0 se mai ricevuto
+
+    def get(self, can_id: int):
+        return self.packets[_SLOT[can_id]]
+
+    def count(self, can_id: int) -> int:
+        return self.counts[_SLOT[can_id]]
+
+    def age(self, can_id: int, now: Optional[float] = None) -> Optional[float]:
+        """Secondi dall'ultimo frame di can_id, None se mai ricevuto"""
+        i = _SLOT[can_id]
+        if not self.counts[i]:
+            return None
+        return (time.monotonic() if now is None else now) - self.timestamps[i]
+
+    @property
+    def stat(self):
+        return self.packets[0]
+
+    @property
+    def act1(self):
+        return self.packets[1]
+
+    @property
+    def act2(self):
+        return self.packets[2]
+
+    @property
+    def act3(self):
+        return self.packets[3]
+
+    @property
+    def act4(self):
+        return self.packets[4]
+
+    @property
+    def tst1(self):
+        return self.packets[5]
+
+    @property
+    def temp(self):
+        return self.packets[6]
+
+    @property
+    def stst1(self):
+        return self.packets[7]
+
+    @property
+    def tst2(self):
+        return self.packets[8]
+
+    @property
+    def sw(self):
+        return self.packets[9]
+
+    @property
+    def sn(self):
+        return self.packets[10]
+
+
+class ChargerState:
+    """Ultimo stato di un charger: un solo scrittore, lettori a piacere"""
+
+    def __init__(self, charger: int = 1):
+        self.charger = charger
+        self._seq = 0               # Dispari mentre lo scrittore è in una sezione di scrittura
+        self._version = 0
+        self._packets: List = list(_EMPTY)
+        self._counts: List[int] = list(_ZEROS)
+        self._times: List[float] = [0.0] * len(STATE_IDS)
+
+    # ---- scrittore (solo thread di lettura) ----
+
+    def update(self, base_id: int, packet, timestamp: float) -> bool:
+        """Pubblica un pacchetto; False se base_id non fa parte dello stato"""
+        i = _SLOT.get(base_id)
+        if i is None:
+            return False
+        self._seq += 1
+        self._packets[i] = packet
+        self._counts[i] += 1
+        self._times[i] = timestamp
+        self._version += 1
+        self._seq += 1
+        return True
+
+    def publish(self, updates: Iterable[Tuple[int, object, float]]) -> int:
+        """Pubblica una raffica di (base_id, packet, timestamp) in una sola sezione di scrittura"""
+        slot = _SLOT.get
+        packets, counts, times = self._packets, self._counts, self._times
+        n = 0
+        self._seq += 1
+        for base_id, packet, timestamp in updates:
+            i = slot(base_id)
+            if i is None:
+                continue
+            packets[i] = packet
+            counts[i] += 1
+            times[i] = timestamp
+            n += 1
+        self._version += n
+        self._seq += 1
+        return n
+
+    def clear(self):
+        self._seq += 1
+        self._packets[:] = _EMPTY
+        self._counts[:] = _ZEROS
+        self._times[:] = [0.0] * len(STATE_IDS)
+        self._version = 0
+        self._seq += 1
+
+    # ---- lettori (qualsiasi thread) ----
+
+    @property
+    def version(self) -> int:
+        return self._version
+
+    def snapshot(self) -> ChargerSnapshot:
+        while True:
+            seq = self._seq
+            if seq & 1:
+                time.sleep(0)       # Scrittore dentro la sua sezione: lo si lascia finire
+                continue
+            snap = ChargerSnapshot(self.charger, self._version, tuple(self._packets),
+                                   tuple(self._counts), tuple(self._times))
+            if self._seq == seq:
+                return snap
+
+
+class ChargerStateTable:
+    """Un ChargerState per ID charger, tutti allocati subito (nessun resize durante la lettura)"""
+
+    def __init__(self):
+        self.states: Tuple[ChargerState, ...] = tuple(
+            ChargerState(ch) for ch in range(1, MAX_CHARGERS + 1))
+
+    def __getitem__(self, charger: int) -> ChargerState:
+        return self.states[charger - 1]
+
+    def publish_message(self, can_id: int, extended: bool, data: List[int],
+                        timestamp: float) -> Optional[Tuple[int, int, object]]:
+        """Decodifica un frame del bus e lo pubblica; restituisce il risultato di decode_bus_message (ValueError: DLC corto)"""
+        decoded = CANDecoder.decode_bus_message(can_id, extended, data)
+        if decoded is not None and decoded[2] is not None:
+            self.states[decoded[1] - 1].update(decoded[0], decoded[2], timestamp)
+        return decoded
+
+    def publish(self, updates: Iterable[Tuple[int, int, object, float]]) -> int:
+        """Pubblica una raffica di (charger, base_id, packet, timestamp), una sezione di scrittura per charger"""
+        by_charger: Dict[int, List[Tuple[int, object, float]]] = {}
+        for charger, base_id, packet, timestamp in updates:
+            by_charger.setdefault(charger, []).append((base_id, packet, timestamp))
+        return sum(self.states[ch - 1].publish(items) for ch, items in by_charger.items())
+
+    def snapshot(self, charger: int) -> ChargerSnapshot:
+        return self.states[charger - 1].snapshot()
+
+    def clear(self):
+        for state in self.states:
+            state.clear()
+
+
+# ============================================================================
+# Verifica di coerenza
+# ============================================================================
+
+def check(seconds: float = 2.0, readers: int = 2, burst: int = 8) -> bool:
+    """Thread scrittore che pubblica raffiche alla massima velocità, lettori che verificano ogni snapshot
+
+    Ogni pacchetto porta il proprio numero di sequenza, quindi uno snapshot
+    inconsistente si vede da conteggi che non corrispondono ai pacchetti o
+    che non sommano alla versione.
+    """
+    state = ChargerState(1)
+    stop = threading.Event()
+    errors: List[str] = []
+    snapshots = [0] * readers
+
+    def writer():
+        n = 0
+        while not stop.is_set():
+            items = []
+            for _ in range(burst):
+                base_id = STATE_IDS[n % len(STATE_IDS)]
+                n += 1
+                items.append((base_id, n, float(n)))
+            state.publish(items)
+
+    def reader(k: int):
+        while not stop.is_set():
+            s = state.snapshot()
+            snapshots[k] += 1
+            if sum(s.counts) != s.version:
+                errors.append(f"version {s.version} != sum(counts) {sum(s.counts)}")
+            # Scrittore round robin: l'ultimo pacchetto nello slot i è il numero di frame
+            for i, (p, c, t) in enumerate(zip(s.packets, s.counts, s.timestamps)):
+                if c and (p != (c - 1) * len(STATE_IDS) + i + 1 or t != float(p)):
+                    errors.append(f"slot {i}: packet {p} count {c} time {t}")
+            if s.version % burst:
+                errors.append(f"partial burst visible (version {s.version})")
+            if errors:
+                stop.set()
+
+    threads = [threading.Thread(target=writer)]
+    threads += [threading.Thread(target=reader, args=(k,)) for k in range(readers)]
+    for t in threads:
+        t.start()
+    time.sleep(seconds)
+    stop.set()
+    for t in threads:
+        t.join()
+
+    print(f"frames published {state.version}, snapshots {sum(snapshots)}, errors {len(errors)}")
+    for e in errors[:10]:
+        print("  " + e)
+    return not errors
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Charger state seqlock check")
+    parser.add_argument("--check", type=float, default=2.0, metavar="SECONDS")
+    parser.add_argument("--readers", type=int, default=2)
+    args = parser.parse_args(argv)
+    return 0 if check(args.check, args.readers) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
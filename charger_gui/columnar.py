@@ -0,0 +1,435 @@
+"""Codec a colonne consapevole dei segnali per le registrazioni (.evcol)
+
+    python -m charger_gui.columnar pack session.evlog       # -> session.evcol
+    python -m charger_gui.columnar unpack session.evcol     # -> session.evlog
+    python -m charger_gui.columnar info session.evcol
+    python -m charger_gui.columnar bench                    # carica simulata
+
+I frame si dividono per ID di bus (gruppo = ID con flag, DLC, canale) e ogni
+gruppo si salva a colonne, così ogni colonna contiene un solo tipo di valore:
+
+    timestamp           delta di delta, zigzag, bit-packed
+    ACT1/TEMP/ACT3/ACT4 quattro campi a 16 bit, ognuno delta + zigzag + bit-packed
+    altri ID            una colonna per byte di payload, run-length
+                        (flag TST1/STST1, STAT, setpoint CTL: sequenze lunghe)
+
+Il bit-packing lavora su blocchi di BLOCK valori con la larghezza del valore
+più grande del blocco (0 bit per un delta costante). Ogni colonna è
+preceduta dalla sua dimensione, così un ID si decodifica senza toccare gli
+altri: i grafici leggono decode(group) direttamente in colonne decode_bulk.
+
+L'ordine dei frame tra gruppi non si salva quando è l'ordine dei timestamp
+(a parità vince il numero di gruppo, numerati per prima comparsa); qualsiasi
+altro ordine si conserva con un indice di gruppo esplicito per frame.
+
+    Header (32 byte)
+        0  char[8]  magic "EVOCANCL"
+        8  u16      versione (1)
+       10  u16      flag (1 = stream di ordine presente)
+       12  u32      gruppi
+       16  u64      inizio sessione, tempo unix [us]
+       24  u64      frame
+    [stream di ordine]
+    Gruppo (ripetuto)
+        u32 chiave (ID CAN | flag come in .evlog), u8 DLC, u8 canale, u8 tipo,
+        u8 riservato, u32 frame, u32 dimensione delle colonne che seguono
+        colonne (u32 dimensione + dati ciascuna)
+"""
+
+import itertools
+import os
+import struct
+import sys
+import time
+from typing import Dict, Iterator, List, NamedTuple, Optional, Tuple
+
+from .can_decoder import CANDecoder
+from .recording import Frame, Recording, RecordingWriter, RECORD_EXTENDED, RECORD_ID_MASK, RECORD_TX
+from .signals import SIGNALS, decode_bulk
+
+C = CANDecoder
+
+MAGIC = b"EVOCANCL"
+VERSION = 1
+FLAG_ORDER = 1
+
+HEADER = struct.Struct('<8sHHIQQ')
+GROUP = struct.Struct('<IBBBxII')
+SIZE = struct.Struct('<I')
+
+BLOCK = 128
+
+# Tipi di gruppo
+KIND_BYTES = 0          # una colonna RLE per byte di payload
+KIND_WORDS = 1          # quattro colonne big endian a 16 bit, delta + zigzag + bit-packed
+
+WORD_IDS = (C.CAN_ID_ACT1, C.CAN_ID_TEMP, C.CAN_ID_ACT3, C.CAN_ID_ACT4)
+
+
+class ColumnarError(Exception):
+    """File non valido o versione non supportata"""
+
+
+# ============================================================================
+# Stream di interi
+# ============================================================================
+
+def _varint(value: int, out: bytearray):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+def _read_varint(buf, pos: int) -> Tuple[int, int]:
+    value = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if b < 0x80:
+            return value, pos
+        shift += 7
+
+
+def pack_uints(values: List[int]) -> bytes:
+    """Interi non negativi, bit-packed in blocchi di BLOCK con un byte di larghezza per blocco"""
+    out = bytearray()
+    _varint(len(values), out)
+    for start in range(0, len(values), BLOCK):
+        block = values[start:start + BLOCK]
+        w = max(block).bit_length()
+        out.append(w)
+        if w:
+            acc = 0
+            for i, v in enumerate(block):
+                acc |= v << (i * w)
+            out += acc.to_bytes((len(block) * w + 7) // 8, 'little')
+    return bytes(out)
+
+
+def unpack_uints(buf) -> List[int]:
+    n, pos = _read_varint(buf, 0)
+    out: List[int] = []
+    while len(out) < n:
+        m = min(BLOCK, n - len(out))
+        w = buf[pos]
+        pos += 1
+        size = (m * w + 7) // 8
+        if w == 0:
+            out.extend(itertools.repeat(0, m))
+        elif w == 8:
+            out.extend(buf[pos:pos + m])
+        elif w == 16:
+            out.extend(struct.unpack_from(f'<{m}H', buf, pos))
+        else:
+            acc = int.from_bytes(buf[pos:pos + size], 'little')
+            mask = (1 << w) - 1
+            out.extend([(acc >> s) & mask for s in range(0, m * w, w)])
+        pos += size
+    return out
+
+
+def _zigzag(values) -> List[int]:
+    return [(v << 1) if v >= 0 else ((-v) << 1) - 1 for v in values]
+
+
+def _unzigzag(values: List[int]) -> List[int]:
+    return [(z >> 1) ^ -(z & 1) for z in values]
+
+
+def pack_deltas(values: List[int]) -> bytes:
+    return pack_uints(_zigzag([b - a for a, b in zip(itertools.chain((0,), values), values)]))
+
+
+def unpack_deltas(buf) -> List[int]:
+    return list(itertools.accumulate(_unzigzag(unpack_uints(buf))))
+
+
+def pack_timestamps(values: List[int]) -> bytes:
+    """Delta di delta: un messaggio periodico costa 0 bit per frame"""
+    deltas = [b - a for a, b in zip(itertools.chain((0,), values), values)]
+    return pack_deltas(deltas)
+
+
+def unpack_timestamps(buf) -> List[int]:
+    return list(itertools.accumulate(unpack_deltas(buf)))
+
+
+def pack_rle(column: bytes) -> bytes:
+    """Colonna di byte a sequenze: conteggio varint, valori, lunghezze bit-packed"""
+    values = bytearray()
+    lengths: List[int] = []
+    for value, run in itertools.groupby(column):
+        values.append(value)
+        lengths.append(sum(1 for _ in run))
+    out = bytearray()
+    _varint(len(values), out)
+    out += values
+    out += pack_uints(lengths)
+    return bytes(out)
+
+
+def unpack_rle(buf) -> bytes:
+    n, pos = _read_varint(buf, 0)
+    values = buf[pos:pos + n]
+    lengths = unpack_uints(buf[pos + n:])
+    return b"".join(bytes((v,)) * k for v, k in zip(values, lengths))
+
+
+# ============================================================================
+# Encoder
+# ============================================================================
+
+class Group(NamedTuple):
+    key: int                # CAN ID | RECORD_EXTENDED | RECORD_TX
+    dlc: int
+    channel: int
+    kind: int
+    count: int
+    columns: Tuple[memoryview, ...]     # Stream grezzi delle colonne (prima i timestamp)
+
+    @property
+    def can_id(self) -> int:
+        return self.key & RECORD_ID_MASK
+
+    @property
+    def extended(self) -> bool:
+        return bool(self.key & RECORD_EXTENDED)
+
+    @property
+    def base_id(self) -> Optional[int]:
+        resolved = C.id_map.resolve(self.can_id, self.extended)
+        return resolved[0] if resolved else None
+
+
+def _kind(key: int, dlc: int) -> int:
+    resolved = C.id_map.resolve(key & RECORD_ID_MASK, bool(key & RECORD_EXTENDED))
+    if dlc == 8 and resolved is not None and resolved[0] in WORD_IDS:
+        return KIND_WORDS
+    return KIND_BYTES
+
+
+def _encode_columns(kind: int, dlc: int, timestamps: List[int], payloads: bytes) -> List[bytes]:
+    n = len(timestamps)
+    cols = [pack_timestamps(timestamps)]
+    if kind == KIND_WORDS:
+        words = struct.unpack(f'>{n * 4}H', payloads)
+        cols += [pack_deltas(list(words[k::4])) for k in range(4)]
+    else:
+        cols += [pack_rle(payloads[b::8]) for b in range(dlc)]
+    return cols
+
+
+def encode(rec: Recording) -> bytes:
+    """Registrazione intera -> bytes .evcol"""
+    groups: Dict[Tuple[int, int, int], int] = {}
+    order: List[int] = []
+    times: List[List[int]] = []
+    payloads: List[bytearray] = []
+    for ts, key, dlc, ch, _res, data in rec.raw():
+        g = groups.get((key, dlc, ch))
+        if g is None:
+            g = groups[(key, dlc, ch)] = len(groups)
+            times.append([])
+            payloads.append(bytearray())
+        order.append(g)
+        times[g].append(ts)
+        payloads[g] += data
+
+    # Ordine canonico: per timestamp, a parità per numero di gruppo (= prima comparsa)
+    ts_of = [0] * len(order)
+    seen = [0] * len(groups)
+    for i, g in enumerate(order):
+        ts_of[i] = times[g][seen[g]]
+        seen[g] += 1
+    canonical = all((ts_of[i], order[i]) <= (ts_of[i + 1], order[i + 1]) for i in range(len(order) - 1))
+
+    out = bytearray(HEADER.pack(MAGIC, VERSION, 0 if canonical else FLAG_ORDER, len(groups),
+                                rec.start_unix_us, len(order)))
+    if not canonical:
+        stream = pack_uints(order)
+        out += SIZE.pack(len(stream)) + stream
+    for (key, dlc, ch), g in groups.items():
+        kind = _kind(key, dlc)
+        body = bytearray()
+        for col in _encode_columns(kind, dlc, times[g], bytes(payloads[g])):
+            body += SIZE.pack(len(col)) + col
+        out += GROUP.pack(key, dlc, ch, kind, len(times[g]), len(body)) + body
+    return bytes(out)
+
+
+# ============================================================================
+# Decoder
+# ============================================================================
+
+class ColumnarLog:
+    """Directory dei gruppi letta subito; colonne decodificate su richiesta"""
+
+    def __init__(self, path: str):
+        with open(path, 'rb') as f:
+            self.raw = memoryview(f.read())
+        self.path = path
+        if len(self.raw) < HEADER.size:
+            raise ColumnarError(f"{path}: file too short")
+        magic, version, flags, ngroups, start, frames = HEADER.unpack_from(self.raw)
+        if magic != MAGIC:
+            raise ColumnarError(f"{path}: not an EVO columnar log")
+        if version != VERSION:
+            raise ColumnarError(f"{path}: unsupported version {version}")
+        self.start_unix_us = start
+        self.count = frames
+        pos = HEADER.size
+        self._order: Optional[memoryview] = None
+        if flags & FLAG_ORDER:
+            size, = SIZE.unpack_from(self.raw, pos)
+            self._order = self.raw[pos + SIZE.size:pos + SIZE.size + size]
+            pos += SIZE.size + size
+        self.groups: List[Group] = []
+        for _ in range(ngroups):
+            key, dlc, ch, kind, count, size = GROUP.unpack_from(self.raw, pos)
+            pos += GROUP.size
+            end = pos + size
+            cols = []
+            while pos < end:
+                n, = SIZE.unpack_from(self.raw, pos)
+                cols.append(self.raw[pos + SIZE.size:pos + SIZE.size + n])
+                pos += SIZE.size + n
+            self.groups.append(Group(key, dlc, ch, kind, count, tuple(cols)))
+
+    def __len__(self) -> int:
+        return self.count
+
+    def find(self, base_id: int, charger: int = 1) -> List[Group]:
+        """Gruppi di un messaggio di un charger (standard ed esteso, Rx e Tx)"""
+        return [g for g in self.groups if C.id_map.resolve(g.can_id, g.extended) == (base_id, charger)]
+
+    @staticmethod
+    def timestamps(group: Group) -> List[int]:
+        return unpack_timestamps(group.columns[0])
+
+    @staticmethod
+    def payloads(group: Group) -> bytes:
+        """8 byte per frame, zeri dopo il DLC (come Recording.payloads())"""
+        n = group.count
+        if group.kind == KIND_WORDS:
+            words = [0] * (n * 4)
+            for k in range(4):
+                words[k::4] = unpack_deltas(group.columns[1 + k])
+            return struct.pack(f'>{n * 4}H', *words)
+        out = bytearray(n * 8)
+        for b in range(group.dlc):
+            out[b::8] = unpack_rle(group.columns[1 + b])
+        return bytes(out)
+
+    def decode(self, group: Group) -> Dict[str, list]:
+        """Colonne decode_bulk del gruppo + "t" [s dall'inizio sessione]"""
+        base_id = group.base_id
+        cols = decode_bulk(base_id, self.payloads(group)) if base_id in SIGNALS else {}
+        cols["t"] = [ts / 1e6 for ts in self.timestamps(group)]
+        return cols
+
+    def order(self) -> List[int]:
+        """Indice di gruppo di ogni frame, in ordine di file"""
+        if self._order is not None:
+            return unpack_uints(self._order)
+        merged = [(ts, g) for g, group in enumerate(self.groups) for ts in self.timestamps(group)]
+        merged.sort()
+        return [g for _ts, g in merged]
+
+    def records(self) -> Iterator[Tuple[Frame, int]]:
+        """(frame, canale) in ordine di file"""
+        iters = []
+        for g in self.groups:
+            p = self.payloads(g)
+            tx = bool(g.key & RECORD_TX)
+            iters.append(iter([(Frame(ts, g.can_id, g.extended, tx, p[i * 8:i * 8 + g.dlc]), g.channel)
+                               for i, ts in enumerate(self.timestamps(g))]))
+        for g in self.order():
+            yield next(iters[g])
+
+    def __iter__(self) -> Iterator[Frame]:
+        return (fr for fr, _ch in self.records())
+
+
+def write_recording(log: ColumnarLog, path: str) -> int:
+    with RecordingWriter(path, log.start_unix_us) as w:
+        for fr, ch in log.records():
+            w.write(fr.timestamp_us, fr.can_id, fr.data, fr.extended, fr.tx, ch)
+        return w.count
+
+
+# ============================================================================
+# Benchmark su una carica simulata
+# ============================================================================
+
+def bench(tmp_dir: str, ambient_C: float = 25.0, soc: float = 0.0) -> bool:
+    from .archive import _simulated_evlog
+    log = os.path.join(tmp_dir, "bench.evlog")
+    n = _simulated_evlog(log, ambient_C, soc)
+    raw_size = os.path.getsize(log)
+
+    start = time.perf_counter()
+    data = encode(Recording(log))
+    enc_s = time.perf_counter() - start
+    out = os.path.join(tmp_dir, "bench.evcol")
+    with open(out, "wb") as f:
+        f.write(data)
+
+    col = ColumnarLog(out)
+    start = time.perf_counter()
+    decoded = sum(len(col.decode(g)["t"]) for g in col.groups)
+    dec_s = time.perf_counter() - start
+    ok = list(col) == list(Recording(log))
+
+    ratio = raw_size / len(data)
+    print(f"{n} frames, {len(col.groups)} groups, .evlog {raw_size / 1e6:.2f} MB -> "
+          f".evcol {len(data) / 1e3:.1f} kB ({ratio:.1f}x), {len(data) / n:.2f} byte/frame")
+    print(f"encode {enc_s:.2f} s, decode all signals {dec_s * 1000:.0f} ms "
+          f"({decoded / dec_s / 1e6:.2f} Mframe/s), round trip {'OK' if ok else 'FAILED'}")
+    return ok and ratio >= 10.0
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Columnar codec for .evlog recordings")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    for name, text in (("pack", ".evlog -> .evcol"), ("unpack", ".evcol -> .evlog"),
+                       ("info", "groups and column sizes")):
+        sub.add_parser(name, help=text).add_argument("files", nargs="+")
+    p = sub.add_parser("bench", help="encode a simulated charge, check ratio and round trip")
+    p.add_argument("--ambient", type=float, default=25.0)
+    p.add_argument("--soc", type=float, default=0.0)
+    args = parser.parse_args(argv)
+
+    if args.cmd == "pack":
+        for path in args.files:
+            out = os.path.splitext(path)[0] + ".evcol"
+            data = encode(Recording(path))
+            with open(out, "wb") as f:
+                f.write(data)
+            print(f"{out}: {os.path.getsize(path) / len(data):.1f}x")
+    elif args.cmd == "unpack":
+        for path in args.files:
+            out = os.path.splitext(path)[0] + ".evlog"
+            print(f"{out}: {write_recording(ColumnarLog(path), out)} frames")
+    elif args.cmd == "info":
+        for path in args.files:
+            log = ColumnarLog(path)
+            print(f"{path}: {len(log)} frames, {len(log.groups)} groups, "
+                  f"order {'stored' if log._order is not None else 'by timestamp'}")
+            for g in log.groups:
+                sizes = [len(c) for c in g.columns]
+                kind = "words" if g.kind == KIND_WORDS else "bytes"
+                id_str = f"0x{g.can_id:08X}" if g.extended else f"0x{g.can_id:03X}"
+                print(f"  {id_str} dlc {g.dlc} {kind:<5} {g.count:7d} frames  "
+                      f"t {sizes[0]:6d} B  payload {sum(sizes[1:]):7d} B")
+    else:
+        import tempfile
+        with tempfile.TemporaryDirectory() as tmp:
+            return 0 if bench(tmp, args.ambient, args.soc) else 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,351 @@
+-- =============================================================================
+--  FILE: evo11ka_dissector.lua
+-- =============================================================================
+--
+--  Wireshark dissector for the EVO11KA charger CAN messages (levels 1-4),
+--  on top of the SocketCAN dissector (LINKTYPE_CAN_SOCKETCAN, pcapng export).
+--  Install: copy into the Wireshark personal Lua plugins folder.
+--
+--  GENERATED by charger_gui/wireshark.py (python -m charger_gui.wireshark lua --write)
+--  Do not edit: change signals.SIGNALS and regenerate.
+--
+-- =============================================================================
+
+local evo = Proto("evo11ka", "EVO11KA Charger")
+
+local f_message = ProtoField.string("evo11ka.message", "Message")
+local f_charger = ProtoField.uint8("evo11ka.charger", "Charger")
+local f_no_fault = ProtoField.bool("evo11ka.no_fault", "No fault")
+local fields = { f_message, f_charger, f_no_fault }
+
+local can_id_f = Field.new("can.id")
+local can_xtd_f = Field.new("can.flags.xtd")
+
+-- Value strings
+local vs_FrameType = { [1] = "SINGLE", [2] = "MULTI" }
+local vs_fault_code = { [160] = "BULK1_VOLTAGE", [161] = "BULK2_VOLTAGE", [162] = "BULK3_VOLTAGE", [163] = "BULK_ERROR", [164] = "CAN_REGISTERS", [165] = "CAN_COMMAND", [166] = "TEMP_LOW", [167] = "TEMP_DERATING", [168] = "TEMP_HIGH", [169] = "TEMP_FAILED", [170] = "INPUT_CURRENT_MAX", [171] = "HVIL_INTERLOCK", [172] = "LOGIC_TEMP", [173] = "OUTPUT_OVERVOLT" }
+local vs_failure_level = { [0] = "WARNING", [1] = "WARNING", [2] = "SOFT", [3] = "HARD" }
+local vs_BaudrateType = { [0] = "BAUDRATE_500KBIT", [1] = "BAUDRATE_250KBIT", [2] = "BAUDRATE_125KBIT", [3] = "BAUDRATE_1MBIT" }
+local vs_IdType = { [0] = "STANDARD_11BIT", [1] = "EXTENDED_29BIT" }
+local vs_IacControlType = { [0] = "NOT_CONTROLLED", [1] = "SAEJ1772", [2] = "EN61851", [3] = "ID618" }
+local vs_RangeType = { [0] = "R4_EVO_USERS", [1] = "R3", [2] = "R2", [3] = "R1" }
+local vs_EVCModelType = { [0] = "EVO11K", [1] = "EVO22K" }
+local vs_IDSettingType = { [0] = "SINGLE_CHARGER", [1] = "RANGE_1_16" }
+
+-- base CAN ID -> { name, signals = { { field, kind, byte, size, scale, offset } } }
+local messages = {}
+
+messages[0x618] = { name = "CTL (Control)", fault = false, signals = {
+    { ProtoField.bool("evo11ka.ctl.can_enable", "can_enable", 8, nil, 0x80), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.ctl.led3_enable", "led3_enable", 8, nil, 0x08), "raw", 0, 1, 1, 0 },
+    { ProtoField.float("evo11ka.ctl.iac_max_A", "iac_max_A [A]"), "float", 1, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.ctl.vout_max_V", "vout_max_V [V]"), "float", 3, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.ctl.iout_max_A", "iout_max_A [A]"), "float", 5, 2, 0.1, 0.0 },
+} }
+
+messages[0x610] = { name = "STAT (Status)", fault = false, signals = {
+    { ProtoField.bool("evo11ka.stat.power_enable", "power_enable", 8, nil, 0x80), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stat.error_latch", "error_latch", 8, nil, 0x40), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stat.warn_limit", "warn_limit", 8, nil, 0x20), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stat.lim_temp", "lim_temp", 8, nil, 0x08), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stat.warning_hv", "warning_hv", 8, nil, 0x02), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stat.bulks", "bulks", 8, nil, 0x01), "raw", 0, 1, 1, 0 },
+} }
+
+messages[0x611] = { name = "ACT1 (Actual Values 1)", fault = false, signals = {
+    { ProtoField.float("evo11ka.act1.iac_A", "iac_A [A]"), "float", 0, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.act1.temp_C", "temp_C [°C]"), "float", 2, 2, 0.005188, -40.0 },
+    { ProtoField.float("evo11ka.act1.vout_V", "vout_V [V]"), "float", 4, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.act1.iout_A", "iout_A [A]"), "float", 6, 2, 0.1, 0.0 },
+} }
+
+messages[0x614] = { name = "ACT2 (Actual Values 2)", fault = false, signals = {
+    { ProtoField.float("evo11ka.act2.temp_loglv_C", "temp_loglv_C [°C]"), "float", 0, 2, 0.005188, -40.0 },
+    { ProtoField.float("evo11ka.act2.ac_power_kW", "ac_power_kW [kW]"), "float", 2, 2, 0.01, 0.0 },
+    { ProtoField.float("evo11ka.act2.prox_limit_A", "prox_limit_A [A]"), "float", 4, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.act2.pilot_limit_A", "pilot_limit_A [A]"), "float", 6, 2, 0.1, 0.0 },
+} }
+
+messages[0x615] = { name = "TST1 (Test/Diagnostic)", fault = false, signals = {
+    { ProtoField.bool("evo11ka.tst1.ack", "ack", 8, nil, 0x80), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.pr_compl", "pr_compl", 8, nil, 0x40), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.pwr_ok", "pwr_ok", 8, nil, 0x20), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.vout_ok", "vout_ok", 8, nil, 0x10), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.neutral", "neutral", 8, nil, 0x08), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.led3", "led3", 8, nil, 0x04), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.led618", "led618", 8, nil, 0x02), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.ovp", "ovp", 8, nil, 0x80), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.conn_open", "conn_open", 8, nil, 0x40), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.ther_fail", "ther_fail", 8, nil, 0x04), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.rx618_fail", "rx618_fail", 8, nil, 0x01), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.bulk1_fail", "bulk1_fail", 8, nil, 0x80), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.bulk2_fail", "bulk2_fail", 8, nil, 0x40), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.bulk3_fail", "bulk3_fail", 8, nil, 0x20), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.pump_on", "pump_on", 8, nil, 0x10), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.fan_on", "fan_on", 8, nil, 0x08), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.hv_rx_fail", "hv_rx_fail", 8, nil, 0x04), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.cooling_fail", "cooling_fail", 8, nil, 0x02), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.rx619_fail", "rx619_fail", 8, nil, 0x01), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.neutro1", "neutro1", 8, nil, 0x80), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.neutro2", "neutro2", 8, nil, 0x40), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.three_phase", "three_phase", 8, nil, 0x20), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.iac_fail", "iac_fail", 8, nil, 0x04), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.ignition", "ignition", 8, nil, 0x02), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.lv_battery_np", "lv_battery_np", 8, nil, 0x01), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.prox_ok", "prox_ok", 8, nil, 0x80), "raw", 4, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.pilot_ok", "pilot_ok", 8, nil, 0x20), "raw", 4, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst1.s2_ok", "s2_ok", 8, nil, 0x08), "raw", 4, 1, 1, 0 },
+    { ProtoField.uint16("evo11ka.tst1.cnt_hours", "cnt_hours [h]", base.DEC, nil), "raw", 6, 2, 1, 0 },
+} }
+
+messages[0x61B] = { name = "REQ (Request)", fault = false, signals = {
+    { ProtoField.bool("evo11ka.req.enable", "enable", 8, nil, 0x80), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint16("evo11ka.req.id_requested", "id_requested", base.DEC, nil), "raw", 2, 2, 1, 0 },
+} }
+
+messages[0x61D] = { name = "FLTA (Fault Active)", fault = true, signals = {
+    { ProtoField.uint8("evo11ka.flta.frame_type", "frame_type", base.DEC, vs_FrameType, 0xC0), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.flta.total_errors", "total_errors", base.DEC, nil, 0x3F), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.flta.frame_number", "frame_number", base.DEC, nil, 0xFC), "raw", 1, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.flta.fault_code", "fault_code", base.DEC, vs_fault_code), "raw", 2, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.flta.occurrence", "occurrence", base.DEC, nil, 0xFC), "raw", 3, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.flta.failure_level", "failure_level", base.DEC, vs_failure_level, 0x03), "raw", 3, 1, 1, 0 },
+    { ProtoField.uint16("evo11ka.flta.first_time_h", "first_time_h [h]", base.DEC, nil), "raw", 4, 2, 1, 0 },
+    { ProtoField.uint16("evo11ka.flta.last_time_h", "last_time_h [h]", base.DEC, nil), "raw", 6, 2, 1, 0 },
+} }
+
+messages[0x61E] = { name = "SW (Software Version)", fault = false, signals = {
+    { ProtoField.string("evo11ka.sw.version", "version"), "raw", 0, 8, 1, 0 },
+} }
+
+messages[0x61F] = { name = "SN (Serial Number)", fault = false, signals = {
+    { ProtoField.string("evo11ka.sn.serial", "serial"), "raw", 0, 8, 1, 0 },
+} }
+
+messages[0x616] = { name = "TST2 (Configuration)", fault = false, signals = {
+    { ProtoField.uint8("evo11ka.tst2.baudrate", "baudrate", base.DEC, vs_BaudrateType, 0xC0), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.tst2.id_type", "id_type", base.DEC, vs_IdType, 0x20), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.tst2.iac_control", "iac_control", base.DEC, vs_IacControlType, 0x0C), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.tst2.range", "range", base.DEC, vs_RangeType, 0x03), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst2.three_phase", "three_phase", 8, nil, 0x01), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst2.slave", "slave", 8, nil, 0x80), "raw", 1, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.tst2.evc_model", "evc_model", base.DEC, vs_EVCModelType, 0x40), "raw", 1, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.tst2.id_setting", "id_setting", base.DEC, vs_IDSettingType, 0x3C), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst2.air_cooler", "air_cooler", 8, nil, 0x01), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.tst2.parallel_ctrl", "parallel_ctrl", 8, nil, 0x02), "raw", 1, 1, 1, 0 },
+    { ProtoField.float("evo11ka.tst2.iacm_max_set_A", "iacm_max_set_A [A]"), "float", 2, 1, 0.2, 0.0 },
+    { ProtoField.float("evo11ka.tst2.vout_max_set_V", "vout_max_set_V [V]"), "float", 3, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.tst2.iout_max_set_A", "iout_max_set_A [A]"), "float", 5, 2, 0.1, 0.0 },
+    { ProtoField.uint8("evo11ka.tst2.password", "password", base.DEC, nil), "raw", 7, 1, 1, 0 },
+} }
+
+messages[0x712] = { name = "ACT3 (AC Currents)", fault = false, signals = {
+    { ProtoField.float("evo11ka.act3.fan_voltage_V", "fan_voltage_V [V]"), "float", 0, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.act3.iacm1_A", "iacm1_A [A]"), "float", 2, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.act3.iacm2_A", "iacm2_A [A]"), "float", 4, 2, 0.1, 0.0 },
+    { ProtoField.float("evo11ka.act3.iacm3_A", "iacm3_A [A]"), "float", 6, 2, 0.1, 0.0 },
+} }
+
+messages[0x713] = { name = "TEMP (Temperatures)", fault = false, signals = {
+    { ProtoField.float("evo11ka.temp.temp_loghv_C", "temp_loghv_C [°C]"), "float", 0, 2, 0.005188, -40.0 },
+    { ProtoField.float("evo11ka.temp.temp_power1_C", "temp_power1_C [°C]"), "float", 2, 2, 0.005188, -40.0 },
+    { ProtoField.float("evo11ka.temp.temp_power2_C", "temp_power2_C [°C]"), "float", 4, 2, 0.005188, -40.0 },
+    { ProtoField.float("evo11ka.temp.temp_power3_C", "temp_power3_C [°C]"), "float", 6, 2, 0.005188, -40.0 },
+} }
+
+messages[0x714] = { name = "ACT4 (Temperature FAN)", fault = false, signals = {
+    { ProtoField.float("evo11ka.act4.temp_logfan_C", "temp_logfan_C [°C]"), "float", 0, 2, 0.005188, -40.0 },
+    { ProtoField.uint16("evo11ka.act4.iout1_raw", "iout1_raw", base.DEC, nil), "raw", 2, 2, 1, 0 },
+    { ProtoField.uint16("evo11ka.act4.iout2_raw", "iout2_raw", base.DEC, nil), "raw", 4, 2, 1, 0 },
+    { ProtoField.uint16("evo11ka.act4.iout3_raw", "iout3_raw", base.DEC, nil), "raw", 6, 2, 1, 0 },
+} }
+
+messages[0x715] = { name = "STST1 (Real Time Diagnostic)", fault = false, signals = {
+    { ProtoField.bool("evo11ka.stst1.pfc_enable", "pfc_enable", 8, nil, 0x04), "raw", 0, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.log_temp_high", "log_temp_high", 8, nil, 0x20), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.log_temp_low", "log_temp_low", 8, nil, 0x10), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.uvlo_log", "uvlo_log", 8, nil, 0x08), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.ther_low_fail", "ther_low_fail", 8, nil, 0x04), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.rx618_fail", "rx618_fail", 8, nil, 0x01), "raw", 1, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.bulk1_fail", "bulk1_fail", 8, nil, 0x80), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.bulk2_fail", "bulk2_fail", 8, nil, 0x40), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.bulk3_fail", "bulk3_fail", 8, nil, 0x20), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.cooling_fail1", "cooling_fail1", 8, nil, 0x10), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.cooling_fail2", "cooling_fail2", 8, nil, 0x08), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.cooling_fail3", "cooling_fail3", 8, nil, 0x04), "raw", 2, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.uvlo_log_lv", "uvlo_log_lv", 8, nil, 0x08), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.bat_over", "bat_over", 8, nil, 0x02), "raw", 3, 1, 1, 0 },
+    { ProtoField.bool("evo11ka.stst1.bat_under", "bat_under", 8, nil, 0x01), "raw", 3, 1, 1, 0 },
+} }
+
+messages[0x61C] = { name = "FLTP (Fault Passive)", fault = true, signals = {
+    { ProtoField.uint8("evo11ka.fltp.frame_type", "frame_type", base.DEC, vs_FrameType, 0xC0), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.fltp.total_errors", "total_errors", base.DEC, nil, 0x3F), "raw", 0, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.fltp.frame_number", "frame_number", base.DEC, nil, 0xFC), "raw", 1, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.fltp.fault_code", "fault_code", base.DEC, vs_fault_code), "raw", 2, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.fltp.occurrence", "occurrence", base.DEC, nil, 0xFC), "raw", 3, 1, 1, 0 },
+    { ProtoField.uint8("evo11ka.fltp.failure_level", "failure_level", base.DEC, vs_failure_level, 0x03), "raw", 3, 1, 1, 0 },
+    { ProtoField.uint16("evo11ka.fltp.first_time_h", "first_time_h [h]", base.DEC, nil), "raw", 4, 2, 1, 0 },
+    { ProtoField.uint16("evo11ka.fltp.last_time_h", "last_time_h [h]", base.DEC, nil), "raw", 6, 2, 1, 0 },
+} }
+
+for _, msg in pairs(messages) do
+    for _, s in ipairs(msg.signals) do
+        fields[#fields + 1] = s[1]
+    end
+end
+evo.fields = fields
+
+-- Bus ID (29-bit with bit 31 set) -> { base CAN ID, charger }
+local bus_ids = {
+    [0x00000020] = { 0x610, 16 }, [0x00000021] = { 0x611, 16 }, [0x00000024] = { 0x614, 16 },
+    [0x00000025] = { 0x615, 16 }, [0x00000026] = { 0x616, 16 }, [0x00000028] = { 0x618, 16 },
+    [0x0000002B] = { 0x61B, 16 }, [0x0000002C] = { 0x61C, 16 }, [0x0000002D] = { 0x61D, 16 },
+    [0x0000002E] = { 0x61E, 16 }, [0x0000002F] = { 0x61F, 16 }, [0x00000030] = { 0x610, 15 },
+    [0x00000031] = { 0x611, 15 }, [0x00000034] = { 0x614, 15 }, [0x00000035] = { 0x615, 15 },
+    [0x00000036] = { 0x616, 15 }, [0x00000038] = { 0x618, 15 }, [0x0000003B] = { 0x61B, 15 },
+    [0x0000003C] = { 0x61C, 15 }, [0x0000003D] = { 0x61D, 15 }, [0x0000003E] = { 0x61E, 15 },
+    [0x0000003F] = { 0x61F, 15 }, [0x00000560] = { 0x610, 12 }, [0x00000561] = { 0x611, 12 },
+    [0x00000564] = { 0x614, 12 }, [0x00000565] = { 0x615, 12 }, [0x00000566] = { 0x616, 12 },
+    [0x00000568] = { 0x618, 12 }, [0x0000056C] = { 0x61C, 12 }, [0x0000056D] = { 0x61D, 12 },
+    [0x0000056E] = { 0x61E, 12 }, [0x0000056F] = { 0x61F, 12 }, [0x00000570] = { 0x610, 11 },
+    [0x00000571] = { 0x611, 11 }, [0x00000574] = { 0x614, 11 }, [0x00000575] = { 0x615, 11 },
+    [0x00000576] = { 0x616, 11 }, [0x00000578] = { 0x618, 11 }, [0x0000057C] = { 0x61C, 11 },
+    [0x0000057D] = { 0x61D, 11 }, [0x0000057E] = { 0x61E, 11 }, [0x0000057F] = { 0x61F, 11 },
+    [0x00000580] = { 0x610, 10 }, [0x00000581] = { 0x611, 10 }, [0x00000584] = { 0x614, 10 },
+    [0x00000585] = { 0x615, 10 }, [0x00000586] = { 0x616, 10 }, [0x00000588] = { 0x618, 10 },
+    [0x0000058C] = { 0x61C, 10 }, [0x0000058D] = { 0x61D, 10 }, [0x0000058E] = { 0x61E, 10 },
+    [0x0000058F] = { 0x61F, 10 }, [0x00000590] = { 0x610, 9 }, [0x00000591] = { 0x611, 9 },
+    [0x00000594] = { 0x614, 9 }, [0x00000595] = { 0x615, 9 }, [0x00000596] = { 0x616, 9 },
+    [0x00000598] = { 0x618, 9 }, [0x0000059C] = { 0x61C, 9 }, [0x0000059D] = { 0x61D, 9 },
+    [0x0000059E] = { 0x61E, 9 }, [0x0000059F] = { 0x61F, 9 }, [0x000005A0] = { 0x610, 8 },
+    [0x000005A1] = { 0x611, 8 }, [0x000005A4] = { 0x614, 8 }, [0x000005A5] = { 0x615, 8 },
+    [0x000005A6] = { 0x616, 8 }, [0x000005A8] = { 0x618, 8 }, [0x000005AC] = { 0x61C, 8 },
+    [0x000005AD] = { 0x61D, 8 }, [0x000005AE] = { 0x61E, 8 }, [0x000005AF] = { 0x61F, 8 },
+    [0x000005B0] = { 0x610, 7 }, [0x000005B1] = { 0x611, 7 }, [0x000005B4] = { 0x614, 7 },
+    [0x000005B5] = { 0x615, 7 }, [0x000005B6] = { 0x616, 7 }, [0x000005B8] = { 0x618, 7 },
+    [0x000005BC] = { 0x61C, 7 }, [0x000005BD] = { 0x61D, 7 }, [0x000005BE] = { 0x61E, 7 },
+    [0x000005BF] = { 0x61F, 7 }, [0x000005C0] = { 0x610, 6 }, [0x000005C1] = { 0x611, 6 },
+    [0x000005C4] = { 0x614, 6 }, [0x000005C5] = { 0x615, 6 }, [0x000005C6] = { 0x616, 6 },
+    [0x000005C8] = { 0x618, 6 }, [0x000005CB] = { 0x61B, 6 }, [0x000005CC] = { 0x61C, 6 },
+    [0x000005CD] = { 0x61D, 6 }, [0x000005CE] = { 0x61E, 6 }, [0x000005CF] = { 0x61F, 6 },
+    [0x000005D0] = { 0x610, 5 }, [0x000005D1] = { 0x611, 5 }, [0x000005D4] = { 0x614, 5 },
+    [0x000005D5] = { 0x615, 5 }, [0x000005D6] = { 0x616, 5 }, [0x000005D8] = { 0x618, 5 },
+    [0x000005DB] = { 0x61B, 5 }, [0x000005DC] = { 0x61C, 5 }, [0x000005DD] = { 0x61D, 5 },
+    [0x000005DE] = { 0x61E, 5 }, [0x000005DF] = { 0x61F, 5 }, [0x000005E0] = { 0x610, 4 },
+    [0x000005E1] = { 0x611, 4 }, [0x000005E4] = { 0x614, 4 }, [0x000005E5] = { 0x615, 4 },
+    [0x000005E6] = { 0x616, 4 }, [0x000005E8] = { 0x618, 4 }, [0x000005EB] = { 0x61B, 4 },
+    [0x000005EC] = { 0x61C, 4 }, [0x000005ED] = { 0x61D, 4 }, [0x000005EE] = { 0x61E, 4 },
+    [0x000005EF] = { 0x61F, 4 }, [0x000005F0] = { 0x610, 3 }, [0x000005F1] = { 0x611, 3 },
+    [0x000005F4] = { 0x614, 3 }, [0x000005F5] = { 0x615, 3 }, [0x000005F6] = { 0x616, 3 },
+    [0x000005F8] = { 0x618, 3 }, [0x000005FB] = { 0x61B, 3 }, [0x000005FC] = { 0x61C, 3 },
+    [0x000005FD] = { 0x61D, 3 }, [0x000005FE] = { 0x61E, 3 }, [0x000005FF] = { 0x61F, 3 },
+    [0x00000600] = { 0x610, 2 }, [0x00000601] = { 0x611, 2 }, [0x00000604] = { 0x614, 2 },
+    [0x00000605] = { 0x615, 2 }, [0x00000606] = { 0x616, 2 }, [0x00000608] = { 0x618, 2 },
+    [0x0000060B] = { 0x61B, 2 }, [0x0000060C] = { 0x61C, 2 }, [0x0000060D] = { 0x61D, 2 },
+    [0x0000060E] = { 0x61E, 2 }, [0x0000060F] = { 0x61F, 2 }, [0x00000610] = { 0x610, 1 },
+    [0x00000611] = { 0x611, 1 }, [0x00000614] = { 0x614, 1 }, [0x00000615] = { 0x615, 1 },
+    [0x00000616] = { 0x616, 1 }, [0x00000618] = { 0x618, 1 }, [0x0000061B] = { 0x61B, 1 },
+    [0x0000061C] = { 0x61C, 1 }, [0x0000061D] = { 0x61D, 1 }, [0x0000061E] = { 0x61E, 1 },
+    [0x0000061F] = { 0x61F, 1 }, [0x0000066B] = { 0x61B, 12 }, [0x0000067B] = { 0x61B, 11 },
+    [0x0000068B] = { 0x61B, 10 }, [0x0000069B] = { 0x61B, 9 }, [0x000006AB] = { 0x61B, 8 },
+    [0x000006BB] = { 0x61B, 7 }, [0x00000712] = { 0x712, 1 }, [0x00000713] = { 0x713, 1 },
+    [0x00000714] = { 0x714, 1 }, [0x00000715] = { 0x715, 1 }, [0x80000020] = { 0x610, 16 },
+    [0x80000021] = { 0x611, 16 }, [0x80000024] = { 0x614, 16 }, [0x80000025] = { 0x615, 16 },
+    [0x80000026] = { 0x616, 16 }, [0x80000028] = { 0x618, 16 }, [0x8000002B] = { 0x61B, 16 },
+    [0x8000002C] = { 0x61C, 16 }, [0x8000002D] = { 0x61D, 16 }, [0x8000002E] = { 0x61E, 16 },
+    [0x8000002F] = { 0x61F, 16 }, [0x80000030] = { 0x610, 15 }, [0x80000031] = { 0x611, 15 },
+    [0x80000034] = { 0x614, 15 }, [0x80000035] = { 0x615, 15 }, [0x80000036] = { 0x616, 15 },
+    [0x80000038] = { 0x618, 15 }, [0x8000003B] = { 0x61B, 15 }, [0x8000003C] = { 0x61C, 15 },
+    [0x8000003D] = { 0x61D, 15 }, [0x8000003E] = { 0x61E, 15 }, [0x8000003F] = { 0x61F, 15 },
+    [0x80000560] = { 0x610, 12 }, [0x80000561] = { 0x611, 12 }, [0x80000564] = { 0x614, 12 },
+    [0x80000565] = { 0x615, 12 }, [0x80000566] = { 0x616, 12 }, [0x80000568] = { 0x618, 12 },
+    [0x8000056C] = { 0x61C, 12 }, [0x8000056D] = { 0x61D, 12 }, [0x8000056E] = { 0x61E, 12 },
+    [0x8000056F] = { 0x61F, 12 }, [0x80000570] = { 0x610, 11 }, [0x80000571] = { 0x611, 11 },
+    [0x80000574] = { 0x614, 11 }, [0x80000575] = { 0x615, 11 }, [0x80000576] = { 0x616, 11 },
+    [0x80000578] = { 0x618, 11 }, [0x8000057C] = { 0x61C, 11 }, [0x8000057D] = { 0x61D, 11 },
+    [0x8000057E] = { 0x61E, 11 }, [0x8000057F] = { 0x61F, 11 }, [0x80000580] = { 0x610, 10 },
+    [0x80000581] = { 0x611, 10 }, [0x80000584] = { 0x614, 10 }, [0x80000585] = { 0x615, 10 },
+    [0x80000586] = { 0x616, 10 }, [0x80000588] = { 0x618, 10 }, [0x8000058C] = { 0x61C, 10 },
+    [0x8000058D] = { 0x61D, 10 }, [0x8000058E] = { 0x61E, 10 }, [0x8000058F] = { 0x61F, 10 },
+    [0x80000590] = { 0x610, 9 }, [0x80000591] = { 0x611, 9 }, [0x80000594] = { 0x614, 9 },
+    [0x80000595] = { 0x615, 9 }, [0x80000596] = { 0x616, 9 }, [0x80000598] = { 0x618, 9 },
+    [0x8000059C] = { 0x61C, 9 }, [0x8000059D] = { 0x61D, 9 }, [0x8000059E] = { 0x61E, 9 },
+    [0x8000059F] = { 0x61F, 9 }, [0x800005A0] = { 0x610, 8 }, [0x800005A1] = { 0x611, 8 },
+    [0x800005A4] = { 0x614, 8 }, [0x800005A5] = { 0x615, 8 }, [0x800005A6] = { 0x616, 8 },
+    [0x800005A8] = { 0x618, 8 }, [0x800005AC] = { 0x61C, 8 }, [0x800005AD] = { 0x61D, 8 },
+    [0x800005AE] = { 0x61E, 8 }, [0x800005AF] = { 0x61F, 8 }, [0x800005B0] = { 0x610, 7 },
+    [0x800005B1] = { 0x611, 7 }, [0x800005B4] = { 0x614, 7 }, [0x800005B5] = { 0x615, 7 },
+    [0x800005B6] = { 0x616, 7 }, [0x800005B8] = { 0x618, 7 }, [0x800005BC] = { 0x61C, 7 },
+    [0x800005BD] = { 0x61D, 7 }, [0x800005BE] = { 0x61E, 7 }, [0x800005BF] = { 0x61F, 7 },
+    [0x800005C0] = { 0x610, 6 }, [0x800005C1] = { 0x611, 6 }, [0x800005C4] = { 0x614, 6 },
+    [0x800005C5] = { 0x615, 6 }, [0x800005C6] = { 0x616, 6 }, [0x800005C8] = { 0x618, 6 },
+    [0x800005CB] = { 0x61B, 6 }, [0x800005CC] = { 0x61C, 6 }, [0x800005CD] = { 0x61D, 6 },
+    [0x800005CE] = { 0x61E, 6 }, [0x800005CF] = { 0x61F, 6 }, [0x800005D0] = { 0x610, 5 },
+    [0x800005D1] = { 0x611, 5 }, [0x800005D4] = { 0x614, 5 }, [0x800005D5] = { 0x615, 5 },
+    [0x800005D6] = { 0x616, 5 }, [0x800005D8] = { 0x618, 5 }, [0x800005DB] = { 0x61B, 5 },
+    [0x800005DC] = { 0x61C, 5 }, [0x800005DD] = { 0x61D, 5 }, [0x800005DE] = { 0x61E, 5 },
+    [0x800005DF] = { 0x61F, 5 }, [0x800005E0] = { 0x610, 4 }, [0x800005E1] = { 0x611, 4 },
+    [0x800005E4] = { 0x614, 4 }, [0x800005E5] = { 0x615, 4 }, [0x800005E6] = { 0x616, 4 },
+    [0x800005E8] = { 0x618, 4 }, [0x800005EB] = { 0x61B, 4 }, [0x800005EC] = { 0x61C, 4 },
+    [0x800005ED] = { 0x61D, 4 }, [0x800005EE] = { 0x61E, 4 }, [0x800005EF] = { 0x61F, 4 },
+    [0x800005F0] = { 0x610, 3 }, [0x800005F1] = { 0x611, 3 }, [0x800005F4] = { 0x614, 3 },
+    [0x800005F5] = { 0x615, 3 }, [0x800005F6] = { 0x616, 3 }, [0x800005F8] = { 0x618, 3 },
+    [0x800005FB] = { 0x61B, 3 }, [0x800005FC] = { 0x61C, 3 }, [0x800005FD] = { 0x61D, 3 },
+    [0x800005FE] = { 0x61E, 3 }, [0x800005FF] = { 0x61F, 3 }, [0x80000600] = { 0x610, 2 },
+    [0x80000601] = { 0x611, 2 }, [0x80000604] = { 0x614, 2 }, [0x80000605] = { 0x615, 2 },
+    [0x80000606] = { 0x616, 2 }, [0x80000608] = { 0x618, 2 }, [0x8000060B] = { 0x61B, 2 },
+    [0x8000060C] = { 0x61C, 2 }, [0x8000060D] = { 0x61D, 2 }, [0x8000060E] = { 0x61E, 2 },
+    [0x8000060F] = { 0x61F, 2 }, [0x80000610] = { 0x610, 1 }, [0x80000611] = { 0x611, 1 },
+    [0x80000614] = { 0x614, 1 }, [0x80000615] = { 0x615, 1 }, [0x80000616] = { 0x616, 1 },
+    [0x80000618] = { 0x618, 1 }, [0x8000061B] = { 0x61B, 1 }, [0x8000061C] = { 0x61C, 1 },
+    [0x8000061D] = { 0x61D, 1 }, [0x8000061E] = { 0x61E, 1 }, [0x8000061F] = { 0x61F, 1 },
+    [0x8000066B] = { 0x61B, 12 }, [0x8000067B] = { 0x61B, 11 }, [0x8000068B] = { 0x61B, 10 },
+    [0x8000069B] = { 0x61B, 9 }, [0x800006AB] = { 0x61B, 8 }, [0x800006BB] = { 0x61B, 7 },
+    [0x80000712] = { 0x712, 1 }, [0x80000713] = { 0x713, 1 }, [0x80000714] = { 0x714, 1 },
+    [0x80000715] = { 0x715, 1 },
+}
+
+function evo.dissector(buf, pinfo, tree)
+    local can_id = can_id_f()
+    if can_id == nil then return 0 end
+    local key = can_id.value
+    local xtd = can_xtd_f()
+    if xtd ~= nil and xtd.value then key = key + 0x80000000 end
+    local bus = bus_ids[key]
+    if bus == nil then return 0 end
+    local msg = messages[bus[1]]
+    pinfo.cols.protocol = "EVO11KA"
+    pinfo.cols.info = string.format("%s charger %d", msg.name, bus[2])
+    local sub = tree:add(evo, buf(), "EVO11KA " .. msg.name)
+    sub:add(f_message, msg.name)
+    sub:add(f_charger, bus[2])
+    local n = buf:len()
+    if msg.fault and n == 8 and buf(1, 7):bytes():tohex() == "FFFFFFFFFFFFFF" then
+        sub:add(f_no_fault, true)
+        pinfo.cols.info:append(" no fault")
+        return n
+    end
+    for _, s in ipairs(msg.signals) do
+        local byte, size = s[3], s[4]
+        if byte + size <= n then
+            if s[2] == "float" then
+                sub:add(s[1], buf(byte, size), buf(byte, size):uint() * s[5] + s[6])
+            else
+                sub:add(s[1], buf(byte, size))
+            end
+        end
+    end
+    return n
+end
+
+-- Standard IDs in can.id, 29-bit IDs in can.extended_id (older versions: can.id only)
+local std_table = DissectorTable.get("can.id")
+local ok, ext_table = pcall(DissectorTable.get, "can.extended_id")
+for key, _ in pairs(bus_ids) do
+    if key >= 0x80000000 then
+        if ok and ext_table ~= nil then ext_table:add(key - 0x80000000, evo) end
+    else
+        std_table:add(key, evo)
+    end
+end
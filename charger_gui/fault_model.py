@@ -0,0 +1,110 @@
+"""Lista guasti indicizzata per (charger, codice guasto), senza Qt
+
+FaultStore tiene un FaultRecord per (charger, codice) in una lista di
+righe più un dict chiave -> riga, così un frame di guasto è un upsert O(1).
+Le righe vengono solo aggiunte o rimosse con swap: una vista può tenere i
+numeri di riga e aggiornarli a blocchi (FaultTableModel in widgets.py).
+
+Attivo/passivo segue la lista in cui il guasto è stato riportato: FLTA
+(0x61D) lo marca attivo; un guasto che esce dalla lista attiva resta
+passivo (storico) finché non esce anche dalla lista inattiva (vedi
+fault_poller).
+"""
+
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple
+
+from .can_decoder import FailureLevel, FaultPacket
+from .fault_table import FaultInfo, fault_info
+
+# Rango di ordinamento per livello riportato (più alto = più grave)
+LEVEL_RANK = {FailureLevel.WARNING: 1, FailureLevel.SOFT: 2, FailureLevel.HARD: 3}
+
+FaultKey = Tuple[int, int]          # (charger, codice guasto)
+
+
+@dataclass
+class FaultRecord:
+    charger: int
+    code: int
+    active: bool
+    level: FailureLevel
+    occurrence: int
+    first_time_h: int
+    last_time_h: int
+    info: FaultInfo
+
+    @property
+    def key(self) -> FaultKey:
+        return self.charger, self.code
+
+    @property
+    def sort_key(self) -> int:
+        """Prima la gravità, poi l'ultimo istante (un int: usabile come sort role Qt)"""
+        return (LEVEL_RANK.get(self.level, 0) << 17) | (self.active << 16) | self.last_time_h
+
+
+class FaultStore:
+    def __init__(self):
+        self.rows: List[FaultRecord] = []
+        self.index: Dict[FaultKey, int] = {}
+
+    def __len__(self) -> int:
+        return len(self.rows)
+
+    def get(self, charger: int, code: int) -> Optional[FaultRecord]:
+        row = self.index.get((charger, code))
+        return None if row is None else self.rows[row]
+
+    def upsert(self, charger: int, packet: FaultPacket, active: bool) -> Tuple[int, bool]:
+        """Inserisce o aggiorna da un frame di guasto decodificato: (riga, inserito)
+
+        Un report passivo non declassa un guasto attualmente attivo.
+        """
+        key = (charger, packet.fault_code)
+        row = self.index.get(key)
+        if row is None:
+            row = len(self.rows)
+            self.rows.append(FaultRecord(charger, packet.fault_code, active, packet.failure_level,
+                                         packet.occurrence, packet.first_time_h, packet.last_time_h,
+                                         fault_info(packet.fault_code)))
+            self.index[key] = row
+            return row, True
+        rec = self.rows[row]
+        rec.active = active or rec.active
+        rec.level = packet.failure_level
+        rec.occurrence = packet.occurrence
+        rec.first_time_h = packet.first_time_h
+        rec.last_time_h = packet.last_time_h
+        return row, False
+
+    def deactivate(self, key: FaultKey) -> Optional[int]:
+        """Guasto attivo diventa passivo: riga cambiata, None se sconosciuto o già passivo"""
+        row = self.index.get(key)
+        if row is None or not self.rows[row].active:
+            return None
+        self.rows[row].active = False
+        return row
+
+    def remove(self, key: FaultKey) -> Optional[Tuple[int, int]]:
+        """Rimozione con swap: (riga rimossa, riga spostata al suo posto) o None
+
+        L'ultima riga prende il posto liberato, quindi cambiano solo due righe.
+        """
+        row = self.index.pop(key, None)
+        if row is None:
+            return None
+        last = len(self.rows) - 1
+        if row != last:
+            moved = self.rows[last]
+            self.rows[row] = moved
+            self.index[moved.key] = row
+        self.rows.pop()
+        return row, last
+
+    def clear(self):
+        self.rows.clear()
+        self.index.clear()
+
+    def active_count(self) -> int:
+        return sum(1 for r in self.rows if r.active)
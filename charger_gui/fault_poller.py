@@ -0,0 +1,243 @@
+"""Polling dei guasti in background con aggiornamenti solo delle differenze (senza Qt)
+
+    python -m charger_gui.fault_poller               # ciclo chiuso contro il simulatore
+
+A ogni intervallo il poller richiede le liste dei guasti attivi (0x61D) e
+inattivi (0x61C) di ogni charger con un frame REQ (0x61B, "80 00 06 1D"
+come nel manuale); ogni charger usa i suoi ID (charger 2: REQ 0x60B,
+"80 00 06 0D"). La risposta è un frame per guasto (FrameType MULTI, frame n
+di total_errors) o il frame "No Fault"; viene ricomposta per charger e
+lista, e solo quando è completa confrontata con la lista completa precedente.
+Il risultato è un FaultDiff con i soli guasti aggiunti, rimossi e cambiati:
+una lista invariata non produce nulla per la UI o il log.
+
+Una risposta ancora incompleta quando parte la richiesta successiva viene
+scartata. Il polling è opzionale: con l'intervallo di default (0) non si
+invia nulla sul bus, le risposte a richieste inviate da altri vengono
+comunque seguite.
+"""
+
+import logging
+import sys
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Sequence, Tuple
+
+from .can_decoder import CANDecoder, FaultPacket, FrameType, ReqPacket
+from .can_encoder import CANEncoder
+
+C = CANDecoder
+
+log = logging.getLogger(__name__)
+
+FAULT_LISTS = (C.CAN_ID_FLTA, C.CAN_ID_FLTP)
+DEFAULT_INTERVAL_S = 0.0         # Spento: la GUI invia REQ solo se l'utente imposta un intervallo
+
+FaultList = Dict[int, FaultPacket]      # codice guasto -> ultimo frame
+
+
+def _same(a: FaultPacket, b: FaultPacket) -> bool:
+    """Stesso stato del guasto (numerazione dei frame ignorata)"""
+    return (a.occurrence == b.occurrence and a.failure_level == b.failure_level
+            and a.first_time_h == b.first_time_h and a.last_time_h == b.last_time_h)
+
+
+@dataclass
+class FaultDiff:
+    charger: int
+    list_id: int                        # CAN_ID_FLTA o CAN_ID_FLTP
+    added: List[FaultPacket] = field(default_factory=list)
+    changed: List[FaultPacket] = field(default_factory=list)
+    removed: List[int] = field(default_factory=list)      # codici guasto
+
+    @property
+    def active(self) -> bool:
+        return self.list_id == C.CAN_ID_FLTA
+
+    def __bool__(self) -> bool:
+        return bool(self.added or self.changed or self.removed)
+
+    def lines(self) -> List[str]:
+        kind = "active" if self.active else "inactive"
+        out = [f"charger {self.charger} {kind} +0x{p.fault_code:02X} {p.failure_level.name} "
+               f"occ {p.occurrence} last {p.last_time_h}h" for p in self.added]
+        out += [f"charger {self.charger} {kind} ~0x{p.fault_code:02X} {p.failure_level.name} "
+                f"occ {p.occurrence} last {p.last_time_h}h" for p in self.changed]
+        out += [f"charger {self.charger} {kind} -0x{code:02X}" for code in self.removed]
+        return out
+
+
+def diff_lists(charger: int, list_id: int, old: FaultList, new: FaultList) -> FaultDiff:
+    d = FaultDiff(charger, list_id)
+    for code, p in new.items():
+        prev = old.get(code)
+        if prev is None:
+            d.added.append(p)
+        elif not _same(prev, p):
+            d.changed.append(p)
+    d.removed = [code for code in old if code not in new]
+    return d
+
+
+class FaultAssembler:
+    """Frame di una risposta (un charger, una lista) -> lista guasti completa"""
+
+    def __init__(self):
+        self.frames: Dict[int, FaultPacket] = {}
+        self.total = 0
+
+    def reset(self):
+        self.frames.clear()
+        self.total = 0
+
+    @property
+    def pending(self) -> bool:
+        return bool(self.frames)
+
+    def feed(self, packet: Optional[FaultPacket]) -> Optional[FaultList]:
+        """None finché la risposta è incompleta"""
+        if packet is None:                                  # "No Fault Detected"
+            self.reset()
+            return {}
+        if packet.frame_type != FrameType.MULTI or packet.total_errors <= 1:
+            self.reset()
+            return {packet.fault_code: packet}
+        if packet.total_errors != self.total or packet.frame_number in self.frames:
+            self.reset()                                    # Iniziata una nuova risposta
+            self.total = packet.total_errors
+        self.frames[packet.frame_number] = packet
+        if len(self.frames) < self.total:
+            return None
+        result = {p.fault_code: p for p in self.frames.values()}
+        self.reset()
+        return result
+
+
+class FaultPoller:
+    """Pianificazione REQ + ricomposizione + diff, guidati da poll(now) e on_frame()"""
+
+    def __init__(self, interval_s: float = DEFAULT_INTERVAL_S, lists: Sequence[int] = FAULT_LISTS):
+        self.interval_s = interval_s            # <= 0: nessuna richiesta, risposte comunque seguite
+        self.lists = tuple(lists)
+        self.known: Dict[Tuple[int, int], FaultList] = {}
+        self._asm: Dict[Tuple[int, int], FaultAssembler] = {}
+        self._next: Dict[int, float] = {}       # charger -> istante della prossima richiesta
+        self._extended: Dict[int, bool] = {}
+        # Statistiche
+        self.requests = 0
+        self.answers = 0
+        self.dropped = 0
+        self.diffs = 0
+
+    def forget(self):
+        """Dimentica le liste note: le prossime risposte complete escono tutte come aggiunte"""
+        self.known.clear()
+
+    def _assembler(self, key: Tuple[int, int]) -> FaultAssembler:
+        asm = self._asm.get(key)
+        if asm is None:
+            asm = self._asm[key] = FaultAssembler()
+        return asm
+
+    def request_frames(self, charger: int) -> List[Tuple[int, bool, List[int]]]:
+        """(ID di bus, esteso, payload) dei frame REQ di un charger"""
+        extended = self._extended.get(charger, False)
+        req_id = C.id_map.bus_id(C.CAN_ID_REQ, charger, extended)
+        return [(req_id, extended,
+                 CANEncoder.encode_req(ReqPacket(True, C.id_map.bus_id(list_id, charger, extended))))
+                for list_id in self.lists]
+
+    def poll(self, now: float, chargers: Sequence[int]) -> List[Tuple[int, bool, List[int]]]:
+        """Frame REQ dovuti all'istante now [s] per i charger indicati"""
+        if self.interval_s <= 0:
+            return []
+        out = []
+        for charger in chargers:
+            if charger not in C.id_map.chargers or now < self._next.get(charger, 0.0):
+                continue                        # 13, 14: nessun ID nel manuale
+            self._next[charger] = now + self.interval_s
+            for list_id in self.lists:
+                asm = self._assembler((charger, list_id))
+                if asm.pending:
+                    self.dropped += 1
+                    asm.reset()
+            out += self.request_frames(charger)
+            self.requests += len(self.lists)
+        return out
+
+    def on_frame(self, charger: int, list_id: int, packet: Optional[FaultPacket],
+                 extended: bool = False) -> Optional[FaultDiff]:
+        """Un frame FLTA/FLTP (packet None = "No Fault"): il diff quando la lista è completa"""
+        self._extended[charger] = extended
+        key = (charger, list_id)
+        faults = self._assembler(key).feed(packet)
+        if faults is None:
+            return None
+        self.answers += 1
+        d = diff_lists(charger, list_id, self.known.get(key, {}), faults)
+        self.known[key] = faults
+        if not d:
+            return None
+        self.diffs += 1
+        for line in d.lines():
+            log.info(line)
+        return d
+
+
+# ============================================================================
+# Verifica a ciclo chiuso contro il simulatore
+# ============================================================================
+
+def simulate(seconds: float = 60.0, interval_s: float = 1.0, charger: int = 1,
+             extended: bool = False) -> FaultPoller:
+    """Charger simulato con guasti che compaiono/spariscono, interrogato ogni interval_s"""
+    from .can_decoder import FailureLevel, FaultCode
+    from .simulator import ActiveFault, ChargerSimulator
+
+    sim = ChargerSimulator(charger, extended)
+    poller = FaultPoller(interval_s)
+    events = {
+        10.0: ("add", ActiveFault(FaultCode.CAN_COMMAND.value, FailureLevel.SOFT, 1, 10, 10)),
+        20.0: ("add", ActiveFault(FaultCode.HVIL_INTERLOCK.value, FailureLevel.SOFT, 2, 5, 12)),
+        30.0: ("add", ActiveFault(FaultCode.HVIL_INTERLOCK.value, FailureLevel.SOFT, 3, 5, 13)),
+        40.0: ("del", FaultCode.CAN_COMMAND.value),
+    }
+    flt = {sim.bus_id(list_id): list_id for list_id in FAULT_LISTS}
+    frames = 0
+    while sim.now_ms < seconds * 1000:
+        t = sim.now_ms / 1000.0
+        ev = events.pop(t, None)
+        if ev and ev[0] == "add":
+            sim.state.faults[ev[1].code] = ev[1]
+        elif ev:
+            sim.state.faults.pop(ev[1], None)
+        for bus_id, extended, data in poller.poll(t, [sim.charger]):
+            sim.receive(bus_id, data, extended)
+        for f in sim.step():
+            list_id = flt.get(f.can_id)
+            if list_id is None:
+                continue
+            frames += 1
+            d = poller.on_frame(sim.charger, list_id, C.decode_fault(f.data), f.extended)
+            if d:
+                for line in d.lines():
+                    print(f"{t:6.1f} s  {line}")
+    print(f"{poller.requests} requests, {frames} fault frames, {poller.answers} answers, "
+          f"{poller.diffs} diffs, {poller.dropped} dropped")
+    return poller
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Fault poller against the simulator")
+    parser.add_argument("--seconds", type=float, default=60.0)
+    parser.add_argument("--interval", type=float, default=1.0, help="poll interval [s]")
+    parser.add_argument("--charger", type=int, default=1, help="simulated charger (1-12, 15, 16)")
+    parser.add_argument("--extended", action="store_true", help="29-bit IDs")
+    args = parser.parse_args(argv)
+    poller = simulate(args.seconds, args.interval, args.charger, args.extended)
+    # 4 cambi attesi: +A5, +AB, ~AB, -A5
+    return 0 if poller.diffs == 4 and not poller.dropped else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
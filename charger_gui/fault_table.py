@@ -0,0 +1,196 @@
+"""Metadati dei codici di guasto (Tabella 4.6 del manuale), condivisi tra Python e C
+
+    python -m charger_gui.fault_table            # verifica che l'header C sia aggiornato
+    python -m charger_gui.fault_table --write    # rigenera l'header C
+
+FAULT_SPECS è l'unico punto in cui i codici di guasto sono descritti. Viene
+espanso in una tabella di 256 voci indicizzata direttamente dal codice (D2 di
+FLTA/FLTP): FAULT_TABLE qui e FAULT_TABLE[] nel file generato
+utils_c_functions/utils_canBus_fault_table.h. I codici fuori dalla Tabella 4.6
+hanno una riga "Unknown", così nessuna ricerca richiede branch o confronti
+tra stringhe.
+
+La severità è il tipo di guasto del manuale (valori FailureLevel: gli stessi
+numeri dei bit 1-0 di D3 decodificati); ac_reset marca i guasti che si
+azzerano solo scollegando e ricollegando la rete AC.
+"""
+
+import os
+import sys
+from typing import List, NamedTuple, Optional, Tuple
+
+from .can_decoder import FailureLevel, FaultCode
+
+W, S, H = FailureLevel.WARNING, FailureLevel.SOFT, FailureLevel.HARD
+
+# codice, suffisso identificatore C, nome, severità, reset AC, azione consigliata
+FAULT_SPECS = (
+    (0xA0, "BULK1_VOLTAGE", "Bulk 1 Voltage", S, False,
+     "Check AC mains supply; clears when bulk > 360 V for 1 s"),
+    (0xA1, "BULK2_VOLTAGE", "Bulk 2 Voltage", S, False,
+     "Check AC mains supply; clears when bulk > 360 V for 1 s"),
+    (0xA2, "BULK3_VOLTAGE", "Bulk 3 Voltage", S, False,
+     "Check AC mains supply; clears when bulk > 360 V for 1 s"),
+    (0xA3, "BULK_ERROR", "Bulk Error", H, True,
+     "Bulk voltage low for more than 1 min: check mains, then cycle AC"),
+    (0xA4, "CAN_REGISTERS", "CAN Registers", W, False,
+     "Check CAN wiring, termination and bus load"),
+    (0xA5, "CAN_COMMAND", "CAN Command", S, False,
+     "CTL not received for 600 ms: check BMS CTL transmission (100 ms)"),
+    (0xA6, "TEMP_LOW", "Cold Plate Temp LOW", S, False,
+     "Cold plate below -30 C: warm up; clears above -25 C"),
+    (0xA7, "TEMP_DERATING", "Cold Plate Temp DERATING", W, False,
+     "Cold plate above 65 C, output derated: check coolant flow"),
+    (0xA8, "TEMP_HIGH", "Cold Plate Temp HIGH", S, False,
+     "Cold plate over maximum: check cooling; clears below max for 1 s"),
+    (0xA9, "TEMP_FAILED", "Cold Plate Temp FAILED", H, True,
+     "Over temperature while still running: check cooling, then cycle AC"),
+    (0xAA, "INPUT_CURRENT_MAX", "Input Current MAX", H, True,
+     "Input current > 16.5 A for 1 min: lower CTL IacMax, then cycle AC"),
+    (0xAB, "HVIL_INTERLOCK", "HVIL Interlock Loop", S, False,
+     "HVIL loop open: check HV connectors; clears when the loop closes"),
+    (0xAC, "LOGIC_TEMP", "Logic Temperature", S, False,
+     "Logic board over temperature: check cooling and ventilation"),
+    (0xAD, "OUTPUT_OVERVOLT", "Output Overvoltage", H, True,
+     "Output over the voltage limit: check CTL VoutMax and pack, then cycle AC"),
+)
+
+UNKNOWN_NAME = "Unknown Fault"
+UNKNOWN_ACTION = "Code not in Table 4.6: check charger firmware and manual"
+
+
+class FaultInfo(NamedTuple):
+    code: int
+    name: str
+    severity: Optional[FailureLevel]    # None = codice non presente in Tabella 4.6
+    ac_reset: bool
+    action: str
+
+    @property
+    def known(self) -> bool:
+        return self.severity is not None
+
+    @property
+    def label(self) -> str:
+        """Nome da visualizzare, con il codice per i guasti sconosciuti"""
+        return self.name if self.severity is not None else f"Unknown (0x{self.code:02X})"
+
+
+def _build() -> Tuple[FaultInfo, ...]:
+    table = [FaultInfo(code, UNKNOWN_NAME, None, False, UNKNOWN_ACTION) for code in range(256)]
+    for code, _ident, name, severity, ac_reset, action in FAULT_SPECS:
+        table[code] = FaultInfo(code, name, severity, ac_reset, action)
+    return tuple(table)
+
+
+FAULT_TABLE: Tuple[FaultInfo, ...] = _build()
+
+
+def fault_info(code: int) -> FaultInfo:
+    return FAULT_TABLE[code & 0xFF]
+
+
+# ============================================================================
+# Generatore dell'header C
+# ============================================================================
+
+C_HEADER = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))),
+                        "utils_c_functions", "utils_canBus_fault_table.h")
+
+_C_SEVERITY = {None: "FAULT_SEV_UNKNOWN", W: "FAULT_SEV_WARNING", S: "FAULT_SEV_SOFT", H: "FAULT_SEV_HARD"}
+
+
+def _c_string(text: str) -> str:
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def generate_c_header() -> str:
+    out: List[str] = [
+        "/* =============================================================================",
+        " *  FILE: utils_canBus_fault_table.h",
+        " * =============================================================================",
+        " *",
+        " *  EVO Charger fault code metadata (Table 4.6), 256 entries indexed by code",
+        " *",
+        " *  GENERATED by charger_gui/fault_table.py (python -m charger_gui.fault_table --write)",
+        " *  Do not edit: change FAULT_SPECS and regenerate.",
+        " *",
+        " * =============================================================================",
+        " */",
+        "",
+        "#ifndef UTILS_CANBUS_FAULT_TABLE_H",
+        "#define UTILS_CANBUS_FAULT_TABLE_H",
+        "",
+        "#include <stdint.h>",
+        "#include <stdbool.h>",
+        "",
+        "/* Fault codes (from Table 4.6) */",
+        "typedef enum {",
+    ]
+    for i, (code, ident, *_rest) in enumerate(FAULT_SPECS):
+        sep = "," if i < len(FAULT_SPECS) - 1 else ""
+        out.append(f"    FAULT_{code:02X}_{ident:<18} = 0x{code:02X}{sep}")
+    out += [
+        "} FaultCode_t;",
+        "",
+        "/* Failure type of the fault (same values as FailureLevel_t, 0 = not in the table) */",
+        "typedef enum {",
+        "    FAULT_SEV_UNKNOWN = 0,",
+        "    FAULT_SEV_WARNING = 1,     /* charger works, output de-rated */",
+        "    FAULT_SEV_SOFT    = 10,    /* charger stops, restarts when the fault clears */",
+        "    FAULT_SEV_HARD    = 11     /* charger stops until AC mains is cycled */",
+        "} FaultSeverity_t;",
+        "",
+        "typedef struct {",
+        "    const char *name;",
+        "    const char *action;          /* Recommended action */",
+        "    uint8_t severity;            /* FaultSeverity_t */",
+        "    bool ac_reset;               /* Clears only with AC disconnect/reconnect */",
+        "} FaultInfo_t;",
+        "",
+        "static const FaultInfo_t FAULT_TABLE[256] = {",
+    ]
+    for info in FAULT_TABLE:
+        out.append(f"    /* 0x{info.code:02X} */ {{ {_c_string(info.name)}, {_c_string(info.action)}, "
+                   f"{_C_SEVERITY[info.severity]}, {'true' if info.ac_reset else 'false'} }},")
+    out += [
+        "};",
+        "",
+        "#endif /* UTILS_CANBUS_FAULT_TABLE_H */",
+        "",
+    ]
+    return "\n".join(out)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Fault table: check or regenerate the C header")
+    parser.add_argument("--write", action="store_true", help="regenerate the C header")
+    parser.add_argument("--header", default=C_HEADER, help="header path")
+    args = parser.parse_args(argv)
+
+    codes = {code: ident for code, ident, *_rest in FAULT_SPECS}
+    if codes != {f.value: f.name for f in FaultCode}:
+        print("FAULT_SPECS and can_decoder.FaultCode differ")
+        return 1
+
+    text = generate_c_header()
+    if args.write:
+        with open(args.header, "w", newline="\n") as f:
+            f.write(text)
+        print(f"{args.header}: {len(FAULT_SPECS)} fault codes, 256 entries")
+        return 0
+    try:
+        with open(args.header) as f:
+            current = f.read()
+    except FileNotFoundError:
+        current = ""
+    if current != text:
+        print(f"{args.header} is out of date: run python -m charger_gui.fault_table --write")
+        return 1
+    print(f"{args.header} up to date")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
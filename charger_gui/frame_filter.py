@@ -0,0 +1,459 @@
+"""Espressioni filtro per traffico live e registrato, compilate una volta
+
+    python -m charger_gui.frame_filter "id==0x611 && vout > 400 && iout < 5" sessione.evlog
+    python -m charger_gui.frame_filter "tst1.rx618_fail" sessione.evlog --count
+    python -m charger_gui.frame_filter --bench
+
+Grammatica (stile C, accettati anche "and"/"or"/"not"):
+
+    expr    := or
+    or      := and ("||" and)*
+    and     := not ("&&" not)*
+    not     := "!" not | cmp
+    cmp     := bits (("==" | "!=" | "<" | "<=" | ">" | ">=") bits)?
+    bits    := atom ("&" atom)*
+    atom    := number | name | "(" expr ")" | "-" atom
+
+Nomi:
+    id, bus_id, charger     ID CAN base (0x611 per ogni charger), ID sul bus, charger 1..16
+    ext, tx, dlc, t         29 bit, inviato da noi, lunghezza payload, tempo [s] dall'inizio sessione
+    b0 .. b7                byte del payload
+    act1                    vero per i frame ACT1 (qualsiasi nome di messaggio delle tabelle livello 1-4)
+    act1.vout_V             segnale di un messaggio (suffisso di unità opzionale: act1.vout)
+    vout                    segnale di qualsiasi messaggio che lo ha (qui vout_V di ACT1)
+
+Un segnale che il frame non porta non ha valore: ogni confronto con esso è
+falso, quindi "vout > 400" seleziona solo i frame ACT1.
+
+Il parser costruisce un albero di closure su una tupla per frame
+(base, charger, bus_id, ext, tx, data, t_us); i segnali si leggono dai byte
+del payload con offset/scale di signals.SIGNALS, senza decodificare il
+pacchetto intero e senza lavoro su stringhe per frame. L'insieme degli ID
+base che l'espressione può soddisfare si ricava in compilazione, così i
+frame degli altri messaggi si scartano con una ricerca in un set.
+"""
+
+import operator
+import re
+import sys
+import time
+from typing import Callable, Dict, FrozenSet, Iterator, List, Optional, Tuple
+
+from .can_decoder import CANDecoder
+from .recording import Frame, Recording, RECORD_EXTENDED, RECORD_ID_MASK, RECORD_TX
+from .signals import ASCII, BOOL, FLOAT, SIGNALS, Signal
+
+C = CANDecoder
+
+Ctx = Tuple[int, int, int, bool, bool, bytes, int]         # base, charger, bus_id, ext, tx, data, t_us
+Getter = Callable[[Ctx], object]
+
+UNIT_SUFFIXES = ("A", "V", "C", "kW")
+
+_TOKEN = re.compile(r"""\s*(?:
+    (?P<num>0[xX][0-9A-Fa-f]+|\d+\.?\d*(?:[eE][-+]?\d+)?|\.\d+(?:[eE][-+]?\d+)?)
+  | (?P<name>[A-Za-z_][A-Za-z0-9_]*(?:\.[A-Za-z_][A-Za-z0-9_]*)?)
+  | (?P<op>\|\||&&|==|!=|<=|>=|[<>!&()-])
+)""", re.VERBOSE)
+
+_WORDS = {"and": "&&", "or": "||", "not": "!"}
+_CONSTANTS = {"true": True, "false": False}
+
+_COMPARE = {"==": operator.eq, "!=": operator.ne, "<": operator.lt,
+            "<=": operator.le, ">": operator.gt, ">=": operator.ge}
+
+_BUILTINS: Dict[str, Getter] = {
+    "id": operator.itemgetter(0),
+    "charger": operator.itemgetter(1),
+    "bus_id": operator.itemgetter(2),
+    "ext": operator.itemgetter(3),
+    "tx": operator.itemgetter(4),
+    "dlc": lambda c: len(c[5]),
+    "t": lambda c: c[6] / 1e6,
+}
+
+
+class FilterError(ValueError):
+    """Espressione filtro non valida"""
+
+
+# ============================================================================
+# Accesso ai segnali
+# ============================================================================
+
+def _message_key(base_id: int) -> str:
+    return C.get_message_name(base_id).split()[0].lower()
+
+
+MESSAGES: Dict[str, int] = {_message_key(base_id): base_id for base_id in SIGNALS}
+
+
+def _aliases(s: Signal) -> List[str]:
+    stem, _, suffix = s.name.rpartition("_")
+    return [s.name, stem] if stem and suffix in UNIT_SUFFIXES else [s.name]
+
+
+def _reader(s: Signal) -> Callable[[bytes], object]:
+    """Payload -> valore del segnale (None se il payload è troppo corto)"""
+    b, end = s.byte, s.byte + (2 if s.length == 16 else 1)
+    if s.length == 16:
+        if s.kind == FLOAT:
+            scale, offset = s.scale, s.offset
+            return lambda d: ((d[b] << 8 | d[b + 1]) * scale + offset) if len(d) >= end else None
+        return lambda d: (d[b] << 8 | d[b + 1]) if len(d) >= end else None
+    if s.kind == BOOL:
+        m = 1 << s.bit
+        return lambda d: (d[b] & m != 0) if len(d) > b else None
+    sh, mask = s.bit, s.mask
+    if s.kind == FLOAT:
+        scale, offset = s.scale, s.offset
+        return lambda d: ((d[b] >> sh & mask) * scale + offset) if len(d) > b else None
+    return lambda d: (d[b] >> sh & mask) if len(d) > b else None
+
+
+def _signals(name: str) -> Dict[int, Signal]:
+    """ID base -> Signal per "msg.signal" o per un nome di segnale semplice"""
+    msg, _, sig = name.rpartition(".")
+    if msg and msg not in MESSAGES:
+        raise FilterError(f"unknown message '{msg}' (known: {', '.join(sorted(MESSAGES))})")
+    bases = [MESSAGES[msg]] if msg else list(SIGNALS)
+    found = {}
+    for base_id in bases:
+        for s in SIGNALS[base_id]:
+            if sig in _aliases(s):
+                if s.kind == ASCII:
+                    raise FilterError(f"'{name}' is a text field, not comparable")
+                found[base_id] = s
+                break
+    return found
+
+
+# ============================================================================
+# Parser -> closure
+# ============================================================================
+
+class _Node:
+    """Sottoespressione compilata: getter + ID base per cui può essere vera/presente (None = tutti)"""
+    __slots__ = ("fn", "bases", "const")
+
+    def __init__(self, fn: Getter, bases: Optional[FrozenSet[int]] = None, const=None):
+        self.fn = fn
+        self.bases = bases
+        self.const = const          # Valore letterale, o None
+
+
+def _truth(fn: Getter) -> Callable[[Ctx], bool]:
+    return lambda c: bool(fn(c))
+
+
+class _Parser:
+    def __init__(self, text: str):
+        self.text = text
+        self.tokens: List[Tuple[str, object, int]] = []
+        pos = 0
+        text = text.rstrip()
+        while pos < len(text):
+            m = _TOKEN.match(text, pos)
+            if m is None or m.end() == pos:
+                raise FilterError(f"unexpected character at {pos}: '{text[pos:pos + 10]}'")
+            if m.group("num") is not None:
+                raw = m.group("num")
+                value = int(raw, 16) if raw[:2] in ("0x", "0X") else (float(raw) if any(ch in raw for ch in ".eE") else int(raw))
+                self.tokens.append(("num", value, m.start("num")))
+            elif m.group("name") is not None:
+                word = m.group("name")
+                if word in _WORDS:
+                    self.tokens.append(("op", _WORDS[word], m.start("name")))
+                elif word in _CONSTANTS:
+                    self.tokens.append(("num", _CONSTANTS[word], m.start("name")))
+                else:
+                    self.tokens.append(("name", word, m.start("name")))
+            else:
+                self.tokens.append(("op", m.group("op"), m.start("op")))
+            pos = m.end()
+        self.i = 0
+
+    def peek(self) -> Optional[object]:
+        return self.tokens[self.i][1] if self.i < len(self.tokens) and self.tokens[self.i][0] == "op" else None
+
+    def take(self):
+        tok = self.tokens[self.i]
+        self.i += 1
+        return tok
+
+    def error(self, what: str) -> FilterError:
+        if self.i < len(self.tokens):
+            return FilterError(f"{what} at {self.tokens[self.i][2]}")
+        return FilterError(f"{what} at end of expression")
+
+    def parse(self) -> _Node:
+        if not self.tokens:
+            raise FilterError("empty expression")
+        node = self.or_()
+        if self.i < len(self.tokens):
+            raise self.error("unexpected token")
+        return node
+
+    def or_(self) -> _Node:
+        nodes = [self.and_()]
+        while self.peek() == "||":
+            self.take()
+            nodes.append(self.and_())
+        if len(nodes) == 1:
+            return nodes[0]
+        bases = None if any(n.bases is None for n in nodes) else frozenset().union(*(n.bases for n in nodes))
+        fn = nodes[0].fn
+        for n in nodes[1:]:
+            fn = (lambda a, b: lambda c: bool(a(c)) or bool(b(c)))(fn, n.fn)
+        return _Node(fn, bases)
+
+    def and_(self) -> _Node:
+        nodes = [self.not_()]
+        while self.peek() == "&&":
+            self.take()
+            nodes.append(self.not_())
+        if len(nodes) == 1:
+            return nodes[0]
+        known = [n.bases for n in nodes if n.bases is not None]
+        bases = frozenset.intersection(*known) if known else None
+        # Coppie annidate a destra: short circuit senza un ciclo per frame
+        fn = nodes[-1].fn
+        for n in reversed(nodes[:-1]):
+            fn = (lambda a, b: lambda c: bool(a(c)) and bool(b(c)))(n.fn, fn)
+        return _Node(fn, bases)
+
+    def not_(self) -> _Node:
+        if self.peek() == "!":
+            self.take()
+            inner = self.not_().fn
+            return _Node(lambda c: not inner(c))
+        return self.cmp()
+
+    def cmp(self) -> _Node:
+        left = self.bits()
+        op = self.peek()
+        if op not in _COMPARE:
+            return left
+        self.take()
+        right = self.bits()
+        fn = _COMPARE[op]
+        bases = left.bases if right.bases is None else (right.bases if left.bases is None
+                                                        else left.bases & right.bases)
+        lf, rf = left.fn, right.fn
+        if right.const is not None:
+            k = right.const
+            if op == "==" and lf is _BUILTINS["id"]:
+                bases = frozenset((k,))             # id == 0x611: gli altri messaggi scartati subito
+            return _Node(lambda c: (x := lf(c)) is not None and fn(x, k), bases)
+        return _Node(lambda c: (x := lf(c)) is not None and (y := rf(c)) is not None and fn(x, y), bases)
+
+    def bits(self) -> _Node:
+        node = self.atom()
+        while self.peek() == "&":
+            self.take()
+            right = self.atom()
+            lf, rf = node.fn, right.fn
+            node = _Node(lambda c: (x := lf(c)) is not None and (y := rf(c)) is not None and int(x) & int(y),
+                         node.bases if right.bases is None else right.bases)
+        return node
+
+    def atom(self) -> _Node:
+        if self.i >= len(self.tokens):
+            raise self.error("missing operand")
+        kind, value, _pos = self.take()
+        if kind == "num":
+            return _Node(lambda c: value, const=value)
+        if kind == "name":
+            return self.name(value)
+        if value == "(":
+            node = self.or_()
+            if self.peek() != ")":
+                raise self.error("missing ')'")
+            self.take()
+            return node
+        if value == "-":
+            inner = self.atom()
+            if inner.const is not None:
+                k = -inner.const
+                return _Node(lambda c: k, const=k)
+            f = inner.fn
+            return _Node(lambda c: None if (x := f(c)) is None else -x, inner.bases)
+        self.i -= 1
+        raise self.error(f"unexpected '{value}'")
+
+    def name(self, name: str) -> _Node:
+        if name in _BUILTINS:
+            return _Node(_BUILTINS[name])
+        if len(name) == 2 and name[0] == "b" and name[1] in "01234567":
+            i = int(name[1])
+            return _Node(lambda c: c[5][i] if len(c[5]) > i else None)
+        if name in MESSAGES:
+            base = MESSAGES[name]
+            return _Node(lambda c: c[0] == base, frozenset((base,)))
+        found = _signals(name)
+        if not found:
+            raise FilterError(f"unknown field '{name}'")
+        bases = frozenset(found)
+        if len(found) == 1:
+            (base, s), = found.items()
+            read = _reader(s)
+            return _Node(lambda c: read(c[5]) if c[0] == base else None, bases)
+        readers = {base: _reader(s) for base, s in found.items()}
+        get = readers.get
+
+        def multi(c):
+            r = get(c[0])
+            return r(c[5]) if r is not None else None
+        return _Node(multi, bases)
+
+
+# ============================================================================
+# Filtro compilato
+# ============================================================================
+
+class Filter:
+    """Espressione compilata; match() per frame, select() su una registrazione"""
+
+    def __init__(self, text: str):
+        self.text = text
+        root = _Parser(text).parse()
+        self.bases = root.bases             # ID base che possono soddisfare il filtro (None = tutti, non-EVO inclusi)
+        self._fn = _truth(root.fn)
+        self._resolve = C.id_map.resolve
+
+    def __repr__(self) -> str:
+        return f"Filter({self.text!r})"
+
+    def match(self, bus_id: int, extended: bool, tx: bool, data: bytes, t_us: int = 0) -> bool:
+        resolved = self._resolve(bus_id, extended)
+        base, charger = resolved if resolved is not None else (-1, 0)
+        if self.bases is not None and base not in self.bases:
+            return False
+        return self._fn((base, charger, bus_id, extended, tx, data, t_us))
+
+    def frame(self, fr: Frame) -> bool:
+        return self.match(fr.can_id, fr.extended, fr.tx, fr.data, fr.timestamp_us)
+
+    def _keys(self) -> Dict[int, Optional[Tuple[int, int]]]:
+        """Chiave del record (ID | flag) -> (base, charger), None per le chiavi scartate subito"""
+        out: Dict[int, Optional[Tuple[int, int]]] = {}
+        for key in C.id_map.keys():
+            base_charger = C.id_map.resolve(key & RECORD_ID_MASK, bool(key & RECORD_EXTENDED))
+            keep = self.bases is None or base_charger[0] in self.bases
+            out[key] = out[key | RECORD_TX] = base_charger if keep else None
+        return out
+
+    def select(self, rec: Recording) -> Iterator[Frame]:
+        """Frame di una registrazione che soddisfano il filtro, senza costruire Frame per gli altri"""
+        resolve, fn = self._keys(), self._fn
+        miss = (-1, 0) if self.bases is None else None          # ID non-EVO
+        for ts, key, dlc, _ch, _res, data in rec.raw():
+            resolved = resolve.get(key, miss)
+            if resolved is None:
+                continue
+            bus_id = key & RECORD_ID_MASK
+            ext = bool(key & RECORD_EXTENDED)
+            tx = bool(key & RECORD_TX)
+            data = data[:dlc]
+            if fn((resolved[0], resolved[1], bus_id, ext, tx, data, ts)):
+                yield Frame(ts, bus_id, ext, tx, data)
+
+
+def compile_filter(text: Optional[str]) -> Optional[Filter]:
+    """None per un'espressione vuota (tiene tutto)"""
+    if text is None or not text.strip():
+        return None
+    return Filter(text)
+
+
+# ============================================================================
+# CLI
+# ============================================================================
+
+def _trace_line(fr: Frame) -> str:
+    resolved = C.id_map.resolve(fr.can_id, fr.extended)
+    name = C.get_message_name(resolved[0]).split()[0] if resolved else "-"
+    ident = f"{fr.can_id:08X}" if fr.extended else f"{fr.can_id:03X}"
+    return (f"{fr.timestamp_us / 1e6:12.6f}  {'Tx' if fr.tx else 'Rx'}  {ident:>8}  {name:<5} "
+            f"ch{resolved[1] if resolved else 0:<2}  {fr.data.hex(' ').upper()}")
+
+
+def bench() -> bool:
+    """Carica simulata: filtro compilato contro la stessa condizione sui pacchetti decodificati"""
+    import os
+    import tempfile
+    from .archive import _simulated_evlog
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "sim.evlog")
+        _simulated_evlog(path, 25.0, 0.2)
+        rec = Recording(path)
+        frames = list(rec)
+
+    text = "id==0x611 && vout > 400 && iout < 5"
+    flt = Filter(text)
+    start = time.perf_counter()
+    got = list(flt.select(rec))
+    dt_select = time.perf_counter() - start
+    start = time.perf_counter()
+    n_match = sum(1 for fr in frames if flt.frame(fr))
+    dt_match = time.perf_counter() - start
+
+    start = time.perf_counter()
+    want = []
+    for fr in frames:
+        decoded = C.decode_bus_message(fr.can_id, fr.extended, list(fr.data))
+        if decoded and decoded[0] == C.CAN_ID_ACT1 and decoded[2].vout_V > 400 and decoded[2].iout_A < 5:
+            want.append(fr)
+    dt_decode = time.perf_counter() - start
+    ok = got == want and n_match == len(want)
+    print(f"{len(frames)} frames, '{text}': {len(got)} match")
+    print(f"  select    {dt_select * 1e3:7.1f} ms  {dt_select / len(frames) * 1e9:6.0f} ns/frame")
+    print(f"  match     {dt_match * 1e3:7.1f} ms  {dt_match / len(frames) * 1e9:6.0f} ns/frame")
+    print(f"  decode    {dt_decode * 1e3:7.1f} ms  (full decode + Python condition)  {'OK' if ok else 'MISMATCH'}")
+
+    # Verifiche del parser: nomi, alias, operatori, errori
+    for expr in ("tst1.rx618_fail", "!act1 && charger == 1", "b0 & 0x80 && stat",
+                 "(vout_V >= 0.5 or tx) and not ext", "iacm_max_set > -1", "t < 1e3"):
+        Filter(expr)
+    for bad in ("vout >", "foo == 1", "act9.x", "(tx", "sw.version == 1", "tx ^ 1"):
+        try:
+            Filter(bad)
+        except FilterError:
+            continue
+        print(f"  '{bad}' accepted")
+        ok = False
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Filter frames of a recording")
+    parser.add_argument("expression", nargs="?")
+    parser.add_argument("files", nargs="*")
+    parser.add_argument("--count", action="store_true", help="only the number of matching frames")
+    parser.add_argument("--bench", action="store_true", help="speed against full decode")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        return 0 if bench() else 1
+    if not args.expression or not args.files:
+        parser.error("expression and files required")
+    try:
+        flt = Filter(args.expression)
+    except FilterError as e:
+        print(f"filter: {e}")
+        return 1
+    for path in args.files:
+        rec = Recording(path)
+        n = 0
+        for fr in flt.select(rec):
+            n += 1
+            if not args.count:
+                print(_trace_line(fr))
+        print(f"{path}: {n} / {len(rec)} frames")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,463 @@
+"""Suite di regressione sul corpus golden per i decoder CAN
+
+    python -m charger_gui.golden                    # corpus contro i decoder Python
+    python -m charger_gui.golden --c                # + ricompila l'harness C e lo verifica
+    python -m charger_gui.golden --sweep 100000     # + 100k frame casuali per ID (serve gcc)
+    python -m charger_gui.golden --rebuild          # rigenera corpus e valori attesi
+
+Il corpus (corpus/golden_v1.evlog) contiene frame per ogni ID EVO: i frame
+degli scenari del simulatore e di una carica simulata, payload limite (tutti
+0, tutti 1, bit che scorre, ogni livello di guasto) e payload casuali con
+seed. I valori attesi (corpus/golden_v1.expected) vengono dai decoder C di
+riferimento, compilati da utils_c_functions/utils_canBus_golden.c.
+
+Ogni backend (CANDecoder, decoder a blocchi, harness C) deve riprodurli:
+interi, flag ed enum esatti, float entro l'arrotondamento float32 (2^-20 del
+fondo scala del campo, molto sotto un LSB). Exit code 1 a ogni differenza,
+così un refactor del decoder è sicuro quando la suite è verde.
+"""
+
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from array import array
+from dataclasses import dataclass, field
+from operator import attrgetter, sub
+from typing import Callable, Dict, List, Optional, Sequence, Tuple
+
+from .can_decoder import CANDecoder
+from .recording import (Frame, Recording, write_frames, HEADER, RECORD, MAGIC, VERSION,
+                        PAYLOAD_OFFSET)
+from .signals import SIGNALS, FAULT_IDS, ASCII, ENUM, FLOAT, LEVEL, Signal, decode_bulk
+
+PACKAGE_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_DIR = os.path.dirname(PACKAGE_DIR)
+CORPUS_DIR = os.path.join(PACKAGE_DIR, "corpus")
+CORPUS_VERSION = 1
+CORPUS_LOG = os.path.join(CORPUS_DIR, f"golden_v{CORPUS_VERSION}.evlog")
+CORPUS_EXPECTED = os.path.join(CORPUS_DIR, f"golden_v{CORPUS_VERSION}.expected")
+HARNESS_SRC = os.path.join(REPO_DIR, "utils_c_functions", "utils_canBus_golden.c")
+
+SIM_FRAMES_PER_ID = 100         # Frame unici del simulatore tenuti per ID
+RANDOM_FRAMES_PER_ID = 100
+FLOAT_TOLERANCE = 2.0 ** -20    # Relativa al fondo scala del campo
+
+MAX_REPORTED = 20
+
+
+def value_count(base_id: int) -> int:
+    """Valori per frame nell'output dell'harness (i campi ASCII sono 8 byte)"""
+    return sum(8 if s.kind == ASCII else 1 for s in SIGNALS[base_id])
+
+
+# ============================================================================
+# Generazione del corpus
+# ============================================================================
+
+def _simulated_frames() -> List[Tuple[int, bytes]]:
+    """(base_id, payload) da ogni scenario e da una carica completa"""
+    from .simulator import Scenario, ScenarioRunner
+    from .charge_sim import ChargeSimulation
+
+    frames = []
+    scen_dir = os.path.join(PACKAGE_DIR, "scenarios")
+    for name in sorted(os.listdir(scen_dir)):
+        if name.endswith(".json"):
+            frames += ScenarioRunner(Scenario.load(os.path.join(scen_dir, name))).run().frames
+    frames += ChargeSimulation(ambient_C=35.0, soc=0.2).run(keep_frames=True).frame_log
+
+    out = []
+    for f in frames:
+        resolved = CANDecoder.id_map.resolve(f.can_id, f.extended)
+        if resolved is not None:
+            out.append((resolved[0], bytes(f.data).ljust(8, b'\x00')))
+    return out
+
+
+def _edge_payloads(base_id: int) -> List[bytes]:
+    payloads = [bytes(8), b'\xff' * 8]
+    for bit in range(64):
+        one = 1 << (63 - bit)
+        payloads.append(one.to_bytes(8, 'big'))
+        payloads.append((~one & (2 ** 64 - 1)).to_bytes(8, 'big'))
+    if base_id in FAULT_IDS:
+        payloads.append(b'\x00' + b'\xff' * 7)                  # No Fault Detected
+        for level in range(4):
+            for frame_type in range(4):
+                payloads.append(bytes([(frame_type << 6) | 3, 1 << 2, 0xA7,
+                                       (5 << 2) | level, 0, 10, 0, 20]))
+    return payloads
+
+
+def build_corpus(seed: int = CORPUS_VERSION) -> List[Frame]:
+    """Frame del corpus golden, in ordine deterministico"""
+    seen = set()
+    per_id: Dict[int, List[bytes]] = {bid: [] for bid in SIGNALS}
+
+    def add(base_id: int, payload: bytes):
+        if (base_id, payload) not in seen:
+            seen.add((base_id, payload))
+            per_id[base_id].append(payload)
+
+    sim: Dict[int, List[bytes]] = {bid: [] for bid in SIGNALS}
+    for base_id, payload in _simulated_frames():
+        if payload not in sim[base_id]:
+            sim[base_id].append(payload)
+    for base_id, payloads in sim.items():
+        step = max(1, len(payloads) // SIM_FRAMES_PER_ID)
+        for payload in payloads[::step][:SIM_FRAMES_PER_ID]:
+            add(base_id, payload)
+
+    rng = random.Random(seed)
+    for base_id in SIGNALS:
+        for payload in _edge_payloads(base_id):
+            add(base_id, payload)
+        for _ in range(RANDOM_FRAMES_PER_ID):
+            add(base_id, rng.randbytes(8))
+
+    # ID alternati come su un bus reale, a 1 ms di distanza
+    frames = []
+    queues = [list(p) for p in per_id.values()]
+    ids = list(per_id)
+    t_us = 0
+    while any(queues):
+        for base_id, q in zip(ids, queues):
+            if q:
+                frames.append(Frame(t_us, base_id, False, base_id in (CANDecoder.CAN_ID_CTL,
+                                                                      CANDecoder.CAN_ID_REQ), q.pop(0)))
+                t_us += 1000
+    return frames
+
+
+def write_sweep(path: str, per_id: int, seed: int) -> Dict[int, "Block"]:
+    """Payload casuali raggruppati per ID, record impacchettati a blocchi (nessun lavoro per frame)"""
+    rng = random.Random(seed)
+    size = RECORD.size
+    records = bytearray(size * per_id * len(SIGNALS))
+    blocks: Dict[int, Block] = {}
+    first = 0
+    for base_id in SIGNALS:
+        payloads = rng.randbytes(8 * per_id)
+        end = first + per_id * size
+        records[first + 8:end:size] = bytes([base_id & 0xFF]) * per_id
+        records[first + 9:end:size] = bytes([base_id >> 8]) * per_id
+        records[first + 12:end:size] = b'\x08' * per_id
+        for j in range(8):
+            records[first + PAYLOAD_OFFSET + j:end:size] = payloads[j::8]
+        start_frame = first // size
+        blocks[base_id] = Block(base_id, range(start_frame, start_frame + per_id), payloads)
+        first = end
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, size, 0, 0))
+        f.write(records)
+    return blocks
+
+
+def fill_expected(blocks: Dict[int, "Block"], values: array):
+    """Divide tra i blocchi l'output dell'harness di write_sweep()"""
+    pos = 0
+    for block in blocks.values():
+        n = len(block.frames) * value_count(block.base_id)
+        block.expected = values[pos:pos + n]
+        pos += n
+    if pos != len(values):
+        raise ValueError(f"harness output: {len(values)} values, {pos} expected")
+
+
+# ============================================================================
+# Harness C
+# ============================================================================
+
+def compile_harness(build_dir: str) -> str:
+    cc = os.environ.get("CC", "gcc")
+    if shutil.which(cc) is None:
+        raise RuntimeError(f"C compiler '{cc}' not found (set CC)")
+    exe = os.path.join(build_dir, "golden")
+    subprocess.run([cc, "-std=c11", "-O2", HARNESS_SRC, "-o", exe, "-lm"], check=True)
+    return exe
+
+
+def run_harness(exe: str, log_path: str) -> array:
+    out = subprocess.run([exe, log_path, "-"], check=True, stdout=subprocess.PIPE).stdout
+    values = array('d')
+    values.frombytes(out)
+    return values
+
+
+# ============================================================================
+# File dei valori attesi
+# ============================================================================
+
+def _fmt(v: float) -> str:
+    return "nan" if v != v else f"{v:.9g}"
+
+
+def write_expected(path: str, frames: Sequence[Frame], values: array):
+    with open(path, "w", encoding="ascii", newline="\n") as f:
+        f.write(f"# EVO11KA golden corpus v{CORPUS_VERSION}: values of the reference C decoders\n")
+        f.write("# (utils_c_functions/utils_canBus_golden.c), one line per frame of the .evlog\n")
+        f.write("# frame id values... (field order of charger_gui/signals.py)\n")
+        pos = 0
+        for i, fr in enumerate(frames):
+            n = value_count(fr.can_id)
+            f.write(f"{i} 0x{fr.can_id:03X} " + " ".join(_fmt(v) for v in values[pos:pos + n]) + "\n")
+            pos += n
+
+
+def read_expected(path: str) -> array:
+    values = array('d')
+    with open(path, encoding="ascii") as f:
+        for line in f:
+            if not line.startswith("#"):
+                values.extend(float(v) for v in line.split()[2:])
+    return values
+
+
+# ============================================================================
+# Confronto
+# ============================================================================
+
+@dataclass
+class Block:
+    """Frame di un ID, payload concatenati, valori attesi per righe"""
+    base_id: int
+    frames: Sequence[int] = field(default_factory=list)     # Indice nel corpus
+    payloads: bytes = field(default_factory=bytearray)
+    expected: array = field(default_factory=lambda: array('d'))
+
+
+@dataclass
+class Mismatch:
+    backend: str
+    frame: int
+    base_id: int
+    field: str
+    expected: float
+    got: object
+
+    def __str__(self) -> str:
+        return (f"[{self.backend}] frame {self.frame} 0x{self.base_id:03X} {self.field}: "
+                f"expected {_fmt(self.expected)}, got {self.got}")
+
+
+def make_blocks(frames: Sequence[Frame], values: array) -> Dict[int, Block]:
+    blocks: Dict[int, Block] = {}
+    pos = 0
+    for i, fr in enumerate(frames):
+        if fr.can_id not in SIGNALS or fr.extended:
+            continue
+        n = value_count(fr.can_id)
+        b = blocks.get(fr.can_id)
+        if b is None:
+            b = blocks[fr.can_id] = Block(fr.can_id)
+        b.frames.append(i)
+        b.payloads += fr.data.ljust(8, b'\x00')
+        b.expected.extend(values[pos:pos + n])
+        pos += n
+    if pos != len(values):
+        raise ValueError(f"expected values: {len(values)} found, {pos} needed by the corpus")
+    return blocks
+
+
+def _columns(block: Block) -> List[Tuple[str, Signal, array]]:
+    """(nome, segnale, colonna attesa) con i campi ASCII divisi per byte"""
+    nv = value_count(block.base_id)
+    cols, k = [], 0
+    for s in SIGNALS[block.base_id]:
+        if s.kind == ASCII:
+            for j in range(8):
+                cols.append((f"{s.name}[{j}]", s, block.expected[k::nv]))
+                k += 1
+        else:
+            cols.append((s.name, s, block.expected[k::nv]))
+            k += 1
+    return cols
+
+
+def _check_column(backend: str, block: Block, name: str, sig: Signal, expected: array,
+                  got: Sequence, rows: Sequence[int], out: List[Mismatch]):
+    full = len(rows) == len(expected)
+    exp = expected if full else [expected[i] for i in rows]
+    val = got if full else [got[i] for i in rows]
+    # Percorso veloce su colonne intere, la scansione per riga gira solo in caso di errore
+    if sig.kind == FLOAT:
+        tol = sig.full_scale * FLOAT_TOLERANCE
+        if max(map(abs, map(sub, exp, val)), default=0.0) <= tol:
+            return
+        bad = [i for i in rows if not abs(expected[i] - got[i]) <= tol]
+    else:
+        if array('d', exp) == array('d', val):
+            return
+        bad = [i for i in rows if expected[i] != got[i]]
+    for i in bad[:MAX_REPORTED]:
+        out.append(Mismatch(backend, block.frames[i], block.base_id, name, expected[i], got[i]))
+
+
+def _check_no_fault(backend: str, block: Block, no_fault: Sequence[bool],
+                    out: List[Mismatch]) -> List[int]:
+    """Confronta le righe "No Fault Detected", restituisce le righe con un guasto da verificare"""
+    first = block.expected[0::value_count(block.base_id)]
+    rows = []
+    for i, (e, nf) in enumerate(zip(first, no_fault)):
+        if (e != e) != nf:
+            out.append(Mismatch(backend, block.frames[i], block.base_id, "no_fault",
+                                e, "no fault" if nf else "fault"))
+        elif not nf:
+            rows.append(i)
+    return rows
+
+
+def check_bulk(block: Block) -> List[Mismatch]:
+    out: List[Mismatch] = []
+    got = decode_bulk(block.base_id, bytes(block.payloads))
+    n = len(block.frames)
+    rows = range(n)
+    if block.base_id in FAULT_IDS:
+        rows = _check_no_fault("bulk", block, got["no_fault"], out)
+    text = {s.name: ''.join(got[s.name]).encode('latin-1')
+            for s in SIGNALS[block.base_id] if s.kind == ASCII}
+    for name, sig, expected in _columns(block):
+        if sig.kind == ASCII:
+            j = int(name[len(sig.name) + 1:-1])
+            col = list(text[sig.name][j::8])
+        else:
+            col = got[name]
+        _check_column("bulk", block, name, sig, expected, col, rows, out)
+    return out
+
+
+def _row_getter(base_id: int) -> Callable[[object], List[float]]:
+    """Packet -> valori nell'ordine dell'harness (enum come .value, ASCII come bytes)"""
+    sigs = SIGNALS[base_id]
+    getter = attrgetter(*(s.name for s in sigs))
+    if any(s.kind == ASCII for s in sigs):
+        return lambda p: list(getter(p).encode('latin-1'))
+    enums = [k for k, s in enumerate(sigs) if s.kind == ENUM or s.kind == LEVEL]
+    if not enums:
+        return lambda p: getter(p)
+
+    def row(p):
+        values = list(getter(p))
+        for k in enums:
+            values[k] = values[k].value
+        return values
+    return row
+
+
+def check_python(block: Block) -> List[Mismatch]:
+    """CANDecoder.decode_message frame per frame, come fa la GUI"""
+    out: List[Mismatch] = []
+    decode = CANDecoder.decode_message
+    base_id = block.base_id
+    payloads = block.payloads
+    decoded = [decode(base_id, list(payloads[i:i + 8])) for i in range(0, len(payloads), 8)]
+    rows = range(len(decoded))
+    if base_id in FAULT_IDS:
+        rows = _check_no_fault("python", block, [p is None for p in decoded], out)
+    row = _row_getter(base_id)
+    table = [row(p) if p is not None else None for p in decoded]
+    for k, (name, sig, expected) in enumerate(_columns(block)):
+        col = [r[k] if r is not None else math.nan for r in table]
+        _check_column("python", block, name, sig, expected, col, rows, out)
+    return out
+
+
+BACKENDS: Dict[str, Callable[[Block], List[Mismatch]]] = {
+    "python": check_python,
+    "bulk": check_bulk,
+}
+
+
+def check_c(exe: str, log_path: str, expected: array) -> List[Mismatch]:
+    """L'harness C ricompilato deve riprodurre i valori attesi versionati"""
+    frames = list(Recording(log_path))
+    got = run_harness(exe, log_path)
+    blocks = make_blocks(frames, expected)
+    got_blocks = make_blocks(frames, got)
+    out: List[Mismatch] = []
+    for base_id, block in blocks.items():
+        for (name, sig, exp_col), (_, _, got_col) in zip(_columns(block), _columns(got_blocks[base_id])):
+            rows = [i for i in range(len(exp_col)) if exp_col[i] == exp_col[i]]
+            _check_column("c", block, name, sig, exp_col, got_col, rows, out)
+    return out
+
+
+def run_backends(blocks: Dict[int, Block], backends: Sequence[str], label: str) -> List[Mismatch]:
+    mismatches: List[Mismatch] = []
+    n = sum(len(b.frames) for b in blocks.values())
+    for name in backends:
+        start = time.perf_counter()
+        found = []
+        for block in blocks.values():
+            found += BACKENDS[name](block)
+        wall = time.perf_counter() - start
+        status = "PASS" if not found else f"FAIL ({len(found)})"
+        print(f"[{status}] {label} {name}: {n} frames, {wall:.2f} s "
+              f"({n / wall / 1e6 if wall else 0:.2f} Mframe/s)")
+        mismatches += found
+    return mismatches
+
+
+# ============================================================================
+# Riga di comando
+# ============================================================================
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Golden corpus regression suite for the CAN decoders")
+    parser.add_argument("--backend", action="append", choices=sorted(BACKENDS),
+                        help="Python backend(s) to check (default: all)")
+    parser.add_argument("--c", action="store_true",
+                        help="rebuild the C harness and check it against the committed values")
+    parser.add_argument("--sweep", type=int, default=0, metavar="N",
+                        help="also check N random frames per ID, expected values from the C harness")
+    parser.add_argument("--seed", type=int, default=1, help="seed of the sweep")
+    parser.add_argument("--rebuild", action="store_true",
+                        help=f"regenerate the corpus and the expected values (golden_v{CORPUS_VERSION})")
+    args = parser.parse_args(argv)
+    backends = args.backend or list(BACKENDS)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = compile_harness(tmp) if (args.c or args.sweep or args.rebuild) else None
+
+        if args.rebuild:
+            os.makedirs(CORPUS_DIR, exist_ok=True)
+            frames = build_corpus()
+            write_frames(CORPUS_LOG, frames)
+            write_expected(CORPUS_EXPECTED, frames, run_harness(exe, CORPUS_LOG))
+            print(f"Corpus: {len(frames)} frames -> {os.path.relpath(CORPUS_LOG, REPO_DIR)}")
+
+        expected = read_expected(CORPUS_EXPECTED)
+        frames = list(Recording(CORPUS_LOG))
+        mismatches = run_backends(make_blocks(frames, expected), backends, "corpus")
+
+        if exe and args.c:
+            start = time.perf_counter()
+            found = check_c(exe, CORPUS_LOG, expected)
+            print(f"[{'PASS' if not found else f'FAIL ({len(found)})'}] corpus c: "
+                  f"{len(frames)} frames, {time.perf_counter() - start:.2f} s")
+            mismatches += found
+
+        if args.sweep:
+            start = time.perf_counter()
+            log = os.path.join(tmp, "sweep.evlog")
+            blocks = write_sweep(log, args.sweep, args.seed)
+            fill_expected(blocks, run_harness(exe, log))
+            print(f"Sweep: {args.sweep * len(blocks)} frames generated and decoded by C in "
+                  f"{time.perf_counter() - start:.2f} s")
+            mismatches += run_backends(blocks, backends, "sweep")
+
+    for m in mismatches[:MAX_REPORTED]:
+        print(f"  {m}")
+    if len(mismatches) > MAX_REPORTED:
+        print(f"  ... {len(mismatches) - MAX_REPORTED} more")
+    return 1 if mismatches else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
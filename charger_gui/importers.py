@@ -0,0 +1,610 @@
+"""Importer per i log di altri strumenti -> .evlog (o direttamente ai decoder)
+
+    python -m charger_gui.importers bench.log car.asc car.blf capture.pcapng
+    python -m charger_gui.importers --all car.blf           # tiene anche gli ID non-EVO
+    python -m charger_gui.importers --decode car.asc        # solo decodifica, frame per messaggio
+    python -m charger_gui.importers --bench                 # log sintetici di ogni formato
+
+Formati (riconosciuti dai magic byte, poi dall'estensione):
+    candump   "(1436509052.249713) can0 611#0102030405060708" (candump -L)
+    ASC       log ASCII Vector (CANalyzer/CANoe), "base hex|dec"
+    BLF       log binari Vector, CAN_MESSAGE / CAN_MESSAGE2, container zlib
+    pcap(ng)  LINKTYPE_CAN_SOCKETCAN (227), pcap classico e pcapng
+
+Ogni reader è un generatore di tuple (timestamp_us, can_id, extended, tx,
+data) (i campi di recording.Frame) con il timestamp sul clock del file, tempo
+unix quando il formato lo prevede. I parser sono scritti a mano: le righe di
+testo si dividono una volta e il token dell'ID si cerca come bytes nel set
+degli ID EVO prima di convertire qualsiasi cosa; i formati binari si
+scorrono in buffer grandi con struct precompilate e la word grezza dell'ID
+(bit esteso incluso) si cerca direttamente. I frame CAN FD, remote ed error
+vengono saltati.
+"""
+
+import binascii
+import calendar
+import os
+import struct
+import sys
+import time
+import zlib
+from typing import BinaryIO, Callable, Dict, FrozenSet, Iterator, List, NamedTuple, Optional, Tuple
+
+from .can_decoder import CANDecoder, EXTENDED_FLAG
+from .recording import Frame, Recording, RecordingWriter, RECORD, RECORD_EXTENDED, RECORD_TX
+
+C = CANDecoder
+
+READ_SIZE = 1 << 20
+WRITE_SIZE = 1 << 20
+
+# Un timestamp sopra questo valore è tempo unix [us] (anno 2001 e successivi)
+UNIX_US_MIN = 1_000_000_000 * 1_000_000
+
+RawFrame = Tuple[int, int, bool, bool, bytes]
+
+
+class IdFilter(NamedTuple):
+    """ID da tenere nella forma in cui li vede ogni parser (None = tutto)"""
+    keys: Optional[FrozenSet[int]]          # bus_id | EXTENDED_FLAG (= CAN_EFF_FLAG = BLF bit 31)
+    candump: Optional[FrozenSet[bytes]]     # b"611", b"00000E11"
+    asc: Optional[FrozenSet[bytes]]         # b"611", b"E11x"
+
+
+def evo_filter() -> IdFilter:
+    keys = C.id_map.keys()
+    candump, asc = set(), set()
+    for key in keys:
+        bus_id = key & 0x1FFFFFFF
+        if key & EXTENDED_FLAG:
+            forms_cd, forms_asc = [f"{bus_id:08X}"], [f"{bus_id:X}x", f"{bus_id:X}X"]
+        else:
+            forms_cd, forms_asc = [f"{bus_id:03X}"], [f"{bus_id:X}"]
+        for text in forms_cd:
+            candump.update((text.encode(), text.lower().encode()))
+        for text in forms_asc:
+            asc.update((text.encode(), text.lower().encode()))
+    return IdFilter(frozenset(keys), frozenset(candump), frozenset(asc))
+
+
+EVO = evo_filter()
+ALL = IdFilter(None, None, None)
+
+
+def _seconds_to_us(text: bytes) -> int:
+    """"1436509052.249713" -> us, esatto (nessun arrotondamento float)"""
+    sec, _, frac = text.partition(b".")
+    if len(frac) == 6:
+        return int(sec) * 1_000_000 + int(frac)
+    return int(sec) * 1_000_000 + int((frac + b"000000")[:6] or b"0")
+
+
+# ============================================================================
+# candump -L
+# ============================================================================
+
+def read_candump(f: BinaryIO, flt: IdFilter = EVO) -> Iterator[RawFrame]:
+    text = flt.candump
+    unhex = binascii.a2b_hex
+    for line in f:
+        parts = line.split()
+        if len(parts) < 3 or parts[0][:1] != b"(":
+            continue
+        ident, sep, payload = parts[2].partition(b"#")
+        if not sep or payload[:1] in (b"#", b"R", b"r"):    # CAN FD (##) / remote (#R)
+            continue
+        if text is not None and ident not in text:
+            continue
+        # Flag di direzione opzionale delle versioni recenti di candump ("T" = inviato da questo nodo)
+        yield (_seconds_to_us(parts[0][1:-1]), int(ident, 16), len(ident) > 3,
+               len(parts) > 3 and parts[3] == b"T", unhex(payload))
+
+
+# ============================================================================
+# Vector ASC
+# ============================================================================
+
+_ASC_MONTHS = {m: i for i, m in enumerate((b"jan", b"feb", b"mar", b"apr", b"may", b"jun", b"jul", b"aug",
+                                           b"sep", b"oct", b"nov", b"dec"), start=1)}
+
+
+def _asc_date(parts: List[bytes]) -> Optional[int]:
+    """"date Wed Jun 5 10:20:30.123 am 2024" -> unix us (ora locale presa come UTC)"""
+    try:
+        month = _ASC_MONTHS[parts[2][:3].lower()]
+        day = int(parts[3])
+        hms, _, ms = parts[4].partition(b".")
+        h, m, s = (int(x) for x in hms.split(b":"))
+        rest = [p.lower() for p in parts[5:]]
+        if b"pm" in rest and h < 12:
+            h += 12
+        elif b"am" in rest and h == 12:
+            h = 0
+        year = int(parts[-1])
+    except (KeyError, IndexError, ValueError):
+        return None
+    return calendar.timegm((year, month, day, h, m, s)) * 1_000_000 + int((ms + b"000")[:3] or b"0") * 1000
+
+
+def read_asc(f: BinaryIO, flt: IdFilter = EVO) -> Iterator[RawFrame]:
+    base = 16
+    start_us = 0
+    text = flt.asc
+    unhex = binascii.a2b_hex
+    for line in f:
+        parts = line.split()
+        if len(parts) < 6 or parts[4] != b"d":
+            # Righe di header; le righe dei messaggi sono "<time> <channel> <id>[x] <Rx|Tx> d <dlc> <bytes...>"
+            if parts and parts[0] == b"date":
+                start_us = _asc_date(parts) or 0
+            elif len(parts) >= 2 and parts[0] == b"base":
+                base = 10 if parts[1] == b"dec" else 16
+            continue
+        ident = parts[2]
+        if base == 16 and text is not None and ident not in text:
+            continue
+        extended = ident[-1:] in (b"x", b"X")
+        try:
+            can_id = int(ident[:-1] if extended else ident, base)
+        except ValueError:
+            continue
+        if base != 16 and flt.keys is not None and (can_id | (EXTENDED_FLAG if extended else 0)) not in flt.keys:
+            continue
+        dlc = int(parts[5], 16)
+        yield (start_us + _seconds_to_us(parts[0]), can_id, extended, parts[3] == b"Tx",
+               unhex(b"".join(parts[6:6 + dlc])))
+
+
+# ============================================================================
+# Vector BLF
+# ============================================================================
+
+BLF_FILE_HEADER = struct.Struct("<4sLBBBBBBBBQQLL8H8H")
+BLF_OBJ_BASE = struct.Struct("<4sHHLL")
+BLF_OBJ_V1 = struct.Struct("<LHHQ")
+BLF_OBJ_V2 = struct.Struct("<LBBHQQ")
+BLF_CONTAINER = struct.Struct("<H6xL4x")
+BLF_CAN_MSG = struct.Struct("<HBBL8s")
+BLF_CAN_V1 = struct.Struct("<4sHHLLLHHQHBBL8s")     # Base + header V1 + messaggio CAN in un colpo solo
+
+BLF_CAN_MESSAGE = 1
+BLF_LOG_CONTAINER = 10
+BLF_CAN_MESSAGE2 = 86
+
+BLF_TIME_TEN_MICS = 1
+BLF_TIME_ONE_NANS = 2
+BLF_CAN_EXT = 0x80000000
+BLF_CAN_DIR_TX = 0x01
+BLF_CAN_REMOTE = 0x80
+
+
+def _blf_systemtime(fields) -> int:
+    year, month, _dow, day, hour, minute, second, ms = fields
+    if not year:
+        return 0
+    return calendar.timegm((year, month, day, hour, minute, second)) * 1_000_000 + ms * 1000
+
+
+def _blf_frames(data: bytes, start_us: int, keys: Optional[FrozenSet[int]], out: List[RawFrame]) -> int:
+    """Frame CAN del payload di un container aggiunti a out; restituisce l'offset di un oggetto tagliato"""
+    end = len(data)
+    pos = 0
+    base_unpack = BLF_OBJ_BASE.unpack_from
+    v1_unpack = BLF_CAN_V1.unpack_from
+    v1_size = BLF_CAN_V1.size
+    while pos + 16 <= end:
+        sig, header_size, header_version, obj_size, obj_type = base_unpack(data, pos)
+        if sig != b"LOBJ" or obj_size < 16:
+            raise ValueError("BLF: object signature not found")
+        if pos + obj_size > end:
+            break
+        if obj_type == BLF_CAN_MESSAGE or obj_type == BLF_CAN_MESSAGE2:
+            if header_version == 1 and header_size == 32 and pos + v1_size <= end:
+                (_s, _hs, _hv, _os, _ot, flags, _ci, _ov, ts,
+                 _ch, msg_flags, dlc, arb_id, payload) = v1_unpack(data, pos)
+            else:
+                if header_version == 1:
+                    flags, _ci, _ov, ts = BLF_OBJ_V1.unpack_from(data, pos + 16)
+                else:
+                    flags, _st, _r, _ov, ts, _orig = BLF_OBJ_V2.unpack_from(data, pos + 16)
+                _ch, msg_flags, dlc, arb_id, payload = BLF_CAN_MSG.unpack_from(data, pos + header_size)
+            if not msg_flags & BLF_CAN_REMOTE and (keys is None or arb_id in keys):
+                ts_us = ts * 10 if flags == BLF_TIME_TEN_MICS else ts // 1000
+                out.append((start_us + ts_us, arb_id & 0x1FFFFFFF, arb_id >= BLF_CAN_EXT,
+                            bool(msg_flags & BLF_CAN_DIR_TX), payload[:dlc] if dlc < 8 else payload))
+        pos += obj_size
+    return pos
+
+
+def read_blf(f: BinaryIO, flt: IdFilter = EVO) -> Iterator[RawFrame]:
+    head = f.read(BLF_FILE_HEADER.size)
+    if len(head) < BLF_FILE_HEADER.size or head[:4] != b"LOGG":
+        raise ValueError("BLF: bad file signature")
+    fields = BLF_FILE_HEADER.unpack(head)
+    start_us = _blf_systemtime(fields[14:22])
+    f.read(fields[1] - BLF_FILE_HEADER.size)
+
+    tail = b""
+    out: List[RawFrame] = []
+    while True:
+        base = f.read(BLF_OBJ_BASE.size)
+        if len(base) < BLF_OBJ_BASE.size:
+            break
+        sig, _hs, _hv, obj_size, obj_type = BLF_OBJ_BASE.unpack(base)
+        if sig != b"LOBJ":
+            raise ValueError("BLF: object signature not found")
+        body = f.read(obj_size - BLF_OBJ_BASE.size)
+        f.read(obj_size % 4)                                # Padding degli oggetti di primo livello
+        if obj_type == BLF_LOG_CONTAINER:
+            method, _size = BLF_CONTAINER.unpack_from(body)
+            payload = body[BLF_CONTAINER.size:]
+            data = tail + (zlib.decompress(payload) if method == 2 else payload)
+        else:
+            data = tail + base + body                       # Oggetto fuori da un container
+        cut = _blf_frames(data, start_us, flt.keys, out)
+        tail = data[cut:]
+        yield from out
+        out.clear()
+
+
+# ============================================================================
+# pcap / pcapng (LINKTYPE_CAN_SOCKETCAN)
+# ============================================================================
+
+LINKTYPE_CAN_SOCKETCAN = 227
+
+CAN_EFF_FLAG = 0x80000000
+CAN_RTR_FLAG = 0x40000000
+CAN_ERR_FLAG = 0x20000000
+SOCKETCAN_HEADER = struct.Struct(">IB3x")        # can_id (ordine di rete), len, pad/res
+
+PCAP_MAGIC_US = 0xA1B2C3D4
+PCAP_MAGIC_NS = 0xA1B23C4D
+PCAPNG_SHB = 0x0A0D0D0A
+PCAPNG_BYTE_ORDER = 0x1A2B3C4D
+PCAPNG_IDB = 1
+PCAPNG_EPB = 6
+PCAPNG_OPT_TSRESOL = 9
+PCAPNG_OPT_EPB_FLAGS = 2
+
+
+def _buffers(f: BinaryIO) -> Iterator[Tuple[bytes, List[bytes]]]:
+    """Letture grandi; il consumatore restituisce la coda non consumata in rest[0]"""
+    tail = b""
+    while True:
+        chunk = f.read(READ_SIZE)
+        if not chunk:
+            return
+        buf = tail + chunk
+        rest = [b""]
+        yield buf, rest
+        tail = rest[0]
+
+
+def read_pcap(f: BinaryIO, flt: IdFilter = EVO) -> Iterator[RawFrame]:
+    head = f.read(24)
+    if len(head) < 24:
+        raise ValueError("pcap: file too short")
+    e = "<" if struct.unpack_from("<I", head)[0] in (PCAP_MAGIC_US, PCAP_MAGIC_NS) else ">"
+    ns = struct.unpack_from(e + "I", head)[0] == PCAP_MAGIC_NS
+    linktype, = struct.unpack_from(e + "I", head, 20)
+    if linktype & 0xFFFF != LINKTYPE_CAN_SOCKETCAN:
+        raise ValueError(f"pcap: linktype {linktype}, not CAN SocketCAN")
+    rec = struct.Struct(e + "IIII")
+    keys = flt.keys
+    can = SOCKETCAN_HEADER.unpack_from
+    for buf, rest in _buffers(f):
+        pos, end = 0, len(buf)
+        while pos + 16 <= end:
+            sec, frac, incl, _orig = rec.unpack_from(buf, pos)
+            if pos + 16 + incl > end:
+                break
+            p = pos + 16
+            pos = p + incl
+            if incl < 8:
+                continue
+            raw_id, length = can(buf, p)
+            if raw_id & (CAN_RTR_FLAG | CAN_ERR_FLAG) or (keys is not None and raw_id not in keys):
+                continue
+            extended = raw_id >= CAN_EFF_FLAG
+            yield (sec * 1_000_000 + (frac // 1000 if ns else frac), raw_id & (0x1FFFFFFF if extended else 0x7FF),
+                   extended, False, buf[p + 8:p + 8 + min(length, 8)])
+        rest[0] = buf[pos:]
+
+
+def _pcapng_tsresol(options: bytes, e: str) -> int:
+    """Unità di timestamp al secondo dalle opzioni IDB (default 1e6)"""
+    pos = 0
+    while pos + 4 <= len(options):
+        code, length = struct.unpack_from(e + "HH", options, pos)
+        if code == 0:
+            break
+        if code == PCAPNG_OPT_TSRESOL and length >= 1:
+            v = options[pos + 4]
+            return 2 ** (v & 0x7F) if v & 0x80 else 10 ** v
+        pos += 4 + ((length + 3) & ~3)
+    return 1_000_000
+
+
+def _pcapng_outbound(buf: bytes, pos: int, end: int, e: str) -> bool:
+    """Opzione epb_flags di un EPB: bit di direzione 01 ingresso, 10 uscita"""
+    while pos + 4 <= end:
+        code, length = struct.unpack_from(e + "HH", buf, pos)
+        if code == 0:
+            break
+        if code == PCAPNG_OPT_EPB_FLAGS and length == 4:
+            return struct.unpack_from(e + "I", buf, pos + 4)[0] & 3 == 2
+        pos += 4 + ((length + 3) & ~3)
+    return False
+
+
+def read_pcapng(f: BinaryIO, flt: IdFilter = EVO) -> Iterator[RawFrame]:
+    e = "<"
+    block = struct.Struct("<II")
+    epb = struct.Struct("<IIIIIII")
+    interfaces: List[Optional[int]] = []       # tsresol per interfaccia, None = non CAN
+    keys = flt.keys
+    can = SOCKETCAN_HEADER.unpack_from
+    for buf, rest in _buffers(f):
+        pos, end = 0, len(buf)
+        while pos + 12 <= end:
+            btype, total = block.unpack_from(buf, pos)
+            if btype == PCAPNG_SHB:
+                e = "<" if struct.unpack_from("<I", buf, pos + 8)[0] == PCAPNG_BYTE_ORDER else ">"
+                block = struct.Struct(e + "II")
+                epb = struct.Struct(e + "IIIIIII")
+                btype, total = block.unpack_from(buf, pos)
+                interfaces = []
+            if total < 12:
+                raise ValueError("pcapng: bad block length")
+            if pos + total > end:
+                break
+            if btype == PCAPNG_EPB:
+                _t, _l, iface, hi, lo, cap, _orig = epb.unpack_from(buf, pos)
+                p = pos + 28
+                pos += total
+                resol = interfaces[iface] if iface < len(interfaces) else None
+                if resol is None or cap < 8:
+                    continue
+                raw_id, length = can(buf, p)
+                if raw_id & (CAN_RTR_FLAG | CAN_ERR_FLAG) or (keys is not None and raw_id not in keys):
+                    continue
+                ts = (hi << 32) | lo
+                extended = raw_id >= CAN_EFF_FLAG
+                opt = p + ((cap + 3) & ~3)
+                yield (ts if resol == 1_000_000 else ts * 1_000_000 // resol,
+                       raw_id & (0x1FFFFFFF if extended else 0x7FF), extended,
+                       opt < pos - 4 and _pcapng_outbound(buf, opt, pos - 4, e),
+                       buf[p + 8:p + 8 + min(length, 8)])
+                continue
+            if btype == PCAPNG_IDB:
+                linktype, = struct.unpack_from(e + "H", buf, pos + 8)
+                interfaces.append(_pcapng_tsresol(buf[pos + 16:pos + total - 4], e)
+                                  if linktype == LINKTYPE_CAN_SOCKETCAN else None)
+            pos += total
+        rest[0] = buf[pos:]
+
+
+# ============================================================================
+# Riconoscimento e import
+# ============================================================================
+
+READERS: Dict[str, Callable[[BinaryIO, IdFilter], Iterator[RawFrame]]] = {
+    "candump": read_candump, "asc": read_asc, "blf": read_blf, "pcap": read_pcap, "pcapng": read_pcapng,
+}
+
+
+def detect(path: str) -> str:
+    with open(path, "rb") as f:
+        head = f.read(64)
+    if head[:4] == b"LOGG":
+        return "blf"
+    if len(head) >= 4:
+        if struct.unpack_from("<I", head)[0] == PCAPNG_SHB:
+            return "pcapng"
+        magics = (PCAP_MAGIC_US, PCAP_MAGIC_NS)
+        if struct.unpack_from("<I", head)[0] in magics or struct.unpack_from(">I", head)[0] in magics:
+            return "pcap"
+    if head.lstrip()[:1] == b"(":
+        return "candump"
+    if os.path.splitext(path)[1].lower() == ".asc" or head.startswith((b"date", b"base")):
+        return "asc"
+    raise ValueError(f"{path}: unknown log format")
+
+
+def read_raw(path: str, fmt: Optional[str] = None, evo_only: bool = True) -> Iterator[RawFrame]:
+    reader = READERS[fmt or detect(path)]
+    with open(path, "rb", buffering=READ_SIZE) as f:
+        yield from reader(f, EVO if evo_only else ALL)
+
+
+def read_log(path: str, fmt: Optional[str] = None, evo_only: bool = True) -> Iterator[Frame]:
+    """Frame di un log esterno, in streaming"""
+    return map(Frame._make, read_raw(path, fmt, evo_only))
+
+
+def decode_log(path: str, fmt: Optional[str] = None) -> Iterator[tuple]:
+    """(timestamp_us, base_id, charger, packet) di ogni frame EVO, senza .evlog intermedio"""
+    decode = C.decode_bus_message
+    for ts, can_id, extended, _tx, data in read_raw(path, fmt):
+        decoded = decode(can_id, extended, list(data))
+        if decoded is not None:
+            yield (ts,) + tuple(decoded)
+
+
+class ImportStats(NamedTuple):
+    fmt: str
+    frames: int
+    bytes_in: int
+    seconds: float
+
+
+def import_log(path: str, out_path: str, fmt: Optional[str] = None, evo_only: bool = True) -> ImportStats:
+    """Log esterno -> .evlog; i timestamp unix diventano inizio sessione + offset"""
+    fmt = fmt or detect(path)
+    start = time.perf_counter()
+    frames = read_raw(path, fmt, evo_only)
+    first = next(frames, None)
+    t0 = first[0] if first is not None and first[0] >= UNIX_US_MIN else 0
+    pack = RECORD.pack
+    buf = bytearray()
+    with RecordingWriter(out_path, t0) as w:
+        if first is not None:
+            for ts, can_id, extended, tx, data in _chain(first, frames):
+                key = can_id | (RECORD_EXTENDED if extended else 0) | (RECORD_TX if tx else 0)
+                buf += pack(ts - t0, key, len(data), 0, 0, data)
+                if len(buf) >= WRITE_SIZE:
+                    w.write_packed(buf)
+                    buf.clear()
+            w.write_packed(buf)
+        count = w.count
+    return ImportStats(fmt, count, os.path.getsize(path), time.perf_counter() - start)
+
+
+def _chain(first: RawFrame, rest: Iterator[RawFrame]) -> Iterator[RawFrame]:
+    yield first
+    yield from rest
+
+
+# ============================================================================
+# Log sintetici (benchmark e autoverifica)
+# ============================================================================
+
+def _write_candump(path: str, frames: List[Frame]):
+    with open(path, "w") as f:
+        for fr in frames:
+            ident = f"{fr.can_id:08X}" if fr.extended else f"{fr.can_id:03X}"
+            f.write(f"({fr.timestamp_us // 1_000_000}.{fr.timestamp_us % 1_000_000:06d}) can0 "
+                    f"{ident}#{fr.data.hex().upper()}{' T' if fr.tx else ''}\n")
+
+
+def _write_asc(path: str, frames: List[Frame], start_us: int):
+    t = time.gmtime(start_us // 1_000_000)
+    with open(path, "w") as f:
+        f.write(time.strftime("date %a %b %d %I:%M:%S", t) + f".000 {'pm' if t.tm_hour >= 12 else 'am'} "
+                f"{t.tm_year}\nbase hex  timestamps absolute\nno internal events logged\n"
+                f"Begin Triggerblock\n   0.000000 Start of measurement\n")
+        for fr in frames:
+            rel = fr.timestamp_us - start_us
+            ident = f"{fr.can_id:X}x" if fr.extended else f"{fr.can_id:X}"
+            f.write(f"{rel // 1_000_000:5d}.{rel % 1_000_000:06d} 1  {ident:<15} {'Tx' if fr.tx else 'Rx'}   "
+                    f"d {len(fr.data)} {' '.join(f'{b:02X}' for b in fr.data)}\n")
+        f.write("End TriggerBlock\n")
+
+
+def _write_blf(path: str, frames: List[Frame], start_us: int, per_container: int = 5000):
+    t = time.gmtime(start_us // 1_000_000)
+    systime = (t.tm_year, t.tm_mon, 0, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, 0)
+    header_size = 144
+    stream = bytearray()
+    for fr in frames:
+        ts = (fr.timestamp_us - start_us) * 1000
+        arb = fr.can_id | (BLF_CAN_EXT if fr.extended else 0)
+        size = BLF_OBJ_BASE.size + BLF_OBJ_V1.size + BLF_CAN_MSG.size
+        stream += BLF_OBJ_BASE.pack(b"LOBJ", 32, 1, size, BLF_CAN_MESSAGE)
+        stream += BLF_OBJ_V1.pack(BLF_TIME_ONE_NANS, 0, 0, ts)
+        stream += BLF_CAN_MSG.pack(1, BLF_CAN_DIR_TX if fr.tx else 0, len(fr.data), arb, fr.data)
+    with open(path, "wb") as f:
+        f.write(BLF_FILE_HEADER.pack(b"LOGG", header_size, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, len(frames), 0,
+                                     *systime, *systime).ljust(header_size, b"\0"))
+        # Container tagliati a offset arbitrari: gli oggetti possono stare a cavallo di due container
+        step = per_container * 48 + 7
+        for pos in range(0, len(stream), step):
+            chunk = stream[pos:pos + step]
+            comp = zlib.compress(bytes(chunk), 6)
+            size = BLF_OBJ_BASE.size + BLF_CONTAINER.size + len(comp)
+            f.write(BLF_OBJ_BASE.pack(b"LOBJ", 16, 1, size, BLF_LOG_CONTAINER))
+            f.write(BLF_CONTAINER.pack(2, len(chunk)) + comp + b"\0" * (size % 4))
+
+
+def _write_pcapng(path: str, frames: List[Frame], start_us: int):
+    from .wireshark import PcapngWriter
+    with PcapngWriter(path, start_us) as w:
+        for fr in frames:
+            w.write(fr.timestamp_us - start_us, fr.can_id, fr.data, fr.extended, fr.tx)
+
+
+def bench(tmp_dir: str) -> bool:
+    """Carica simulata + traffico esterno in ogni formato: i frame EVO importati devono coincidere"""
+    import random
+    from .charge_sim import ChargeSimulation
+
+    start_us = 1_717_000_000 * 1_000_000
+    rnd = random.Random(7)
+    frames: List[Frame] = []
+    for tick in ChargeSimulation().ticks():
+        for sf in tick:
+            frames.append(Frame(start_us + sf.t_ms * 1000, sf.can_id, sf.extended, sf.direction == "Tx",
+                                bytes(sf.data)))
+        # Altri nodi sul bus dell'auto (celle BMS, inverter): non EVO, filtrati
+        t = start_us + tick[0].t_ms * 1000 + 500
+        frames.append(Frame(t, 0x18FF0000 | rnd.randrange(256), True, False, bytes(rnd.randrange(256) for _ in range(8))))
+        frames.append(Frame(t + 1, 0x0A0 + rnd.randrange(16), False, False, bytes(rnd.randrange(256) for _ in range(4))))
+    expected = [fr for fr in frames if (fr.can_id | (EXTENDED_FLAG if fr.extended else 0)) in EVO.keys]
+
+    writers = {
+        "candump": lambda p: _write_candump(p, frames),
+        "asc": lambda p: _write_asc(p, frames, start_us),
+        "blf": lambda p: _write_blf(p, frames, start_us),
+        "pcapng": lambda p: _write_pcapng(p, frames, start_us),
+    }
+    ok = True
+    print(f"{len(frames)} frames, {len(expected)} EVO")
+    for fmt, write in writers.items():
+        path = os.path.join(tmp_dir, f"bench.{fmt}")
+        write(path)
+        if detect(path) != fmt:
+            print(f"  {fmt}: detected as {detect(path)}")
+            ok = False
+        out = os.path.join(tmp_dir, f"{fmt}.evlog")
+        stats = import_log(path, out)
+        rec = Recording(out)
+        got = [fr._replace(timestamp_us=fr.timestamp_us + rec.start_unix_us) for fr in rec]
+        match = got == expected
+        ok &= match
+        print(f"  {fmt:<8} {stats.bytes_in / 1e6:7.2f} MB  {stats.frames:6d} frames  {stats.seconds:5.2f} s  "
+              f"{stats.bytes_in / 1e6 / stats.seconds:6.1f} MB/s  "
+              f"{len(frames) / stats.seconds / 1e6:5.2f} Mframe/s  {'OK' if match else 'MISMATCH'}")
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Import candump/ASC/BLF/pcap(ng) logs into .evlog")
+    parser.add_argument("files", nargs="*")
+    parser.add_argument("--format", choices=sorted(READERS), help="skip detection")
+    parser.add_argument("--all", action="store_true", help="keep non-EVO IDs too")
+    parser.add_argument("-o", "--output", help="output .evlog (single input)")
+    parser.add_argument("--decode", action="store_true", help="decode only: frames per message")
+    parser.add_argument("--bench", action="store_true", help="synthetic logs of every format")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        import tempfile
+        with tempfile.TemporaryDirectory() as tmp:
+            return 0 if bench(tmp) else 1
+    if not args.files:
+        parser.error("no input files")
+
+    for path in args.files:
+        try:
+            if args.decode:
+                counts: Dict[str, int] = {}
+                names = {v: k[7:] for k, v in vars(CANDecoder).items() if k.startswith("CAN_ID_")}
+                for _t, base_id, _ch, _packet in decode_log(path, args.format):
+                    name = names.get(base_id, hex(base_id))
+                    counts[name] = counts.get(name, 0) + 1
+                print(f"{path}: " + ", ".join(f"{k} {v}" for k, v in sorted(counts.items())))
+                continue
+            out = args.output or os.path.splitext(path)[0] + ".evlog"
+            s = import_log(path, out, args.format, not args.all)
+        except (OSError, ValueError) as e:
+            print(f"{path}: {e}")
+            return 1
+        print(f"{out}: {s.frames} frames from {s.fmt} ({s.bytes_in / 1e6:.1f} MB, "
+              f"{s.bytes_in / 1e6 / max(s.seconds, 1e-9):.0f} MB/s)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,337 @@
+"""Macchina a stati del ciclo di carica con tempi delle fasi (un charger)
+
+    python -m charger_gui.lifecycle                          # carica simulata (charge_sim)
+    python -m charger_gui.lifecycle --ambient 45 --soc 0.2
+    python -m charger_gui.lifecycle session.evlog frames.log # registrazioni / log del gateway
+
+Aggiornata in modo incrementale a ogni frame decodificato (feed()); si
+tengono solo i flag dell'ultimo TST1/STAT, l'ultimo ACT1 e i setpoint del
+BMS (CTL).
+
+Fasi (manuale, flag TST1: ACok -> PrCompl -> PwrOk -> VoutOk):
+    IDLE          rete AC assente (TST1 ack = 0)
+    AC_CONNECTED  AC presente, non in precarica e senza potenza in uscita: i
+                  primi PRECHARGE_DELAY_S dopo ACok, poi "pronto" in attesa del BMS
+    PRECHARGE     ACok, precarica non completata
+    RAMPING       uscita accesa, corrente in salita verso il setpoint CTL
+    CC            corrente di setpoint raggiunta (corrente costante)
+    CV            tensione di uscita al limite di tensione CTL (tensione costante)
+    DERATED       uscita accesa con STAT lim_temp / warn_limit
+    FAULTED       STAT error_latch, AC presente
+    STOPPED       uscita di nuovo spenta dopo aver caricato, AC ancora presente
+
+Una sessione inizia quando ACok sale e finisce quando scende (o a close()).
+"""
+
+import sys
+from dataclasses import dataclass, field
+from enum import Enum
+from typing import Dict, Iterable, List, Optional, Tuple
+
+from .can_decoder import CANDecoder
+
+C = CANDecoder
+
+
+class Phase(Enum):
+    IDLE = "Idle"
+    AC_CONNECTED = "AC connected"
+    PRECHARGE = "Precharge"
+    RAMPING = "Ramping"
+    CC = "CC"
+    CV = "CV"
+    DERATED = "Derated"
+    FAULTED = "Faulted"
+    STOPPED = "Stopped"
+
+
+PRECHARGE_DELAY_S = 0.3         # ACok diventa vero ~300 ms prima dell'inizio della precarica
+RAMP_DONE_RATIO = 0.95          # Rampa finita al 95% del setpoint di corrente CTL
+RAMP_STEADY_RATIO = 0.01        # ... o, senza CTL, quando iout smette di salire (1%/frame)
+CV_BAND_V = 1.0                 # vout così vicina al limite di tensione CTL = CV
+
+_POWER_PHASES = (Phase.RAMPING, Phase.CC, Phase.CV, Phase.DERATED)
+
+
+@dataclass
+class PhaseChange:
+    t: float
+    old: Phase
+    new: Phase
+
+
+@dataclass
+class Session:
+    """Tempi delle fasi di una connessione AC [s]"""
+    start: float
+    end: Optional[float] = None
+    durations: Dict[Phase, float] = field(default_factory=dict)
+    entries: Dict[Phase, int] = field(default_factory=dict)
+    precharge_done: Optional[float] = None      # Primo PrCompl (None: già a 1 all'apertura)
+    power_on: Optional[float] = None            # Primo PwrOk + VoutOk (None: già in potenza)
+    full_power: Optional[float] = None          # Primo CC/CV (fine della prima rampa)
+    fault: Optional[float] = None               # Primo error_latch
+
+    def _since_start(self, t: Optional[float]) -> Optional[float]:
+        return None if t is None else t - self.start
+
+    @property
+    def precharge_s(self) -> Optional[float]:
+        """AC collegata -> precarica completata"""
+        return self._since_start(self.precharge_done)
+
+    @property
+    def time_to_power_s(self) -> Optional[float]:
+        """AC collegata -> uscita accesa"""
+        return self._since_start(self.power_on)
+
+    @property
+    def time_to_full_power_s(self) -> Optional[float]:
+        """AC collegata -> CC/CV raggiunto"""
+        return self._since_start(self.full_power)
+
+    @property
+    def ramp_s(self) -> Optional[float]:
+        if self.power_on is None or self.full_power is None:
+            return None
+        return self.full_power - self.power_on
+
+    @property
+    def duration_s(self) -> Optional[float]:
+        return self._since_start(self.end)
+
+
+class LifecycleTracker:
+    """Tracciamento incrementale delle fasi: feed() a ogni frame decodificato di un charger"""
+
+    def __init__(self):
+        self.phase = Phase.IDLE
+        self.phase_start: Optional[float] = None
+        self.sessions: List[Session] = []
+        self.session: Optional[Session] = None
+        # Ultimi ingressi
+        self.ack = self.pr_compl = self.pwr_ok = self.vout_ok = False
+        self.power_enable = self.error_latch = self.limited = False
+        self.iout_A = self.vout_V = 0.0
+        self.iout_set_A: Optional[float] = None
+        self.vout_set_V: Optional[float] = None
+        self._ack_since = 0.0
+        self._prev_iout = 0.0
+        self._ramp_done = False
+        self._cv = False
+        self._charged = False
+        # Flag visti a 0 nella sessione: solo allora i tempi di precarica/potenza sono misurati
+        self._pr_off_seen = False
+        self._power_off_seen = False
+
+    # ------------------------------------------------------------------
+    # Ingressi
+    # ------------------------------------------------------------------
+
+    def feed(self, base_id: int, packet, t: float) -> Optional[PhaseChange]:
+        """Aggiorna con un frame decodificato (t in secondi); restituisce il cambio di fase, se c'è"""
+        if base_id == C.CAN_ID_TST1:
+            if packet.ack and not self.ack:
+                self._ack_since = t
+            elif self.ack and not packet.ack:
+                self.error_latch = False    # Il ciclo AC resetta il charger: si attende un nuovo STAT
+            self.ack, self.pr_compl = packet.ack, packet.pr_compl
+            self.pwr_ok, self.vout_ok = packet.pwr_ok, packet.vout_ok
+        elif base_id == C.CAN_ID_STAT:
+            self.power_enable, self.error_latch = packet.power_enable, packet.error_latch
+            self.limited = packet.lim_temp or packet.warn_limit
+        elif base_id == C.CAN_ID_ACT1:
+            self._prev_iout = self.iout_A
+            self.iout_A, self.vout_V = packet.iout_A, packet.vout_V
+        elif base_id == C.CAN_ID_CTL:
+            self.iout_set_A, self.vout_set_V = packet.iout_max_A, packet.vout_max_V
+            return None             # I setpoint spostano solo le soglie
+        else:
+            return None
+        if not self.pr_compl:
+            self._pr_off_seen = True
+        if not self._powered():
+            self._power_off_seen = True
+        change = self._set(self._evaluate(t, base_id), t)
+        s = self.session
+        if s is not None and s.precharge_done is None and self.pr_compl and self._pr_off_seen:
+            s.precharge_done = t
+        return change
+
+    def settled(self) -> bool:
+        """True se un frame uguale al precedente del suo ID non può cambiare nulla
+
+        Solo il ritardo di precarica (tempo da ACok) e la fine della rampa
+        (iout rispetto all'ACT1 precedente) dipendono dai frame ripetuti.
+        """
+        if not self.ack or self.error_latch:
+            return True
+        if not self.pr_compl:
+            return self.phase == Phase.PRECHARGE
+        return not self._powered() or self._ramp_done
+
+    def feed_all(self, frames: Iterable[Tuple[int, object, float]]) -> List[PhaseChange]:
+        changes = []
+        for base_id, packet, t in frames:
+            change = self.feed(base_id, packet, t)
+            if change:
+                changes.append(change)
+        return changes
+
+    def close(self, t: float):
+        """Fine dei dati: chiude la fase e la sessione aperte"""
+        self._set(Phase.IDLE, t)
+
+    # ------------------------------------------------------------------
+    # Transizioni
+    # ------------------------------------------------------------------
+
+    def _evaluate(self, t: float, base_id: int) -> Phase:
+        # La perdita dell'AC chiude la sessione anche se l'ultimo STAT aveva ancora il latch
+        if not self.ack:
+            return Phase.IDLE
+        if self.error_latch:
+            return Phase.FAULTED
+        if not self.pr_compl:
+            if t - self._ack_since < PRECHARGE_DELAY_S:
+                return Phase.AC_CONNECTED
+            return Phase.PRECHARGE
+        if not self._powered():
+            self._ramp_done = self._cv = False
+            return Phase.STOPPED if self._charged else Phase.AC_CONNECTED
+
+        self._charged = True
+        if not self._ramp_done and base_id == C.CAN_ID_ACT1:
+            self._ramp_done = self._ramp_complete()
+        if self.vout_set_V is not None and self.vout_V >= self.vout_set_V - CV_BAND_V:
+            self._cv = self._ramp_done = True
+        if self.limited:
+            return Phase.DERATED
+        if not self._ramp_done:
+            return Phase.RAMPING
+        return Phase.CV if self._cv else Phase.CC
+
+    def _powered(self) -> bool:
+        return self.power_enable and self.pwr_ok and self.vout_ok
+
+    def _ramp_complete(self) -> bool:
+        if self.iout_A <= 0.0:
+            return False
+        if self.iout_set_A:
+            return self.iout_A >= RAMP_DONE_RATIO * self.iout_set_A
+        return self.iout_A - self._prev_iout <= RAMP_STEADY_RATIO * self.iout_A
+
+    def _set(self, phase: Phase, t: float) -> Optional[PhaseChange]:
+        if self.phase_start is None:
+            self.phase_start = t
+        if phase == self.phase:
+            return None
+
+        old = self.phase
+        s = self.session
+        if s is not None:
+            s.durations[old] = s.durations.get(old, 0.0) + (t - self.phase_start)
+        if phase == Phase.IDLE and s is not None:
+            s.end = t
+            self.session = s = None
+            self._charged = False
+        elif s is None and phase != Phase.IDLE:
+            self.session = s = Session(start=t)
+            self.sessions.append(s)
+            # Dati iniziati a carica già avviata: nessun tempo di precarica/accensione
+            self._pr_off_seen = not self.pr_compl
+            self._power_off_seen = not self._powered()
+
+        if s is not None:
+            s.entries[phase] = s.entries.get(phase, 0) + 1
+            if s.power_on is None and phase in _POWER_PHASES and self._power_off_seen:
+                s.power_on = t
+            if s.full_power is None and s.power_on is not None and phase in (Phase.CC, Phase.CV):
+                s.full_power = t
+            if s.fault is None and phase == Phase.FAULTED:
+                s.fault = t
+
+        self.phase = phase
+        self.phase_start = t
+        return PhaseChange(t, old, phase)
+
+    def phase_time(self, now: float) -> float:
+        """Secondi trascorsi nella fase corrente"""
+        return 0.0 if self.phase_start is None else now - self.phase_start
+
+
+# ============================================================================
+# Report
+# ============================================================================
+
+def _fmt_s(value: Optional[float]) -> str:
+    return "-" if value is None else f"{value:.1f} s"
+
+
+def format_session(n: int, s: Session) -> List[str]:
+    lines = [f"Session {n}: {_fmt_s(s.duration_s)}  precharge {_fmt_s(s.precharge_s)}  "
+             f"to power {_fmt_s(s.time_to_power_s)}  to full power {_fmt_s(s.time_to_full_power_s)}  "
+             f"ramp {_fmt_s(s.ramp_s)}"]
+    for phase in Phase:
+        if phase in s.durations:
+            lines.append(f"  {phase.value:<13} {s.durations[phase]:9.1f} s  ({s.entries.get(phase, 0)}x)")
+    return lines
+
+
+def _decoded(messages) -> Iterable[Tuple[int, object, float]]:
+    """(base_id, packet, t) del charger 1 da (can_id, extended, data, t)"""
+    for can_id, extended, data, t in messages:
+        decoded = CANDecoder.decode_bus_message(can_id, extended, data)
+        if decoded is not None and decoded[1] == 1 and decoded[2] is not None:
+            yield decoded[0], decoded[2], t
+
+
+def _read_file(path: str):
+    if path.endswith(".evlog"):
+        from .recording import Recording
+        for f in Recording(path):
+            yield f.can_id, f.extended, list(f.data), f.timestamp_us / 1e6
+        return
+    from .serial_protocol import parse_line
+    with open(path) as fh:
+        for line in fh:
+            t, _, rest = line.partition(" ")
+            msg = parse_line(rest, float(t))
+            if msg is not None:
+                yield msg.can_id, msg.extended, msg.data, msg.timestamp
+
+
+def _simulated(ambient_C: float, soc: float):
+    from .charge_sim import ChargeSimulation
+    for frames in ChargeSimulation(ambient_C=ambient_C, soc=soc).ticks():
+        for f in frames:
+            yield f.can_id, f.extended, f.data, f.t_ms / 1000.0
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Charge phases and timing from CAN frames")
+    parser.add_argument("files", nargs="*", help=".evlog recordings or gateway logs (\"t line\")")
+    parser.add_argument("--ambient", type=float, default=25.0, help="simulated charge: ambient [C]")
+    parser.add_argument("--soc", type=float, default=0.0, help="simulated charge: start SOC [0-1]")
+    parser.add_argument("-v", "--verbose", action="store_true", help="print every phase change")
+    args = parser.parse_args(argv)
+
+    sources = [(p, _read_file(p)) for p in args.files] or \
+              [(f"charge_sim ambient {args.ambient} C SOC {args.soc}", _simulated(args.ambient, args.soc))]
+    for label, messages in sources:
+        tracker = LifecycleTracker()
+        t = 0.0
+        for base_id, packet, t in _decoded(messages):
+            change = tracker.feed(base_id, packet, t)
+            if change and args.verbose:
+                print(f"  {change.t:9.1f} s  {change.old.value} -> {change.new.value}")
+        tracker.close(t)
+        print(label)
+        for n, s in enumerate(tracker.sessions, start=1):
+            print("\n".join(format_session(n, s)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
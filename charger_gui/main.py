@@ -1,18 +1,27 @@
 #!/usr/bin/env python3
 
-import sys, os
+import sys, os, time
 
 import serial
 from PyQt6.QtWidgets import (QApplication, QMainWindow, QTabWidget, QWidget,
                               QVBoxLayout, QHBoxLayout, QPushButton, QComboBox,
                               QLabel, QStatusBar, QMenuBar, QMenu, QMessageBox,
                               QDialog, QDialogButtonBox, QFormLayout, QSpinBox,
-                              QCheckBox, QDoubleSpinBox)
-from PyQt6.QtCore import Qt, pyqtSlot
+                              QCheckBox, QDoubleSpinBox, QTableWidget,
+                              QTableWidgetItem, QGroupBox, QHeaderView, QFileDialog,
+                              QLineEdit, QInputDialog)
+from PyQt6.QtCore import Qt, pyqtSlot, QTimer
 from PyQt6.QtGui import QAction, QIcon
 from .tabs import Level1Tab, Level2Tab, Level3Tab, Level4Tab
 from .serial_handler import SerialHandler, SerialMessage, list_serial_ports
-from .can_decoder import CANDecoder
+from .can_decoder import CANDecoder, BaudrateType
+from .bus_load import BITRATES, BusLoadEstimator, TrafficPlanner
+from .lifecycle import LifecycleTracker, format_session
+from .charge_predictor import ChargePredictor, PIT_WINDOW_S, format_plan, format_prediction
+from .fault_poller import FaultPoller, DEFAULT_INTERVAL_S
+from .recording import LiveRecorder
+from .frame_filter import compile_filter, FilterError
+from .web_dashboard import DashboardServer, DEFAULT_HOST, DEFAULT_PORT
 
 
 class ControlDialog(QDialog):
@@ -74,6 +83,164 @@ class ControlDialog(QDialog):
         }
 
 
+class RecordDialog(QDialog):
+    """Dialog per filtro e trigger della registrazione (espressioni frame_filter)"""
+    
+    def __init__(self, path: str, parent=None):
+        super().__init__(parent)
+        self.setWindowTitle("Record CAN traffic")
+        self.keep = None
+        self.trigger = None
+        self.setup_ui(path)
+    
+    def setup_ui(self, path: str):
+        layout = QFormLayout()
+        layout.addRow("File:", QLabel(os.path.basename(path)))
+        
+        self.filter_edit = QLineEdit()
+        self.filter_edit.setPlaceholderText("all frames   (e.g. act1 && vout > 400)")
+        layout.addRow("Filter:", self.filter_edit)
+        
+        self.trigger_edit = QLineEdit()
+        self.trigger_edit.setPlaceholderText("start now   (e.g. stat.error_latch)")
+        layout.addRow("Start trigger:", self.trigger_edit)
+        
+        self.error_label = QLabel("")
+        self.error_label.setStyleSheet("color: #f44336;")
+        layout.addRow(self.error_label)
+        
+        buttons = QDialogButtonBox(
+            QDialogButtonBox.StandardButton.Ok | 
+            QDialogButtonBox.StandardButton.Cancel
+        )
+        buttons.accepted.connect(self.accept)
+        buttons.rejected.connect(self.reject)
+        
+        layout.addRow(buttons)
+        self.setLayout(layout)
+    
+    def accept(self):
+        # Compilate qui una volta: il thread seriale le valuta soltanto
+        try:
+            self.keep = compile_filter(self.filter_edit.text())
+            self.trigger = compile_filter(self.trigger_edit.text())
+        except FilterError as e:
+            self.error_label.setText(str(e))
+            return
+        super().accept()
+
+
+class BusLoadDialog(QDialog):
+    """Utilizzo del bus (live) e planner what-if alle 4 velocità di TST2"""
+
+    RATES = [BaudrateType.BAUDRATE_125KBIT, BaudrateType.BAUDRATE_250KBIT,
+             BaudrateType.BAUDRATE_500KBIT, BaudrateType.BAUDRATE_1MBIT]
+    RATE_LABELS = ["125k", "250k", "500k", "1M"]
+
+    def __init__(self, estimator: BusLoadEstimator, parent=None):
+        super().__init__(parent)
+        self.setWindowTitle("CAN Bus Load")
+        self.resize(760, 620)
+        self.estimator = estimator
+        self.planner = TrafficPlanner(estimator=estimator)
+        self.setup_ui()
+
+        self.timer = QTimer(self)
+        self.timer.timeout.connect(self.refresh_live)
+        self.timer.start(1000)
+        self.refresh_live()
+        self.refresh_plan()
+
+    def setup_ui(self):
+        layout = QVBoxLayout()
+
+        # Live
+        live_group = QGroupBox(f"Live ({self.estimator.window_s:.0f} s window)")
+        live_layout = QVBoxLayout()
+        self.live_table = QTableWidget(0, 4 + len(self.RATES))
+        self.live_table.setHorizontalHeaderLabels(
+            ["ID", "Message", "Frames/s", "Bits/frame"] + [f"% @{r}" for r in self.RATE_LABELS])
+        self.live_table.horizontalHeader().setSectionResizeMode(QHeaderView.ResizeMode.Stretch)
+        live_layout.addWidget(self.live_table)
+        self.live_total_label = QLabel()
+        live_layout.addWidget(self.live_total_label)
+        live_group.setLayout(live_layout)
+        layout.addWidget(live_group)
+
+        # Planner what-if
+        plan_group = QGroupBox("What-if planner")
+        plan_layout = QVBoxLayout()
+        self.plan_table = QTableWidget(len(self.planner.plan), 4 + len(self.RATES))
+        self.plan_table.setHorizontalHeaderLabels(
+            ["Message", "Enabled", "Period (ms)", "Bits/frame"] + [f"% @{r}" for r in self.RATE_LABELS])
+        self.plan_table.horizontalHeader().setSectionResizeMode(QHeaderView.ResizeMode.Stretch)
+        for row, m in enumerate(self.planner.plan):
+            self.plan_table.setItem(row, 0, QTableWidgetItem(f"{m.name} (0x{m.can_id:03X})"))
+
+            enable_cb = QCheckBox()
+            enable_cb.setChecked(m.enabled)
+            enable_cb.toggled.connect(lambda checked, name=m.name: self.on_plan_enabled(name, checked))
+            self.plan_table.setCellWidget(row, 1, enable_cb)
+
+            period_spin = QSpinBox()
+            period_spin.setRange(1, 10000)
+            period_spin.setValue(int(m.period_ms))
+            period_spin.valueChanged.connect(lambda value, name=m.name: self.on_plan_period(name, value))
+            self.plan_table.setCellWidget(row, 2, period_spin)
+        plan_layout.addWidget(self.plan_table)
+        self.plan_total_label = QLabel()
+        plan_layout.addWidget(self.plan_total_label)
+        plan_group.setLayout(plan_layout)
+        layout.addWidget(plan_group)
+
+        buttons = QDialogButtonBox(QDialogButtonBox.StandardButton.Close)
+        buttons.rejected.connect(self.reject)
+        layout.addWidget(buttons)
+        self.setLayout(layout)
+
+    @staticmethod
+    def _format_totals(values):
+        return "Total: " + "   ".join(
+            f"{label}: {100 * v:.1f}%" for label, v in zip(BusLoadDialog.RATE_LABELS, values))
+
+    def refresh_live(self):
+        loads = self.estimator.per_id(time.monotonic())
+        window = self.estimator.window_s
+        self.live_table.setRowCount(len(loads))
+        for row, load in enumerate(loads):
+            id_str = f"0x{load.can_id:08X}" if load.extended else f"0x{load.can_id:03X}"
+            decoded = CANDecoder.id_map.resolve(load.can_id, load.extended)
+            name = CANDecoder.get_message_name(decoded[0]) if decoded else "-"
+            cells = [id_str, name, f"{load.rate_hz:.1f}", f"{load.bits / load.frames:.1f}"]
+            cells += [f"{100 * load.utilisation(BITRATES[r], window):.2f}" for r in self.RATES]
+            for col, text in enumerate(cells):
+                self.live_table.setItem(row, col, QTableWidgetItem(text))
+
+        self.live_total_label.setText(self._format_totals(
+            [self.estimator.utilisation(BITRATES[r]) for r in self.RATES]))
+
+        # Le lunghezze del planner usano gli ultimi payload ricevuti
+        self.refresh_plan()
+
+    def refresh_plan(self):
+        for row, (m, bps) in enumerate(self.planner.bits_per_second()):
+            cells = [str(self.planner.message_bits(m))]
+            cells += [f"{100 * bps / BITRATES[r]:.2f}" for r in self.RATES]
+            for col, text in enumerate(cells, start=3):
+                self.plan_table.setItem(row, col, QTableWidgetItem(text))
+
+        totals = self.planner.utilisation()
+        self.plan_total_label.setText(self._format_totals([totals[r] for r in self.RATES]))
+
+    def on_plan_enabled(self, name: str, enabled: bool):
+        self.planner.set_enabled(name, enabled)
+        self.refresh_plan()
+
+    def on_plan_period(self, name: str, period_ms: int):
+        self.planner.set_period(name, period_ms)
+        self.refresh_plan()
+
+
 class MainWindow(QMainWindow):
     def __init__(self):
         super().__init__()
@@ -85,6 +252,24 @@ class MainWindow(QMainWindow):
         self.serial_handler.message_received.connect(self.on_message_received)
         self.serial_handler.connection_status.connect(self.on_connection_status)
         self.serial_handler.error_occurred.connect(self.on_error)
+        # Stato aggregato scritto dal thread seriale (snapshot senza lock)
+        self.charger_state = self.serial_handler.state
+
+        # Bus load (tutti i frame, prima del filtro per charger)
+        self.bus_load = BusLoadEstimator()
+        self.bus_load_dialog = None
+        self.dashboard = None
+
+        # Fasi di carica del charger mostrato nei tab
+        self.lifecycle = LifecycleTracker()
+        # Tempo a piena carica e piano per la finestra di pit, aggiornati una volta al secondo
+        self.predictor = ChargePredictor()
+
+        # Liste guasti (0x61D/0x61C) richieste periodicamente, alla UI arrivano solo i cambi
+        self.fault_poller = FaultPoller(DEFAULT_INTERVAL_S)
+        self.poll_timer = QTimer(self)
+        self.poll_timer.timeout.connect(self.on_poll_timer)
+        self.poll_timer.start(200)
 
         script_dir = os.path.dirname(os.path.abspath(__file__))
         icon_path = os.path.join(script_dir, "logoGUI.ico")
@@ -118,6 +303,25 @@ class MainWindow(QMainWindow):
         self.baudrate_combo.setCurrentIndex(16)         #imposta 115200 predefinito
         toolbar_layout.addWidget(self.baudrate_combo)
 
+        # Selezione charger: solo quelli con ID nel manuale (13 e 14 non esistono)
+        toolbar_layout.addWidget(QLabel("Charger:"))
+        self.charger_combo = QComboBox()
+        for charger in CANDecoder.id_map.chargers:
+            self.charger_combo.addItem(str(charger), charger)
+        self.charger_combo.setToolTip("Charger shown in the tabs when several chargers share the bus")
+        self.charger_combo.currentIndexChanged.connect(self.on_charger_changed)
+        toolbar_layout.addWidget(self.charger_combo)
+
+        # Intervallo di polling dei guasti (opzionale, 0 = spento: le risposte sono comunque seguite)
+        toolbar_layout.addWidget(QLabel("Fault poll [s]:"))
+        self.fault_poll_spin = QSpinBox()
+        self.fault_poll_spin.setRange(0, 600)
+        self.fault_poll_spin.setSpecialValueText("Off")
+        self.fault_poll_spin.setValue(int(DEFAULT_INTERVAL_S))
+        self.fault_poll_spin.setToolTip("Request active/inactive faults every N seconds (0 = off)")
+        self.fault_poll_spin.valueChanged.connect(self.on_fault_poll_changed)
+        toolbar_layout.addWidget(self.fault_poll_spin)
+
         # Refresh button
         self.refresh_btn = QPushButton("Refresh")
         self.refresh_btn.clicked.connect(self.refresh_ports)
@@ -147,10 +351,31 @@ class MainWindow(QMainWindow):
         self.tab_widget.addTab(self.level4_tab, "Level 4 - Configuration")
 
         main_layout.addWidget(self.tab_widget)
+        self.level2_tab.faults_cleared.connect(self.fault_poller.forget)
+
+        # Tabella di dispatch: ID CAN base -> metodo di aggiornamento del tab
+        self.handlers = {
+            CANDecoder.CAN_ID_CTL: self.level1_tab.update_ctl,
+            CANDecoder.CAN_ID_ACT1: self.level1_tab.update_act1,
+            CANDecoder.CAN_ID_STAT: self.level1_tab.update_stat,
+            CANDecoder.CAN_ID_ACT2: self.level1_tab.update_act2,
+            CANDecoder.CAN_ID_TST1: self.level1_tab.update_tst1,
+            CANDecoder.CAN_ID_SW: self.level2_tab.update_software,
+            CANDecoder.CAN_ID_SN: self.level2_tab.update_serial,
+            CANDecoder.CAN_ID_ACT3: self.level3_tab.update_act3,
+            CANDecoder.CAN_ID_TEMP: self.level3_tab.update_temp,
+            CANDecoder.CAN_ID_STST1: self.level3_tab.update_stst1,
+            CANDecoder.CAN_ID_ACT4: self.level3_tab.update_act4,
+            CANDecoder.CAN_ID_TST2: self.level4_tab.update_tst2,
+        }
 
         # Status Bar
         self.status_bar = QStatusBar()
         self.setStatusBar(self.status_bar)
+        self.phase_label = QLabel(f"Phase: {self.lifecycle.phase.value}")
+        self.status_bar.addPermanentWidget(self.phase_label)
+        self.eta_label = QLabel("Full in: -")
+        self.status_bar.addPermanentWidget(self.eta_label)
         self.status_bar.showMessage("Ready - Not Connected")
 
         # Menu Bar
@@ -163,6 +388,12 @@ class MainWindow(QMainWindow):
         # File menu
         file_menu = menubar.addMenu("File")
 
+        # Registrazione di tutti i frame: .evlog (nativo) o .pcapng (Wireshark)
+        self.record_action = QAction("Record...", self)
+        self.record_action.setCheckable(True)
+        self.record_action.triggered.connect(self.toggle_recording)
+        file_menu.addAction(self.record_action)
+
         exit_action = QAction("Exit", self)
         exit_action.triggered.connect(self.close)
         file_menu.addAction(exit_action)
@@ -174,6 +405,16 @@ class MainWindow(QMainWindow):
         clear_action.triggered.connect(self.clear_all_data)
         tools_menu.addAction(clear_action)
 
+        bus_load_action = QAction("Bus Load...", self)
+        bus_load_action.triggered.connect(self.show_bus_load)
+        tools_menu.addAction(bus_load_action)
+
+        # Dashboard nel browser (tablet del pit), alimentata dallo stato condiviso dei charger
+        self.dashboard_action = QAction("Web dashboard...", self)
+        self.dashboard_action.setCheckable(True)
+        self.dashboard_action.triggered.connect(self.toggle_dashboard)
+        tools_menu.addAction(self.dashboard_action)
+
         # Help menu
         help_menu = menubar.addMenu("Help")
 
@@ -216,45 +457,105 @@ class MainWindow(QMainWindow):
             self.refresh_btn.setEnabled(True)
 
 
-    @pyqtSlot(SerialMessage)
-    def on_message_received(self, msg: SerialMessage):
-        """Handle received CAN message"""
+    @pyqtSlot(SerialMessage, object)
+    def on_message_received(self, msg: SerialMessage, decoded):
+        """Gestisce un messaggio CAN ricevuto
+
+        decoded: (ID base, charger, packet) già decodificato dal thread seriale, None se non EVO
+        """
 
-        decoded = CANDecoder.decode_message(msg.can_id, msg.data)
+        self.bus_load.add_frame(msg.timestamp, msg.can_id, msg.data, msg.extended)
 
         if decoded is None:
             return
+        base_id, charger, packet = decoded
+        if base_id in (CANDecoder.CAN_ID_FLTA, CANDecoder.CAN_ID_FLTP):
+            # Tutti i charger, frame "No Fault" inclusi: la tabella cambia solo su un diff
+            diff = self.fault_poller.on_frame(charger, base_id, packet, msg.extended)
+            if diff:
+                passive = self.fault_poller.known.get((charger, CANDecoder.CAN_ID_FLTP), {})
+                self.level2_tab.apply_fault_diff(diff, passive, msg.can_id, msg.data, msg.extended)
+            return
+        if packet is None or charger != self.current_charger():
+            return
+
+        handler = self.handlers.get(base_id)
+        if handler:
+            handler(packet, msg.can_id, msg.data, msg.extended)
 
-        if msg.can_id == CANDecoder.CAN_ID_CTL:
-            self.level1_tab.update_ctl(decoded,msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_ACT1:
-            self.level1_tab.update_act1(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_STAT:
-            self.level1_tab.update_stat(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_ACT2:
-            self.level1_tab.update_act2(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_TST1:
-            self.level1_tab.update_tst1(decoded, msg.can_id, msg.data)
-        elif msg.can_id in [CANDecoder.CAN_ID_FLTA, CANDecoder.CAN_ID_FLTP]:
-            self.level2_tab.update_fault(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_SW:
-            self.level2_tab.update_software(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_SN:
-            self.level2_tab.update_serial(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_ACT3:
-            self.level3_tab.update_act3(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_TEMP:
-            self.level3_tab.update_temp(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_STST1:
-            self.level3_tab.update_stst1(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_ACT4:
-            self.level3_tab.update_act4(decoded, msg.can_id, msg.data)
-        elif msg.can_id == CANDecoder.CAN_ID_TST2:
-            self.level4_tab.update_tst2(decoded, msg.can_id, msg.data)
+        if self.lifecycle.feed(base_id, packet, msg.timestamp):
+            self.update_phase_label()
+        prediction = self.predictor.feed(base_id, packet, msg.timestamp)
+        if prediction is not None:
+            self.update_eta_label(prediction)
 
         # Aggiorna status bar
-        msg_name = CANDecoder.get_message_name(msg.can_id)
-        self.status_bar.showMessage(f"Last message: {msg_name} ({msg.direction})")
+        msg_name = CANDecoder.get_message_name(base_id)
+        frames = self.charger_state.snapshot(charger).version
+        self.status_bar.showMessage(f"Last message: {msg_name} ({msg.direction}) - Charger {charger} "
+                                    f"({frames} status frames)")
+
+    def toggle_recording(self, checked: bool):
+        """Avvia/ferma la registrazione del traffico in .evlog o .pcapng"""
+        recorder = self.serial_handler.recorder
+        if recorder is not None:
+            self.serial_handler.recorder = None
+            recorder.close()
+            self.record_action.setText("Record...")
+            self.status_bar.showMessage(f"Recording saved: {recorder.path} ({recorder.count} frames)")
+            return
+        path, _ = QFileDialog.getSaveFileName(
+            self, "Record CAN traffic", time.strftime("sessione_%Y%m%d_%H%M%S.evlog"),
+            "EVO recording (*.evlog);;Wireshark pcapng (*.pcapng)")
+        dialog = RecordDialog(path, self) if path else None
+        if dialog is None or dialog.exec() != QDialog.DialogCode.Accepted:
+            self.record_action.setChecked(False)
+            return
+        try:
+            self.serial_handler.recorder = LiveRecorder(path, dialog.keep, dialog.trigger)
+        except OSError as e:
+            self.record_action.setChecked(False)
+            QMessageBox.warning(self, "Recording", str(e))
+            return
+        self.record_action.setText(f"Stop recording ({os.path.basename(path)})")
+
+    def update_phase_label(self):
+        tracker = self.lifecycle
+        self.phase_label.setText(f"Phase: {tracker.phase.value}")
+        sessions = tracker.sessions
+        self.phase_label.setToolTip("\n".join(format_session(len(sessions), sessions[-1]))
+                                    if sessions else "")
+
+    def update_eta_label(self, prediction):
+        if not prediction.charging:
+            self.eta_label.setText("Full in: -")
+            self.eta_label.setToolTip("")
+            return
+        eta = prediction.time_to_full_s
+        self.eta_label.setText(f"Full in: {eta / 60:.0f} min" if eta is not None else "Full in: > 4 h")
+        plan = self.predictor.plan(PIT_WINDOW_S)
+        self.eta_label.setToolTip("\n".join([format_prediction(prediction)] + (format_plan(plan) if plan else [])))
+
+    def on_fault_poll_changed(self, seconds: int):
+        self.fault_poller.interval_s = float(seconds)
+
+    def on_poll_timer(self):
+        if not self.serial_handler.running:
+            return
+        # Charger visti sul bus, almeno quello mostrato
+        chargers = {self.current_charger()}
+        chargers.update(s.charger for s in self.charger_state.states if s.version)
+        for bus_id, extended, data in self.fault_poller.poll(time.monotonic(), sorted(chargers)):
+            self.serial_handler.send_message(SerialMessage(bus_id, data, "Tx", extended=extended).raw)
+
+    def current_charger(self) -> int:
+        return self.charger_combo.currentData()
+
+    def on_charger_changed(self, index: int):
+        self.lifecycle = LifecycleTracker()
+        self.update_phase_label()
+        self.predictor = ChargePredictor()
+        self.eta_label.setText("Full in: -")
 
     @pyqtSlot(bool, str)
     def on_connection_status(self, connected: bool, message: str):
@@ -275,6 +576,36 @@ class MainWindow(QMainWindow):
         QMessageBox.information(self, "Clear Data",
                                 "Data clearing not yet implemented.\nRestart the application to clear all data.")
 
+    def show_bus_load(self):
+        if self.bus_load_dialog is None:
+            self.bus_load_dialog = BusLoadDialog(self.bus_load, self)
+        self.bus_load_dialog.show()
+        self.bus_load_dialog.raise_()
+
+    def toggle_dashboard(self, checked: bool):
+        """Avvia/ferma il server della dashboard HTTP + WebSocket"""
+        if self.dashboard is not None:
+            self.dashboard.stop()
+            self.dashboard = None
+            self.dashboard_action.setText("Web dashboard...")
+            self.status_bar.showMessage("Web dashboard stopped")
+            return
+        hosts = [f"{DEFAULT_HOST} (this PC only)", "0.0.0.0 (hotspot / LAN)"]
+        choice, ok = QInputDialog.getItem(self, "Web dashboard", "Listen on:", hosts, 0, False)
+        if not ok:
+            self.dashboard_action.setChecked(False)
+            return
+        server = DashboardServer(self.serial_handler.state, choice.split()[0], DEFAULT_PORT)
+        try:
+            server.start()
+        except OSError as e:
+            self.dashboard_action.setChecked(False)
+            QMessageBox.warning(self, "Web dashboard", str(e))
+            return
+        self.dashboard = server
+        self.dashboard_action.setText(f"Stop web dashboard ({server.url})")
+        self.status_bar.showMessage(f"Web dashboard on {server.url}")
+
     def show_about(self):
         QMessageBox.about(self, "About EVO Charger Monitor/Debug",
                           "<h3>EVO Charger CAN Bus Monitor</h3>"
@@ -293,6 +624,10 @@ class MainWindow(QMainWindow):
         """Handle window close event"""
         if self.serial_handler.running:
             self.serial_handler.stop()
+        if self.serial_handler.recorder is not None:
+            self.serial_handler.recorder.close()
+        if self.dashboard is not None:
+            self.dashboard.stop()
         event.accept()
 
 
@@ -0,0 +1,275 @@
+"""Piramide min/media/max dei segnali di sessione (grafici, confronti, report)
+
+    python -m charger_gui.pyramid sessione.evcol              # livelli e tempi di costruzione
+    python -m charger_gui.pyramid --bench
+
+Il livello 0 ha un bin per ogni BASE_S secondi di sessione (conteggio,
+somma, min, max); ogni livello successivo unisce FACTOR bin del precedente,
+fino a un solo bin. Un grafico di qualsiasi finestra a qualsiasi larghezza
+legge il livello più grossolano che ha ancora almeno un bin per pixel: una
+sessione di due ore sono 7200 bin al livello 0 e poche decine in cima,
+quindi zoom e confronti non toccano più i frame.
+
+Le sessioni si caricano da .evcol (si decodificano solo i gruppi dei
+messaggi richiesti) o da .evlog (un passaggio sui record, payload
+raggruppati per messaggio e decodificati a blocchi).
+"""
+
+import os
+import sys
+import time
+from bisect import bisect_left
+from typing import Dict, Iterable, List, NamedTuple, Optional, Sequence, Tuple
+
+from .can_decoder import CANDecoder
+from .recording import Recording, RECORD_EXTENDED, RECORD_ID_MASK, RECORD_TX
+from .signals import SIGNALS, decode_bulk
+
+C = CANDecoder
+
+BASE_S = 1.0
+FACTOR = 4
+
+# (messaggio, segnale) tenuti per ogni sessione; i bool diventano 0/1 (media = frazione di tempo)
+SESSION_SIGNALS: Tuple[Tuple[int, str], ...] = (
+    (C.CAN_ID_ACT1, "iout_A"), (C.CAN_ID_ACT1, "vout_V"), (C.CAN_ID_ACT1, "iac_A"),
+    (C.CAN_ID_ACT1, "temp_C"), (C.CAN_ID_ACT2, "ac_power_kW"), (C.CAN_ID_ACT2, "temp_loglv_C"),
+    (C.CAN_ID_TEMP, "temp_loghv_C"), (C.CAN_ID_TEMP, "temp_power1_C"),
+    (C.CAN_ID_TEMP, "temp_power2_C"), (C.CAN_ID_TEMP, "temp_power3_C"),
+    (C.CAN_ID_STAT, "lim_temp"), (C.CAN_ID_STAT, "warn_limit"), (C.CAN_ID_STAT, "error_latch"),
+    (C.CAN_ID_CTL, "iout_max_A"), (C.CAN_ID_CTL, "vout_max_V"),
+)
+
+
+class Level(NamedTuple):
+    step_s: float
+    count: List[int]
+    total: List[float]
+    lo: List[float]
+    hi: List[float]
+
+    def mean(self, i: int) -> Optional[float]:
+        n = self.count[i]
+        return self.total[i] / n if n else None
+
+
+class Pyramid:
+    """Bin di un segnale; t in secondi dall'inizio sessione, crescente (ordine dei frame)"""
+
+    def __init__(self, t: Sequence[float], values: Sequence[float], base_s: float = BASE_S,
+                 factor: int = FACTOR):
+        self.base_s = base_s
+        self.factor = factor
+        nbins = int(t[-1] // base_s) + 1 if len(t) else 0
+        count = [0] * nbins
+        total = [0.0] * nbins
+        lo = [float("inf")] * nbins
+        hi = [float("-inf")] * nbins
+        # Una slice di valori per bin (limiti per bisezione): sum/min/max girano in C, non per frame
+        j = 0
+        for i in range(nbins):
+            k = bisect_left(t, (i + 1) * base_s, j) if i < nbins - 1 else len(t)
+            if k > j:
+                seg = values[j:k]
+                count[i] = k - j
+                total[i] = sum(seg)
+                lo[i] = min(seg)
+                hi[i] = max(seg)
+            j = k
+        self.levels: List[Level] = [Level(base_s, count, total, lo, hi)]
+        while len(self.levels[-1].count) > 1:
+            self.levels.append(self._merge(self.levels[-1]))
+
+    def _merge(self, lv: Level) -> Level:
+        f = self.factor
+        n = (len(lv.count) + f - 1) // f
+        count = [sum(lv.count[i * f:i * f + f]) for i in range(n)]
+        total = [sum(lv.total[i * f:i * f + f]) for i in range(n)]
+        lo = [min(lv.lo[i * f:i * f + f]) for i in range(n)]
+        hi = [max(lv.hi[i * f:i * f + f]) for i in range(n)]
+        return Level(lv.step_s * f, count, total, lo, hi)
+
+    def __len__(self) -> int:
+        return len(self.levels[0].count)
+
+    @property
+    def duration_s(self) -> float:
+        return len(self) * self.base_s
+
+    def level_for(self, t0: float, t1: float, points: int) -> Level:
+        """Livello più grossolano con almeno `points` bin in [t0, t1)"""
+        for lv in reversed(self.levels):
+            if (t1 - t0) / lv.step_s >= points:
+                return lv
+        return self.levels[0]
+
+    def window(self, t0: float, t1: float, points: int) -> Tuple[List[float], List[float], List[float], List[float]]:
+        """(t, media, min, max) dei bin non vuoti in [t0, t1), circa `points`"""
+        lv = self.level_for(t0, t1, points)
+        step = lv.step_s
+        i0 = max(0, int(t0 // step))
+        i1 = min(len(lv.count), int(-(-t1 // step)))
+        ts, mean, lo, hi = [], [], [], []
+        for i in range(i0, i1):
+            n = lv.count[i]
+            if n:
+                ts.append((i + 0.5) * step)
+                mean.append(lv.total[i] / n)
+                lo.append(lv.lo[i])
+                hi.append(lv.hi[i])
+        return ts, mean, lo, hi
+
+    def held(self, nbins: Optional[int] = None) -> List[float]:
+        """Medie del livello 0 con i bin vuoti al valore precedente (0 prima del primo)"""
+        lv = self.levels[0]
+        out = []
+        last = 0.0
+        for n, s in zip(lv.count, lv.total):
+            if n:
+                last = s / n
+            out.append(last)
+        if nbins is not None:
+            out = out[:nbins] + [last] * (nbins - len(out))
+        return out
+
+
+# ============================================================================
+# Sessioni
+# ============================================================================
+
+def session_columns(path: str, bases: Iterable[int], charger: int = 1) -> Tuple[int, Dict[int, Dict[str, list]]]:
+    """(inizio unix us, ID base -> colonne decode_bulk + "t") di un charger, .evcol o .evlog"""
+    bases = set(bases)
+    out: Dict[int, Dict[str, list]] = {}
+    if os.path.splitext(path)[1].lower() == ".evcol":
+        from .columnar import ColumnarLog
+        log = ColumnarLog(path)
+        for base in bases:
+            groups = log.find(base, charger)
+            if not groups:
+                continue
+            parts = [log.decode(g) for g in groups]
+            if len(parts) == 1:
+                out[base] = parts[0]
+                continue
+            # Gruppi Rx e Tx (o 11/29 bit) di un messaggio: uniti per tempo
+            rows = sorted((t, p, i) for p, cols in enumerate(parts) for i, t in enumerate(cols["t"]))
+            out[base] = {name: [parts[p][name][i] for _t, p, i in rows] for name in parts[0]}
+        return log.start_unix_us, out
+
+    rec = Recording(path)
+    keys: Dict[int, int] = {}
+    for key in C.id_map.keys():
+        base_charger = C.id_map.resolve(key & RECORD_ID_MASK, bool(key & RECORD_EXTENDED))
+        if base_charger[1] == charger and base_charger[0] in bases:
+            keys[key] = keys[key | RECORD_TX] = base_charger[0]
+    times: Dict[int, List[int]] = {b: [] for b in bases}
+    payloads: Dict[int, bytearray] = {b: bytearray() for b in bases}
+    get = keys.get
+    for ts, key, _dlc, _ch, _res, data in rec.raw():
+        base = get(key)
+        if base is not None:
+            times[base].append(ts)
+            payloads[base] += data
+    for base in bases:
+        if times[base] and base in SIGNALS:
+            cols = decode_bulk(base, bytes(payloads[base]))
+            cols["t"] = [ts / 1e6 for ts in times[base]]
+            out[base] = cols
+    return rec.start_unix_us, out
+
+
+def session_pyramids(path: str, charger: int = 1,
+                     signals: Sequence[Tuple[int, str]] = SESSION_SIGNALS) -> Tuple[int, Dict[str, Pyramid]]:
+    """(inizio unix us, nome segnale -> Pyramid); "power_kW" è vout * iout di ACT1"""
+    start, cols = session_columns(path, {base for base, _name in signals}, charger)
+    out: Dict[str, Pyramid] = {}
+    for base, name in signals:
+        c = cols.get(base)
+        if c is None or not c["t"] or name not in c:
+            continue
+        values = c[name]
+        if isinstance(values[0], bool):
+            values = [1.0 if v else 0.0 for v in values]
+        out[name] = Pyramid(c["t"], values)
+    act1 = cols.get(C.CAN_ID_ACT1)
+    if act1 is not None and act1["t"]:
+        out["power_kW"] = Pyramid(act1["t"], [v * i / 1000.0 for v, i in zip(act1["vout_V"], act1["iout_A"])])
+    return start, out
+
+
+# ============================================================================
+# CLI
+# ============================================================================
+
+def _simulated(tmp_dir: str, name: str, **kwargs) -> str:
+    """Carica simulata come .evcol (argomenti keyword di charge_sim)"""
+    from .charge_sim import ChargeSimulation
+    from .columnar import encode
+    from .recording import RecordingWriter
+    evlog = os.path.join(tmp_dir, name + ".evlog")
+    with RecordingWriter(evlog, 0) as w:
+        for frames in ChargeSimulation(**kwargs).ticks():
+            for f in frames:
+                w.write(f.t_ms * 1000, f.can_id, f.data, f.extended, f.direction == "Tx")
+    evcol = os.path.join(tmp_dir, name + ".evcol")
+    with open(evcol, "wb") as f:
+        f.write(encode(Recording(evlog)))
+    return evcol
+
+
+def bench() -> bool:
+    import random
+    import tempfile
+    with tempfile.TemporaryDirectory() as tmp:
+        path = _simulated(tmp, "sim", ambient_C=35.0)
+        start = time.perf_counter()
+        _start, pyr = session_pyramids(path)
+        build = time.perf_counter() - start
+        evlog = path[:-6] + ".evlog"
+        start = time.perf_counter()
+        session_pyramids(evlog)
+        build_evlog = time.perf_counter() - start
+
+    iout = pyr["iout_A"]
+    rnd = random.Random(1)
+    start = time.perf_counter()
+    for _ in range(200):
+        t0 = rnd.uniform(0, iout.duration_s)
+        t1 = t0 + rnd.uniform(10, iout.duration_s)
+        iout.window(t0, t1, 800)
+    window_ms = (time.perf_counter() - start) / 200 * 1e3
+    # Il livello più alto copre tutta la sessione con gli stessi estremi del livello 0
+    lv0, top = iout.levels[0], iout.levels[-1]
+    ok = (top.hi[0] == max(lv0.hi) and top.lo[0] == min(lv0.lo)
+          and sum(top.count) == sum(lv0.count))
+    print(f"{len(pyr)} signals, {len(iout)} s, {len(iout.levels)} levels")
+    print(f"  build from .evcol {build * 1e3:6.0f} ms, from .evlog {build_evlog * 1e3:6.0f} ms")
+    print(f"  window of 800 points {window_ms:6.2f} ms  {'OK' if ok else 'MISMATCH'}")
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Signal pyramid of a session")
+    parser.add_argument("files", nargs="*")
+    parser.add_argument("--charger", type=int, default=1)
+    parser.add_argument("--bench", action="store_true", help="simulated charge: build and window times")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        return 0 if bench() else 1
+    for path in args.files:
+        start = time.perf_counter()
+        _t0, pyr = session_pyramids(path, args.charger)
+        dt = time.perf_counter() - start
+        print(f"{path}: {len(pyr)} signals in {dt * 1e3:.0f} ms")
+        for name, p in sorted(pyr.items()):
+            lv = p.levels[0]
+            print(f"  {name:<16} {len(p):6d} s  {len(p.levels):2d} levels  "
+                  f"min {min(lv.lo):9.2f}  max {max(lv.hi):9.2f}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
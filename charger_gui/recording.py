@@ -0,0 +1,247 @@
+"""Formato binario nativo di registrazione delle sessioni CAN (.evlog)
+
+Record little endian a dimensione fissa, così un log si può indicizzare,
+tagliare e mappare in memoria senza parsing (struct.iter_unpack in Python,
+mmap in C).
+
+    Header (32 byte)
+        0  char[8]  magic "EVOCANLG"
+        8  u16      versione (1)
+       10  u16      dimensione record (24)
+       12  u32      flag (riservato, 0)
+       16  u64      inizio sessione, tempo unix [us]
+       24  u8[8]    riservato
+
+    Record (24 byte)
+        0  u64      timestamp [us] dall'inizio sessione
+        8  u32      ID CAN | RECORD_EXTENDED (bit 31) | RECORD_TX (bit 30)
+       12  u8       DLC
+       13  u8       canale (0 = gateway seriale)
+       14  u16      riservato
+       16  u8[8]    payload (zeri dopo il DLC)
+"""
+
+import os
+import struct
+import sys
+import threading
+import time
+from array import array
+from typing import BinaryIO, Iterator, List, NamedTuple, Optional, Sequence, Tuple
+
+MAGIC = b"EVOCANLG"
+VERSION = 1
+
+HEADER = struct.Struct('<8sHHIQ8x')
+RECORD = struct.Struct('<QIBBH8s')
+
+RECORD_EXTENDED = 1 << 31
+RECORD_TX = 1 << 30
+RECORD_ID_MASK = 0x1FFFFFFF
+
+KEY_OFFSET = 8
+DLC_OFFSET = 12
+PAYLOAD_OFFSET = 16             # Offset in byte del payload dentro un record
+
+
+class Frame(NamedTuple):
+    timestamp_us: int
+    can_id: int
+    extended: bool
+    tx: bool
+    data: bytes                 # DLC byte di payload
+
+
+class RecordingError(Exception):
+    """File non valido o versione non supportata"""
+
+
+# ============================================================================
+# Writer
+# ============================================================================
+
+class RecordingWriter:
+    """Writer bufferizzato: i record si impacchettano in memoria e si scrivono a blocchi"""
+
+    FLUSH_RECORDS = 4096
+
+    def __init__(self, path: str, start_unix_us: Optional[int] = None):
+        self.path = path
+        self.start_unix_us = int(time.time() * 1e6) if start_unix_us is None else start_unix_us
+        self.count = 0
+        self._file: BinaryIO = open(path, 'wb')
+        self._file.write(HEADER.pack(MAGIC, VERSION, RECORD.size, 0, self.start_unix_us))
+        self._buf = bytearray()
+        self._pending = 0
+
+    def write(self, timestamp_us: int, can_id: int, data: Sequence[int],
+              extended: bool = False, tx: bool = False, channel: int = 0):
+        key = can_id & RECORD_ID_MASK
+        if extended:
+            key |= RECORD_EXTENDED
+        if tx:
+            key |= RECORD_TX
+        self._buf += RECORD.pack(timestamp_us, key, len(data), channel, 0, bytes(data))
+        self.count += 1
+        self._pending += 1
+        if self._pending >= self.FLUSH_RECORDS:
+            self.flush()
+
+    def write_packed(self, records: bytes):
+        """Record già impacchettati con RECORD (import a blocchi)"""
+        self._buf += records
+        n = len(records) // RECORD.size
+        self.count += n
+        self._pending += n
+        if self._pending >= self.FLUSH_RECORDS:
+            self.flush()
+
+    def flush(self):
+        if self._buf:
+            self._file.write(self._buf)
+            self._buf.clear()
+            self._pending = 0
+        self._file.flush()
+
+    def close(self):
+        if self._file.closed:
+            return
+        self.flush()
+        self._file.close()
+
+    def __enter__(self) -> "RecordingWriter":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+# ============================================================================
+# Reader
+# ============================================================================
+
+class Recording:
+    """Registrazione intera caricata in memoria (record tenuti in un solo blocco bytes)"""
+
+    def __init__(self, path: str):
+        with open(path, 'rb') as f:
+            raw = f.read()
+        if len(raw) < HEADER.size:
+            raise RecordingError(f"{path}: file too short")
+        magic, version, record_size, _flags, start = HEADER.unpack_from(raw)
+        if magic != MAGIC:
+            raise RecordingError(f"{path}: not an EVO recording")
+        if version != VERSION or record_size != RECORD.size:
+            raise RecordingError(f"{path}: unsupported version {version} (record {record_size} byte)")
+
+        self.path = path
+        self.start_unix_us = start
+        body = len(raw) - HEADER.size
+        # Un ultimo record troncato (registratore terminato a metà scrittura) viene ignorato
+        self.records = memoryview(raw)[HEADER.size:HEADER.size + body - body % RECORD.size]
+        self._key_bytes: Optional[List[bytes]] = None
+
+    def __len__(self) -> int:
+        return len(self.records) // RECORD.size
+
+    def raw(self) -> Iterator[Tuple[int, int, int, int, int, bytes]]:
+        """(timestamp_us, id|flag, dlc, canale, riservato, payload8) per record, senza copie"""
+        return RECORD.iter_unpack(self.records)
+
+    def __iter__(self) -> Iterator[Frame]:
+        for ts, key, dlc, _ch, _res, data in RECORD.iter_unpack(self.records):
+            yield Frame(ts, key & RECORD_ID_MASK, bool(key & RECORD_EXTENDED),
+                        bool(key & RECORD_TX), data[:dlc])
+
+    def columns(self) -> Tuple[array, array, bytes, array]:
+        """Colonne (timestamp_us, id|flag, dlc, payload) a blocchi; payload come u64 (byte 0 = byte basso)"""
+        q = array('Q')
+        q.frombytes(self.records)
+        w = array('I')
+        w.frombytes(self.records)
+        if sys.byteorder == 'big':
+            q.byteswap()
+            w.byteswap()
+        return q[0::3], w[2::6], bytes(self.records[DLC_OFFSET::RECORD.size]), q[2::3]
+
+    def key_mask(self, key: int) -> bytes:
+        """1 per i record con questo id|flag, 0 altrimenti (per itertools.compress)
+
+        Ognuno dei 4 byte della chiave si confronta con bytes.translate sulla
+        sua colonna a passo fisso e le 4 maschere si mettono in AND come un
+        solo intero: nessun lavoro Python per record.
+        """
+        if self._key_bytes is None:
+            self._key_bytes = [bytes(self.records[KEY_OFFSET + j::RECORD.size]) for j in range(4)]
+        mask = -1
+        for j, col in enumerate(self._key_bytes):
+            table = bytearray(256)
+            table[key >> 8 * j & 0xFF] = 1
+            mask &= int.from_bytes(col.translate(table), 'little')
+        return mask.to_bytes(len(self), 'little')
+
+    def payloads(self) -> bytes:
+        """Tutti i payload concatenati (8 byte per record), per i decoder a blocchi"""
+        out = bytearray(len(self) * 8)
+        for i in range(8):
+            out[i::8] = self.records[PAYLOAD_OFFSET + i::RECORD.size]
+        return bytes(out)
+
+
+def write_frames(path: str, frames: List[Frame], start_unix_us: int = 0) -> int:
+    with RecordingWriter(path, start_unix_us) as w:
+        for fr in frames:
+            w.write(fr.timestamp_us, fr.can_id, fr.data, fr.extended, fr.tx)
+        return w.count
+
+
+def open_writer(path: str, start_unix_us: Optional[int] = None):
+    """RecordingWriter, o PcapngWriter per un percorso .pcapng (stessa write())"""
+    if os.path.splitext(path)[1].lower() == ".pcapng":
+        from .wireshark import PcapngWriter
+        return PcapngWriter(path, start_unix_us)
+    return RecordingWriter(path, start_unix_us)
+
+
+class LiveRecorder:
+    """Frame del thread seriale -> writer, timestamp dal clock monotonic
+    
+    write() impacchetta solo nel buffer del writer (scrittura su disco ogni
+    FLUSH_RECORDS frame); il lock è libero tranne mentre close() gira dal
+    thread della GUI.
+    
+    keep e trigger sono oggetti frame_filter.Filter compilati: si scrivono
+    solo i frame che soddisfano keep, e nulla prima del primo frame che
+    soddisfa trigger (quel frame incluso).
+    """
+
+    def __init__(self, path: str, keep=None, trigger=None):
+        self._mono0 = time.monotonic()
+        self.writer = open_writer(path)
+        self.path = path
+        self.count = 0
+        self.keep = keep
+        self.trigger = trigger
+        self._lock = threading.Lock()
+
+    def write(self, timestamp: float, can_id: int, data: Sequence[int], extended: bool, tx: bool):
+        """timestamp: time.monotonic() del frame (SerialMessage.timestamp)"""
+        t_us = max(0, int((timestamp - self._mono0) * 1e6))
+        if self.trigger is not None or self.keep is not None:
+            payload = bytes(data)
+            if self.trigger is not None:
+                if not self.trigger.match(can_id, extended, tx, payload, t_us):
+                    return
+                self.trigger = None
+            if self.keep is not None and not self.keep.match(can_id, extended, tx, payload, t_us):
+                return
+        with self._lock:
+            if self.writer is not None:
+                self.writer.write(t_us, can_id, data, extended, tx)
+                self.count += 1
+
+    def close(self):
+        with self._lock:
+            if self.writer is not None:
+                self.writer.close()
+                self.writer = None
@@ -1,31 +1,20 @@
-import re
 from typing import Optional, List
 from PyQt6.QtCore import QThread, pyqtSignal
 import serial
 import serial.tools.list_ports
 
-
-class SerialMessage:
-    def __init__(self, can_id: int, data: List[int], direction: str = "RX", raw: str = ""):
-        self.direction = direction  # "RX" o "TX"
-        self.can_id = can_id
-        self.data = data
-        self.raw = raw if raw else self._format_raw()
-    
-    def _format_raw(self):
-        data_hex = ' '.join(f'{b:02X}' for b in self.data)
-        return f"CanBus {self.direction} 0x{self.can_id:03X} {data_hex}"
-    
-    def __repr__(self):
-        data_hex = ' '.join(f'{b:02X}' for b in self.data)
-        return f"CAN {self.direction} ID=0x{self.can_id:03X} Data=[{data_hex}]"
+from .serial_protocol import SerialMessage, LineFramer, parse_line
+from .can_decoder import CANDecoder
+from .charger_state import ChargerStateTable
+from .recording import LiveRecorder
 
 
 class SerialHandler(QThread):
     """Thread to handle serial communication"""
     
     # PyQt Signals
-    message_received = pyqtSignal(SerialMessage)
+    # (messaggio, risultato di decode_bus_message): i frame si decodificano solo qui, la GUI riusa il pacchetto
+    message_received = pyqtSignal(SerialMessage, object)
     connection_status = pyqtSignal(bool, str)  # (connected, message)
     error_occurred = pyqtSignal(str)
     
@@ -35,15 +24,11 @@ class SerialHandler(QThread):
         self.running = False
         self.port_name = ""
         self.baudrate = 115200
-        
-        # Pattern espressione regolare: "CanBus Rx/Tx {ID} {Contenuto}"
-        # Esempi:
-        # "CanBus Rx 0x618 12 34 56 78 9A BC DE F0"
-        # "CanBus Tx 0x610 AA BB CC DD"
-        self.pattern = re.compile(
-            r'CanBus\s+(Rx|Tx)\s+(?:0x)?([0-9A-Fa-f]+)\s+((?:[0-9A-Fa-f]{2}\s*)+)',
-            re.IGNORECASE
-        )
+        self.framer = LineFramer()
+        # Ultimi pacchetti per charger, scritti solo da questo thread (snapshot() da qualsiasi thread)
+        self.state = ChargerStateTable()
+        # Registrazione opzionale di tutti i frame (.evlog o .pcapng), impostata/tolta dalla GUI
+        self.recorder: Optional[LiveRecorder] = None
     
     def set_port(self, port_name: str, baudrate: int = 115200):
         """Set serial port and baudrate"""
@@ -88,29 +73,10 @@ class SerialHandler(QThread):
     def parse_message(self, line: str) -> Optional[SerialMessage]:
         """
         Verify if it's an expected RE
-        Parse a line received from serial
-        
-        Expected format: "CanBus Rx/Tx {ID} {Content}"
-        Examples:
-            "CanBus Rx 0x618 12 34 56 78 9A BC DE F0"
-            "CanBus Tx 610 AA BB CC DD EE FF"
+        Analizza una riga ricevuta dalla seriale (vedi serial_protocol.parse_line)
         """
-        match = self.pattern.match(line.strip())
-        if not match:
-            return None
-        direction = match.group(1)  # "Rx" o "Tx"
-        can_id_str = match.group(2)
-        data_str = match.group(3).strip()
-        
         try:
-            # Convert ID (can be hex or decimal)
-            can_id = int(can_id_str, 16)
-            
-            # Convert data (space separated)
-            data_bytes = [int(b, 16) for b in data_str.split()]
-            
-            return SerialMessage(can_id, data_bytes, direction, line)
-            
+            return parse_line(line)
         except ValueError as e:
             self.error_occurred.emit(f"Errore parsing: {e} - Riga: {line}")
             return None
@@ -118,7 +84,7 @@ class SerialHandler(QThread):
     def run(self):
         """Main thread for serial reading"""
         self.running = True
-        buffer = ""
+        self.framer.reset()
         
         while self.running:
             if not self.serial_port or not self.serial_port.is_open:
@@ -129,18 +95,34 @@ class SerialHandler(QThread):
                 # Read from serial
                 if self.serial_port.in_waiting > 0:         #in buffer
                     data = self.serial_port.read(self.serial_port.in_waiting)
-                    buffer += data.decode('utf-8', errors='ignore')
                     
                     # Process complete lines separated by newline
-                    while '\n' in buffer:
-                        line, buffer = buffer.split('\n', 1)
-                        line = line.strip()
-                        
-                        if line:
-                            # Parse the message
-                            msg = self.parse_message(line)
-                            if msg:
-                                self.message_received.emit(msg)
+                    messages = []
+                    updates = []
+                    recorder = self.recorder
+                    for line in self.framer.feed(data.decode('utf-8', errors='ignore')):
+                        # Parse the message
+                        msg = self.parse_message(line)
+                        if msg:
+                            if recorder is not None:
+                                recorder.write(msg.timestamp, msg.can_id, msg.data, msg.extended,
+                                               msg.direction.upper() == "TX")
+                            # Un frame errato (DLC corto) scarta solo se stesso, non la lettura
+                            try:
+                                decoded = CANDecoder.decode_bus_message(msg.can_id, msg.extended, msg.data)
+                            except ValueError as e:
+                                self.error_occurred.emit(f"Errore decodifica: {e} - Riga: {line}")
+                                decoded = None
+                            messages.append((msg, decoded))
+                            if decoded is not None and decoded[2] is not None:
+                                updates.append((decoded[1], decoded[0], decoded[2], msg.timestamp))
+                    
+                    # Lettura intera pubblicata in un colpo (gli snapshot non vedono mai mezza raffica),
+                    # prima di notificare la GUI
+                    if updates:
+                        self.state.publish(updates)
+                    for msg, decoded in messages:
+                        self.message_received.emit(msg, decoded)
                 
                 self.msleep(10)  # Small pause to avoid CPU overload
                 
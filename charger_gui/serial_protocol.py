@@ -0,0 +1,87 @@
+import re
+import time
+from typing import List, Optional
+
+
+# Pattern espressione regolare: "CanBus Rx/Tx {ID} {Contenuto}"
+# Esempi:
+# "CanBus Rx 0x618 12 34 56 78 9A BC DE F0"
+# "CanBus Tx 0x610 AA BB CC DD"
+LINE_PATTERN = re.compile(
+    r'CanBus\s+(Rx|Tx)\s+(?:0x)?([0-9A-Fa-f]+)\s+((?:[0-9A-Fa-f]{2}\s*)+)',
+    re.IGNORECASE
+)
+
+
+class SerialMessage:
+    def __init__(self, can_id: int, data: List[int], direction: str = "RX", raw: str = "",
+                 extended: bool = False, timestamp: Optional[float] = None):
+        self.direction = direction  # "RX" o "TX"
+        self.can_id = can_id
+        self.extended = extended    # True = ID a 29 bit
+        self.data = data
+        self.timestamp = time.monotonic() if timestamp is None else timestamp   # secondi
+        self.raw = raw if raw else self._format_raw()
+    
+    def _id_str(self):
+        return f"0x{self.can_id:08X}" if self.extended else f"0x{self.can_id:03X}"
+    
+    def _format_raw(self):
+        data_hex = ' '.join(f'{b:02X}' for b in self.data)
+        return f"CanBus {self.direction} {self._id_str()} {data_hex}"
+    
+    def __repr__(self):
+        data_hex = ' '.join(f'{b:02X}' for b in self.data)
+        return f"CAN {self.direction} ID={self._id_str()} Data=[{data_hex}]"
+
+
+def parse_line(line: str, timestamp: Optional[float] = None) -> Optional[SerialMessage]:
+    """
+    Analizza una riga ricevuta dalla seriale (None se non è una riga CAN)
+    
+    Formato atteso: "CanBus Rx/Tx {ID} {Contenuto}"
+    Esempi:
+        "CanBus Rx 0x618 12 34 56 78 9A BC DE F0"
+        "CanBus Tx 610 AA BB CC DD EE FF"
+        "CanBus Rx 0x00000E11 12 34 56 78 9A BC DE F0"   (29 bit, 8 cifre)
+    
+    Solleva ValueError su numeri malformati.
+    """
+    match = LINE_PATTERN.match(line.strip())
+    if not match:
+        return None
+    direction = match.group(1)  # "Rx" o "Tx"
+    can_id_str = match.group(2)
+    data_str = match.group(3).strip()
+    
+    # Converte l'ID (esadecimale o decimale)
+    # Più di 3 cifre (o > 0x7FF) indica un ID esteso a 29 bit
+    can_id = int(can_id_str, 16)
+    extended = len(can_id_str) > 3 or can_id > 0x7FF
+    
+    # Converte i dati (separati da spazi)
+    data_bytes = [int(b, 16) for b in data_str.split()]
+    
+    return SerialMessage(can_id, data_bytes, direction, line, extended, timestamp)
+
+
+class LineFramer:
+    """Divide il flusso di byte seriale in righe, tenendo la coda incompleta
+    
+    Un solo split per lettura invece di uno per riga: il costo resta lineare
+    quando una lettura restituisce migliaia di righe.
+    """
+    
+    def __init__(self):
+        self._tail = ""
+    
+    def feed(self, text: str) -> List[str]:
+        if '\n' not in text:
+            self._tail += text
+            return []
+        lines = (self._tail + text).split('\n')
+        self._tail = lines.pop()
+        return [l.strip() for l in lines if l.strip()]
+    
+    def reset(self):
+        self._tail = ""
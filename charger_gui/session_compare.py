@@ -0,0 +1,292 @@
+"""Confronto di due sessioni di carica (es. prima/dopo una modifica del profilo CTL)
+
+    python -m charger_gui.session_compare prima.evcol dopo.evcol
+    python -m charger_gui.session_compare prima.evcol dopo.evcol --align energy --csv diff.csv
+    python -m charger_gui.session_compare --bench              # due profili simulati
+
+Le due sessioni si leggono con pyramid.session_pyramids (.evcol o .evlog) e
+si tengono sulla griglia di 1 s del livello 0, tagliate alla carica (dal
+primo all'ultimo secondo con iout sopra ACTIVE_A). Le curve vengono poi
+allineate su uno dei tre assi e confrontate punto per punto su una griglia
+comune:
+
+    time     secondi trascorsi dall'inizio della carica
+    energy   kWh erogati (integrale di vout * iout)
+    vout     tensione di uscita (massimo progressivo, l'asse non torna indietro)
+
+e il riepilogo riporta tempo di carica, energia, potenza, massimi di
+temperatura e tempo in derating di entrambe le sessioni con la differenza.
+Il caricamento è l'unico passo proporzionale ai frame; allineare e
+confrontare due sessioni di 2 h lavora su 7200 punti per curva.
+"""
+
+import bisect
+import sys
+import time
+from typing import Dict, List, NamedTuple, Optional, Sequence, Tuple
+
+from .pyramid import BASE_S, session_pyramids
+
+ACTIVE_A = 0.5                          # iout sopra questa soglia = in carica
+ALIGN_MODES = ("time", "energy", "vout")
+AXIS_UNITS = {"time": "s", "energy": "kWh", "vout": "V"}
+GRID_POINTS = 1000                      # Griglia comune per l'allineamento energy/vout
+
+# Curve confrontate se presenti in entrambe le sessioni
+DIFF_CURVES = ("iout_A", "power_kW", "vout_V", "iac_A", "temp_C", "temp_power1_C",
+               "temp_power2_C", "temp_power3_C", "derating")
+
+
+class CurveDiff(NamedTuple):
+    name: str
+    mean_a: float
+    mean_b: float
+    mean_diff: float                    # b - a
+    max_abs_diff: float
+    at: float                           # valore dell'asse con la differenza più grande
+
+
+class Comparison(NamedTuple):
+    align: str
+    grid: List[float]
+    curves: Dict[str, Tuple[List[float], List[float]]]     # nome -> (a, b) sulla griglia
+    diffs: List[CurveDiff]
+
+
+def _interp(xs: Sequence[float], ys: Sequence[float], grid: Sequence[float]) -> List[float]:
+    """Interpolazione lineare su un asse non decrescente (plateau: primo punto), griglia ordinata"""
+    out = []
+    n = len(xs)
+    j = 0
+    for x in grid:
+        while j < n - 1 and xs[j + 1] < x:
+            j += 1
+        if x <= xs[0]:
+            out.append(ys[0])
+        elif j >= n - 1:
+            out.append(ys[-1])
+        else:
+            x0, x1 = xs[j], xs[j + 1]
+            if x1 <= x0:
+                out.append(ys[j + 1])
+            else:
+                w = (x - x0) / (x1 - x0)
+                out.append(ys[j] + (ys[j + 1] - ys[j]) * w)
+    return out
+
+
+def _runs(flags: Sequence[bool]) -> List[Tuple[int, int]]:
+    """(primo, ultimo + 1) di ogni sequenza di True"""
+    runs = []
+    start = None
+    for i, f in enumerate(flags):
+        if f and start is None:
+            start = i
+        elif not f and start is not None:
+            runs.append((start, i))
+            start = None
+    if start is not None:
+        runs.append((start, len(flags)))
+    return runs
+
+
+class SessionCurves:
+    """Una sessione sulla griglia di 1 s, tagliata alla carica"""
+
+    def __init__(self, path: str, charger: int = 1):
+        self.path = path
+        self.start_unix_us, pyr = session_pyramids(path, charger)
+        if "iout_A" not in pyr:
+            raise ValueError(f"{path}: no ACT1 frames for charger {charger}")
+        n = max(len(p) for p in pyr.values())
+        held = {name: p.held(n) for name, p in pyr.items()}
+        active = [i for i, v in enumerate(held["iout_A"]) if v > ACTIVE_A]
+        if not active:
+            raise ValueError(f"{path}: the charger never delivered current")
+        self.first, last = active[0], active[-1] + 1
+        self.curves: Dict[str, List[float]] = {name: v[self.first:last] for name, v in held.items()}
+        size = last - self.first
+        lim = self.curves.get("lim_temp", [0.0] * size)
+        warn = self.curves.get("warn_limit", [0.0] * size)
+        self.curves["derating"] = [1.0 if a > 0 or b > 0 else 0.0 for a, b in zip(lim, warn)]
+        energy = []
+        total = 0.0
+        for p in self.curves["power_kW"]:
+            total += p * BASE_S / 3600.0
+            energy.append(total)
+        self.curves["energy_kWh"] = energy
+
+    def __len__(self) -> int:
+        return len(self.curves["iout_A"])
+
+    def axis(self, align: str) -> List[float]:
+        if align == "time":
+            return [i * BASE_S for i in range(len(self))]
+        if align == "energy":
+            return self.curves["energy_kWh"]
+        if align == "vout":
+            out, top = [], float("-inf")
+            for v in self.curves["vout_V"]:
+                top = max(top, v)
+                out.append(top)
+            return out
+        raise ValueError(f"unknown alignment '{align}' ({', '.join(ALIGN_MODES)})")
+
+    def derating_periods(self) -> List[Tuple[float, float]]:
+        """(inizio, fine) [s dall'inizio della carica]"""
+        return [(a * BASE_S, b * BASE_S) for a, b in _runs([d > 0 for d in self.curves["derating"]])]
+
+    def time_to_energy(self, kwh: float) -> Optional[float]:
+        i = bisect.bisect_left(self.curves["energy_kWh"], kwh)
+        return i * BASE_S if i < len(self) else None
+
+    def summary(self) -> Dict[str, float]:
+        c = self.curves
+        duration = len(self) * BASE_S
+        out = {
+            "charge_time_min": duration / 60.0,
+            "energy_kWh": c["energy_kWh"][-1],
+            "avg_power_kW": c["energy_kWh"][-1] / (duration / 3600.0),
+            "peak_power_kW": max(c["power_kW"]),
+            "max_vout_V": max(c["vout_V"]),
+            "derating_min": sum(c["derating"]) * BASE_S / 60.0,
+            "derating_periods": float(len(self.derating_periods())),
+        }
+        for name in ("temp_C", "temp_power1_C", "temp_power2_C", "temp_power3_C"):
+            if name in c:
+                out["max_" + name] = max(c[name])
+        return out
+
+
+def compare(a: SessionCurves, b: SessionCurves, align: str = "time", points: int = GRID_POINTS) -> Comparison:
+    ax, bx = a.axis(align), b.axis(align)
+    lo, hi = max(ax[0], bx[0]), min(ax[-1], bx[-1])
+    if hi <= lo:
+        raise ValueError(f"the sessions do not overlap on the {align} axis")
+    if align == "time":
+        grid = [x * BASE_S for x in range(int(lo / BASE_S), int(hi / BASE_S) + 1)]
+    else:
+        grid = [lo + (hi - lo) * k / (points - 1) for k in range(points)]
+    curves: Dict[str, Tuple[List[float], List[float]]] = {}
+    diffs: List[CurveDiff] = []
+    for name in DIFF_CURVES:
+        if name not in a.curves or name not in b.curves:
+            continue
+        ya = _interp(ax, a.curves[name], grid)
+        yb = _interp(bx, b.curves[name], grid)
+        curves[name] = (ya, yb)
+        d = [vb - va for va, vb in zip(ya, yb)]
+        k = max(range(len(d)), key=lambda i: abs(d[i]))
+        n = len(d)
+        diffs.append(CurveDiff(name, sum(ya) / n, sum(yb) / n, sum(d) / n, abs(d[k]), grid[k]))
+    return Comparison(align, grid, curves, diffs)
+
+
+def format_summary(a: SessionCurves, b: SessionCurves) -> List[str]:
+    sa, sb = a.summary(), b.summary()
+    lines = [f"{'':<20} {'A':>10} {'B':>10} {'B-A':>10} {'%':>7}"]
+    for key in sa:
+        if key not in sb:
+            continue
+        va, vb = sa[key], sb[key]
+        pct = f"{(vb - va) / va * 100:+6.1f}%" if va else ""
+        lines.append(f"{key:<20} {va:10.2f} {vb:10.2f} {vb - va:+10.2f} {pct:>7}")
+    # Stesso obiettivo di energia per entrambe: l'80% della sessione più piccola
+    target = 0.8 * min(sa["energy_kWh"], sb["energy_kWh"])
+    ta, tb = a.time_to_energy(target), b.time_to_energy(target)
+    if ta is not None and tb is not None:
+        lines.append(f"{f'min to {target:.1f} kWh':<20} {ta / 60:10.2f} {tb / 60:10.2f} {(tb - ta) / 60:+10.2f} "
+                     f"{(tb - ta) / ta * 100 if ta else 0:+6.1f}%")
+    return lines
+
+
+def format_diffs(cmp: Comparison) -> List[str]:
+    unit = AXIS_UNITS[cmp.align]
+    lines = [f"aligned on {cmp.align}: {len(cmp.grid)} points, {cmp.grid[0]:.1f}-{cmp.grid[-1]:.1f} {unit}",
+             f"{'curve':<16} {'mean A':>9} {'mean B':>9} {'mean B-A':>9} {'max |B-A|':>10} {'at':>10}"]
+    for d in cmp.diffs:
+        lines.append(f"{d.name:<16} {d.mean_a:9.2f} {d.mean_b:9.2f} {d.mean_diff:+9.2f} "
+                     f"{d.max_abs_diff:10.2f} {d.at:9.1f} {unit}")
+    return lines
+
+
+def write_csv(cmp: Comparison, path: str):
+    names = list(cmp.curves)
+    with open(path, "w", newline="") as f:
+        f.write(",".join([cmp.align] + [f"{n}_{s}" for n in names for s in ("a", "b")]) + "\n")
+        for i, x in enumerate(cmp.grid):
+            row = [f"{x:.4f}"]
+            for n in names:
+                ya, yb = cmp.curves[n]
+                row += [f"{ya[i]:.4f}", f"{yb[i]:.4f}"]
+            f.write(",".join(row) + "\n")
+
+
+# ============================================================================
+# CLI
+# ============================================================================
+
+def bench() -> bool:
+    """Due cariche simulate a 35 C: CC 24 A contro 30 A"""
+    import tempfile
+    from .charge_sim import ChargeProfile
+    from .pyramid import _simulated
+
+    with tempfile.TemporaryDirectory() as tmp:
+        pa = _simulated(tmp, "a", ambient_C=35.0, profile=ChargeProfile(cc_current_A=24.0))
+        pb = _simulated(tmp, "b", ambient_C=35.0, profile=ChargeProfile(cc_current_A=30.0))
+        start = time.perf_counter()
+        a, b = SessionCurves(pa), SessionCurves(pb)
+        load = time.perf_counter() - start
+    for line in format_summary(a, b):
+        print(line)
+    ok = True
+    print(f"load both {load * 1e3:.0f} ms")
+    for align in ALIGN_MODES:
+        start = time.perf_counter()
+        cmp = compare(a, b, align)
+        dt = time.perf_counter() - start
+        print(f"  align {align:<7} {len(cmp.grid):5d} points  {dt * 1e3:6.1f} ms")
+        # Sessioni identiche devono dare differenza zero su ogni asse
+        same = compare(a, a, align)
+        ok &= all(d.max_abs_diff < 1e-9 for d in same.diffs)
+    print("self comparison " + ("OK" if ok else "NOT ZERO"))
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Compare two charge sessions")
+    parser.add_argument("files", nargs="*", help="session A and session B (.evcol or .evlog)")
+    parser.add_argument("--align", choices=ALIGN_MODES, default="time")
+    parser.add_argument("--charger", type=int, default=1)
+    parser.add_argument("--csv", help="aligned curves of both sessions")
+    parser.add_argument("--bench", action="store_true", help="two simulated CC profiles")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        return 0 if bench() else 1
+    if len(args.files) != 2:
+        parser.error("two sessions required")
+    try:
+        a, b = (SessionCurves(p, args.charger) for p in args.files)
+        cmp = compare(a, b, args.align)
+    except (OSError, ValueError) as e:
+        print(e)
+        return 1
+    print(f"A: {args.files[0]}\nB: {args.files[1]}")
+    for line in format_summary(a, b) + [""] + format_diffs(cmp):
+        print(line)
+    for label, s in (("A", a), ("B", b)):
+        periods = s.derating_periods()
+        if periods:
+            print(f"derating {label}: " + ", ".join(f"{t0 / 60:.1f}-{t1 / 60:.1f} min" for t0, t1 in periods[:8])
+                  + (" ..." if len(periods) > 8 else ""))
+    if args.csv:
+        write_csv(cmp, args.csv)
+        print(f"{args.csv}: {len(cmp.grid)} rows")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
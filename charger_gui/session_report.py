@@ -0,0 +1,433 @@
+"""Report HTML per sessione (un passaggio a blocchi sulle colonne dei record)
+
+    python -m charger_gui.session_report sessione.evlog           # -> sessione.html
+    python -m charger_gui.session_report sessione.evlog -o report.html --charger 2
+    python -m charger_gui.session_report --bench                  # carica simulata di 2 h
+
+La registrazione si legge a colonne (Recording.columns()) e i record di un
+charger si selezionano per ID a blocchi; i segnali di livello 1 si
+estraggono come word grezze per messaggio e si integrano con map/sum a
+livello C (energia DC da ACT1, energia AC da ACT2, tempo in derating da
+STAT), i massimi di temperatura restano word grezze e i frame di guasto si
+decodificano solo quando cambia il payload. Le fasi di carica vengono dallo
+stesso LifecycleTracker della GUI, alimentato con i frame che cambiano
+qualcosa. Le serie dei grafici si riducono con pyramid.Pyramid; la pagina
+HTML è autonoma (SVG inline, niente script).
+"""
+
+import html
+import os
+import struct
+import sys
+import time
+from array import array
+from bisect import bisect_right
+from dataclasses import dataclass, field
+from itertools import chain, compress
+from operator import gt, mul, ne, sub
+from typing import Dict, List, NamedTuple, Optional, Sequence, Tuple
+
+from .can_decoder import CANDecoder
+from .fault_table import fault_info
+from .lifecycle import LifecycleTracker, Phase, Session
+from .pyramid import Pyramid
+from .recording import Recording, RECORD_EXTENDED, RECORD_ID_MASK, RECORD_TX
+from .signals import TEMP_OFFSET, TEMP_SCALE
+
+C = CANDecoder
+
+ACTIVE_A = 0.5                  # iout sopra questa soglia = in carica
+MAX_GAP_S = 2.0                 # I buchi più lunghi tra frame non si integrano
+PLOT_POINTS = 600
+PLOT_WIDTH, PLOT_HEIGHT = 760, 220
+
+# Word di temperatura: (messaggio, byte, nome)
+TEMP_WORDS = (
+    (C.CAN_ID_ACT1, 2, "temp_C"), (C.CAN_ID_ACT2, 0, "temp_loglv_C"),
+    (C.CAN_ID_TEMP, 0, "temp_loghv_C"), (C.CAN_ID_TEMP, 2, "temp_power1_C"),
+    (C.CAN_ID_TEMP, 4, "temp_power2_C"), (C.CAN_ID_TEMP, 6, "temp_power3_C"),
+    (C.CAN_ID_ACT4, 0, "temp_logfan_C"),
+)
+WORD_MESSAGES = {C.CAN_ID_ACT1, C.CAN_ID_ACT2, C.CAN_ID_STAT} | {base for base, _byte, _name in TEMP_WORDS}
+
+
+class _Act1:
+    """Valori ACT1 passati al tracker delle fasi (un'istanza riusata, feed() li copia)"""
+    __slots__ = ("iout_A", "vout_V")
+
+
+class FaultEvent(NamedTuple):
+    t: float                    # Prima comparsa [s dall'inizio sessione]
+    active: bool                # FLTA (True) o FLTP
+    code: int
+    level: str
+    occurrence: int
+    first_time_h: int
+    last_time_h: int
+
+
+@dataclass
+class SessionStats:
+    path: str
+    start_unix_us: int
+    frames: int = 0
+    duration_s: float = 0.0
+    charging_s: float = 0.0
+    energy_dc_kWh: float = 0.0
+    energy_ac_kWh: float = 0.0
+    peak_power_kW: float = 0.0
+    peak_power_t: float = 0.0
+    derating_s: float = 0.0
+    derating_periods: int = 0
+    max_vout_V: float = 0.0
+    max_iout_A: float = 0.0
+    temps: Dict[str, Tuple[float, float]] = field(default_factory=dict)    # nome -> (max C, t)
+    faults: List[FaultEvent] = field(default_factory=list)
+    sessions: List[Session] = field(default_factory=list)
+    plots: Dict[str, Pyramid] = field(default_factory=dict)
+    scan_s: float = 0.0
+
+    @property
+    def avg_power_kW(self) -> float:
+        return self.energy_dc_kWh / (self.charging_s / 3600.0) if self.charging_s else 0.0
+
+    @property
+    def efficiency(self) -> Optional[float]:
+        return self.energy_dc_kWh / self.energy_ac_kWh if self.energy_ac_kWh > 0 else None
+
+
+def _payload_words(payloads: Sequence[int]) -> Tuple[int, ...]:
+    """Word big endian a 16 bit di payload u64, 4 per frame (word k = byte 2k, 2k + 1)"""
+    a = array('Q', payloads)
+    if sys.byteorder == 'big':
+        a.byteswap()
+    return struct.unpack(f'>{len(a) * 4}H', a.tobytes())
+
+
+def _gaps(ts: Sequence[int], max_gap_us: int) -> List[int]:
+    """ts[i + 1] - ts[i], 0 per buchi più lunghi di max_gap_us (non integrati)"""
+    return [d if d <= max_gap_us else 0 for d in map(sub, ts[1:], ts[:-1])]
+
+
+def _changes(idx: List[int], pays: List[int]) -> List[int]:
+    """Record di idx il cui payload (pays, stesso ordine) differisce dal precedente, il primo incluso"""
+    return idx[:1] + list(compress(idx[1:], map(ne, pays[1:], pays[:-1])))
+
+
+def scan(path: str, charger: int = 1) -> SessionStats:
+    """Tutto ciò che serve al report, dalle colonne dei record del charger"""
+    start = time.perf_counter()
+    rec = Recording(path)
+    st = SessionStats(path, rec.start_unix_us)
+    ts_all, keys, dlcs, payloads = rec.columns()
+
+    dispatch: Dict[int, int] = {}
+    for key in C.id_map.keys():
+        base, ch = C.id_map.resolve(key & RECORD_ID_MASK, bool(key & RECORD_EXTENDED))
+        if ch == charger:
+            dispatch[key] = dispatch[key | RECORD_TX] = base
+    ACT1, ACT2, STAT, TST1, CTL = C.CAN_ID_ACT1, C.CAN_ID_ACT2, C.CAN_ID_STAT, C.CAN_ID_TST1, C.CAN_ID_CTL
+    FAULTS = (C.CAN_ID_FLTA, C.CAN_ID_FLTP)
+    max_gap_us = int(MAX_GAP_S * 1e6)
+
+    # Indici dei record per chiave (Recording.key_mask) e per messaggio, nessun lavoro Python per record
+    index = range(len(keys))
+    by_key: Dict[int, List[int]] = {}
+    for key in set(keys.tolist()) & dispatch.keys():
+        by_key[key] = list(compress(index, rec.key_mask(key)))
+    idx: Dict[int, List[int]] = {}
+    for key, sel in by_key.items():
+        base = dispatch[key]
+        idx[base] = sorted(idx[base] + sel) if base in idx else sel     # Rx + Tx di un messaggio
+    times: Dict[int, List[int]] = {}
+    pays: Dict[int, List[int]] = {}
+    words: Dict[int, Tuple[int, ...]] = {}
+    for base, sel in idx.items():
+        times[base] = [ts_all[i] for i in sel]
+        pays[base] = [payloads[i] for i in sel]
+        if base in WORD_MESSAGES:
+            words[base] = _payload_words(pays[base])
+
+    # ACT1: energia DC, tempo di carica, potenza di picco, serie dei grafici (grezzo 0.1 V x 0.1 A = 10 mW)
+    if ACT1 in idx:
+        ts, w = times[ACT1], words[ACT1]
+        vout_raw, iout_raw = w[2::4], w[3::4]
+        power = list(map(mul, vout_raw, iout_raw))
+        gaps = _gaps(ts, max_gap_us)
+        st.energy_dc_kWh = sum(map(mul, power, gaps)) * 1e-5 / 3.6e9
+        st.charging_s = sum(compress(gaps, map(int(ACTIVE_A * 10).__lt__, iout_raw[1:]))) / 1e6
+        peak = max(power)
+        if peak > 0:
+            st.peak_power_kW, st.peak_power_t = peak * 1e-5, ts[power.index(peak)] / 1e6
+        st.max_vout_V = max(vout_raw) * 0.1
+        st.max_iout_A = max(iout_raw) * 0.1
+        t = [x / 1e6 for x in ts]
+        st.plots["power_kW"] = Pyramid(t, [p * 1e-5 for p in power])
+        st.plots["iout_A"] = Pyramid(t, [r * 0.1 for r in iout_raw])
+        st.plots["vout_V"] = Pyramid(t, [r * 0.1 for r in vout_raw])
+    # ACT2: energia AC (0.01 kW)
+    if ACT2 in idx:
+        ts = times[ACT2]
+        st.energy_ac_kWh = sum(map(mul, words[ACT2][1::4], _gaps(ts, max_gap_us))) * 0.01 / 3.6e9
+    # STAT: derating = warn_limit o lim_temp, tempo contato dal frame che lo riporta
+    if STAT in idx:
+        ts = times[STAT]
+        derating = [w >> 8 & 0x28 != 0 for w in words[STAT][0::4]]
+        st.derating_s = sum(compress(_gaps(ts, max_gap_us), derating)) / 1e6
+        st.derating_periods = sum(map(gt, derating, [False] + derating))
+        st.plots["derating"] = Pyramid([x / 1e6 for x in ts], [1.0 if d else 0.0 for d in derating])
+    # Massimi di temperatura (primo istante raggiunto)
+    for base, byte, name in TEMP_WORDS:
+        if base in words:
+            col = words[base][byte // 2::4]
+            raw = max(col)
+            st.temps[name] = (raw * TEMP_SCALE + TEMP_OFFSET, times[base][col.index(raw)] / 1e6)
+
+    # Guasti: decodificati solo quando cambia il payload del loro ID
+    seen_faults: Dict[Tuple[int, int], FaultEvent] = {}
+    fault_keys = [key for key in by_key if dispatch[key] in FAULTS]
+    for i in sorted(chain.from_iterable(_changes(by_key[key], [payloads[i] for i in by_key[key]]) for key in fault_keys)):
+        base = dispatch[keys[i]]
+        p = C.decode_fault(payloads[i].to_bytes(8, 'little')[:dlcs[i]])
+        if p is not None and (base, p.fault_code) not in seen_faults:
+            seen_faults[(base, p.fault_code)] = FaultEvent(
+                ts_all[i] / 1e6, base == C.CAN_ID_FLTA, p.fault_code, p.failure_level.name,
+                p.occurrence, p.first_time_h, p.last_time_h)
+    st.faults = sorted(seen_faults.values())
+
+    # Fasi: il tracker vede i frame che cambiano un payload; tutti i frame solo
+    # finché dipende dal tempo o dall'ACT1 precedente (LifecycleTracker.settled)
+    tracked = (ACT1, TST1, STAT, CTL)
+    streams = [idx[b] for b in tracked if b in idx]
+    changed = sorted(chain.from_iterable(_changes(idx[b], pays[b]) for b in tracked if b in idx))
+    tracker = LifecycleTracker()
+    feed, settled = tracker.feed, tracker.settled
+    decoders = {TST1: C.decode_tst1, STAT: C.decode_stat, CTL: C.decode_ctl}
+    last_packet: Dict[int, Tuple[int, object]] = {}
+    act1 = _Act1()
+    i = -1
+    k = 0
+    while True:
+        if settled():
+            while k < len(changed) and changed[k] <= i:
+                k += 1
+            if k == len(changed):
+                break
+            i = changed[k]
+        else:
+            nxt = [s[j] for s in streams for j in (bisect_right(s, i),) if j < len(s)]
+            if not nxt:
+                break
+            i = min(nxt)
+        base = dispatch[keys[i]]
+        data = payloads[i].to_bytes(8, 'little')
+        if base == ACT1:
+            act1.vout_V = (data[4] << 8 | data[5]) * 0.1
+            act1.iout_A = (data[6] << 8 | data[7]) * 0.1
+            feed(ACT1, act1, ts_all[i] / 1e6)
+            continue
+        cached = last_packet.get(base)
+        if cached is None or cached[0] != payloads[i]:
+            cached = last_packet[base] = (payloads[i], decoders[base](data[:dlcs[i]]))
+        feed(base, cached[1], ts_all[i] / 1e6)
+    end = ts_all[-1] / 1e6 if len(ts_all) else 0.0
+    tracker.close(end)
+    st.sessions = tracker.sessions
+
+    st.frames = sum(map(len, by_key.values()))
+    st.duration_s = end
+    st.scan_s = time.perf_counter() - start
+    return st
+
+
+# ============================================================================
+# HTML
+# ============================================================================
+
+def _svg_plot(series: Sequence[Tuple[str, Pyramid, str]], duration_s: float, unit: str,
+              shade: Optional[Pyramid] = None) -> str:
+    """Linea media + banda min/max per serie; shade = piramide 0/1 disegnata come bande di sfondo"""
+    w, h, left, bottom = PLOT_WIDTH, PLOT_HEIGHT, 48, 22
+    pw, ph = w - left - 8, h - bottom - 8
+    data = [(label, p.window(0.0, duration_s, PLOT_POINTS), color) for label, p, color in series]
+    lo = min((min(d[2]) for _l, d, _c in data if d[0]), default=0.0)
+    hi = max((max(d[3]) for _l, d, _c in data if d[0]), default=1.0)
+    lo = min(lo, 0.0)
+    if hi <= lo:
+        hi = lo + 1.0
+    span = duration_s or 1.0
+
+    def x(t: float) -> float:
+        return left + t / span * pw
+
+    def y(v: float) -> float:
+        return 8 + (hi - v) / (hi - lo) * ph
+
+    out = [f'<svg viewBox="0 0 {w} {h}" width="{w}" height="{h}" xmlns="http://www.w3.org/2000/svg">']
+    if shade is not None:
+        ts, mean, _l, _h = shade.window(0.0, duration_s, PLOT_POINTS)
+        step = shade.level_for(0.0, duration_s, PLOT_POINTS).step_s
+        for t, m in zip(ts, mean):
+            if m > 0:
+                out.append(f'<rect x="{x(t - step / 2):.1f}" y="8" width="{max(step / span * pw, 1):.1f}" '
+                           f'height="{ph}" fill="#f4c7c3"/>')
+    out.append(f'<rect x="{left}" y="8" width="{pw}" height="{ph}" fill="none" stroke="#999"/>')
+    for k in range(5):
+        v = lo + (hi - lo) * k / 4
+        out.append(f'<text x="{left - 4}" y="{y(v) + 4:.1f}" text-anchor="end">{v:.0f}</text>')
+    for k in range(7):
+        t = span * k / 6
+        out.append(f'<text x="{x(t):.1f}" y="{h - 6}" text-anchor="middle">{t / 60:.0f}</text>')
+    out.append(f'<text x="4" y="16">{html.escape(unit)}</text>')
+    for label, (ts, mean, mins, maxs), color in data:
+        if not ts:
+            continue
+        band = " ".join(f"{x(t):.1f},{y(v):.1f}" for t, v in zip(ts, maxs))
+        band += " " + " ".join(f"{x(t):.1f},{y(v):.1f}" for t, v in zip(reversed(ts), reversed(mins)))
+        out.append(f'<polygon points="{band}" fill="{color}" fill-opacity="0.2" stroke="none"/>')
+        line = " ".join(f"{x(t):.1f},{y(v):.1f}" for t, v in zip(ts, mean))
+        out.append(f'<polyline points="{line}" fill="none" stroke="{color}" stroke-width="1.2">'
+                   f'<title>{html.escape(label)}</title></polyline>')
+    out.append("</svg>")
+    return "".join(out)
+
+
+def _row(label: str, value: str) -> str:
+    return f"<tr><th>{html.escape(label)}</th><td>{html.escape(value)}</td></tr>"
+
+
+def _fmt_s(value: Optional[float]) -> str:
+    if value is None:
+        return "-"
+    return f"{value / 60:.1f} min" if value >= 120 else f"{value:.1f} s"
+
+
+def render_html(st: SessionStats, charger: int = 1) -> str:
+    start = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(st.start_unix_us / 1e6)) if st.start_unix_us else "-"
+    eff = st.efficiency
+    rows = [
+        _row("Recording", os.path.basename(st.path)), _row("Start", start), _row("Charger", str(charger)),
+        _row("Duration", _fmt_s(st.duration_s)), _row("Charging", _fmt_s(st.charging_s)),
+        _row("Energy delivered (DC)", f"{st.energy_dc_kWh:.2f} kWh"),
+        _row("Energy from mains (AC)", f"{st.energy_ac_kWh:.2f} kWh" if st.energy_ac_kWh else "-"),
+        _row("Efficiency", f"{eff * 100:.1f} %" if eff else "-"),
+        _row("Peak power", f"{st.peak_power_kW:.2f} kW at {_fmt_s(st.peak_power_t)}"),
+        _row("Average power (charging)", f"{st.avg_power_kW:.2f} kW"),
+        _row("Max Vout / Iout", f"{st.max_vout_V:.1f} V / {st.max_iout_A:.1f} A"),
+        _row("Derating", f"{_fmt_s(st.derating_s)} in {st.derating_periods} periods"),
+    ]
+    temps = [_row(name, f"{v:.1f} °C at {_fmt_s(t)}") for name, (v, t) in sorted(st.temps.items())]
+
+    phases = []
+    for n, s in enumerate(st.sessions, 1):
+        cells = "".join(f"<td>{_fmt_s(s.durations.get(p))}</td>" for p in Phase if p != Phase.IDLE)
+        phases.append(f"<tr><th>{n}</th><td>{_fmt_s(s.precharge_s)}</td><td>{_fmt_s(s.time_to_power_s)}</td>"
+                      f"<td>{_fmt_s(s.time_to_full_power_s)}</td>{cells}</tr>")
+    phase_head = "".join(f"<th>{p.value}</th>" for p in Phase if p != Phase.IDLE)
+
+    faults = []
+    for f in st.faults:
+        info = fault_info(f.code)
+        faults.append(f"<tr><td>{_fmt_s(f.t)}</td><td>{'active' if f.active else 'inactive'}</td>"
+                      f"<td>0x{f.code:02X} {html.escape(info.label)}</td><td>{f.level}</td><td>{f.occurrence}</td>"
+                      f"<td>{f.first_time_h} h</td><td>{f.last_time_h} h</td><td>{html.escape(info.action)}</td></tr>")
+
+    plots = []
+    p = st.plots
+    shade = p.get("derating")
+    if "power_kW" in p:
+        plots.append(("Output power [kW], derating in red", _svg_plot([("power", p["power_kW"], "#1f77b4")],
+                                                                      st.duration_s, "kW", shade)))
+        plots.append(("Iout [A]", _svg_plot([("iout", p["iout_A"], "#d62728")], st.duration_s, "A", shade)))
+        plots.append(("Vout [V]", _svg_plot([("vout", p["vout_V"], "#2ca02c")], st.duration_s, "V")))
+
+    out = [
+        "<!DOCTYPE html>", "<html><head><meta charset=\"utf-8\">",
+        f"<title>EVO11KA charge report - {html.escape(os.path.basename(st.path))}</title>",
+        "<style>body{font-family:sans-serif;margin:24px;color:#222}table{border-collapse:collapse;margin:8px 0 20px}"
+        "th,td{border:1px solid #ccc;padding:3px 8px;text-align:left;font-size:13px}th{background:#f3f3f3}"
+        "svg text{font-size:11px;fill:#444}h2{margin-top:28px}</style></head><body>",
+        "<h1>EVO11KA charge report</h1>",
+        "<h2>Summary</h2><table>" + "".join(rows) + "</table>",
+        "<h2>Temperature maxima</h2><table>" + ("".join(temps) or "<tr><td>no data</td></tr>") + "</table>",
+        "<h2>Phases</h2><table><tr><th>#</th><th>Precharge</th><th>To power</th><th>To full power</th>"
+        + phase_head + "</tr>" + "".join(phases) + "</table>",
+        "<h2>Faults</h2>" + ("<table><tr><th>Seen at</th><th>List</th><th>Fault</th><th>Level</th><th>Occ.</th>"
+                             "<th>First</th><th>Last</th><th>Action</th></tr>" + "".join(faults) + "</table>"
+                             if faults else "<p>No fault reported.</p>"),
+        "<h2>Plots</h2><p>x axis: minutes from the start of the recording</p>",
+    ]
+    for title, svg in plots:
+        out.append(f"<h3>{html.escape(title)}</h3>{svg}")
+    out.append(f"<p style=\"color:#888\">{st.frames} frames, computed in {st.scan_s * 1e3:.0f} ms</p>")
+    out.append("</body></html>")
+    return "\n".join(out)
+
+
+def write_report(path: str, out_path: str, charger: int = 1) -> SessionStats:
+    st = scan(path, charger)
+    text = render_html(st, charger)
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write(text)
+    return st
+
+
+# ============================================================================
+# CLI
+# ============================================================================
+
+REPORT_LIMIT_S = 1.0
+
+
+def bench() -> bool:
+    """Carica simulata di circa due ore (CC 9 A, 35 C): scan + HTML entro REPORT_LIMIT_S"""
+    import tempfile
+    from .charge_sim import ChargeProfile, ChargeSimulation
+    from .recording import RecordingWriter
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "sim.evlog")
+        sim = ChargeSimulation(ambient_C=35.0, profile=ChargeProfile(cc_current_A=9.0))
+        with RecordingWriter(path, 1_717_000_000 * 1_000_000) as w:
+            for frames in sim.ticks():
+                for f in frames:
+                    w.write(f.t_ms * 1000, f.can_id, f.data, f.extended, f.direction == "Tx")
+        start = time.perf_counter()
+        st = write_report(path, os.path.join(tmp, "sim.html"))
+        total = time.perf_counter() - start
+        size = os.path.getsize(os.path.join(tmp, "sim.html"))
+    # Verifica dell'energia contro l'impianto: energia DC erogata dalla simulazione
+    ok = total < REPORT_LIMIT_S and st.energy_dc_kWh > 0 and st.sessions
+    print(f"{st.frames} frames, {st.duration_s / 60:.0f} min session, {st.energy_dc_kWh:.2f} kWh, "
+          f"{len(st.sessions)} phase session(s)")
+    print(f"  scan {st.scan_s * 1e3:.0f} ms, scan + HTML {total * 1e3:.0f} ms (limit {REPORT_LIMIT_S * 1e3:.0f} ms), "
+          f"{size / 1e3:.0f} kB  {'OK' if ok else 'FAIL'}")
+    return bool(ok)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="HTML report of a charge session")
+    parser.add_argument("files", nargs="*", help=".evlog recordings")
+    parser.add_argument("-o", "--output", help="output .html (single input)")
+    parser.add_argument("--charger", type=int, default=1)
+    parser.add_argument("--bench", action="store_true", help="simulated 2 h charge, time limit check")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        return 0 if bench() else 1
+    if not args.files:
+        parser.error("no input files")
+    for path in args.files:
+        out = args.output or os.path.splitext(path)[0] + ".html"
+        try:
+            st = write_report(path, out, args.charger)
+        except (OSError, ValueError) as e:
+            print(f"{path}: {e}")
+            return 1
+        print(f"{out}: {st.energy_dc_kWh:.2f} kWh, {len(st.faults)} faults, {st.scan_s * 1e3:.0f} ms")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,219 @@
+"""Tabella dei segnali dei messaggi EVO11KA (livelli 1-4)
+
+Una riga per campo delle dataclass *Packet di can_decoder, nello stesso
+ordine, con la sua posizione nel payload. La tabella guida il decoder a
+blocchi e il corpus golden; can_decoder resta il riferimento leggibile.
+"""
+
+import struct
+from dataclasses import dataclass
+from typing import Dict, List, Optional, Tuple, Type
+
+from .can_decoder import (CANDecoder, FrameType, BaudrateType, IdType, IacControlType,
+                          RangeType, EVCModelType, IDSettingType)
+
+# Tipi di campo
+BOOL = "bool"
+UINT = "uint"
+FLOAT = "float"         # raw * scale + offset
+ENUM = "enum"           # valore grezzo di un campo Enum
+LEVEL = "level"         # bit del livello di guasto -> valore FailureLevel
+ASCII = "ascii"         # stringa di 8 byte
+
+TEMP_SCALE = 0.005188
+TEMP_OFFSET = -40.0
+
+# Bit 1-0 di D3 del guasto -> valore FailureLevel (00 non definito, decodificato come Warning)
+LEVEL_VALUES = (1, 1, 10, 11)
+
+
+@dataclass(frozen=True)
+class Signal:
+    name: str
+    byte: int               # Primo byte (MSB per 16 bit, big endian)
+    bit: int                # Shift dell'LSB all'interno del byte
+    length: int             # Bit: 1..8 in un byte, 16 = due byte
+    kind: str = UINT
+    scale: float = 1.0
+    offset: float = 0.0
+    unit: str = ""
+    enum: Optional[Type] = None
+
+    @property
+    def mask(self) -> int:
+        return (1 << self.length) - 1
+
+    def raw(self, data) -> int:
+        if self.length == 16:
+            return (data[self.byte] << 8) | data[self.byte + 1]
+        return (data[self.byte] >> self.bit) & self.mask
+
+    @property
+    def full_scale(self) -> float:
+        """Modulo massimo che il campo può decodificare"""
+        return abs(self.mask * self.scale) + abs(self.offset)
+
+
+def _flag(name: str, byte: int, bit: int) -> Signal:
+    return Signal(name, byte, bit, 1, BOOL)
+
+
+def _u16(name: str, byte: int, scale: float = 0.1, unit: str = "") -> Signal:
+    return Signal(name, byte, 0, 16, FLOAT, scale, 0.0, unit)
+
+
+def _temp(name: str, byte: int) -> Signal:
+    return Signal(name, byte, 0, 16, FLOAT, TEMP_SCALE, TEMP_OFFSET, "°C")
+
+
+def _count16(name: str, byte: int, unit: str = "") -> Signal:
+    return Signal(name, byte, 0, 16, UINT, unit=unit)
+
+
+C = CANDecoder
+
+SIGNALS: Dict[int, Tuple[Signal, ...]] = {
+    # ---- Livello 1 ----
+    C.CAN_ID_CTL: (
+        _flag("can_enable", 0, 7), _flag("led3_enable", 0, 3),
+        _u16("iac_max_A", 1, unit="A"), _u16("vout_max_V", 3, unit="V"),
+        _u16("iout_max_A", 5, unit="A"),
+    ),
+    C.CAN_ID_STAT: (
+        _flag("power_enable", 0, 7), _flag("error_latch", 0, 6), _flag("warn_limit", 0, 5),
+        _flag("lim_temp", 0, 3), _flag("warning_hv", 0, 1), _flag("bulks", 0, 0),
+    ),
+    C.CAN_ID_ACT1: (
+        _u16("iac_A", 0, unit="A"), _temp("temp_C", 2),
+        _u16("vout_V", 4, unit="V"), _u16("iout_A", 6, unit="A"),
+    ),
+    C.CAN_ID_ACT2: (
+        _temp("temp_loglv_C", 0), _u16("ac_power_kW", 2, 0.01, "kW"),
+        _u16("prox_limit_A", 4, unit="A"), _u16("pilot_limit_A", 6, unit="A"),
+    ),
+    C.CAN_ID_TST1: (
+        _flag("ack", 0, 7), _flag("pr_compl", 0, 6), _flag("pwr_ok", 0, 5),
+        _flag("vout_ok", 0, 4), _flag("neutral", 0, 3), _flag("led3", 0, 2),
+        _flag("led618", 0, 1),
+        _flag("ovp", 1, 7), _flag("conn_open", 1, 6), _flag("ther_fail", 1, 2),
+        _flag("rx618_fail", 1, 0),
+        _flag("bulk1_fail", 2, 7), _flag("bulk2_fail", 2, 6), _flag("bulk3_fail", 2, 5),
+        _flag("pump_on", 2, 4), _flag("fan_on", 2, 3), _flag("hv_rx_fail", 2, 2),
+        _flag("cooling_fail", 2, 1), _flag("rx619_fail", 2, 0),
+        _flag("neutro1", 3, 7), _flag("neutro2", 3, 6), _flag("three_phase", 3, 5),
+        _flag("iac_fail", 3, 2), _flag("ignition", 3, 1), _flag("lv_battery_np", 3, 0),
+        _flag("prox_ok", 4, 7), _flag("pilot_ok", 4, 5), _flag("s2_ok", 4, 3),
+        _count16("cnt_hours", 6, "h"),
+    ),
+    # ---- Livello 2 ----
+    C.CAN_ID_REQ: (
+        _flag("enable", 0, 7), _count16("id_requested", 2),
+    ),
+    C.CAN_ID_FLTA: (
+        Signal("frame_type", 0, 6, 2, ENUM, enum=FrameType),
+        Signal("total_errors", 0, 0, 6), Signal("frame_number", 1, 2, 6),
+        Signal("fault_code", 2, 0, 8), Signal("occurrence", 3, 2, 6),
+        Signal("failure_level", 3, 0, 2, LEVEL),
+        _count16("first_time_h", 4, "h"), _count16("last_time_h", 6, "h"),
+    ),
+    C.CAN_ID_SW: (Signal("version", 0, 0, 64, ASCII),),
+    C.CAN_ID_SN: (Signal("serial", 0, 0, 64, ASCII),),
+    # ---- Livello 4 ----
+    C.CAN_ID_TST2: (
+        Signal("baudrate", 0, 6, 2, ENUM, enum=BaudrateType),
+        Signal("id_type", 0, 5, 1, ENUM, enum=IdType),
+        Signal("iac_control", 0, 2, 2, ENUM, enum=IacControlType),
+        Signal("range", 0, 0, 2, ENUM, enum=RangeType),
+        _flag("three_phase", 0, 0), _flag("slave", 1, 7),
+        Signal("evc_model", 1, 6, 1, ENUM, enum=EVCModelType),
+        Signal("id_setting", 1, 2, 4, ENUM, enum=IDSettingType),
+        _flag("air_cooler", 1, 0), _flag("parallel_ctrl", 1, 1),
+        Signal("iacm_max_set_A", 2, 0, 8, FLOAT, 0.2, unit="A"),
+        _u16("vout_max_set_V", 3, unit="V"), _u16("iout_max_set_A", 5, unit="A"),
+        Signal("password", 7, 0, 8),
+    ),
+    # ---- Livello 3 ----
+    C.CAN_ID_ACT3: (
+        _u16("fan_voltage_V", 0, unit="V"), _u16("iacm1_A", 2, unit="A"),
+        _u16("iacm2_A", 4, unit="A"), _u16("iacm3_A", 6, unit="A"),
+    ),
+    C.CAN_ID_TEMP: (
+        _temp("temp_loghv_C", 0), _temp("temp_power1_C", 2),
+        _temp("temp_power2_C", 4), _temp("temp_power3_C", 6),
+    ),
+    C.CAN_ID_ACT4: (
+        _temp("temp_logfan_C", 0), _count16("iout1_raw", 2),
+        _count16("iout2_raw", 4), _count16("iout3_raw", 6),
+    ),
+    C.CAN_ID_STST1: (
+        _flag("pfc_enable", 0, 2),
+        _flag("log_temp_high", 1, 5), _flag("log_temp_low", 1, 4), _flag("uvlo_log", 1, 3),
+        _flag("ther_low_fail", 1, 2), _flag("rx618_fail", 1, 0),
+        _flag("bulk1_fail", 2, 7), _flag("bulk2_fail", 2, 6), _flag("bulk3_fail", 2, 5),
+        _flag("cooling_fail1", 2, 4), _flag("cooling_fail2", 2, 3), _flag("cooling_fail3", 2, 2),
+        _flag("uvlo_log_lv", 3, 3), _flag("bat_over", 3, 1), _flag("bat_under", 3, 0),
+    ),
+}
+SIGNALS[C.CAN_ID_FLTP] = SIGNALS[C.CAN_ID_FLTA]
+
+FAULT_IDS = (C.CAN_ID_FLTA, C.CAN_ID_FLTP)
+
+
+def signal_names(base_id: int) -> List[str]:
+    return [s.name for s in SIGNALS[base_id]]
+
+
+# ============================================================================
+# Decoder a blocchi
+# ============================================================================
+
+_NO_FAULT_TAIL = b'\xff' * 7
+
+
+def decode_bulk(base_id: int, payloads: bytes) -> Dict[str, list]:
+    """Decodifica molti frame di un ID insieme: una colonna per segnale
+    
+    payloads: 8 byte per frame, concatenati (es. Recording.payloads()).
+    I valori sono identici a CANDecoder (stesse espressioni float) ma gli
+    enum restano int grezzi e i frame di guasto hanno una colonna "no_fault"
+    in più.
+    """
+    n = len(payloads) // 8
+    payloads = payloads[:n * 8]
+    cols: Dict[str, list] = {}
+    words = None
+    for s in SIGNALS[base_id]:
+        if s.kind == ASCII:
+            cols[s.name] = [payloads[i:i + 8].decode('latin-1') for i in range(0, n * 8, 8)]
+            continue
+        if s.length == 16:
+            if s.byte % 2 == 0:
+                if words is None:
+                    words = struct.unpack(f'>{n * 4}H', payloads)
+                raw = words[s.byte // 2::4]
+            else:
+                raw = [(hi << 8) | lo for hi, lo in zip(payloads[s.byte::8], payloads[s.byte + 1::8])]
+        else:
+            col = payloads[s.byte::8]
+            if s.kind == BOOL:
+                m = 1 << s.bit
+                cols[s.name] = [b & m != 0 for b in col]
+                continue
+            if s.length == 8:
+                raw = col
+            else:
+                sh, mask = s.bit, s.mask
+                raw = [(b >> sh) & mask for b in col]
+
+        if s.kind == FLOAT:
+            scale, offset = s.scale, s.offset
+            cols[s.name] = [r * scale + offset for r in raw] if offset else [r * scale for r in raw]
+        elif s.kind == LEVEL:
+            lv = LEVEL_VALUES
+            cols[s.name] = [lv[r] for r in raw]
+        else:
+            cols[s.name] = list(raw)
+
+    if base_id in FAULT_IDS:
+        cols["no_fault"] = [payloads[i + 1:i + 8] == _NO_FAULT_TAIL for i in range(0, n * 8, 8)]
+    return cols
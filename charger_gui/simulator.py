@@ -0,0 +1,681 @@
+"""Simulatore del charger EVO e motore di scenari scriptati (senza GUI, niente Qt)
+
+    python -m charger_gui.simulator charger_gui/scenarios            # esegue la suite
+    python -m charger_gui.simulator scenario.json -o frames.log       # scrive i frame
+
+Il simulatore gira in tempo virtuale: ogni tick produce i frame dovuti in
+quel tick e non si dorme mai, così uno scenario di minuti gira in
+millisecondi e produce sempre gli stessi frame.
+"""
+
+import json
+import os
+import sys
+import time
+from dataclasses import dataclass, field
+from typing import Callable, Dict, Iterable, Iterator, List, Optional, Tuple
+
+from .can_decoder import (CANDecoder, StatPacket, Act1Packet, Act2Packet, Tst1Packet,
+                          FaultPacket, FaultCode, FailureLevel, FrameType,
+                          SoftwarePacket, SerialNumberPacket, Act3Packet, TempPacket,
+                          Stst1Packet, Act4Packet, RequestType)
+from .can_encoder import CANEncoder, NO_FAULT_FRAME
+from .fault_table import fault_info
+from .bus_load import DEFAULT_PLAN, PlannedMessage
+
+
+# Nome del messaggio (come nel manuale) -> ID CAN base
+MESSAGE_IDS = {
+    name: getattr(CANDecoder, f"CAN_ID_{name}")
+    for name in ("CTL", "STAT", "ACT1", "ACT2", "TST1", "REQ", "FLTP", "FLTA",
+                 "SW", "SN", "TST2", "ACT3", "TEMP", "ACT4", "STST1")
+}
+
+DERATING_TEMP_C = 70.0      # FAULT_A7 (warning, potenza limitata)
+HIGH_TEMP_C = 90.0          # FAULT_A8 (soft failure, temperatura massima della cold plate)
+HIGH_TEMP_HOLD_MS = 1000    # A8 attivato/azzerato dopo 1 s sopra/sotto il massimo
+ACOK_LEAD_MS = 300          # Tst1.ACok ~300 ms prima dell'inizio della precarica (manuale)
+PRECHARGE_MS = 1000         # Durata della precarica (modello, non nel manuale)
+
+
+# ============================================================================
+# Stato del charger
+# ============================================================================
+
+@dataclass
+class ActiveFault:
+    code: int
+    level: FailureLevel
+    occurrence: int = 1
+    first_time_h: int = 0
+    last_time_h: int = 0
+
+
+@dataclass
+class ChargerState:
+    """Valori che il charger riporta sul bus (modificabili dagli scenari)"""
+    ac_present: bool = True
+    pr_compl: bool = True           # Precarica completata (False: ripartenza dalla spina)
+    enabled: bool = True            # can_enable del CTL
+    led3: bool = False
+    three_phase: bool = True
+    iac_max_A: float = 32.0         # Setpoint del CTL
+    vout_max_V: float = 450.0
+    iout_max_A: float = 25.0
+    iac_A: float = 16.0
+    vout_V: float = 400.0
+    iout_A: float = 20.0
+    temp_C: float = 35.0
+    temp_loglv_C: float = 35.0
+    prox_limit_A: float = 32.0
+    pilot_limit_A: float = 32.0
+    fan_voltage_V: float = 12.0
+    cnt_hours: int = 120
+    version: str = "1.05.02 "
+    serial: str = "EVO11K01"
+    faults: Dict[int, ActiveFault] = field(default_factory=dict)
+
+    @property
+    def charging(self) -> bool:
+        return self.ac_present and self.pr_compl and self.enabled and not self.failure
+
+    @property
+    def failure(self) -> bool:
+        """Soft failure o failure: uscita ferma e Stat.ErrorLatch attivo"""
+        return bool(self.faults) and any(f.level in (FailureLevel.SOFT, FailureLevel.HARD)
+                                         for f in self.faults.values())
+
+    @property
+    def derating(self) -> bool:
+        return bool(self.faults) and any(f.level == FailureLevel.WARNING for f in self.faults.values())
+
+
+@dataclass
+class SimFrame:
+    t_ms: int
+    can_id: int         # ID di bus (ID del charger)
+    data: List[int]
+    extended: bool = False
+    direction: str = "Rx"   # "Tx" = inviato dal BMS
+
+    def to_line(self) -> str:
+        """Riga nel formato seriale del gateway BMS"""
+        id_str = f"0x{self.can_id:08X}" if self.extended else f"0x{self.can_id:03X}"
+        return f"CanBus {self.direction} {id_str} " + ' '.join(f'{b:02X}' for b in self.data)
+
+
+# ============================================================================
+# Simulatore
+# ============================================================================
+
+class ChargerSimulator:
+    """Charger EVO in tempo virtuale: step() avanza di un tick e ritorna i frame"""
+
+    def __init__(self, charger: int = 1, extended: bool = False, tick_ms: int = 100,
+                 plan: Optional[List[PlannedMessage]] = None):
+        self.charger = charger
+        self.extended = extended
+        self.tick_ms = tick_ms
+        self.now_ms = 0
+        self.state = ChargerState()
+        self.plan = [m for m in (plan or DEFAULT_PLAN)
+                     if m.enabled and m.can_id != CANDecoder.CAN_ID_CTL]
+        self.muted_until: Dict[int, int] = {}      # ID base -> t_ms
+        self.pending: List[Tuple[int, List[int]]] = []
+        self._payload_cache: Dict[tuple, List[int]] = {}
+        self._last_ctl: Optional[List[int]] = None
+        self._fault_since: Dict[int, int] = {}     # codice -> t_ms del cambio di condizione
+        self._ac_on_ms: Optional[int] = None       # Inizio di ACok senza precarica completata
+        self._schedule = [(m.can_id, self.bus_id(m.can_id), int(m.period_ms)) for m in self.plan]
+
+    # ------------------------------------------------------------------
+    # Generazione dei frame
+    # ------------------------------------------------------------------
+
+    def bus_id(self, base_id: int) -> int:
+        return CANDecoder.id_map.bus_id(base_id, self.charger, self.extended)
+
+    def _update_precharge(self):
+        """ACok -> 300 ms -> precarica -> PrCompl; senza AC la precarica si perde"""
+        s = self.state
+        if not s.ac_present:
+            s.pr_compl = False
+            self._ac_on_ms = None
+        elif not s.pr_compl:
+            if self._ac_on_ms is None:
+                self._ac_on_ms = self.now_ms
+            if self.now_ms - self._ac_on_ms >= ACOK_LEAD_MS + PRECHARGE_MS:
+                s.pr_compl = True
+                self._ac_on_ms = None
+
+    def _update_faults(self):
+        s = self.state
+        if s.temp_C < DERATING_TEMP_C and not s.faults:
+            self._fault_since.clear()
+            return
+        self._set_fault(FaultCode.TEMP_DERATING, s.temp_C >= DERATING_TEMP_C)
+        self._set_fault(FaultCode.TEMP_HIGH, s.temp_C >= HIGH_TEMP_C, HIGH_TEMP_HOLD_MS)
+
+    def _set_fault(self, code: FaultCode, active: bool, hold_ms: int = 0):
+        """Attiva/azzera un guasto quando la sua condizione dura da hold_ms
+
+        Severità e reset vengono da FAULT_TABLE: i guasti con ac_reset restano
+        attivi finché la rete AC non viene scollegata e ricollegata.
+        """
+        faults = self.state.faults
+        if active == (code.value in faults):
+            self._fault_since.pop(code.value, None)
+            return
+        since = self._fault_since.setdefault(code.value, self.now_ms)
+        if self.now_ms - since < hold_ms:
+            return
+        del self._fault_since[code.value]
+        info = fault_info(code.value)
+        if active:
+            faults[code.value] = ActiveFault(code.value, info.severity, 1,
+                                             self.state.cnt_hours, self.state.cnt_hours)
+        elif not info.ac_reset:
+            del faults[code.value]
+
+    # I messaggi di soli flag dipendono da pochi ingressi: i payload sono in cache su di essi
+    _FLAG_KEYS = {
+        CANDecoder.CAN_ID_STAT: lambda s, on: (on, s.failure, s.derating),
+        CANDecoder.CAN_ID_TST1: lambda s, on: (on, s.ac_present, s.pr_compl, s.enabled, s.led3,
+                                               s.three_phase, s.cnt_hours),
+        CANDecoder.CAN_ID_STST1: lambda s, on: (on, s.ac_present),
+        CANDecoder.CAN_ID_SW: lambda s, on: (s.version,),
+        CANDecoder.CAN_ID_SN: lambda s, on: (s.serial,),
+    }
+
+    def encode(self, base_id: int, on: Optional[bool] = None) -> List[int]:
+        """Payload di un messaggio del charger dallo stato corrente
+
+        on: state.charging se già calcolato in questo tick
+        """
+        if on is None:
+            on = self.state.charging
+        key_fn = self._FLAG_KEYS.get(base_id)
+        if key_fn is None:
+            return self._encode(base_id, on)
+        key = (base_id,) + key_fn(self.state, on)
+        payload = self._payload_cache.get(key)
+        if payload is None:
+            payload = self._payload_cache[key] = self._encode(base_id, on)
+        return list(payload)
+
+    def _encode(self, base_id: int, on: bool) -> List[int]:
+        s = self.state
+        if base_id == CANDecoder.CAN_ID_STAT:
+            return CANEncoder.encode_stat(StatPacket(
+                power_enable=on, error_latch=s.failure, warn_limit=s.derating,
+                lim_temp=s.derating, warning_hv=False, bulks=on))
+        if base_id == CANDecoder.CAN_ID_ACT1:
+            return CANEncoder.encode_act1(Act1Packet(
+                s.iac_A if on else 0.0, s.temp_C, s.vout_V, s.iout_A if on else 0.0))
+        if base_id == CANDecoder.CAN_ID_ACT2:
+            power = s.vout_V * s.iout_A / 1000.0 if on else 0.0
+            return CANEncoder.encode_act2(Act2Packet(
+                s.temp_loglv_C, power, s.prox_limit_A, s.pilot_limit_A))
+        if base_id == CANDecoder.CAN_ID_TST1:
+            return CANEncoder.encode_tst1(Tst1Packet(
+                ack=s.ac_present, pr_compl=s.pr_compl, pwr_ok=on, vout_ok=on,
+                neutral=s.ac_present, led3=s.led3, led618=s.enabled,
+                ovp=False, conn_open=not s.ac_present, ther_fail=False, rx618_fail=False,
+                bulk1_fail=False, bulk2_fail=False, bulk3_fail=False, pump_on=on,
+                fan_on=on, hv_rx_fail=False, cooling_fail=False, rx619_fail=False,
+                neutro1=False, neutro2=False, three_phase=s.three_phase, iac_fail=False,
+                ignition=False, lv_battery_np=False,
+                prox_ok=s.ac_present, pilot_ok=s.ac_present, s2_ok=on,
+                cnt_hours=s.cnt_hours))
+        if base_id == CANDecoder.CAN_ID_ACT3:
+            phase = s.iac_A if on else 0.0
+            return CANEncoder.encode_act3(Act3Packet(
+                s.fan_voltage_V, phase, phase if s.three_phase else 0.0,
+                phase if s.three_phase else 0.0))
+        if base_id == CANDecoder.CAN_ID_TEMP:
+            return CANEncoder.encode_temp(TempPacket(s.temp_loglv_C, s.temp_C, s.temp_C, s.temp_C))
+        if base_id == CANDecoder.CAN_ID_ACT4:
+            raw = int(s.iout_A * 10 / 3) if on else 0
+            return CANEncoder.encode_act4(Act4Packet(s.temp_loglv_C, raw, raw, raw))
+        if base_id == CANDecoder.CAN_ID_STST1:
+            return CANEncoder.encode_stst1(Stst1Packet(
+                pfc_enable=on, log_temp_high=False, log_temp_low=False, uvlo_log=False,
+                ther_low_fail=False, rx618_fail=False, bulk1_fail=False, bulk2_fail=False,
+                bulk3_fail=False, cooling_fail1=False, cooling_fail2=False,
+                cooling_fail3=False, uvlo_log_lv=not s.ac_present, bat_over=False,
+                bat_under=False))
+        if base_id == CANDecoder.CAN_ID_SW:
+            return CANEncoder.encode_software(SoftwarePacket(s.version))
+        if base_id == CANDecoder.CAN_ID_SN:
+            return CANEncoder.encode_serial_number(SerialNumberPacket(s.serial))
+        raise ValueError(f"Message 0x{base_id:03X} not generated by the charger")
+
+    def fault_frames(self, faults: Optional[List[ActiveFault]] = None) -> List[List[int]]:
+        """Frame FLTA/FLTP per una lista di guasti (singolo o multi frame)"""
+        faults = list(self.state.faults.values()) if faults is None else faults
+        if not faults:
+            return [list(NO_FAULT_FRAME)]
+        faults = faults[:0x3F]
+        frame_type = FrameType.SINGLE if len(faults) == 1 else FrameType.MULTI
+        return [CANEncoder.encode_fault(FaultPacket(
+                    frame_type, len(faults), n, f.code, f.occurrence, f.level,
+                    f.first_time_h, f.last_time_h))
+                for n, f in enumerate(faults, start=1)]
+
+    def queue(self, base_id: int, payloads: List[List[int]]):
+        """Frame inviati nel prossimo tick (dopo quelli periodici)"""
+        self.pending.extend((base_id, p) for p in payloads)
+
+    def mute(self, base_id: int, duration_ms: int):
+        self.muted_until[base_id] = self.now_ms + duration_ms
+
+    def receive(self, bus_id: int, data: List[int], extended: bool = False):
+        """Frame dal BMS (CTL, REQ)"""
+        resolved = CANDecoder.id_map.resolve(bus_id, extended)
+        if resolved is None or resolved[1] != self.charger:
+            return
+        base_id = resolved[0]
+        if base_id == CANDecoder.CAN_ID_CTL:
+            if data == self._last_ctl:
+                return                      # CTL ripetuto ogni 100 ms, per lo più invariato
+            self._last_ctl = list(data)
+            ctl = CANDecoder.decode_ctl(data)
+            self.state.enabled = ctl.can_enable
+            self.state.led3 = ctl.led3_enable
+            self.state.iac_max_A = ctl.iac_max_A
+            self.state.vout_max_V = ctl.vout_max_V
+            self.state.iout_max_A = ctl.iout_max_A
+        elif base_id == CANDecoder.CAN_ID_REQ:
+            req = CANDecoder.decode_req(data)
+            if not req.enable:
+                return
+            requested = self._requested_base(req.id_requested, extended)
+            if requested == CANDecoder.CAN_ID_FLTA:
+                self.queue(CANDecoder.CAN_ID_FLTA, self.fault_frames())
+            elif requested == CANDecoder.CAN_ID_FLTP:
+                self.queue(CANDecoder.CAN_ID_FLTP, [list(NO_FAULT_FRAME)])
+            elif requested == CANDecoder.CAN_ID_SW:
+                self.queue(CANDecoder.CAN_ID_SW, [self.encode(CANDecoder.CAN_ID_SW)])
+            elif requested == CANDecoder.CAN_ID_SN:
+                self.queue(CANDecoder.CAN_ID_SN, [self.encode(CANDecoder.CAN_ID_SN)])
+
+    _SHORT_REQUESTS = {t.value for t in RequestType}
+
+    def _requested_base(self, id_requested: int, extended: bool) -> Optional[int]:
+        """ID base del messaggio chiesto da un REQ, None se non è uno di questo charger
+
+        Manuale: si richiede l'ID di bus completo del charger (80 00 06 1D
+        per il charger 1, 80 00 06 0D per il charger 2); è accettata
+        anche la forma corta 0x1C-0x1F. Nessun charger ha un ID di bus in
+        0x01C-0x01F.
+        """
+        if id_requested in self._SHORT_REQUESTS:
+            return 0x600 | id_requested
+        resolved = CANDecoder.id_map.resolve(id_requested, extended)
+        if resolved is None or resolved[1] != self.charger:
+            return None
+        return resolved[0]
+
+    def step(self) -> List[SimFrame]:
+        """Emette i frame del tick corrente, poi avanza il tempo virtuale"""
+        t = self.now_ms
+        self._update_precharge()
+        self._update_faults()
+        frames = []
+        muted = self.muted_until
+        on = self.state.charging
+        for base_id, bus_id, period_ms in self._schedule:
+            if t % period_ms != 0 or (muted and muted.get(base_id, -1) > t):
+                continue
+            frames.append(SimFrame(t, bus_id, self.encode(base_id, on), self.extended))
+        for base_id, payload in self.pending:
+            frames.append(SimFrame(t, self.bus_id(base_id), payload, self.extended))
+        self.pending.clear()
+        self.now_ms += self.tick_ms
+        return frames
+
+
+# ============================================================================
+# Scenari
+# ============================================================================
+
+class ScenarioError(Exception):
+    pass
+
+
+@dataclass
+class Scenario:
+    """Timeline di eventi + aspettative, caricata da JSON
+
+    {
+      "name": "...", "duration_s": 20, "charger": 1, "extended": false,
+      "initial": {"temp_C": 40},
+      "events": [
+        {"t": 1.0, "action": "set", "field": "ac_present", "value": false},
+        {"t": 1.0, "action": "ramp", "field": "temp_C", "to": 95, "duration": 10,
+         "until_fault": "TEMP_DERATING"},
+        {"t": 2.0, "action": "fault_list", "count": 5},
+        {"t": 3.0, "action": "mute", "message": "ACT1", "duration": 0.7},
+        {"t": 4.0, "action": "fault", "code": "HVIL_INTERLOCK"},
+        {"t": 5.0, "action": "clear_fault", "code": "HVIL_INTERLOCK"},
+        {"t": 6.0, "action": "request", "id": "FAULT_ACTIVE"}
+      ],
+      "expect": [
+        {"at": 5.0, "message": "STAT", "field": "lim_temp", "equals": true},
+        {"by": 12.0, "message": "FLTA", "field": "fault_code", "equals": "TEMP_DERATING"},
+        {"from": 3.0, "to": 3.7, "message": "ACT1", "count": 0},
+        {"session": 1, "phase": "PRECHARGE", "equals": 1.0},
+        {"session": 1, "field": "precharge_s", "equals": 1.3}
+      ]
+    }
+    """
+    name: str
+    duration_s: float
+    events: List[dict]
+    expect: List[dict]
+    initial: Dict[str, object] = field(default_factory=dict)
+    charger: int = 1
+    extended: bool = False
+    path: str = ""
+
+    @classmethod
+    def load(cls, path: str) -> "Scenario":
+        with open(path, encoding="utf-8") as f:
+            raw = json.load(f)
+        try:
+            return cls(name=raw.get("name", os.path.splitext(os.path.basename(path))[0]),
+                       duration_s=float(raw["duration_s"]),
+                       events=sorted(raw.get("events", []), key=lambda e: e["t"]),
+                       expect=raw.get("expect", []),
+                       initial=raw.get("initial", {}),
+                       charger=raw.get("charger", 1),
+                       extended=raw.get("extended", False),
+                       path=path)
+        except KeyError as e:
+            raise ScenarioError(f"{path}: missing key {e}")
+
+
+@dataclass
+class ScenarioResult:
+    scenario: Scenario
+    frames: List[SimFrame]
+    failures: List[str]
+    wall_s: float
+
+    @property
+    def passed(self) -> bool:
+        return not self.failures
+
+
+def _to_ms(seconds: float) -> int:
+    return int(round(seconds * 1000))
+
+
+def _fault_code(value) -> int:
+    return FaultCode[value].value if isinstance(value, str) else int(value)
+
+
+class ScenarioRunner:
+    """Esegue uno scenario sul simulatore, deterministico"""
+
+    def __init__(self, scenario: Scenario, simulator: Optional[ChargerSimulator] = None):
+        self.scenario = scenario
+        self.sim = simulator or ChargerSimulator(scenario.charger, scenario.extended)
+        self.ramps: List[dict] = []
+
+    def _apply(self, ev: dict):
+        sim, state = self.sim, self.sim.state
+        action = ev["action"]
+        if action == "set":
+            setattr(state, ev["field"], ev["value"])
+            if ev["field"] == "ac_present" and ev["value"]:
+                # Il ricollegamento AC azzera i guasti attivi fino a un ciclo AC (FAULT_TABLE ac_reset)
+                state.faults = {c: f for c, f in state.faults.items() if not fault_info(c).ac_reset}
+        elif action == "ramp":
+            ticks = max(1, _to_ms(ev["duration"]) // sim.tick_ms)
+            start = getattr(state, ev["field"])
+            self.ramps.append({"field": ev["field"], "step": (ev["to"] - start) / ticks,
+                               "left": ticks, "until": ev.get("until_fault")})
+        elif action == "fault":
+            code = _fault_code(ev["code"])
+            level = FailureLevel[ev["level"]] if "level" in ev else fault_info(code).severity
+            state.faults[code] = ActiveFault(code, level or FailureLevel.WARNING,
+                                             ev.get("occurrence", 1),
+                                             state.cnt_hours, state.cnt_hours)
+        elif action == "clear_fault":
+            state.faults.pop(_fault_code(ev["code"]), None)
+        elif action == "fault_list":
+            codes = [c.value for c in FaultCode]
+            n = ev["count"]
+            faults = [ActiveFault(codes[i % len(codes)], FailureLevel.WARNING, 1 + i // len(codes),
+                                  state.cnt_hours, state.cnt_hours) for i in range(n)]
+            sim.queue(MESSAGE_IDS[ev.get("message", "FLTA")], sim.fault_frames(faults))
+        elif action == "mute":
+            sim.mute(MESSAGE_IDS[ev["message"]], _to_ms(ev["duration"]))
+        elif action == "request":
+            req_id = RequestType[ev["id"]].value
+            sim.receive(sim.bus_id(CANDecoder.CAN_ID_REQ), [0x80, 0, 0, req_id, 0, 0, 0, 0],
+                        sim.extended)
+        else:
+            raise ScenarioError(f"{self.scenario.name}: unknown action '{action}'")
+
+    def _advance_ramps(self):
+        state = self.sim.state
+        for r in self.ramps:
+            if r["until"] and _fault_code(r["until"]) in state.faults:
+                r["left"] = 0
+                continue
+            setattr(state, r["field"], getattr(state, r["field"]) + r["step"])
+            r["left"] -= 1
+        self.ramps = [r for r in self.ramps if r["left"] > 0]
+
+    def ticks(self) -> Iterator[List[SimFrame]]:
+        """Frame di ogni tick (condivisi da run() e play_realtime())"""
+        sc, sim = self.scenario, self.sim
+        for name, value in sc.initial.items():
+            setattr(sim.state, name, value)
+
+        events = [(_to_ms(e["t"]), e) for e in sc.events]
+        end_ms = _to_ms(sc.duration_s)
+        i = 0
+        while sim.now_ms <= end_ms:
+            while i < len(events) and events[i][0] <= sim.now_ms:
+                self._apply(events[i][1])
+                i += 1
+            self._advance_ramps()
+            yield sim.step()
+
+    def run(self) -> ScenarioResult:
+        start = time.perf_counter()
+        sc = self.scenario
+        frames: List[SimFrame] = []
+        for tick in self.ticks():
+            frames.extend(tick)
+
+        failures = check_expectations(sc, frames)
+        return ScenarioResult(sc, frames, failures, time.perf_counter() - start)
+
+
+# ============================================================================
+# Aspettative
+# ============================================================================
+
+def _matches(packet, expect: dict) -> bool:
+    value = getattr(packet, expect["field"])
+    wanted = expect["equals"]
+    if expect["field"] == "fault_code":
+        wanted = _fault_code(wanted)
+    if isinstance(value, float):
+        return abs(value - wanted) <= expect.get("tolerance", 0.1)
+    if hasattr(value, "name") and isinstance(wanted, str):
+        return value.name == wanted
+    return value == wanted
+
+
+def _sessions(scenario: Scenario, decoded: List[Tuple[int, int, object]]) -> list:
+    """Sessioni di LifecycleTracker sui frame (t_ms, base ID, packet) del charger dello scenario"""
+    from .lifecycle import LifecycleTracker
+    tracker = LifecycleTracker()
+    for t, base_id, p in decoded:
+        if p is not None:
+            tracker.feed(base_id, p, t / 1000.0)
+    tracker.close(scenario.duration_s)
+    return tracker.sessions
+
+
+def _check_session(sessions: list, exp: dict) -> List[str]:
+    """{"session": n, "field": "precharge_s" | "phase": "PRECHARGE", "equals": s}"""
+    from .lifecycle import Phase
+    n = exp["session"]
+    if not 1 <= n <= len(sessions):
+        return [f"session {n}: only {len(sessions)} sessions"]
+    s = sessions[n - 1]
+    if "phase" in exp:
+        what, value = exp["phase"], s.durations.get(Phase[exp["phase"]], 0.0)
+    else:
+        what, value = exp["field"], getattr(s, exp["field"])
+    wanted = exp["equals"]
+    if value is None or wanted is None:
+        ok = value is wanted
+    else:
+        ok = abs(value - wanted) <= exp.get("tolerance", 0.05)
+    return [] if ok else [f"session {n} {what} = {value}, expected {wanted}"]
+
+
+def check_expectations(scenario: Scenario, frames: List[SimFrame]) -> List[str]:
+    """Lista dei fallimenti (vuota = scenario superato)"""
+    by_msg: Dict[int, List[Tuple[int, object]]] = {}
+    decoded: List[Tuple[int, int, object]] = []         # In ordine di bus, per le sessioni
+    for f in frames:
+        resolved = CANDecoder.id_map.resolve(f.can_id, f.extended)
+        if resolved is None or resolved[1] != scenario.charger:
+            continue
+        packet = CANDecoder.decode_message(resolved[0], f.data)
+        by_msg.setdefault(resolved[0], []).append((f.t_ms, packet))
+        decoded.append((f.t_ms, resolved[0], packet))
+
+    failures = []
+    sessions = None
+    for exp in scenario.expect:
+        if "session" in exp:
+            if sessions is None:
+                sessions = _sessions(scenario, decoded)
+            failures += _check_session(sessions, exp)
+            continue
+        name = exp["message"]
+        seq = by_msg.get(MESSAGE_IDS[name], [])
+        if "count" in exp or "min_count" in exp:
+            t0, t1 = _to_ms(exp.get("from", 0)), _to_ms(exp.get("to", scenario.duration_s))
+            n = sum(1 for t, _ in seq if t0 <= t < t1)
+            if "count" in exp and n != exp["count"]:
+                failures.append(f"{name}: {n} frames in [{exp.get('from', 0)}, {exp.get('to')}) s, expected {exp['count']}")
+            if "min_count" in exp and n < exp["min_count"]:
+                failures.append(f"{name}: {n} frames in [{exp.get('from', 0)}, {exp.get('to')}) s, expected >= {exp['min_count']}")
+        elif "at" in exp:
+            t_at = _to_ms(exp["at"])
+            last = [p for t, p in seq if t <= t_at]
+            if not last or last[-1] is None or not _matches(last[-1], exp):
+                got = getattr(last[-1], exp["field"], None) if last and last[-1] else None
+                failures.append(f"{name}.{exp['field']} at {exp['at']} s = {got}, expected {exp['equals']}")
+        elif "by" in exp:
+            t_by = _to_ms(exp["by"])
+            if not any(p is not None and _matches(p, exp) for t, p in seq if t <= t_by):
+                failures.append(f"{name}.{exp['field']} never {exp['equals']} by {exp['by']} s")
+        else:
+            failures.append(f"{name}: expectation needs 'at', 'by' or 'count'")
+    return failures
+
+
+# ============================================================================
+# Riproduzione in tempo reale
+# ============================================================================
+
+def play_realtime(ticks: Iterable[List[SimFrame]], write: Callable[[str], None],
+                  speed: float = 1.0, tick_ms: int = 100) -> int:
+    """Invia i frame di un generatore di tick al ritmo dell'orologio reale
+
+    Il generatore è lo stesso consumato in tempo virtuale, quindi i frame sono
+    identici; cambia solo il ritmo. Restituisce il numero di frame.
+    """
+    start = time.monotonic()
+    n = 0
+    for i, frames in enumerate(ticks):
+        due = start + i * tick_ms / 1000.0 / speed
+        delay = due - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        for f in frames:
+            write(f.to_line() + "\n")
+        n += len(frames)
+    return n
+
+
+def open_sink(target: str) -> Tuple[Callable[[str], None], Callable[[], None]]:
+    """(write, close) per '-' (stdout), una porta seriale / pty, o un file"""
+    if target == "-":
+        return (lambda line: (sys.stdout.write(line), sys.stdout.flush())), (lambda: None)
+    if target.startswith(("/dev/", "COM")):
+        import serial
+        port = serial.Serial(target, 115200, timeout=0)
+        return (lambda line: port.write(line.encode("ascii"))), port.close
+    f = open(target, "w")
+    return (lambda line: (f.write(line), f.flush())), f.close
+
+
+# ============================================================================
+# Riga di comando
+# ============================================================================
+
+def _collect(paths: List[str]) -> List[str]:
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            files += sorted(os.path.join(p, f) for f in os.listdir(p) if f.endswith(".json"))
+        else:
+            files.append(p)
+    return files
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Run charger simulator scenarios headless")
+    parser.add_argument("scenarios", nargs="+", help="scenario .json files or directories")
+    parser.add_argument("-o", "--output", help="write the frames of the scenario(s) in gateway format")
+    parser.add_argument("--realtime", metavar="TARGET",
+                        help="play the scenario(s) in real time to '-', a serial port/pty or a file")
+    parser.add_argument("--speed", type=float, default=1.0, help="real-time speed factor")
+    args = parser.parse_args(argv)
+
+    if args.realtime:
+        write, close = open_sink(args.realtime)
+        try:
+            for path in _collect(args.scenarios):
+                play_realtime(ScenarioRunner(Scenario.load(path)).ticks(), write, args.speed)
+        except (KeyboardInterrupt, BrokenPipeError):
+            pass
+        finally:
+            close()
+        return 0
+
+    out = open(args.output, "w") if args.output else None
+    failed = 0
+    total_start = time.perf_counter()
+    for path in _collect(args.scenarios):
+        result = ScenarioRunner(Scenario.load(path)).run()
+        status = "PASS" if result.passed else "FAIL"
+        print(f"[{status}] {result.scenario.name}: {len(result.frames)} frames, "
+              f"{result.wall_s * 1000:.1f} ms")
+        for msg in result.failures:
+            print(f"       {msg}")
+        failed += not result.passed
+        if out:
+            for f in result.frames:
+                out.write(f"{f.t_ms / 1000:.3f} {f.to_line()}\n")
+    if out:
+        out.close()
+    print(f"{failed} failed, {time.perf_counter() - total_start:.2f} s")
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
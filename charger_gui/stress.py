@@ -0,0 +1,398 @@
+"""Generatore di carico a saturazione per la pipeline seriale -> parse -> decode -> GUI (POSIX)
+
+    python -m charger_gui.stress                         # bench di tutte le configurazioni senza GUI
+    python -m charger_gui.stress --config gui            # include la vera MainWindow (offscreen)
+    python -m charger_gui.stress --pty                   # alimentatore autonomo per la GUI reale
+
+I frame di tutti gli ID di livello 1-4 vengono scritti su uno pseudo
+terminale alle frequenze nominali per un moltiplicatore (1x .. 100x). Il lato
+di lettura esegue lo stesso codice di framing/parsing di SerialHandler, poi
+gli stadi configurati. Ogni riga porta in coda " #<seq>" (ignorato dalla
+regex della GUI) così si misura il ritardo di ogni frame e si trovano i
+frame persi.
+"""
+
+import os
+import statistics
+import sys
+import threading
+import time
+from dataclasses import dataclass, field, asdict
+from typing import Callable, Dict, List, Optional, Tuple
+
+from .can_decoder import (CANDecoder, CtlPacket, ReqPacket, Tst2Packet, BaudrateType, IdType,
+                          IacControlType, RangeType, EVCModelType, IDSettingType,
+                          FaultCode, FailureLevel)
+from .can_encoder import CANEncoder
+from .bus_load import DEFAULT_PLAN, BusLoadEstimator
+from .serial_protocol import LineFramer, parse_line
+from .charger_state import ChargerStateTable
+from .simulator import ChargerSimulator, ActiveFault, SimFrame
+
+
+MULTIPLIERS = [1, 2, 5, 10, 20, 50, 100]
+
+# Passo sostenibile: nessuna perdita, ritardo limitato che non cresce, UI fluida
+MAX_LAG_P99_S = 0.200
+MAX_LAG_GROWTH_S = 0.050
+MAX_FRAME_TIME_P95_S = 0.033
+
+
+# ============================================================================
+# Sorgente dei frame
+# ============================================================================
+
+def nominal_cycle() -> List[str]:
+    """Un secondo di traffico nominale su tutti gli ID di livello 1-4, in ordine di invio"""
+    sim = ChargerSimulator()
+    sim.state.faults[FaultCode.TEMP_DERATING.value] = ActiveFault(
+        FaultCode.TEMP_DERATING.value, FailureLevel.WARNING, 2, 100, 120)
+
+    payloads: Dict[int, List[int]] = {}
+    for m in DEFAULT_PLAN:
+        if m.can_id != CANDecoder.CAN_ID_CTL:
+            payloads[m.can_id] = sim.encode(m.can_id)
+    payloads[CANDecoder.CAN_ID_CTL] = CANEncoder.encode_ctl(CtlPacket(True, False, 16.0, 420.0, 24.0))
+    payloads[CANDecoder.CAN_ID_REQ] = CANEncoder.encode_req(ReqPacket(True, 0x1D))
+    payloads[CANDecoder.CAN_ID_FLTA] = sim.fault_frames()[0]
+    payloads[CANDecoder.CAN_ID_FLTP] = sim.fault_frames()[0]
+    payloads[CANDecoder.CAN_ID_SW] = sim.encode(CANDecoder.CAN_ID_SW)
+    payloads[CANDecoder.CAN_ID_SN] = sim.encode(CANDecoder.CAN_ID_SN)
+    payloads[CANDecoder.CAN_ID_TST2] = CANEncoder.encode_tst2(Tst2Packet(
+        BaudrateType.BAUDRATE_500KBIT, IdType.STANDARD_11BIT, IacControlType.ID618,
+        RangeType.R4_EVO_USERS, False, False, EVCModelType.EVO11K,
+        IDSettingType.SINGLE_CHARGER, False, False, 32.0, 450.0, 25.0, 0))
+
+    # Anche gli stream di livello 3 attivi; i messaggi su richiesta una volta al secondo
+    periods_ms = {m.can_id: int(m.period_ms) for m in DEFAULT_PLAN}
+    events: List[Tuple[int, int, str]] = []
+    for can_id, data in payloads.items():
+        period = periods_ms.get(can_id, 1000)
+        line = SimFrame(0, can_id, data, direction="Tx" if can_id in (
+            CANDecoder.CAN_ID_CTL, CANDecoder.CAN_ID_REQ) else "Rx").to_line()
+        for t in range(0, 1000, period):
+            events.append((t, can_id, line))
+    # Un frame troncato al secondo (DLC 2): deve essere scartato da solo
+    events.append((500, CANDecoder.CAN_ID_ACT1,
+                   SimFrame(0, CANDecoder.CAN_ID_ACT1, [0x01, 0x02]).to_line()))
+    events.sort()
+    return [line for _, _, line in events]
+
+
+# ============================================================================
+# Alimentatore (lato scrittura del pty)
+# ============================================================================
+
+class Feeder(threading.Thread):
+    """Scrive il ciclo a rate frame/s; non bloccante, un link pieno perde frame"""
+
+    def __init__(self, fd: int, cycle: List[str]):
+        super().__init__(daemon=True)
+        self.fd = fd
+        self.cycle = cycle
+        self.rate = 0.0
+        self.seq = 0
+        self.sent_at: List[float] = []          # istante di invio previsto per seq
+        self.overrun: set = set()               # seq che non sono entrate nel link
+        self._pending = b""                     # coda di una riga scritta a metà
+        self._start = 0.0
+        self._base_seq = 0
+        self._lock = threading.Lock()
+        self.running = True
+
+    def set_rate(self, rate: float):
+        with self._lock:
+            self.rate = rate
+            self._start = time.monotonic()
+            self._base_seq = self.seq
+
+    def run(self):
+        os.set_blocking(self.fd, False)
+        n_cycle = len(self.cycle)
+        while self.running:
+            time.sleep(0.001)
+            with self._lock:
+                if self.rate <= 0:
+                    continue
+                now = time.monotonic()
+                due = self._base_seq + int((now - self._start) * self.rate)
+                interval = 1.0 / self.rate
+                chunk = []
+                first = self.seq
+                while self.seq < due:
+                    self.sent_at.append(self._start + (self.seq - self._base_seq) * interval)
+                    chunk.append(f"{self.cycle[self.seq % n_cycle]} #{self.seq}\n")
+                    self.seq += 1
+            if chunk:
+                self._write(first, chunk)
+
+    def _write(self, first_seq: int, lines: List[str]):
+        try:
+            if self._pending:
+                n = os.write(self.fd, self._pending)
+                self._pending = self._pending[n:]
+                if self._pending:
+                    raise BlockingIOError
+            data = "".join(lines).encode("ascii")
+            n = os.write(self.fd, data)
+        except BlockingIOError:
+            self.overrun.update(range(first_seq, first_seq + len(lines)))
+            return
+        if n < len(data):
+            # Completa più tardi la riga spezzata, scarta le successive
+            written_lines = data[:n].count(b"\n")
+            cut = data.index(b"\n", n) + 1
+            self._pending = data[n:cut]
+            self.overrun.update(range(first_seq + written_lines + 1, first_seq + len(lines)))
+
+
+# ============================================================================
+# Pipeline (lato lettura)
+# ============================================================================
+
+@dataclass
+class StepResult:
+    multiplier: int
+    target_fps: float
+    sent: int
+    overrun: int
+    lost: int
+    received: int
+    lag_p50_ms: float
+    lag_p99_ms: float
+    lag_growth_ms: float
+    frame_time_p95_ms: float
+    frame_time_max_ms: float
+
+    @property
+    def sustainable(self) -> bool:
+        return (self.overrun == 0 and self.lost == 0
+                and self.lag_p99_ms <= MAX_LAG_P99_S * 1000
+                and self.lag_growth_ms <= MAX_LAG_GROWTH_S * 1000
+                and self.frame_time_p95_ms <= MAX_FRAME_TIME_P95_S * 1000)
+
+
+@dataclass
+class ConfigReport:
+    config: str
+    poll_ms: float
+    steps: List[StepResult] = field(default_factory=list)
+
+    @property
+    def max_sustainable_fps(self) -> float:
+        ok = [s.target_fps for s in self.steps if s.sustainable]
+        return max(ok) if ok else 0.0
+
+
+def _decode(msg):
+    """Come SerialHandler: un frame non decodificabile diventa None"""
+    try:
+        return CANDecoder.decode_bus_message(msg.can_id, msg.extended, msg.data)
+    except ValueError:
+        return None
+
+
+def _stage_parse() -> Callable:
+    return lambda msg: None
+
+
+def _stage_decode() -> Callable:
+    estimator = BusLoadEstimator()
+
+    def stage(msg):
+        estimator.add_frame(msg.timestamp, msg.can_id, msg.data, msg.extended)
+        _decode(msg)
+    return stage
+
+
+def _stage_state() -> Callable:
+    """decode + pubblicazione nel ChargerState condiviso, un consumatore che fa snapshot a 30 Hz"""
+    estimator = BusLoadEstimator()
+    table = ChargerStateTable()
+
+    def consumer():
+        while True:
+            table.snapshot(1)
+            time.sleep(1 / 30)
+    threading.Thread(target=consumer, daemon=True).start()
+
+    def stage(msg):
+        estimator.add_frame(msg.timestamp, msg.can_id, msg.data, msg.extended)
+        decoded = _decode(msg)
+        if decoded is not None and decoded[2] is not None:
+            table.publish([(decoded[1], decoded[0], decoded[2], msg.timestamp)])
+    return stage
+
+
+def _stage_gui() -> Tuple[Callable, Callable]:
+    """MainWindow reale, offscreen: decode (come il thread seriale) + on_message_received + gestione eventi"""
+    os.environ.setdefault("QT_QPA_PLATFORM", "offscreen")
+    from PyQt6.QtWidgets import QApplication
+    from .main import MainWindow
+    app = QApplication.instance() or QApplication(sys.argv)
+    window = MainWindow()
+    window.show()
+
+    def stage(msg):
+        window.on_message_received(msg, _decode(msg))
+    return stage, app.processEvents
+
+
+CONFIGS = {
+    "parse": "framing + regex parse (SerialHandler thread only)",
+    "decode": "parse + bus load + decode_bus_message",
+    "state": "decode + ChargerState publish, 30 Hz snapshot reader",
+    "gui": "decode + MainWindow dispatch + Qt event loop (needs PyQt6)",
+}
+
+
+def run_config(config: str, poll_ms: float, multipliers: List[int], step_s: float,
+               cycle: List[str], log: Callable[[str], None] = print) -> ConfigReport:
+    import tty
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    os.set_blocking(slave, False)
+
+    pump = lambda: None
+    if config == "parse":
+        stage = _stage_parse()
+    elif config == "decode":
+        stage = _stage_decode()
+    elif config == "state":
+        stage = _stage_state()
+    else:
+        stage, pump = _stage_gui()
+
+    feeder = Feeder(master, cycle)
+    feeder.start()
+    framer = LineFramer()
+    received_at: Dict[int, float] = {}
+    report = ConfigReport(config, poll_ms)
+
+    def read_for(duration: float, frame_times: List[float]):
+        end = time.monotonic() + duration
+        while time.monotonic() < end:
+            time.sleep(poll_ms / 1000.0)
+            t0 = time.monotonic()
+            try:
+                data = os.read(slave, 1 << 16)
+            except BlockingIOError:
+                data = b""
+            for line in framer.feed(data.decode("ascii", errors="ignore")):
+                msg = parse_line(line)
+                if msg is None:
+                    continue
+                stage(msg)
+                received_at[int(line.rsplit("#", 1)[1])] = time.monotonic()
+            pump()
+            frame_times.append(time.monotonic() - t0)
+
+    try:
+        for mult in multipliers:
+            rate = mult * len(cycle)
+            first_seq = feeder.seq
+            frame_times: List[float] = []
+            feeder.set_rate(rate)
+            read_for(step_s, frame_times)
+            feeder.set_rate(0)
+            last_seq = feeder.seq
+            read_for(min(2.0, step_s), frame_times)      # svuota
+
+            seqs = range(first_seq, last_seq)
+            overrun = sum(1 for s in seqs if s in feeder.overrun)
+            lags = [received_at[s] - feeder.sent_at[s] for s in seqs if s in received_at]
+            lost = len(seqs) - overrun - len(lags)
+            q = max(1, len(lags) // 4)
+            growth = (statistics.median(lags[-q:]) - statistics.median(lags[:q])) if lags else 0.0
+            lags_sorted = sorted(lags)
+            ft = sorted(frame_times)
+            result = StepResult(
+                multiplier=mult, target_fps=rate, sent=len(seqs), overrun=overrun, lost=lost,
+                received=len(lags),
+                lag_p50_ms=1000 * lags_sorted[len(lags_sorted) // 2] if lags else 0.0,
+                lag_p99_ms=1000 * lags_sorted[int(len(lags_sorted) * 0.99)] if lags else 0.0,
+                lag_growth_ms=1000 * growth,
+                frame_time_p95_ms=1000 * ft[int(len(ft) * 0.95)] if ft else 0.0,
+                frame_time_max_ms=1000 * ft[-1] if ft else 0.0)
+            report.steps.append(result)
+            log(f"  {config:<6} poll {poll_ms:4.1f} ms  {mult:3d}x {rate:7.0f} fps  "
+                f"sent {result.sent:7d}  overrun {result.overrun:6d}  lost {result.lost:6d}  "
+                f"lag p50 {result.lag_p50_ms:7.1f} p99 {result.lag_p99_ms:7.1f} "
+                f"growth {result.lag_growth_ms:7.1f} ms  frame p95 {result.frame_time_p95_ms:6.1f} ms  "
+                f"{'OK' if result.sustainable else 'SATURATED'}")
+            if not result.sustainable and result.lag_growth_ms > 2000:
+                break       # ben oltre il ginocchio: i passi successivi durano solo di più
+    finally:
+        feeder.running = False
+        feeder.join(1.0)
+        os.close(master)
+        os.close(slave)
+    return report
+
+
+def standalone_pty(multipliers: List[int], step_s: float, cycle: List[str]):
+    """Solo alimentatore: la GUI reale si collega al pty stampato"""
+    import tty
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print(f"Connect the GUI to {os.ttyname(slave)} (Ctrl+C to stop)")
+    feeder = Feeder(master, cycle)
+    feeder.start()
+    try:
+        while True:
+            for mult in multipliers:
+                first, overrun_before = feeder.seq, len(feeder.overrun)
+                feeder.set_rate(mult * len(cycle))
+                time.sleep(step_s)
+                print(f"{mult:3d}x {mult * len(cycle):7.0f} fps: sent {feeder.seq - first}, "
+                      f"overrun {len(feeder.overrun) - overrun_before}")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        feeder.running = False
+        os.close(master)
+        os.close(slave)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    import json
+    parser = argparse.ArgumentParser(description="Ramp the frame rate until the pipeline saturates")
+    parser.add_argument("--config", action="append", choices=sorted(CONFIGS),
+                        help="pipeline configuration(s), default: parse and decode")
+    parser.add_argument("--poll", type=float, action="append",
+                        help="reader poll period in ms (SerialHandler uses 10), repeatable")
+    parser.add_argument("--step", type=float, default=2.0, help="seconds per rate step")
+    parser.add_argument("--max", type=int, default=100, help="highest multiplier")
+    parser.add_argument("--json", help="write the report as JSON")
+    parser.add_argument("--pty", action="store_true", help="standalone pty feeder for the real GUI")
+    args = parser.parse_args(argv)
+
+    cycle = nominal_cycle()
+    multipliers = [m for m in MULTIPLIERS if m <= args.max]
+    if args.pty:
+        standalone_pty(multipliers, args.step, cycle)
+        return 0
+
+    print(f"Nominal traffic: {len(cycle)} frames/s on {len(set(c.split()[2] for c in cycle))} IDs")
+    reports = []
+    for config in args.config or ["parse", "decode"]:
+        for poll in args.poll or [10.0]:
+            print(f"{config}: {CONFIGS[config]}")
+            reports.append(run_config(config, poll, multipliers, args.step, cycle))
+
+    print("\nMaximum sustainable rate")
+    for r in reports:
+        print(f"  {r.config:<6} poll {r.poll_ms:4.1f} ms: {r.max_sustainable_fps:7.0f} fps "
+              f"({r.max_sustainable_fps / len(cycle):.0f}x nominal)")
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump([{"config": r.config, "poll_ms": r.poll_ms,
+                        "max_sustainable_fps": r.max_sustainable_fps,
+                        "steps": [dict(asdict(s), sustainable=s.sustainable) for s in r.steps]}
+                       for r in reports], f, indent=2)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
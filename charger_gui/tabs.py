@@ -1,10 +1,12 @@
 from PyQt6.QtGui import QFont
 from PyQt6.QtWidgets import (QWidget, QVBoxLayout, QHBoxLayout, QScrollArea, 
                               QFrame, QPushButton, QLabel, QGridLayout, QMessageBox)
-from PyQt6.QtCore import Qt
+from PyQt6.QtCore import Qt, pyqtSignal
 from .widgets import (ParameterDisplay, BooleanIndicator, GroupPanel, 
                       MessageInfoPanel, FaultListWidget, RawDataDisplay)
 from .can_decoder import *
+from .fault_table import fault_info
+from .fault_poller import FaultDiff, FaultList
 
 
 class Level1Tab(QWidget):
@@ -182,27 +184,27 @@ class Level1Tab(QWidget):
         main_layout.addWidget(scroll)
         self.setLayout(main_layout)
 
-    def update_ctl(self,packet: CtlPacket, can_id:int, raw_data:list):
+    def update_ctl(self,packet: CtlPacket, can_id:int, raw_data:list, extended: bool = False):
         "Aggiorna info CTL trasmesse BMS -> Charger"
-        self.ctl_info.update_info(can_id,"CTL - Control Values")
+        self.ctl_info.update_info(can_id,"CTL - Control Values", extended)
         self.ctl_iac.set_value(packet.iac_max_A)
         self.ctl_vout.set_value(packet.vout_max_V)
         self.ctl_iOut.set_value(packet.iout_max_A)
         self.ctl_can.set_state(packet.can_enable)
         self.ctl_led3.set_state(packet.led3_enable)
 
-    def update_act1(self, packet: Act1Packet, can_id: int, raw_data: list):
+    def update_act1(self, packet: Act1Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update ACT1 display"""
-        self.act1_info.update_info(can_id, "ACT1 - Actual Values 1")
+        self.act1_info.update_info(can_id, "ACT1 - Actual Values 1", extended)
         self.act1_iac.set_value(packet.iac_A)
         self.act1_temp.set_value(packet.temp_C)
         self.act1_vout.set_value(packet.vout_V)
         self.act1_iout.set_value(packet.iout_A)
         self.act1_raw.update_data(raw_data)
     
-    def update_stat(self, packet: StatPacket, can_id: int, raw_data: list):
+    def update_stat(self, packet: StatPacket, can_id: int, raw_data: list, extended: bool = False):
         """Update STAT display"""
-        self.stat_info.update_info(can_id, "STAT - Status")
+        self.stat_info.update_info(can_id, "STAT - Status", extended)
         self.stat_power_enable.set_state(packet.power_enable)
         self.stat_error_latch.set_state(packet.error_latch)
         self.stat_warn_limit.set_state(packet.warn_limit)
@@ -214,18 +216,18 @@ class Level1Tab(QWidget):
         # Show/hide info message based on errorLatch state
         self.error_latch_info.setVisible(packet.error_latch)
     
-    def update_act2(self, packet: Act2Packet, can_id: int, raw_data: list):
+    def update_act2(self, packet: Act2Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update ACT2 display"""
-        self.act2_info.update_info(can_id, "ACT2 - Actual Values 2")
+        self.act2_info.update_info(can_id, "ACT2 - Actual Values 2", extended)
         self.act2_temp_loglv.set_value(packet.temp_loglv_C)
         self.act2_ac_power.set_value(packet.ac_power_kW)
         self.act2_prox_limit.set_value(packet.prox_limit_A)
         self.act2_pilot_limit.set_value(packet.pilot_limit_A)
         self.act2_raw.update_data(raw_data)
     
-    def update_tst1(self, packet: Tst1Packet, can_id: int, raw_data: list):
+    def update_tst1(self, packet: Tst1Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update TST1 display"""
-        self.tst1_info.update_info(can_id, "TST1 - Test/Diagnostic")
+        self.tst1_info.update_info(can_id, "TST1 - Test/Diagnostic", extended)
         self.tst1_ack.set_state(packet.ack)
         self.tst1_pr_compl.set_state(packet.pr_compl)
         self.tst1_pwr_ok.set_state(packet.pwr_ok)
@@ -246,6 +248,9 @@ class Level1Tab(QWidget):
 ########################################################################################################
 
 class Level2Tab(QWidget):
+    # Tabella svuotata dall'utente: le prossime risposte complete vanno mostrate di nuovo
+    faults_cleared = pyqtSignal()
+    
     def __init__(self):
         super().__init__()
         self.total_faults = 0
@@ -344,6 +349,7 @@ class Level2Tab(QWidget):
         button_layout.addStretch()
         
         self.fault_list = FaultListWidget()
+        self.fault_list.faults_changed.connect(self._update_fault_counters)
         self.fault_raw = RawDataDisplay()
         
         self.fault_panel.add_widget(self.fault_info)
@@ -389,35 +395,22 @@ class Level2Tab(QWidget):
         main_layout.addWidget(scroll)
         self.setLayout(main_layout)
     
-    def update_fault(self, packet: FaultPacket, can_id: int, raw_data: list):
-        """Update Fault display"""
-        is_active = can_id == 0x61D
-        msg_name = "FLTA - Active Fault" if is_active else "FLTP - Passive Fault"
-        self.fault_info.update_info(can_id, msg_name)
-        
-        if packet:  # Non "No Fault Detected"
-            fault_name = self.get_fault_name(packet.fault_code)
-            level_str = packet.failure_level.name
-            
-            self.fault_list.add_fault(
-                packet.fault_code,
-                fault_name,
-                packet.occurrence,
-                level_str,
-                packet.last_time_h
-            )
-        else:
-            self.fault_list.clear_faults()
-        
+    def apply_fault_diff(self, diff: FaultDiff, passive: FaultList, can_id: int, raw_data: list,
+                         extended: bool = False):
+        """Lista guasti di un charger cambiata (diff dal fault poller, passive = lista FLTP)"""
+        msg_name = "FLTA - Active Fault" if diff.active else "FLTP - Passive Fault"
+        self.fault_info.update_info(can_id, f"{msg_name} - Charger {diff.charger}", extended)
+        self.fault_list.apply_diff(diff, passive)
+        
+        # I contatori seguono la tabella (a blocchi, vedi FaultListWidget.faults_changed)
         self.fault_raw.update_data(raw_data)
-        self._update_fault_counters()
     
-    def update_software(self, packet: SoftwarePacket, can_id: int, raw_data: list):
+    def update_software(self, packet: SoftwarePacket, can_id: int, raw_data: list, extended: bool = False):
         """Update Software Version display"""
         self.sw_version_value.setText(f"v{packet.version}")
         self.sw_raw.update_data(raw_data)
     
-    def update_serial(self, packet: SerialNumberPacket, can_id: int, raw_data: list):
+    def update_serial(self, packet: SerialNumberPacket, can_id: int, raw_data: list, extended: bool = False):
         """Update Serial Number display"""
         self.sn_number_value.setText(packet.serial)
         self.sn_raw.update_data(raw_data)
@@ -443,6 +436,7 @@ class Level2Tab(QWidget):
         if reply == QMessageBox.StandardButton.Yes:
             self.fault_list.clear_faults()
             self._update_fault_counters()
+            self.faults_cleared.emit()
             QMessageBox.information(
                 self,
                 "Faults Cleared",
@@ -477,23 +471,7 @@ class Level2Tab(QWidget):
     
     @staticmethod
     def get_fault_name(code: int) -> str:
-        fault_names = {
-            0xA0: "Bulk1 Voltage",
-            0xA1: "Bulk2 Voltage",
-            0xA2: "Bulk3 Voltage",
-            0xA3: "Bulk Error",
-            0xA4: "CAN Registers",
-            0xA5: "CAN Command",
-            0xA6: "Temp Low",
-            0xA7: "Temp Derating",
-            0xA8: "Temp High",
-            0xA9: "Temp Failed",
-            0xAA: "Input Current Max",
-            0xAB: "HVIL Interlock",
-            0xAC: "Logic Temp",
-            0xAD: "Output Overvolt"
-        }
-        return fault_names.get(code, f"Unknown (0x{code:02X})")
+        return fault_info(code).label
 
 
 ########################################################################################################
@@ -643,9 +621,9 @@ class Level3Tab(QWidget):
         main_layout.addWidget(scroll)
         self.setLayout(main_layout)
     
-    def update_act3(self, packet: Act3Packet, can_id: int, raw_data: list):
+    def update_act3(self, packet: Act3Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update ACT3 display"""
-        self.act3_info.update_info(can_id, "ACT3 - AC Currents")
+        self.act3_info.update_info(can_id, "ACT3 - AC Currents", extended)
         self.act3_fan_voltage.set_value(packet.fan_voltage_V)
         self.act3_iacm1.set_value(packet.iacm1_A)
         self.act3_iacm2.set_value(packet.iacm2_A)
@@ -657,9 +635,9 @@ class Level3Tab(QWidget):
         # Update summary
         self.current_status_label.setText(f"AC Current: {total_current:.1f}A")
     
-    def update_temp(self, packet: TempPacket, can_id: int, raw_data: list):
+    def update_temp(self, packet: TempPacket, can_id: int, raw_data: list, extended: bool = False):
         """Update TEMP display"""
-        self.temp_info.update_info(can_id, "TEMP - Temperatures")
+        self.temp_info.update_info(can_id, "TEMP - Temperatures", extended)
         self.temp_loghv.set_value(packet.temp_loghv_C)
         self.temp_power1.set_value(packet.temp_power1_C)
         self.temp_power2.set_value(packet.temp_power2_C)
@@ -673,9 +651,9 @@ class Level3Tab(QWidget):
         self.temp_status_label.setText(f"Max Temp: {max_temp:.1f}°C")
         self.temp_status_label.setStyleSheet(f"color: white; padding: 5px 10px; background-color: {temp_color}; border-radius: 3px; font-weight: bold;")
     
-    def update_stst1(self, packet: Stst1Packet, can_id: int, raw_data: list):
+    def update_stst1(self, packet: Stst1Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update STST1 display"""
-        self.stst1_info.update_info(can_id, "STST1 - Real Time Diagnostic")
+        self.stst1_info.update_info(can_id, "STST1 - Real Time Diagnostic", extended)
         self.stst1_pfc_enable.set_state(packet.pfc_enable)
         self.stst1_log_temp_high.set_state(packet.log_temp_high)
         self.stst1_log_temp_low.set_state(packet.log_temp_low)
@@ -687,9 +665,9 @@ class Level3Tab(QWidget):
         self.stst1_cooling_fail3.set_state(packet.cooling_fail3)
         self.stst1_raw.update_data(raw_data)
     
-    def update_act4(self, packet: Act4Packet, can_id: int, raw_data: list):
+    def update_act4(self, packet: Act4Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update ACT4 display"""
-        self.act4_info.update_info(can_id, "ACT4 - Temperature FAN")
+        self.act4_info.update_info(can_id, "ACT4 - Temperature FAN", extended)
         self.act4_temp_logfan.set_value(packet.temp_logfan_C)
         self.act4_raw.update_data(raw_data)
 
@@ -815,9 +793,9 @@ class Level4Tab(QWidget):
         main_layout.addWidget(scroll)
         self.setLayout(main_layout)
     
-    def update_tst2(self, packet: Tst2Packet, can_id: int, raw_data: list):
+    def update_tst2(self, packet: Tst2Packet, can_id: int, raw_data: list, extended: bool = False):
         """Update TST2 display"""
-        self.tst2_info.update_info(can_id, "TST2 - Configuration")
+        self.tst2_info.update_info(can_id, "TST2 - Configuration", extended)
         
         # Update config status
         if not self.config_received:
@@ -0,0 +1,535 @@
+"""Dashboard web: server HTTP + WebSocket che invia ai browser le differenze dei segnali
+
+    python -m charger_gui.web_dashboard --sim                   # carica simulata su 127.0.0.1:8765
+    python -m charger_gui.web_dashboard --sim --host 0.0.0.0 --speed 10
+    python -m charger_gui.web_dashboard --bench                 # 40 client su una carica simulata
+
+La GUI avvia lo stesso server da Tools > Web dashboard sulla propria
+ChargerStateTable. Si usa solo la libreria standard (asyncio, un thread).
+
+Il thread seriale non è mai coinvolto: un task di campionamento legge lo
+snapshot seqlock di ogni charger con almeno un client, al massimo
+RATE_HZ volte al secondo, e si riguardano solo i messaggi il cui conteggio è
+cambiato. I segnali cambiati si codificano UNA volta in un diff binario e
+gli stessi byte si scrivono a ogni client, quindi ogni client costa solo una
+scrittura sul socket.
+
+Messaggi binari (little endian):
+
+    header   u8 tipo (0 = keyframe, 1 = diff), u8 charger, u16 n,
+             u32 tempo del server [ms], u32 versione dello snapshot (frame finora)
+    n x      u16 indice del segnale, f32 valore
+
+Gli indici dei segnali sono quelli di /signals.json (messaggi di STATE_IDS,
+campi ASCII esclusi). Versione software e numero di serie viaggiano come
+messaggio di testo JSON quando cambiano. Un client con il buffer del socket
+sopra MAX_BUFFER salta i diff e riceve un keyframe appena si è svuotato,
+così un tablet lento non rallenta mai gli altri. Ogni HEARTBEAT_S si invia
+un diff con n = 0 come keep alive.
+"""
+
+import asyncio
+import base64
+import hashlib
+import json
+import os
+import struct
+import sys
+import threading
+import time
+from typing import Dict, List, Optional, Tuple
+from urllib.parse import parse_qs, urlsplit
+
+from .charger_state import MAX_CHARGERS, STATE_IDS, ChargerState, ChargerStateTable
+from .signals import ASCII, BOOL, ENUM, SIGNALS
+from .simulator import MESSAGE_IDS
+
+DEFAULT_HOST = "127.0.0.1"
+DEFAULT_PORT = 8765
+RATE_HZ = 10.0                  # Diff al secondo al massimo
+HEARTBEAT_S = 1.0
+MAX_BUFFER = 64 * 1024          # Byte in coda su un client prima di risincronizzarlo
+MAX_CLIENT_FRAME = 4096         # Frame più grandi da un browser chiudono la connessione
+STATIC_PAGE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "dashboard.html")
+
+KEYFRAME, DIFF = 0, 1
+HEADER = struct.Struct("<BBHII")
+ENTRY = struct.Struct("<Hf")
+WS_GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+_NAMES = {base: name for name, base in MESSAGE_IDS.items()}
+
+
+# ============================================================================
+# Catalogo dei segnali
+# ============================================================================
+
+def _catalog():
+    """(voci JSON, per slot di stato [(indice, attributo, tipo)], attributi ASCII per slot)"""
+    entries = []
+    numeric: List[List[Tuple[int, str, str]]] = [[] for _ in STATE_IDS]
+    text: List[List[str]] = [[] for _ in STATE_IDS]
+    for slot, base in enumerate(STATE_IDS):
+        for sig in SIGNALS.get(base, ()):
+            if sig.kind == ASCII:
+                text[slot].append(sig.name)
+                continue
+            entry = {"i": len(entries), "msg": _NAMES[base], "name": sig.name, "unit": sig.unit, "kind": sig.kind}
+            if sig.enum is not None:
+                entry["enum"] = {str(m.value): m.name for m in sig.enum}
+            numeric[slot].append((len(entries), sig.name, sig.kind))
+            entries.append(entry)
+    return entries, numeric, text
+
+
+CATALOG, SLOT_SIGNALS, SLOT_TEXT = _catalog()
+
+
+def _value(v, kind: str) -> float:
+    if kind == BOOL:
+        return 1.0 if v else 0.0
+    if kind == ENUM:
+        return float(v.value)
+    return float(v)
+
+
+def encode(kind: int, charger: int, t_ms: int, version: int, items: List[Tuple[int, float]]) -> bytes:
+    out = bytearray(HEADER.size + ENTRY.size * len(items))
+    HEADER.pack_into(out, 0, kind, charger, len(items), t_ms & 0xFFFFFFFF, version & 0xFFFFFFFF)
+    offset = HEADER.size
+    for index, value in items:
+        ENTRY.pack_into(out, offset, index, value)
+        offset += ENTRY.size
+    return bytes(out)
+
+
+def decode(message: bytes) -> Tuple[int, int, int, int, Dict[int, float]]:
+    """(tipo, charger, t_ms, versione, indice -> valore): quello che fa la pagina web in JavaScript"""
+    kind, charger, n, t_ms, version = HEADER.unpack_from(message, 0)
+    values = dict(ENTRY.iter_unpack(message[HEADER.size:HEADER.size + n * ENTRY.size]))
+    return kind, charger, t_ms, version, values
+
+
+# ============================================================================
+# WebSocket (RFC 6455, solo lato server)
+# ============================================================================
+
+def ws_frame(opcode: int, payload: bytes) -> bytes:
+    n = len(payload)
+    if n < 126:
+        head = struct.pack("!BB", 0x80 | opcode, n)
+    elif n < 1 << 16:
+        head = struct.pack("!BBH", 0x80 | opcode, 126, n)
+    else:
+        head = struct.pack("!BBQ", 0x80 | opcode, 127, n)
+    return head + payload
+
+
+async def ws_read(reader: asyncio.StreamReader) -> Tuple[int, bytes]:
+    """(opcode, payload) di un frame del client; un browser non invia frammenti"""
+    b0, b1 = await reader.readexactly(2)
+    n = b1 & 0x7F
+    if n == 126:
+        n = struct.unpack("!H", await reader.readexactly(2))[0]
+    elif n == 127:
+        n = struct.unpack("!Q", await reader.readexactly(8))[0]
+    if n > MAX_CLIENT_FRAME:
+        raise ConnectionError(f"client frame of {n} bytes")
+    mask = await reader.readexactly(4) if b1 & 0x80 else b"\0\0\0\0"
+    data = await reader.readexactly(n)
+    return b0 & 0x0F, bytes(b ^ mask[i & 3] for i, b in enumerate(data))
+
+
+def ws_accept(key: str) -> str:
+    return base64.b64encode(hashlib.sha1(key.encode() + WS_GUID).digest()).decode()
+
+
+# ============================================================================
+# Invio a tutti i client
+# ============================================================================
+
+class Client:
+    def __init__(self, writer: asyncio.StreamWriter, charger: int):
+        self.writer = writer
+        self.charger = charger
+        self.needs_key = True       # Fino al primo keyframe, e dopo un overflow
+
+    def send(self, data: bytes):
+        self.writer.write(data)
+
+    @property
+    def backlog(self) -> int:
+        return self.writer.transport.get_write_buffer_size()
+
+
+class Broadcaster:
+    """Ultimi valori di un charger e i suoi client"""
+
+    def __init__(self, state: ChargerState, clock):
+        self.state = state
+        self.clock = clock
+        self.clients: List[Client] = []
+        self.values: List[Optional[float]] = [None] * len(CATALOG)
+        self.text: Dict[str, str] = {}
+        self.counts = (0,) * len(STATE_IDS)
+        self.version = -1
+        self.last_sent = 0.0
+        self.bytes_sent = 0
+
+    def keyframe(self) -> bytes:
+        items = [(i, v) for i, v in enumerate(self.values) if v is not None]
+        return ws_frame(0x2, encode(KEYFRAME, self.state.charger, self.clock(), max(self.version, 0), items))
+
+    def _info(self) -> bytes:
+        return ws_frame(0x1, json.dumps(self.text).encode())
+
+    def _resync(self, client: Client):
+        data = self.keyframe() + (self._info() if self.text else b"")
+        client.send(data)
+        client.needs_key = False
+        self.bytes_sent += len(data)
+
+    def tick(self, now: float):
+        snap = self.state.snapshot()
+        changed: List[Tuple[int, float]] = []
+        info = False
+        if snap.version != self.version:
+            if snap.version < self.version:     # Stato azzerato: si ricomincia
+                self.values = [None] * len(CATALOG)
+                self.text = {}
+                self.counts = (0,) * len(STATE_IDS)
+                for c in self.clients:
+                    c.needs_key = True
+            values = self.values
+            for slot, (count, seen) in enumerate(zip(snap.counts, self.counts)):
+                if count == seen:
+                    continue
+                packet = snap.packets[slot]
+                if packet is None:          # clear()
+                    continue
+                for index, attr, kind in SLOT_SIGNALS[slot]:
+                    v = _value(getattr(packet, attr), kind)
+                    if v != values[index]:
+                        values[index] = v
+                        changed.append((index, v))
+                for attr in SLOT_TEXT[slot]:
+                    s = str(getattr(packet, attr)).strip()
+                    if self.text.get(attr) != s:
+                        self.text[attr] = s
+                        info = True
+            self.counts, self.version = snap.counts, snap.version
+
+        data = b""
+        if changed or now - self.last_sent >= HEARTBEAT_S:
+            data = ws_frame(0x2, encode(DIFF, snap.charger, self.clock(), snap.version, changed))
+            if info:
+                data += self._info()
+            self.last_sent = now
+        for client in self.clients:
+            backlog = client.backlog
+            if client.needs_key:
+                if backlog < MAX_BUFFER // 2:
+                    self._resync(client)
+            elif backlog > MAX_BUFFER:
+                client.needs_key = True
+            elif data:
+                client.send(data)
+                self.bytes_sent += len(data)
+
+
+class DashboardServer:
+    """Thread del server su una ChargerStateTable; start() ritorna quando il socket è in ascolto"""
+
+    def __init__(self, state: ChargerStateTable, host: str = DEFAULT_HOST, port: int = DEFAULT_PORT,
+                 rate_hz: float = RATE_HZ):
+        self.state = state
+        self.host = host
+        self.port = port
+        self.rate_hz = rate_hz
+        self.broadcasters: Dict[int, Broadcaster] = {}
+        self.ticks = 0
+        self.tick_s = 0.0           # Tempo speso nel campionamento
+        self._t0 = time.monotonic()
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
+        self._stop: Optional[asyncio.Event] = None
+        self._thread: Optional[threading.Thread] = None
+        self._ready = threading.Event()
+        self._error: Optional[BaseException] = None
+        with open(STATIC_PAGE, "rb") as f:
+            self._page = f.read()
+        self._catalog = json.dumps({"signals": CATALOG, "rate_hz": rate_hz,
+                                    "chargers": MAX_CHARGERS}).encode()
+
+    @property
+    def url(self) -> str:
+        host = "localhost" if self.host in ("127.0.0.1", "0.0.0.0", "") else self.host
+        return f"http://{host}:{self.port}/"
+
+    @property
+    def clients(self) -> int:
+        return sum(len(b.clients) for b in self.broadcasters.values())
+
+    @property
+    def bytes_sent(self) -> int:
+        return sum(b.bytes_sent for b in self.broadcasters.values())
+
+    def _clock(self) -> int:
+        return int((time.monotonic() - self._t0) * 1000)
+
+    # ---- thread ----
+
+    def start(self):
+        self._thread = threading.Thread(target=self._run, name="web-dashboard", daemon=True)
+        self._thread.start()
+        self._ready.wait()
+        if self._error is not None:
+            raise self._error
+
+    def stop(self):
+        if self._loop is not None and self._stop is not None:
+            self._loop.call_soon_threadsafe(self._stop.set)
+        if self._thread is not None:
+            self._thread.join(5.0)
+            self._thread = None
+
+    def _run(self):
+        try:
+            asyncio.run(self._main())
+        except BaseException as e:     # Riportato da start() se il socket non è mai partito
+            self._error = e
+            self._ready.set()
+
+    async def _main(self):
+        self._loop = asyncio.get_running_loop()
+        self._stop = asyncio.Event()
+        server = await asyncio.start_server(self._handle, self.host, self.port)
+        self.port = server.sockets[0].getsockname()[1]
+        self._ready.set()
+        sampler = asyncio.create_task(self._sampler())
+        async with server:
+            await self._stop.wait()
+        sampler.cancel()
+        for b in self.broadcasters.values():
+            for c in b.clients:
+                c.writer.close()
+
+    async def _sampler(self):
+        period = 1.0 / self.rate_hz
+        while True:
+            start = time.perf_counter()
+            now = time.monotonic()
+            for b in self.broadcasters.values():
+                if b.clients:
+                    b.tick(now)
+            self.ticks += 1
+            elapsed = time.perf_counter() - start
+            self.tick_s += elapsed
+            await asyncio.sleep(max(0.0, period - elapsed))
+
+    # ---- HTTP ----
+
+    async def _handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        try:
+            head = await asyncio.wait_for(reader.readuntil(b"\r\n\r\n"), 10.0)
+            lines = head.decode("latin-1").split("\r\n")
+            method, target, _version = lines[0].split(" ", 2)
+            headers = {}
+            for line in lines[1:]:
+                if ":" in line:
+                    k, v = line.split(":", 1)
+                    headers[k.strip().lower()] = v.strip()
+            url = urlsplit(target)
+            if method != "GET":
+                self._reply(writer, "405 Method Not Allowed", "text/plain", b"GET only\n")
+            elif url.path == "/ws" and headers.get("upgrade", "").lower() == "websocket":
+                await self._websocket(reader, writer, headers, parse_qs(url.query))
+                return
+            elif url.path in ("/", "/index.html"):
+                self._reply(writer, "200 OK", "text/html; charset=utf-8", self._page)
+            elif url.path == "/signals.json":
+                self._reply(writer, "200 OK", "application/json", self._catalog)
+            else:
+                self._reply(writer, "404 Not Found", "text/plain", b"not found\n")
+            await writer.drain()
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, asyncio.TimeoutError,
+                ConnectionError, ValueError):
+            pass
+        finally:
+            writer.close()
+
+    @staticmethod
+    def _reply(writer: asyncio.StreamWriter, status: str, content_type: str, body: bytes):
+        writer.write(f"HTTP/1.1 {status}\r\nContent-Type: {content_type}\r\nContent-Length: {len(body)}\r\n"
+                     f"Cache-Control: no-cache\r\nConnection: close\r\n\r\n".encode() + body)
+
+    async def _websocket(self, reader, writer, headers: Dict[str, str], query: Dict[str, List[str]]):
+        key = headers.get("sec-websocket-key")
+        try:
+            charger = int(query.get("charger", ["1"])[0])
+        except ValueError:
+            charger = 0
+        if not key or not 1 <= charger <= MAX_CHARGERS:
+            self._reply(writer, "400 Bad Request", "text/plain", b"bad websocket request\n")
+            return
+        writer.write(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      f"Sec-WebSocket-Accept: {ws_accept(key)}\r\n\r\n").encode())
+        b = self.broadcasters.get(charger)
+        if b is None:
+            b = self.broadcasters[charger] = Broadcaster(self.state[charger], self._clock)
+        client = Client(writer, charger)
+        b.clients.append(client)
+        try:
+            while True:
+                opcode, payload = await ws_read(reader)
+                if opcode == 0x8:               # Chiusura
+                    writer.write(ws_frame(0x8, payload[:2]))
+                    break
+                if opcode == 0x9:               # Ping
+                    writer.write(ws_frame(0xA, payload))
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            b.clients.remove(client)
+            writer.close()
+
+
+# ============================================================================
+# Sorgente simulata
+# ============================================================================
+
+def feed_simulation(state: ChargerStateTable, stop: threading.Event, speed: float = 1.0,
+                    ambient_C: float = 35.0) -> int:
+    """Frame di charge_sim pubblicati come fa il thread seriale; restituisce i frame pubblicati"""
+    from .charge_sim import ChargeSimulation
+    sim = ChargeSimulation(ambient_C=ambient_C)
+    n = 0
+    start = time.monotonic()
+    for frames in sim.ticks():
+        if stop.is_set():
+            break
+        now = time.monotonic()
+        for f in frames:
+            state.publish_message(f.can_id, f.extended, f.data, now)
+        n += len(frames)
+        if speed > 0:
+            delay = start + f.t_ms / 1000.0 / speed - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+    return n
+
+
+# ============================================================================
+# CLI
+# ============================================================================
+
+def bench(viewers: int = 40, seconds: float = 5.0, speed: float = 20.0) -> bool:
+    """Carica simulata a `speed`x, `viewers` client WebSocket che verificano la loro copia dello stato"""
+    import socket
+
+    table = ChargerStateTable()
+    server = DashboardServer(table, port=0)
+    server.start()
+    stop = threading.Event()
+    feeder = threading.Thread(target=feed_simulation, args=(table, stop, speed))
+    feeder.start()
+
+    received = [0] * viewers
+    states: List[Dict[int, float]] = [{} for _ in range(viewers)]
+    keyframes = [0] * viewers
+
+    async def viewer(k: int, until: float):
+        reader, writer = await asyncio.open_connection("127.0.0.1", server.port)
+        key = base64.b64encode(os.urandom(16)).decode()
+        writer.write(f"GET /ws?charger=1 HTTP/1.1\r\nHost: x\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                     f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n".encode())
+        head = await reader.readuntil(b"\r\n\r\n")
+        assert ws_accept(key).encode() in head, head
+        loop = asyncio.get_running_loop()
+        while loop.time() < until:
+            try:
+                b0, b1 = await asyncio.wait_for(reader.readexactly(2), until - loop.time())
+            except asyncio.TimeoutError:
+                break
+            n = b1 & 0x7F
+            if n == 126:
+                n = struct.unpack("!H", await reader.readexactly(2))[0]
+            payload = await reader.readexactly(n)
+            received[k] += 2 + n
+            if b0 & 0x0F == 0x2:
+                kind, _ch, _t, _v, values = decode(payload)
+                if kind == KEYFRAME:            # Sostituisce l'intero stato
+                    keyframes[k] += 1
+                    states[k] = {}
+                states[k].update(values)
+        writer.write(bytes([0x88, 0x80]) + b"\0\0\0\0")      # Chiusura mascherata
+        writer.close()
+
+    async def viewers_main():
+        loop = asyncio.get_running_loop()
+        until = loop.time() + seconds
+        # La sorgente si ferma poco prima dei client: gli ultimi diff devono arrivare a tutti
+        loop.call_later(max(seconds - 0.5, 0.1), stop.set)
+        await asyncio.gather(*(viewer(k, until) for k in range(viewers)))
+
+    # HTTP semplice: pagina e catalogo
+    with socket.create_connection(("127.0.0.1", server.port)) as s:
+        s.sendall(b"GET /signals.json HTTP/1.1\r\nHost: x\r\n\r\n")
+        body = b""
+        while chunk := s.recv(65536):
+            body += chunk
+    catalog = json.loads(body.split(b"\r\n\r\n", 1)[1])
+
+    asyncio.run(viewers_main())
+    feeder.join()
+    b = server.broadcasters[1]
+    server_values = {i: struct.unpack("<f", struct.pack("<f", v))[0] for i, v in enumerate(b.values) if v is not None}
+    ticks, tick_s = server.ticks, server.tick_s
+    server.stop()
+
+    keyframe = len(b.keyframe())
+    match = sum(1 for st in states if st == server_values)
+    rate = sum(received) / viewers / seconds
+    naive = keyframe * server.rate_hz
+    ok = len(catalog["signals"]) == len(CATALOG) and match == viewers and all(keyframes)
+    print(f"{len(CATALOG)} signals, {viewers} viewers for {seconds:.0f} s, simulated charge at {speed:.0f}x")
+    print(f"  sampler {ticks} ticks, {tick_s / max(ticks, 1) * 1e6:.0f} us/tick for all viewers")
+    print(f"  per viewer {rate / 1e3:.2f} kB/s (full state at {server.rate_hz:.0f} Hz: {naive / 1e3:.2f} kB/s, "
+          f"keyframe {keyframe} B)")
+    print(f"  viewers consistent with the server: {match}/{viewers}  {'OK' if ok else 'FAIL'}")
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="Web dashboard (HTTP + WebSocket)")
+    parser.add_argument("--host", default=DEFAULT_HOST, help="0.0.0.0 to reach it from the hotspot")
+    parser.add_argument("--port", type=int, default=DEFAULT_PORT)
+    parser.add_argument("--rate", type=float, default=RATE_HZ, help="diffs per second at most")
+    parser.add_argument("--sim", action="store_true", help="serve a simulated charge (charge_sim)")
+    parser.add_argument("--speed", type=float, default=1.0, help="simulation speed factor")
+    parser.add_argument("--bench", action="store_true", help="40 viewers on a simulated charge")
+    args = parser.parse_args(argv)
+
+    if args.bench:
+        return 0 if bench() else 1
+    if not args.sim:
+        parser.error("without the GUI the only source is --sim")
+    table = ChargerStateTable()
+    server = DashboardServer(table, args.host, args.port, args.rate)
+    try:
+        server.start()
+    except OSError as e:
+        print(e)
+        return 1
+    print(f"{server.url} (Ctrl+C to stop)")
+    stop = threading.Event()
+    try:
+        feed_simulation(table, stop, args.speed)
+    except KeyboardInterrupt:
+        pass
+    server.stop()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,9 +1,15 @@
 from PyQt6.QtWidgets import (QWidget, QLabel, QVBoxLayout, QHBoxLayout,
-                              QGroupBox, QGridLayout, QFrame)
-from PyQt6.QtCore import Qt, pyqtSignal
+                              QGroupBox, QGridLayout, QFrame, QTableView, QHeaderView,
+                              QAbstractItemView)
+from PyQt6.QtCore import (Qt, pyqtSignal, QAbstractTableModel, QModelIndex,
+                          QSortFilterProxyModel, QTimer)
 from PyQt6.QtGui import QFont, QColor, QPalette
 from datetime import datetime
 
+from .can_decoder import FailureLevel, FaultPacket
+from .fault_model import FaultStore, FaultKey
+from .fault_poller import FaultDiff, FaultList
+
 
 class ParameterDisplay(QWidget):
     """Widget per visualizzare un singolo parametro con label e valore"""
@@ -153,22 +159,153 @@ class MessageInfoPanel(QWidget):
         
         self.setLayout(layout)
     
-    def update_info(self, can_id: int, message_name: str):
+    def update_info(self, can_id: int, message_name: str, extended: bool = False):
+        """can_id: ID sul bus (del charger), extended = 29 bit"""
         self.timestamp_label.setText(f"Last Update: {datetime.now().strftime('%H:%M:%S.%f')[:-3]}")
-        self.can_id_label.setText(f"CAN ID: 0x{can_id:03X} - {message_name}")
+        id_str = f"0x{can_id:08X}" if extended else f"0x{can_id:03X}"
+        self.can_id_label.setText(f"CAN ID: {id_str} - {message_name}")
     
     def reset(self):
         self.timestamp_label.setText("Last Update: ---")
         self.can_id_label.setText("CAN ID: ---")
 
 
+class FaultTableModel(QAbstractTableModel):
+    """Tabella guasti su un FaultStore, aggiornamenti della vista a blocchi ogni FLUSH_MS
+    
+    Gli upsert toccano solo lo store; le righe aggiunte dall'ultimo flush
+    restano nascoste (rowCount) finché flush() non le annuncia con un solo
+    insert e un solo dataChanged per tutte le righe cambiate.
+    """
+    
+    FLUSH_MS = 100
+    COLUMNS = ("Charger", "Code", "Fault", "Level", "State", "Occurrences", "First (h)", "Last (h)")
+    LEVEL_COLUMN = 3
+    
+    LEVEL_COLORS = {
+        FailureLevel.HARD: QColor("#ffcdd2"),
+        FailureLevel.SOFT: QColor("#ffe0b2"),
+        FailureLevel.WARNING: QColor("#fff9c4"),
+    }
+    
+    flushed = pyqtSignal()
+    
+    def __init__(self, parent=None):
+        super().__init__(parent)
+        self.store = FaultStore()
+        self._visible = 0
+        self._dirty_min = None
+        self._dirty_max = None
+        self._timer = QTimer(self)
+        self._timer.setSingleShot(True)
+        self._timer.setInterval(self.FLUSH_MS)
+        self._timer.timeout.connect(self.flush)
+    
+    # ---- aggiornamenti (a blocchi) ----
+    
+    def _mark(self, row: int):
+        if self._dirty_min is None or row < self._dirty_min:
+            self._dirty_min = row
+        if self._dirty_max is None or row > self._dirty_max:
+            self._dirty_max = row
+        if not self._timer.isActive():
+            self._timer.start()
+    
+    def upsert(self, charger: int, packet: FaultPacket, active: bool):
+        row, inserted = self.store.upsert(charger, packet, active)
+        if inserted:
+            if not self._timer.isActive():
+                self._timer.start()
+        else:
+            self._mark(row)
+    
+    def deactivate(self, key: FaultKey):
+        row = self.store.deactivate(key)
+        if row is not None:
+            self._mark(row)
+    
+    def flush(self):
+        self._timer.stop()
+        n = len(self.store)
+        if n > self._visible:
+            self.beginInsertRows(QModelIndex(), self._visible, n - 1)
+            self._visible = n
+            self.endInsertRows()
+        if self._dirty_min is not None:
+            bottom = min(self._dirty_max, self._visible - 1)
+            if self._dirty_min <= bottom:
+                self.dataChanged.emit(self.index(self._dirty_min, 0),
+                                      self.index(bottom, len(self.COLUMNS) - 1))
+            self._dirty_min = self._dirty_max = None
+        self.flushed.emit()
+    
+    # ---- rimozioni (rare: immediate) ----
+    
+    def remove(self, key: FaultKey):
+        self.flush()
+        row = self.store.index.get(key)
+        if row is None:
+            return
+        last = len(self.store) - 1
+        self.beginRemoveRows(QModelIndex(), last, last)
+        self.store.remove(key)
+        self._visible = len(self.store)
+        self.endRemoveRows()
+        if row != last:
+            self.dataChanged.emit(self.index(row, 0), self.index(row, len(self.COLUMNS) - 1))
+        self.flushed.emit()
+    
+    def clear(self):
+        self._timer.stop()
+        self.beginResetModel()
+        self.store.clear()
+        self._visible = 0
+        self._dirty_min = self._dirty_max = None
+        self.endResetModel()
+        self.flushed.emit()
+    
+    # ---- interfaccia modello Qt ----
+    
+    def rowCount(self, parent=QModelIndex()):
+        return 0 if parent.isValid() else self._visible
+    
+    def columnCount(self, parent=QModelIndex()):
+        return 0 if parent.isValid() else len(self.COLUMNS)
+    
+    def headerData(self, section, orientation, role=Qt.ItemDataRole.DisplayRole):
+        if role == Qt.ItemDataRole.DisplayRole and orientation == Qt.Orientation.Horizontal:
+            return self.COLUMNS[section]
+        return None
+    
+    def data(self, index, role=Qt.ItemDataRole.DisplayRole):
+        if not index.isValid() or index.row() >= self._visible:
+            return None
+        rec = self.store.rows[index.row()]
+        col = index.column()
+        if role == Qt.ItemDataRole.DisplayRole:
+            return (rec.charger, f"0x{rec.code:02X}", rec.info.label, rec.level.name,
+                    "Active" if rec.active else "Passive", rec.occurrence,
+                    rec.first_time_h, rec.last_time_h)[col]
+        if role == Qt.ItemDataRole.UserRole:        # Chiave di ordinamento
+            return (rec.charger, rec.code, rec.code, rec.sort_key, int(rec.active),
+                    rec.occurrence, rec.first_time_h, rec.last_time_h)[col]
+        if role == Qt.ItemDataRole.BackgroundRole:
+            return self.LEVEL_COLORS.get(rec.level)
+        if role == Qt.ItemDataRole.ToolTipRole:
+            return rec.info.action + ("\nAC reset required" if rec.info.ac_reset else "")
+        return None
+
+
 class FaultListWidget(QWidget):
-    """Widget per visualizzare lista di fault correnti"""
+    """Widget per visualizzare lista di fault correnti (tutti i charger)"""
+    
+    # Emesso dopo ogni aggiornamento a blocchi della vista (contatori)
+    faults_changed = pyqtSignal()
     
     def __init__(self):
         super().__init__()
-        self.faults = []
-        self.fault_info = []  # Store fault metadata
+        self.model = FaultTableModel(self)
+        self.model.flushed.connect(self._on_flushed)
         self.setup_ui()
     
     def setup_ui(self):
@@ -181,102 +318,71 @@ class FaultListWidget(QWidget):
         font.setPointSize(11)
         title.setFont(font)
         
-        # Fault area
-        self.fault_container = QVBoxLayout()
-        
         # Label "no faults"
         self.no_fault_label = QLabel("No faults detected")
         self.no_fault_label.setStyleSheet("color: green; font-style: italic;")
-        self.fault_container.addWidget(self.no_fault_label)
+        
+        # Tabella: ordinata per gravità, poi ultimo istante (più recente prima)
+        self.proxy = QSortFilterProxyModel(self)
+        self.proxy.setSourceModel(self.model)
+        self.proxy.setSortRole(Qt.ItemDataRole.UserRole)
+        self.proxy.setDynamicSortFilter(True)
+        
+        self.table = QTableView()
+        self.table.setModel(self.proxy)
+        self.table.setSortingEnabled(True)
+        self.table.sortByColumn(FaultTableModel.LEVEL_COLUMN, Qt.SortOrder.DescendingOrder)
+        self.table.setSelectionBehavior(QAbstractItemView.SelectionBehavior.SelectRows)
+        self.table.setEditTriggers(QAbstractItemView.EditTrigger.NoEditTriggers)
+        self.table.verticalHeader().setVisible(False)
+        self.table.horizontalHeader().setSectionResizeMode(2, QHeaderView.ResizeMode.Stretch)
+        self.table.setMinimumHeight(160)
+        self.table.hide()
         
         layout.addWidget(title)
-        layout.addLayout(self.fault_container)
-        layout.addStretch()
+        layout.addWidget(self.no_fault_label)
+        layout.addWidget(self.table)
         
         self.setLayout(layout)
     
-    def add_fault(self, fault_code: int, fault_name: str, occurrence: int, 
-                  failure_level: str, last_time_h: int):
-
-        if self.no_fault_label.parent():
-            self.fault_container.removeWidget(self.no_fault_label)
-            self.no_fault_label.hide()
-        
-        # Store fault metadata (check if already exists)
-        fault_key = (fault_code, fault_name)
-        existing_index = None
-        for i, info in enumerate(self.fault_info):
-            if (info['code'], info['name']) == fault_key:
-                existing_index = i
-                break
-        
-        if existing_index is not None:
-            # Update existing fault
-            self.fault_info[existing_index].update({
-                'occurrence': occurrence,
-                'level': failure_level,
-                'last_time_h': last_time_h
-            })
-            # Update widget display
-            fault_widget = self.faults[existing_index]
-            fault_widget.setTitle(f"Fault 0x{fault_code:02X}: {fault_name}")
-            details_label = fault_widget.findChild(QLabel)
-            if details_label:
-                details_label.setText(
-                    f"Occurrences: {occurrence}\n"
-                    f"Level: {failure_level}\n"
-                    f"Last: {last_time_h}h ago"
-                )
-        else:
-            # Add new fault
-            self.fault_info.append({
-                'code': fault_code,
-                'name': fault_name,
-                'occurrence': occurrence,
-                'level': failure_level,
-                'last_time_h': last_time_h,
-                'is_active': 'HARD' in failure_level.upper()  # Assume HARD = active
-            })
-            
-            fault_widget = QGroupBox(f"Fault 0x{fault_code:02X}: {fault_name}")
-            fault_layout = QVBoxLayout()
-
-            details = QLabel(
-                f"Occurrences: {occurrence}\n"
-                f"Level: {failure_level}\n"
-                f"Last: {last_time_h}h ago"
-            )
+    def add_fault(self, charger: int, packet: FaultPacket, active: bool):
+        """Upsert da un frame di guasto (FLTA: active = True, FLTP: False)"""
+        self.model.upsert(charger, packet, active)
+    
+    def apply_diff(self, diff: FaultDiff, passive: FaultList):
+        """Cambi di una lista guasti completa (vedi fault_poller)
 
-            if "HARD" in failure_level.upper():
-                fault_widget.setStyleSheet("border: 2px solid red;")
-            elif "SOFT" in failure_level.upper():
-                fault_widget.setStyleSheet("border: 2px solid orange;")
+        passive: ultima lista FLTP completa del charger ({} se mai ricevuta)
+        """
+        for packet in diff.added + diff.changed:
+            self.model.upsert(diff.charger, packet, diff.active)
+        for code in diff.removed:
+            key = (diff.charger, code)
+            if diff.active and code in passive:
+                self.model.deactivate(key)          # Resta come storico finché è in FLTP
+            elif diff.active:
+                self.model.remove(key)              # Non in FLTP (o già uscito): sparisce
             else:
-                fault_widget.setStyleSheet("border: 2px solid yellow;")
-            
-            fault_layout.addWidget(details)
-            fault_widget.setLayout(fault_layout)
-            
-            self.fault_container.addWidget(fault_widget)
-            self.faults.append(fault_widget)
+                rec = self.model.store.get(*key)
+                if rec is not None and not rec.active:
+                    self.model.remove(key)
     
     def clear_faults(self):
-        for fault in self.faults:
-            self.fault_container.removeWidget(fault)
-            fault.deleteLater()
-        
-        self.faults.clear()
-        self.fault_info.clear()
-        self.no_fault_label.show()
-        self.fault_container.addWidget(self.no_fault_label)
+        self.model.clear()
+    
+    def _on_flushed(self):
+        empty = len(self.model.store) == 0
+        self.no_fault_label.setVisible(empty)
+        self.table.setVisible(not empty)
+        self.faults_changed.emit()
     
     def get_fault_count(self) -> int:
         """Return the total number of faults"""
-        return len(self.fault_info)
+        return len(self.model.store)
     
     def get_active_fault_count(self) -> int:
-        """Return the number of active (HARD) faults"""
-        return sum(1 for fault in self.fault_info if fault.get('is_active', False))
+        """Return the number of active faults (reported on FLTA)"""
+        return self.model.store.active_count()
 
 
 class RawDataDisplay(QWidget):
@@ -0,0 +1,392 @@
+"""Export pcapng (LINKTYPE_CAN_SOCKETCAN) e dissector Wireshark per i frame EVO
+
+    python -m charger_gui.wireshark export sessione.evlog         # -> sessione.pcapng
+    python -m charger_gui.wireshark export sessione.evlog --filter "act1 && vout > 400"
+    python -m charger_gui.wireshark lua                           # dissector Lua aggiornato?
+    python -m charger_gui.wireshark lua --write                   # rigenera il dissector
+    python -m charger_gui.wireshark bench                         # costo per frame + round trip
+
+PcapngWriter ha la stessa write() di RecordingWriter, quindi il registratore
+e la pipeline live possono scrivere entrambi i formati (recording.open_writer
+lo sceglie dall'estensione). Un Enhanced Packet Block per frame, 60 byte:
+
+    EPB header (28)   tipo, lunghezza, interfaccia 0, timestamp hi/lo [us], 16, 16
+    SocketCAN (16)    can_id | CAN_EFF_FLAG (big endian), len, 3 pad, 8 dati
+    epb_flags (8)     direzione: 1 in ingresso (Rx), 2 in uscita (Tx)
+    fine opzioni (4), lunghezza (4)
+
+I blocchi si impacchettano con una struct precompilata in un buffer in
+memoria e si scrivono a gruppi di FLUSH_RECORDS, come in RecordingWriter.
+
+Il dissector Lua è generato da signals.SIGNALS (livelli 1-4) e dalla mappa
+degli ID dei charger: ogni ID di bus EVO è registrato nelle tabelle
+"can.id" / "can.extended_id" del dissector SocketCAN e decodificato in un
+campo per segnale (evo11ka.<messaggio>.<segnale>, filtrabile in Wireshark).
+"""
+
+import os
+import struct
+import sys
+import time
+from typing import BinaryIO, List, Optional, Sequence
+
+from .can_decoder import CANDecoder, EXTENDED_FLAG, FailureLevel, FaultCode
+from .importers import (CAN_EFF_FLAG, LINKTYPE_CAN_SOCKETCAN, PCAPNG_BYTE_ORDER, PCAPNG_EPB,
+                        PCAPNG_IDB, PCAPNG_OPT_TSRESOL, PCAPNG_SHB)
+from .recording import Recording
+from .signals import ASCII, BOOL, ENUM, FLOAT, LEVEL, LEVEL_VALUES, SIGNALS, FAULT_IDS, Signal
+
+C = CANDecoder
+
+LUA_DISSECTOR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "evo11ka_dissector.lua")
+
+PCAPNG_OPT_ENDOFOPT = 0
+PCAPNG_OPT_USERAPPL = 4         # SHB
+PCAPNG_OPT_IF_NAME = 2          # IDB
+PCAPNG_OPT_EPB_FLAGS = 2        # EPB
+EPB_INBOUND = 1
+EPB_OUTBOUND = 2
+
+SNAPLEN = 16                    # struct can_frame
+EPB_FRAME = struct.Struct("<IIIIIII4sB3x8sHHIHHI")
+EPB_SIZE = EPB_FRAME.size
+
+
+def _option(code: int, value: bytes) -> bytes:
+    return struct.pack("<HH", code, len(value)) + value + b"\0" * (-len(value) % 4)
+
+
+def _block(btype: int, body: bytes) -> bytes:
+    body += b"\0" * (-len(body) % 4)
+    return struct.pack("<II", btype, len(body) + 12) + body + struct.pack("<I", len(body) + 12)
+
+
+def pcapng_header(interface: str = "can0", application: str = "EVO Charger CAN Bus Monitor") -> bytes:
+    """Section Header + un'interfaccia SocketCAN con timestamp in microsecondi"""
+    shb = _block(PCAPNG_SHB, struct.pack("<IHHq", PCAPNG_BYTE_ORDER, 1, 0, -1)
+                 + _option(PCAPNG_OPT_USERAPPL, application.encode()) + _option(PCAPNG_OPT_ENDOFOPT, b""))
+    idb = _block(PCAPNG_IDB, struct.pack("<HHI", LINKTYPE_CAN_SOCKETCAN, 0, SNAPLEN)
+                 + _option(PCAPNG_OPT_IF_NAME, interface.encode())
+                 + _option(PCAPNG_OPT_TSRESOL, bytes([6])) + _option(PCAPNG_OPT_ENDOFOPT, b""))
+    return shb + idb
+
+
+# ============================================================================
+# Writer
+# ============================================================================
+
+class PcapngWriter:
+    """Writer pcapng bufferizzato, stessa interfaccia di RecordingWriter (timestamp dall'inizio sessione)"""
+
+    FLUSH_RECORDS = 4096
+
+    def __init__(self, path: str, start_unix_us: Optional[int] = None, interface: str = "can0"):
+        self.path = path
+        self.start_unix_us = int(time.time() * 1e6) if start_unix_us is None else start_unix_us
+        self.count = 0
+        self._file: BinaryIO = open(path, 'wb')
+        self._file.write(pcapng_header(interface))
+        self._buf = bytearray()
+        self._pending = 0
+
+    def write(self, timestamp_us: int, can_id: int, data: Sequence[int],
+              extended: bool = False, tx: bool = False, channel: int = 0):
+        ts = self.start_unix_us + timestamp_us
+        raw_id = (can_id | CAN_EFF_FLAG) if extended else can_id
+        self._buf += EPB_FRAME.pack(PCAPNG_EPB, EPB_SIZE, 0, ts >> 32, ts & 0xFFFFFFFF, SNAPLEN, SNAPLEN,
+                                    raw_id.to_bytes(4, "big"), len(data), bytes(data),
+                                    PCAPNG_OPT_EPB_FLAGS, 4, EPB_OUTBOUND if tx else EPB_INBOUND,
+                                    PCAPNG_OPT_ENDOFOPT, 0, EPB_SIZE)
+        self.count += 1
+        self._pending += 1
+        if self._pending >= self.FLUSH_RECORDS:
+            self.flush()
+
+    def flush(self):
+        if self._buf:
+            self._file.write(self._buf)
+            self._buf.clear()
+            self._pending = 0
+        self._file.flush()
+
+    def close(self):
+        if self._file.closed:
+            return
+        self.flush()
+        self._file.close()
+
+    def __enter__(self) -> "PcapngWriter":
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def export(evlog_path: str, out_path: str, flt=None) -> int:
+    """.evlog -> .pcapng, frame in ordine di file (solo quelli che soddisfano flt, un frame_filter.Filter)"""
+    rec = Recording(evlog_path)
+    with PcapngWriter(out_path, rec.start_unix_us) as w:
+        for fr in (rec if flt is None else flt.select(rec)):
+            w.write(fr.timestamp_us, fr.can_id, fr.data, fr.extended, fr.tx)
+        return w.count
+
+
+# ============================================================================
+# Dissector Lua
+# ============================================================================
+
+def _lua_string(text: str) -> str:
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def _message_key(base_id: int) -> str:
+    return C.get_message_name(base_id).split()[0].lower()
+
+
+def _valuestring(s: Signal) -> Optional[dict]:
+    if s.kind == ENUM:
+        return {m.value: m.name for m in s.enum}
+    if s.kind == LEVEL:
+        return {raw: FailureLevel(v).name for raw, v in enumerate(LEVEL_VALUES)}
+    if s.name == "fault_code":
+        return {f.value: f.name for f in FaultCode}
+    return None
+
+
+def _field(key: str, s: Signal, vs_name: Optional[str]) -> str:
+    abbr = _lua_string(f"evo11ka.{key}.{s.name}")
+    label = _lua_string(f"{s.name} [{s.unit}]" if s.unit else s.name)
+    if s.kind == BOOL:
+        return f"ProtoField.bool({abbr}, {label}, 8, nil, 0x{1 << s.bit:02X})"
+    if s.kind == FLOAT:
+        return f"ProtoField.float({abbr}, {label})"
+    if s.kind == ASCII:
+        return f"ProtoField.string({abbr}, {label})"
+    vs = vs_name or "nil"
+    if s.length == 16:
+        return f"ProtoField.uint16({abbr}, {label}, base.DEC, {vs})"
+    mask = f", 0x{s.mask << s.bit:02X}" if s.length < 8 else ""
+    return f"ProtoField.uint8({abbr}, {label}, base.DEC, {vs}{mask})"
+
+
+def generate_lua() -> str:
+    out: List[str] = [
+        "-- =============================================================================",
+        "--  FILE: evo11ka_dissector.lua",
+        "-- =============================================================================",
+        "--",
+        "--  Wireshark dissector for the EVO11KA charger CAN messages (levels 1-4),",
+        "--  on top of the SocketCAN dissector (LINKTYPE_CAN_SOCKETCAN, pcapng export).",
+        "--  Install: copy into the Wireshark personal Lua plugins folder.",
+        "--",
+        "--  GENERATED by charger_gui/wireshark.py (python -m charger_gui.wireshark lua --write)",
+        "--  Do not edit: change signals.SIGNALS and regenerate.",
+        "--",
+        "-- =============================================================================",
+        "",
+        'local evo = Proto("evo11ka", "EVO11KA Charger")',
+        "",
+        "local f_message = ProtoField.string(\"evo11ka.message\", \"Message\")",
+        "local f_charger = ProtoField.uint8(\"evo11ka.charger\", \"Charger\")",
+        "local f_no_fault = ProtoField.bool(\"evo11ka.no_fault\", \"No fault\")",
+        "local fields = { f_message, f_charger, f_no_fault }",
+        "",
+        "local can_id_f = Field.new(\"can.id\")",
+        "local can_xtd_f = Field.new(\"can.flags.xtd\")",
+        "",
+        "-- Value strings",
+    ]
+    # Value string condivise per nome (fault_code, failure_level, enum)
+    vs_names = {}
+    for base_id, signals in SIGNALS.items():
+        for s in signals:
+            vs = _valuestring(s)
+            if vs is None:
+                continue
+            name = "vs_" + (s.enum.__name__ if s.enum else s.name)
+            if name in vs_names:
+                continue
+            vs_names[name] = vs
+            items = ", ".join(f"[{k}] = {_lua_string(v)}" for k, v in sorted(vs.items()))
+            out.append(f"local {name} = {{ {items} }}")
+    out += ["", "-- base CAN ID -> { name, signals = { { field, kind, byte, size, scale, offset } } }",
+            "local messages = {}"]
+    for base_id, signals in SIGNALS.items():
+        key = _message_key(base_id)
+        out += ["", f"messages[0x{base_id:03X}] = {{ name = {_lua_string(C.get_message_name(base_id))}, "
+                    f"fault = {'true' if base_id in FAULT_IDS else 'false'}, signals = {{"]
+        for s in signals:
+            vs = _valuestring(s)
+            vs_name = ("vs_" + (s.enum.__name__ if s.enum else s.name)) if vs is not None else None
+            size = 8 if s.kind == ASCII else (2 if s.length == 16 else 1)
+            if s.kind == FLOAT:
+                assert s.bit == 0 and s.length in (8, 16), s.name
+                kind, scale, offset = '"float"', repr(s.scale), repr(s.offset)
+            else:
+                kind, scale, offset = '"raw"', "1", "0"
+            out.append(f"    {{ {_field(key, s, vs_name)}, {kind}, {s.byte}, {size}, {scale}, {offset} }},")
+        out.append("} }")
+    out += [
+        "",
+        "for _, msg in pairs(messages) do",
+        "    for _, s in ipairs(msg.signals) do",
+        "        fields[#fields + 1] = s[1]",
+        "    end",
+        "end",
+        "evo.fields = fields",
+        "",
+        "-- Bus ID (29-bit with bit 31 set) -> { base CAN ID, charger }",
+        "local bus_ids = {",
+    ]
+    entries = []
+    for key in sorted(C.id_map.keys()):
+        extended = bool(key & EXTENDED_FLAG)
+        base_id, charger = C.id_map.resolve(key & 0x1FFFFFFF, extended)
+        entries.append(f"[0x{key:08X}] = {{ 0x{base_id:03X}, {charger} }}")
+    for i in range(0, len(entries), 3):
+        out.append("    " + ", ".join(entries[i:i + 3]) + ",")
+    out += [
+        "}",
+        "",
+        "function evo.dissector(buf, pinfo, tree)",
+        "    local can_id = can_id_f()",
+        "    if can_id == nil then return 0 end",
+        "    local key = can_id.value",
+        "    local xtd = can_xtd_f()",
+        "    if xtd ~= nil and xtd.value then key = key + 0x80000000 end",
+        "    local bus = bus_ids[key]",
+        "    if bus == nil then return 0 end",
+        "    local msg = messages[bus[1]]",
+        "    pinfo.cols.protocol = \"EVO11KA\"",
+        "    pinfo.cols.info = string.format(\"%s charger %d\", msg.name, bus[2])",
+        "    local sub = tree:add(evo, buf(), \"EVO11KA \" .. msg.name)",
+        "    sub:add(f_message, msg.name)",
+        "    sub:add(f_charger, bus[2])",
+        "    local n = buf:len()",
+        "    if msg.fault and n == 8 and buf(1, 7):bytes():tohex() == \"FFFFFFFFFFFFFF\" then",
+        "        sub:add(f_no_fault, true)",
+        "        pinfo.cols.info:append(\" no fault\")",
+        "        return n",
+        "    end",
+        "    for _, s in ipairs(msg.signals) do",
+        "        local byte, size = s[3], s[4]",
+        "        if byte + size <= n then",
+        "            if s[2] == \"float\" then",
+        "                sub:add(s[1], buf(byte, size), buf(byte, size):uint() * s[5] + s[6])",
+        "            else",
+        "                sub:add(s[1], buf(byte, size))",
+        "            end",
+        "        end",
+        "    end",
+        "    return n",
+        "end",
+        "",
+        "-- Standard IDs in can.id, 29-bit IDs in can.extended_id (older versions: can.id only)",
+        "local std_table = DissectorTable.get(\"can.id\")",
+        "local ok, ext_table = pcall(DissectorTable.get, \"can.extended_id\")",
+        "for key, _ in pairs(bus_ids) do",
+        "    if key >= 0x80000000 then",
+        "        if ok and ext_table ~= nil then ext_table:add(key - 0x80000000, evo) end",
+        "    else",
+        "        std_table:add(key, evo)",
+        "    end",
+        "end",
+        "",
+    ]
+    return "\n".join(out)
+
+
+# ============================================================================
+# Benchmark / autoverifica
+# ============================================================================
+
+def bench(tmp_dir: str) -> bool:
+    """Costo di scrittura per frame (percorso live) e round trip tramite l'importer pcapng"""
+    from .archive import _simulated_evlog
+    from .importers import read_pcapng, ALL
+    from .recording import RecordingWriter
+
+    evlog = os.path.join(tmp_dir, "sim.evlog")
+    _simulated_evlog(evlog, 25.0, 0.2)
+    rec = Recording(evlog)
+    frames = list(rec)
+    ok = True
+    for name, cls in (("evlog", RecordingWriter), ("pcapng", PcapngWriter)):
+        path = os.path.join(tmp_dir, f"out.{name}")
+        start = time.perf_counter()
+        with cls(path, rec.start_unix_us) as w:
+            for fr in frames:
+                w.write(fr.timestamp_us, fr.can_id, fr.data, fr.extended, fr.tx)
+        dt = time.perf_counter() - start
+        print(f"  {name:<7} {len(frames)} frames  {dt / len(frames) * 1e6:5.2f} us/frame  "
+              f"{os.path.getsize(path) / 1e6:6.2f} MB")
+
+    pcap = os.path.join(tmp_dir, "out.pcapng")
+    with open(pcap, "rb") as f:
+        got = [(ts - rec.start_unix_us, can_id, ext, tx, data) for ts, can_id, ext, tx, data in read_pcapng(f, ALL)]
+    match = got == [tuple(fr) for fr in frames]
+    ok &= match
+    print(f"  round trip pcapng -> frames: {'OK' if match else 'MISMATCH'} "
+          f"({sum(fr.tx for fr in frames)} Tx frames)")
+
+    text = generate_lua()
+    print(f"  dissector: {text.count('ProtoField.') - 3} signal fields, "
+          f"{len(C.id_map.keys())} bus IDs, {len(text) / 1e3:.0f} kB")
+    return ok
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    import argparse
+    parser = argparse.ArgumentParser(description="pcapng export and Wireshark dissector")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("export", help=".evlog -> .pcapng")
+    p.add_argument("files", nargs="+")
+    p.add_argument("-o", "--output", help="output .pcapng (single input)")
+    p.add_argument("--filter", help='frame filter, e.g. "act1 && vout > 400"')
+    p = sub.add_parser("lua", help="check or regenerate the Lua dissector")
+    p.add_argument("--write", action="store_true")
+    p.add_argument("--path", default=LUA_DISSECTOR)
+    sub.add_parser("bench", help="write cost per frame and round trip")
+    args = parser.parse_args(argv)
+
+    if args.cmd == "export":
+        from .frame_filter import compile_filter, FilterError
+        try:
+            flt = compile_filter(args.filter)
+        except FilterError as e:
+            print(f"filter: {e}")
+            return 1
+        for path in args.files:
+            out = args.output or os.path.splitext(path)[0] + ".pcapng"
+            try:
+                n = export(path, out, flt)
+            except (OSError, ValueError) as e:
+                print(f"{path}: {e}")
+                return 1
+            print(f"{out}: {n} frames")
+        return 0
+    if args.cmd == "bench":
+        import tempfile
+        with tempfile.TemporaryDirectory() as tmp:
+            return 0 if bench(tmp) else 1
+
+    text = generate_lua()
+    if args.write:
+        with open(args.path, "w", encoding="utf-8", newline="\n") as f:
+            f.write(text)
+        print(f"{args.path}: {len(SIGNALS)} messages, {len(C.id_map.keys())} bus IDs")
+        return 0
+    try:
+        with open(args.path, encoding="utf-8") as f:
+            current = f.read()
+    except FileNotFoundError:
+        current = ""
+    if current != text:
+        print(f"{args.path} is out of date: run python -m charger_gui.wireshark lua --write")
+        return 1
+    print(f"{args.path} up to date")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+/* =============================================================================
+ *  FILE: utils_canBus_charger_id_table.h
+ * =============================================================================
+ *
+ *  EVO Charger bus IDs per charger (manual ID tables of LEVEL 1 and LEVEL 2)
+ *
+ *  GENERATED by charger_gui/charger_ids.py (python -m charger_gui.charger_ids --write)
+ *  Do not edit: change ID_SPECS and regenerate.
+ *
+ * =============================================================================
+ */
+
+#ifndef UTILS_CANBUS_CHARGER_ID_TABLE_H
+#define UTILS_CANBUS_CHARGER_ID_TABLE_H
+
+#include <stdint.h>
+
+/* EVO messages (default IDs = charger 1) */
+typedef enum {
+    CAN_MSG_STAT = 0,     /* 0x610 */
+    CAN_MSG_ACT1,         /* 0x611 */
+    CAN_MSG_ACT2,         /* 0x614 */
+    CAN_MSG_TST1,         /* 0x615 */
+    CAN_MSG_TST2,         /* 0x616 */
+    CAN_MSG_CTL,          /* 0x618 */
+    CAN_MSG_REQ,          /* 0x61B */
+    CAN_MSG_FLTP,         /* 0x61C */
+    CAN_MSG_FLTA,         /* 0x61D */
+    CAN_MSG_SW,           /* 0x61E */
+    CAN_MSG_SN,           /* 0x61F */
+    CAN_MSG_ACT3,         /* 0x712 */
+    CAN_MSG_TEMP,         /* 0x713 */
+    CAN_MSG_ACT4,         /* 0x714 */
+    CAN_MSG_STST1,        /* 0x715 */
+    CAN_MSG_COUNT
+} CanMsg_t;
+
+#define CAN_MSG_SERVICE_FIRST  CAN_MSG_ACT3   /* LEVEL 3: same ID for every charger */
+#define CAN_CHARGER_SLOTS      14
+#define CAN_CHARGER_NONE       0xFF
+
+static const uint16_t CAN_MSG_BASE_ID[CAN_MSG_COUNT] = {
+    0x610, 0x611, 0x614, 0x615, 0x616, 0x618, 0x61B, 0x61C, 0x61D, 0x61E, 0x61F, 0x712, 0x713, 0x714, 0x715
+};
+
+static const char *const CAN_MSG_NAME[CAN_MSG_COUNT] = {
+    "STAT", "ACT1", "ACT2", "TST1", "TST2", "CTL", "REQ", "FLTP", "FLTA", "SW", "SN", "ACT3", "TEMP", "ACT4", "STST1"
+};
+
+/* Charger number (1-16) and Setup.IDsetting of each column */
+static const uint8_t CAN_CHARGER_NUMBER[CAN_CHARGER_SLOTS] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 15, 16 };
+static const uint8_t CAN_CHARGER_ID_SETTING[CAN_CHARGER_SLOTS] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 14, 15 };
+
+/* Charger number -> column (CAN_CHARGER_NONE: no ID set for the charger) */
+static const uint8_t CAN_CHARGER_SLOT[17] = { CAN_CHARGER_NONE, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, CAN_CHARGER_NONE, CAN_CHARGER_NONE, 12, 13 };
+
+/* Bus ID: [message][column] */
+static const uint16_t CAN_CHARGER_BUS_ID[CAN_MSG_COUNT][CAN_CHARGER_SLOTS] = {
+    /* STAT  */ { 0x610, 0x600, 0x5F0, 0x5E0, 0x5D0, 0x5C0, 0x5B0, 0x5A0, 0x590, 0x580, 0x570, 0x560, 0x030, 0x020 },
+    /* ACT1  */ { 0x611, 0x601, 0x5F1, 0x5E1, 0x5D1, 0x5C1, 0x5B1, 0x5A1, 0x591, 0x581, 0x571, 0x561, 0x031, 0x021 },
+    /* ACT2  */ { 0x614, 0x604, 0x5F4, 0x5E4, 0x5D4, 0x5C4, 0x5B4, 0x5A4, 0x594, 0x584, 0x574, 0x564, 0x034, 0x024 },
+    /* TST1  */ { 0x615, 0x605, 0x5F5, 0x5E5, 0x5D5, 0x5C5, 0x5B5, 0x5A5, 0x595, 0x585, 0x575, 0x565, 0x035, 0x025 },
+    /* TST2  */ { 0x616, 0x606, 0x5F6, 0x5E6, 0x5D6, 0x5C6, 0x5B6, 0x5A6, 0x596, 0x586, 0x576, 0x566, 0x036, 0x026 },
+    /* CTL   */ { 0x618, 0x608, 0x5F8, 0x5E8, 0x5D8, 0x5C8, 0x5B8, 0x5A8, 0x598, 0x588, 0x578, 0x568, 0x038, 0x028 },
+    /* REQ   */ { 0x61B, 0x60B, 0x5FB, 0x5EB, 0x5DB, 0x5CB, 0x6BB, 0x6AB, 0x69B, 0x68B, 0x67B, 0x66B, 0x03B, 0x02B },
+    /* FLTP  */ { 0x61C, 0x60C, 0x5FC, 0x5EC, 0x5DC, 0x5CC, 0x5BC, 0x5AC, 0x59C, 0x58C, 0x57C, 0x56C, 0x03C, 0x02C },
+    /* FLTA  */ { 0x61D, 0x60D, 0x5FD, 0x5ED, 0x5DD, 0x5CD, 0x5BD, 0x5AD, 0x59D, 0x58D, 0x57D, 0x56D, 0x03D, 0x02D },
+    /* SW    */ { 0x61E, 0x60E, 0x5FE, 0x5EE, 0x5DE, 0x5CE, 0x5BE, 0x5AE, 0x59E, 0x58E, 0x57E, 0x56E, 0x03E, 0x02E },
+    /* SN    */ { 0x61F, 0x60F, 0x5FF, 0x5EF, 0x5DF, 0x5CF, 0x5BF, 0x5AF, 0x59F, 0x58F, 0x57F, 0x56F, 0x03F, 0x02F },
+    /* ACT3  */ { 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712, 0x712 },
+    /* TEMP  */ { 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713, 0x713 },
+    /* ACT4  */ { 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714, 0x714 },
+    /* STST1 */ { 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715, 0x715 },
+};
+
+#endif /* UTILS_CANBUS_CHARGER_ID_TABLE_H */
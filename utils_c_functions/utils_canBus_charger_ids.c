@@ -0,0 +1,288 @@
+/* =============================================================================
+ *  FILE: utils_canBus_charger_ids.c
+ * =============================================================================
+ *
+ *  EVO Charger CAN Bus Utilities - ID dei messaggi e piu' charger
+ *  ID estesi a 29 bit, ID per charger (Setup.IDsetting, tabelle ID del
+ *  manuale) e lookup ID bus → (messaggio, charger) in O(1) con hash perfetto
+ *
+ *  Indirizzamento (stessa tabella di charger_gui/can_decoder.py, CanIdMap):
+ *   - Tabella ID del manuale in utils_canBus_charger_id_table.h, generata da
+ *     charger_gui/charger_ids.py: charger 1-12, 15, 16 (13 e 14 non esistono)
+ *   - Charger 1 (o charger singolo) usa gli ID di default (0x61x)
+ *   - Gli ID non seguono un passo fisso (REQ dei charger 7-12 e' 0x6xB)
+ *   - 29 bit: stessi ID numerici in formato esteso
+ *   - LEVEL 3 (0x712-0x715): stesso ID per ogni charger (Service CAN),
+ *     attribuito al charger 1
+ *
+ *  Hash perfetto a due livelli (hash-and-displace): il primo hash sceglie
+ *  un bucket, il seed del bucket (trovato in costruzione) porta ogni chiave
+ *  in uno slot diverso. Lookup = 2 hash + 1 confronto, qualunque sia il
+ *  numero di charger.
+ *
+ * =============================================================================
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils_canBus_charger_id_table.h"   /* CanMsg_t, CAN_CHARGER_BUS_ID[][] */
+
+
+#define CAN_ID_KEY_EXTENDED   0x80000000UL  /* Bit della chiave per frame a 29 bit */
+
+/* Dimensioni dell'hash (potenze di 2) */
+#define ID_MAP_SLOTS          512   /* >= chiavi / 0.75 */
+#define ID_MAP_BUCKETS        128   /* ~4 chiavi per bucket */
+#define ID_MAP_EMPTY          0xFFFFFFFFUL
+
+/* Slot della tabella */
+typedef struct {
+    uint32_t key;       /* ID bus | CAN_ID_KEY_EXTENDED (ID_MAP_EMPTY se libero) */
+    uint8_t msg;        /* CanMsg_t */
+    uint8_t charger;    /* 1-12, 15, 16 */
+} CanIdEntry_t;
+
+/* Mappa ID bus → messaggio */
+typedef struct {
+    CanIdEntry_t slots[ID_MAP_SLOTS];
+    uint16_t seeds[ID_MAP_BUCKETS];
+    uint16_t n_keys;
+} CanIdMap_t;
+
+
+/* ============================================================================
+ * INDIRIZZAMENTO
+ * ============================================================================ */
+
+/**
+ * @brief ID sul bus di un messaggio per un dato charger
+ *
+ * @param msg Messaggio (CAN_MSG_*)
+ * @param charger Numero del charger (1-12, 15, 16), 1 = ID di default
+ * @param extended true per frame a 29 bit
+ * @return ID da usare in trasmissione / atteso in ricezione, 0 se il
+ *         charger non ha ID nella tabella (13, 14)
+ */
+uint32_t CanBus_ChargerBusId(CanMsg_t msg, uint8_t charger, bool extended) {
+    (void)extended;                 /* 29 bit: stesso ID numerico */
+    if (msg >= CAN_MSG_COUNT || charger > 16 || CAN_CHARGER_SLOT[charger] == CAN_CHARGER_NONE) return 0;
+    return CAN_CHARGER_BUS_ID[msg][CAN_CHARGER_SLOT[charger]];
+}
+
+
+/* ============================================================================
+ * HASH PERFETTO
+ * ============================================================================ */
+
+/** Finalizzatore di MurmurHash3 (mix a 32 bit) */
+static inline uint32_t Hash_Mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6BUL;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35UL;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline uint32_t IdMap_Bucket(uint32_t key) {
+    return Hash_Mix32(key) & (ID_MAP_BUCKETS - 1);
+}
+
+static inline uint32_t IdMap_Slot(uint32_t key, uint16_t seed) {
+    return Hash_Mix32(key ^ ((uint32_t)seed * 0x9E3779B9UL)) & (ID_MAP_SLOTS - 1);
+}
+
+/**
+ * @brief Costruisce la mappa per tutti i charger della tabella, a 11 bit
+ *        (standard) e/o a 29 bit (extended)
+ * @return true se esiste un hash perfetto (false se troppe chiavi o ID duplicati)
+ */
+bool CanIdMap_Build(CanIdMap_t *map, bool standard, bool extended) {
+    static CanIdEntry_t keys[ID_MAP_SLOTS];
+    static uint16_t bucket_keys[ID_MAP_BUCKETS][ID_MAP_SLOTS / ID_MAP_BUCKETS * 4];
+    static uint8_t bucket_size[ID_MAP_BUCKETS];
+    const uint16_t bucket_cap = ID_MAP_SLOTS / ID_MAP_BUCKETS * 4;
+    uint16_t n = 0;
+
+    if (map == NULL) return false;
+
+    for (int ext = 0; ext <= 1; ext++) {
+        if (!(ext ? extended : standard)) continue;
+        for (uint8_t col = 0; col < CAN_CHARGER_SLOTS; col++) {
+            for (uint8_t m = 0; m < CAN_MSG_COUNT; m++) {
+                /* LEVEL 3: un solo ID per tutti i charger, tenuto dal charger 1 */
+                if (m >= CAN_MSG_SERVICE_FIRST && col > 0) continue;
+                uint32_t key = CAN_CHARGER_BUS_ID[m][col] | (ext ? CAN_ID_KEY_EXTENDED : 0);
+                keys[n++] = (CanIdEntry_t){ key, m, CAN_CHARGER_NUMBER[col] };
+            }
+        }
+    }
+    if (n > ID_MAP_SLOTS * 3 / 4) return false;
+
+    /* 1. Distribuzione delle chiavi nei bucket */
+    memset(bucket_size, 0, sizeof(bucket_size));
+    for (uint16_t i = 0; i < n; i++) {
+        uint32_t b = IdMap_Bucket(keys[i].key);
+        if (bucket_size[b] >= bucket_cap) return false;
+        bucket_keys[b][bucket_size[b]++] = i;
+    }
+
+    for (uint16_t s = 0; s < ID_MAP_SLOTS; s++) map->slots[s].key = ID_MAP_EMPTY;
+    memset(map->seeds, 0, sizeof(map->seeds));
+
+    /* 2. Bucket dal piu' grande al piu' piccolo: cerca il seed che porta
+     *    tutte le sue chiavi in slot liberi e distinti */
+    for (int size = bucket_cap; size > 0; size--) {
+        for (uint32_t b = 0; b < ID_MAP_BUCKETS; b++) {
+            if (bucket_size[b] != size) continue;
+
+            bool placed = false;
+            for (uint32_t seed = 0; seed <= 0xFFFF && !placed; seed++) {
+                uint32_t slot[ID_MAP_SLOTS / ID_MAP_BUCKETS * 4];
+                bool ok = true;
+                for (int k = 0; k < size && ok; k++) {
+                    slot[k] = IdMap_Slot(keys[bucket_keys[b][k]].key, (uint16_t)seed);
+                    if (map->slots[slot[k]].key != ID_MAP_EMPTY) ok = false;
+                    for (int j = 0; j < k && ok; j++) {
+                        if (slot[j] == slot[k]) ok = false;
+                    }
+                }
+                if (!ok) continue;
+
+                for (int k = 0; k < size; k++) {
+                    map->slots[slot[k]] = keys[bucket_keys[b][k]];
+                }
+                map->seeds[b] = (uint16_t)seed;
+                placed = true;
+            }
+            if (!placed) return false;
+        }
+    }
+
+    map->n_keys = n;
+    return true;
+}
+
+/**
+ * @brief Lookup ID bus → messaggio e charger in O(1)
+ *
+ * @param map Mappa costruita con CanIdMap_Build
+ * @param bus_id ID ricevuto
+ * @param extended true se frame a 29 bit
+ * @param msg Messaggio (output)
+ * @param charger Numero del charger 1-12, 15, 16 (output)
+ * @return true se l'ID e' un messaggio EVO
+ */
+bool CanIdMap_Lookup(const CanIdMap_t *map, uint32_t bus_id, bool extended,
+                     CanMsg_t *msg, uint8_t *charger) {
+    uint32_t key = extended ? (bus_id | CAN_ID_KEY_EXTENDED) : bus_id;
+    const CanIdEntry_t *e = &map->slots[IdMap_Slot(key, map->seeds[IdMap_Bucket(key)])];
+
+    if (e->key != key) return false;
+    if (msg) *msg = (CanMsg_t)e->msg;
+    if (charger) *charger = e->charger;
+    return true;
+}
+
+
+/* ============================================================================
+ * EXAMPLES
+ * ============================================================================ */
+
+/**
+ * ESEMPIO 1: ID di alcuni messaggi, confrontati con gli esempi del manuale
+ * (charger 5: CTL 0x5D8, charger 6: CTL 0x5C8, charger 7: REQ 0x6BB)
+ */
+void Example_ChargerIds(void) {
+    static const uint8_t chargers[] = { 1, 2, 5, 6, 7, 12, 15, 16 };
+
+    printf("\n\r=== CHARGER BUS IDS ===\n");
+    printf("  Charger  STAT   ACT1   CTL    REQ    FLTA\n");
+    for (uint8_t i = 0; i < sizeof(chargers); i++) {
+        uint8_t c = chargers[i];
+        printf("  %7u  0x%03lX  0x%03lX  0x%03lX  0x%03lX  0x%03lX\n", c,
+               (unsigned long)CanBus_ChargerBusId(CAN_MSG_STAT, c, false),
+               (unsigned long)CanBus_ChargerBusId(CAN_MSG_ACT1, c, false),
+               (unsigned long)CanBus_ChargerBusId(CAN_MSG_CTL, c, false),
+               (unsigned long)CanBus_ChargerBusId(CAN_MSG_REQ, c, false),
+               (unsigned long)CanBus_ChargerBusId(CAN_MSG_FLTA, c, false));
+    }
+    bool manual = CanBus_ChargerBusId(CAN_MSG_CTL, 5, false) == 0x5D8 &&
+                  CanBus_ChargerBusId(CAN_MSG_CTL, 6, false) == 0x5C8 &&
+                  CanBus_ChargerBusId(CAN_MSG_REQ, 7, false) == 0x6BB &&
+                  CanBus_ChargerBusId(CAN_MSG_ACT1, 13, false) == 0;
+    printf("  Manual examples: %s\n", manual ? "PASS" : "FAIL");
+}
+
+/**
+ * ESEMPIO 2: Mappa completa (14 charger a 11 e a 29 bit), verifica e tempi
+ */
+void Example_PerfectHash(void) {
+    static CanIdMap_t map;
+    CanMsg_t msg;
+    uint8_t charger;
+    uint32_t errors = 0;
+
+    if (!CanIdMap_Build(&map, true, true)) {
+        printf("  Build failed\n");
+        return;
+    }
+
+    /* Tutti gli ID EVO devono essere trovati con il messaggio giusto
+     * (LEVEL 3 sempre con il charger 1) */
+    for (uint8_t col = 0; col < CAN_CHARGER_SLOTS; col++) {
+        uint8_t c = CAN_CHARGER_NUMBER[col];
+        for (uint8_t m = 0; m < CAN_MSG_COUNT; m++) {
+            uint8_t expected = (m >= CAN_MSG_SERVICE_FIRST) ? 1 : c;
+            for (int ext = 0; ext <= 1; ext++) {
+                bool found = CanIdMap_Lookup(&map, CanBus_ChargerBusId((CanMsg_t)m, c, ext), ext, &msg, &charger);
+                if (!found || msg != m || charger != expected) errors++;
+            }
+        }
+    }
+
+    /* Nessun altro ID a 11 bit deve essere accettato, oltre a quelli EVO */
+    uint32_t accepted = 0;
+    for (uint32_t id = 0; id <= 0x7FF; id++) {
+        if (CanIdMap_Lookup(&map, id, false, NULL, NULL)) accepted++;
+    }
+    uint32_t expected_ids = CAN_CHARGER_SLOTS * CAN_MSG_SERVICE_FIRST + (CAN_MSG_COUNT - CAN_MSG_SERVICE_FIRST);
+
+    clock_t t0 = clock();
+    volatile uint32_t hits = 0;
+    for (uint32_t i = 0; i < 10000000UL; i++) {
+        uint8_t c = CAN_CHARGER_NUMBER[(i >> 4) % CAN_CHARGER_SLOTS];
+        uint32_t id = CanBus_ChargerBusId((CanMsg_t)(i % CAN_MSG_COUNT), c, true);
+        if (CanIdMap_Lookup(&map, id, true, &msg, &charger)) hits++;
+    }
+    double ns = (double)(clock() - t0) / CLOCKS_PER_SEC * 1e9 / 10000000.0;
+
+    printf("\n\r=== PERFECT HASH EXAMPLE ===\n");
+    printf("  Keys: %u in %u slots, %u buckets\n", map.n_keys, ID_MAP_SLOTS, ID_MAP_BUCKETS);
+    printf("  Lookup errors: %lu -> %s\n", (unsigned long)errors, errors == 0 ? "PASS" : "FAIL");
+    printf("  11-bit IDs accepted: %lu (expected %lu)\n", (unsigned long)accepted, (unsigned long)expected_ids);
+    printf("  Lookup time: %.1f ns (incl. ID generation)\n", ns);
+
+    if (CanIdMap_Lookup(&map, 0x000005D8UL, true, &msg, &charger)) {
+        printf("  0x000005D8 (29-bit) -> %s, charger %u\n", CAN_MSG_NAME[msg], charger);
+    }
+}
+
+
+int main(void) {
+    printf("\n\r========================================\n");
+    printf("  EVO Charger - CAN IDs & Multi-charger\n");
+    printf("========================================\n");
+
+    Example_ChargerIds();
+    printf("\n\r###########################\n");
+
+    Example_PerfectHash();
+
+    return 0;
+}
@@ -16,6 +16,12 @@
 #include <stdlib.h>
 #include <time.h>
 
+#ifdef USE_HAL_DRIVER
+#include "main.h"               /* hcan1, HAL_GetTick() */
+extern CAN_HandleTypeDef hcan1;
+#define CTL_CAN_HANDLE          (&hcan1)
+#endif
+
 
 /* CAN IDs */
 #define CAN_ID_CTL   0x618  /* BMS → Charger - Control */
@@ -236,6 +242,160 @@ bool CanBus_CreatePacket_Ctl_Simple(bool can_enable,
 }
 
 
+/* ============================================================================
+ * SCHEDULE CTL PRECALCOLATO
+ * ============================================================================ */
+
+/* Periodo di invio del CTL [ms] */
+#define CTL_PERIOD_MS   100
+
+/* Setpoint del profilo di carica: vale da t_ms fino al setpoint successivo */
+typedef struct {
+    uint32_t t_ms;            /* Istante dall'inizio del profilo [ms] */
+    bool can_enable;
+    float iac_max_A;
+    float vout_max_V;
+    float iout_max_A;
+} CanCtlSetpoint_t;
+
+/* Frame CTL pronti da inviare, uno per periodo */
+typedef struct {
+    const uint8_t (*frames)[8];
+    uint32_t count;
+    uint32_t period_ms;
+    uint32_t bus_id;          /* ID del CTL sul bus (CanBus_ChargerBusId, 0x618 = charger 1) */
+    bool extended;            /* ID a 29 bit */
+    uint32_t tx_errors;       /* Invii rifiutati da HAL_CAN_AddTxMessage (mailbox piene) */
+} CanCtlSchedule_t;
+
+/**
+ * @brief Numero di frame necessari per un profilo (dimensionamento del buffer)
+ * 
+ * Arrotondato per eccesso: l'ultimo setpoint (di solito lo spegnimento) ha
+ * sempre almeno un frame, anche se t_ms non e' multiplo del periodo.
+ * 
+ * @return ceil(t dell'ultimo setpoint / periodo) + 1, 0 se il profilo e' vuoto
+ */
+uint32_t CanBus_CtlSchedule_FrameCount(const CanCtlSetpoint_t *points, uint32_t n_points,
+                                       uint32_t period_ms) {
+    if (points == NULL || n_points == 0 || period_ms == 0) return 0;
+    return (points[n_points - 1].t_ms + period_ms - 1) / period_ms + 1;
+}
+
+/**
+ * @brief Variante bulk di CanBus_CreatePacket_Ctl: codifica tutto il profilo
+ * 
+ * Il frame k (istante k x period_ms) usa l'ultimo setpoint con t_ms <= k x period_ms;
+ * prima del primo setpoint il charger resta disabilitato (frame a zero).
+ * Un setpoint intermedio piu' corto di un periodo puo' non essere mai inviato,
+ * l'ultimo invece occupa sempre l'ultimo frame (e resta attivo a fine profilo).
+ * Ogni setpoint viene codificato una sola volta e copiato nei periodi in cui vale,
+ * quindi il costo e' O(setpoint) conversioni + O(frame) memcpy da 8 byte.
+ * 
+ * @param points Setpoint ordinati per t_ms crescente
+ * @param n_points Numero di setpoint
+ * @param led3_enable LED3 per tutto il profilo
+ * @param period_ms Periodo di invio (CTL_PERIOD_MS)
+ * @param frames Buffer di uscita
+ * @param max_frames Capacita' del buffer (frame)
+ * @return Numero di frame scritti, 0 se errore (profilo non ordinato o buffer piccolo)
+ */
+uint32_t CanBus_CreatePacket_Ctl_Bulk(const CanCtlSetpoint_t *points, uint32_t n_points,
+                                      bool led3_enable, uint32_t period_ms,
+                                      uint8_t (*frames)[8], uint32_t max_frames) {
+    uint32_t count = CanBus_CtlSchedule_FrameCount(points, n_points, period_ms);
+    if (count == 0 || frames == NULL || count > max_frames) return 0;
+    for (uint32_t i = 1; i < n_points; i++) {
+        if (points[i].t_ms < points[i - 1].t_ms) return 0;
+    }
+
+    /* Prima del primo setpoint: charger disabilitato */
+    uint32_t k = (points[0].t_ms + period_ms - 1) / period_ms;
+    memset(frames, 0, (size_t)k * 8);
+
+    for (uint32_t i = 0; i < n_points; i++) {
+        /* Ultimo frame coperto: prima dell'istante del setpoint successivo */
+        uint32_t end = (i + 1 < n_points) ? (points[i + 1].t_ms + period_ms - 1) / period_ms : count;
+        /* Setpoint intermedio piu' corto di un periodo: mai inviato. Per l'ultimo
+         * end = count > k sempre (FrameCount arrotonda per eccesso) */
+        if (end <= k) continue;
+
+        CanPacket_Ctl_t ctl = {
+            .can_enable = points[i].can_enable,
+            .led3_enable = led3_enable,
+            .iac_max_A = points[i].iac_max_A,
+            .vout_max_V = points[i].vout_max_V,
+            .iout_max_A = points[i].iout_max_A,
+        };
+        CanBus_CreatePacket_Ctl(&ctl, frames[k]);
+        for (uint32_t j = k + 1; j < end; j++) {
+            memcpy(frames[j], frames[k], 8);
+        }
+        k = end;
+    }
+    return count;
+}
+
+/**
+ * @brief Inizializza lo schedule su un buffer gia' codificato
+ * @param bus_id ID del CTL del charger destinatario (CanBus_ChargerBusId(CAN_MSG_CTL, ...))
+ * @param extended true se il charger usa ID a 29 bit
+ */
+void CanBus_CtlSchedule_Init(CanCtlSchedule_t *sched, const uint8_t (*frames)[8],
+                             uint32_t count, uint32_t period_ms, uint32_t bus_id, bool extended) {
+    sched->frames = frames;
+    sched->count = count;
+    sched->period_ms = period_ms;
+    sched->bus_id = bus_id;
+    sched->extended = extended;
+    sched->tx_errors = 0;
+}
+
+/**
+ * @brief Frame da inviare all'istante elapsed_ms dall'avvio del profilo
+ * 
+ * Solo un indice nel buffer: nessuna codifica nel tick da 100 ms. Un tick in
+ * ritardo prende comunque il frame del suo periodo; finito il profilo si
+ * continua a inviare l'ultimo frame (il charger vuole il CTL ogni 100 ms).
+ */
+const uint8_t *CanBus_CtlSchedule_At(const CanCtlSchedule_t *sched, uint32_t elapsed_ms) {
+    if (sched == NULL || sched->count == 0) return NULL;
+    uint32_t k = elapsed_ms / sched->period_ms;
+    return sched->frames[k < sched->count ? k : sched->count - 1];
+}
+
+#ifdef USE_HAL_DRIVER
+/**
+ * @brief Da chiamare nel tick da 100 ms: invia il frame CTL del periodo corrente
+ * 
+ * ID e formato (11/29 bit) sono quelli dello schedule. Un invio rifiutato
+ * (mailbox piene, bus off) non viene ripetuto: il tick successivo manda
+ * comunque il frame del suo periodo, l'errore e' contato in tx_errors.
+ * 
+ * @param start_ms HAL_GetTick() all'avvio del profilo
+ * @return true se il frame e' in una mailbox
+ */
+bool CanBus_CtlSchedule_Send(CanCtlSchedule_t *sched, uint32_t start_ms) {
+    const uint8_t *data = CanBus_CtlSchedule_At(sched, HAL_GetTick() - start_ms);
+    if (data == NULL) return false;
+
+    CAN_TxHeaderTypeDef header = {
+        .StdId = sched->extended ? 0 : sched->bus_id,
+        .ExtId = sched->extended ? sched->bus_id : 0,
+        .IDE = sched->extended ? CAN_ID_EXT : CAN_ID_STD,
+        .RTR = CAN_RTR_DATA,
+        .DLC = 8,
+    };
+    uint32_t mailbox;
+    if (HAL_CAN_AddTxMessage(CTL_CAN_HANDLE, &header, (uint8_t *)data, &mailbox) != HAL_OK) {
+        sched->tx_errors++;
+        return false;
+    }
+    return true;
+}
+#endif
+
+
 /* ============================================================================
  * FUNZIONI DI DECODIFICA PACCHETTI RICEVUTI DAL CHARGER
  * ============================================================================ */
@@ -729,6 +889,91 @@ void Example_RandomPacket(void) {
     CanBus_Debug_PrintTst1(random_data);
 }
 
+/**
+ * ESEMPIO 5: Profilo di carica precalcolato
+ * Rampa di corrente, CC, CV e spegnimento: il buffer deve essere identico a
+ * CanBus_CreatePacket_Ctl chiamata a ogni tick, ma senza codifica nel tick.
+ */
+#define EXAMPLE_PROFILE_FRAMES  (60u * 60u * 1000u / CTL_PERIOD_MS + 1u)  /* 1 ora */
+
+static uint8_t profile_frames[EXAMPLE_PROFILE_FRAMES][8];
+
+void Example_CtlSchedule(void) {
+    CanCtlSetpoint_t profile[64];
+    uint32_t n = 0;
+
+    /* Rampa 0 -> 24 A in 20 s, a passi da 1 s */
+    for (uint32_t s = 0; s <= 20; s++) {
+        profile[n++] = (CanCtlSetpoint_t){ s * 1000u, true, 16.0f, 420.0f, 24.0f * s / 20.0f };
+    }
+    /* CC per 40 min, CV a corrente decrescente, stop a 60 min */
+    profile[n++] = (CanCtlSetpoint_t){ 40u * 60u * 1000u, true, 16.0f, 415.0f, 12.0f };
+    profile[n++] = (CanCtlSetpoint_t){ 50u * 60u * 1000u, true, 16.0f, 415.0f, 4.0f };
+    profile[n++] = (CanCtlSetpoint_t){ 60u * 60u * 1000u, false, 0.0f, 0.0f, 0.0f };
+
+    clock_t start = clock();
+    uint32_t count = CanBus_CreatePacket_Ctl_Bulk(profile, n, false, CTL_PERIOD_MS,
+                                                  profile_frames, EXAMPLE_PROFILE_FRAMES);
+    double bulk_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    CanCtlSchedule_t sched;
+    CanBus_CtlSchedule_Init(&sched, profile_frames, count, CTL_PERIOD_MS, CAN_ID_CTL, false);
+
+    /* Confronto con la codifica a ogni tick */
+    uint32_t errors = 0;
+    uint32_t p = 0;
+    start = clock();
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t t = k * CTL_PERIOD_MS;
+        while (p + 1 < n && profile[p + 1].t_ms <= t) p++;
+        uint8_t data[8];
+        CanBus_CreatePacket_Ctl_Simple(profile[p].can_enable, false, profile[p].iac_max_A,
+                                       profile[p].vout_max_V, profile[p].iout_max_A, data);
+        if (memcmp(data, CanBus_CtlSchedule_At(&sched, t + 37), 8) != 0) errors++;
+    }
+    double tick_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("\n\r=== CTL SCHEDULE EXAMPLE ===\n");
+    printf("  Setpoints: %lu -> %lu frames (%lu bytes)\n", (unsigned long)n,
+           (unsigned long)count, (unsigned long)count * 8);
+    printf("  Bulk encode: %.3f ms, per-tick encode + compare: %.3f ms\n",
+           bulk_s * 1000.0, tick_s * 1000.0);
+    printf("  Mismatches vs CanBus_CreatePacket_Ctl: %lu  -> %s\n",
+           (unsigned long)errors, errors == 0 ? "PASS" : "FAIL");
+    printf("\n\r--- Frame at t = 10.05 s (ramp) ---");
+    CanBus_Debug_PrintCtl(CanBus_CtlSchedule_At(&sched, 10050));
+    printf("\n\r--- Frame after the end of the profile ---");
+    CanBus_Debug_PrintCtl(CanBus_CtlSchedule_At(&sched, 2u * 60u * 60u * 1000u));
+}
+
+/**
+ * ESEMPIO 6: Spegnimento a un istante non multiplo del periodo
+ * Abilitazione a 0 ms e disable a 150 ms: dal frame dei 200 ms in poi (anche
+ * dopo la fine del profilo) il CTL deve avere CanEnable = 0.
+ */
+void Example_CtlScheduleStop(void) {
+    const CanCtlSetpoint_t profile[] = {
+        {   0u, true,  16.0f, 400.0f, 20.0f },
+        { 150u, false,  0.0f,   0.0f,  0.0f },
+    };
+    uint8_t frames[4][8];
+    uint32_t count = CanBus_CreatePacket_Ctl_Bulk(profile, 2, false, CTL_PERIOD_MS, frames, 4);
+
+    CanCtlSchedule_t sched;
+    CanBus_CtlSchedule_Init(&sched, frames, count, CTL_PERIOD_MS, CAN_ID_CTL, false);
+
+    uint32_t errors = (count == 3) ? 0 : 1;
+    for (uint32_t t = 0; count > 0 && t <= 1000; t += 10) {
+        bool expected = t < 200;   /* Frame dei 100 ms: vale ancora l'enable */
+        bool enabled = (CanBus_CtlSchedule_At(&sched, t)[0] & 0x80) != 0;
+        if (enabled != expected) errors++;
+    }
+
+    printf("\n\r=== CTL SCHEDULE STOP EXAMPLE ===\n");
+    printf("  Setpoints: 0 ms enable, 150 ms disable -> %lu frames\n", (unsigned long)count);
+    printf("  CanEnable = 0 from 200 ms to 1000 ms: %s\n", errors == 0 ? "PASS" : "FAIL");
+}
+
 int main(void) {
     Example_BasicCtlPacket();
     printf("\n\r###########################\n\r");
@@ -743,6 +988,11 @@ int main(void) {
 
     /* Esempio con pacchetto casuale */
     Example_RandomPacket();
+    printf("\n\r###########################\n\r");
+
+    Example_CtlSchedule();
+    printf("\n\r###########################\n\r");
+    Example_CtlScheduleStop();
     
     return 0;
 }
\ No newline at end of file
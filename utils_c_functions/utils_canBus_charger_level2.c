@@ -14,6 +14,8 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "utils_canBus_fault_table.h"   /* FaultCode_t, FAULT_TABLE[256] (generato) */
+
 
 /* CAN IDs - Level 2 */
 #define CAN_ID_REQ   0x61B  /* BMS → Charger - Request diagnostic */
@@ -71,23 +73,7 @@ typedef struct {
     char serial[9];  /* 8 ASCII characters + null terminator */
 } CanPacket_SerialNumber_t;
 
-/* Fault Code Definitions (from Table 4.6) */
-typedef enum {
-    FAULT_A0_BULK1_VOLTAGE     = 0xA0,
-    FAULT_A1_BULK2_VOLTAGE     = 0xA1,
-    FAULT_A2_BULK3_VOLTAGE     = 0xA2,
-    FAULT_A3_BULK_ERROR        = 0xA3,
-    FAULT_A4_CAN_REGISTERS     = 0xA4,
-    FAULT_A5_CAN_COMMAND       = 0xA5,
-    FAULT_A6_TEMP_LOW          = 0xA6,
-    FAULT_A7_TEMP_DERATING     = 0xA7,
-    FAULT_A8_TEMP_HIGH         = 0xA8,
-    FAULT_A9_TEMP_FAILED       = 0xA9,
-    FAULT_AA_INPUT_CURRENT_MAX = 0xAA,
-    FAULT_AB_HVIL_INTERLOCK    = 0xAB,
-    FAULT_AC_LOGIC_TEMP        = 0xAC,
-    FAULT_AD_OUTPUT_OVERVOLT   = 0xAD
-} FaultCode_t;
+/* Fault Code Definitions (Table 4.6): FaultCode_t in utils_canBus_fault_table.h */
 
 
 /* ============================================================================
@@ -201,13 +187,13 @@ bool CanBus_DecodePacket_Fault(const uint8_t data[8], CanPacket_Fault_t *fault)
     fault->occurrence = (data[3] >> 2) & 0x3F;  /* 6 bit: 0-63 */
     uint8_t level_bits = data[3] & 0x03;
     
-    /* Converti level bits in FailureLevel_t */
-    if (level_bits == 0x00) {
-        fault->failure_level = FAILURE_WARNING;      /* 01 = Warning */
-    } else if (level_bits == 0x02) {
+    /* Converti level bits in FailureLevel_t (00 non definito: come Warning) */
+    if (level_bits == 0x02) {
         fault->failure_level = FAILURE_SOFT;         /* 10 = Soft */
     } else if (level_bits == 0x03) {
         fault->failure_level = FAILURE_HARD;         /* 11 = Hard */
+    } else {
+        fault->failure_level = FAILURE_WARNING;      /* 01 = Warning */
     }
     
     /* D4-D5: First time (Big Endian) */
@@ -290,27 +276,19 @@ void CanBus_Debug_PrintReq(const uint8_t data[8]) {
     }
 }
 
+/**
+ * @brief Metadati del fault code (nome, severità, azione, reset AC)
+ * Accesso diretto alla tabella generata: 256 righe, codici sconosciuti inclusi
+ */
+const FaultInfo_t* CanBus_GetFaultInfo(uint8_t code) {
+    return &FAULT_TABLE[code];
+}
+
 /**
  * @brief Ottiene il nome del fault code
  */
 const char* CanBus_GetFaultName(uint8_t code) {
-    switch (code) {
-        case FAULT_A0_BULK1_VOLTAGE:     return "Bulk 1 Voltage";
-        case FAULT_A1_BULK2_VOLTAGE:     return "Bulk 2 Voltage";
-        case FAULT_A2_BULK3_VOLTAGE:     return "Bulk 3 Voltage";
-        case FAULT_A3_BULK_ERROR:        return "Bulk Error";
-        case FAULT_A4_CAN_REGISTERS:     return "CAN Registers";
-        case FAULT_A5_CAN_COMMAND:       return "CAN Command";
-        case FAULT_A6_TEMP_LOW:          return "Cold Plate Temp LOW";
-        case FAULT_A7_TEMP_DERATING:     return "Cold Plate Temp DERATING";
-        case FAULT_A8_TEMP_HIGH:         return "Cold Plate Temp HIGH";
-        case FAULT_A9_TEMP_FAILED:       return "Cold Plate Temp FAILED";
-        case FAULT_AA_INPUT_CURRENT_MAX: return "Input Current MAX";
-        case FAULT_AB_HVIL_INTERLOCK:    return "HVIL Interlock Loop";
-        case FAULT_AC_LOGIC_TEMP:        return "Logic Temperature";
-        case FAULT_AD_OUTPUT_OVERVOLT:   return "Output Overvoltage";
-        default: return "Unknown Fault";
-    }
+    return FAULT_TABLE[code].name;
 }
 
 /**
@@ -374,11 +352,13 @@ void CanBus_Debug_PrintFault(const uint8_t data[8], bool is_active) {
         printf("  Frame: 1 of 1\n");
     }
     
-    printf("  Fault Code: 0x%02X (%s)\n", fault.fault_code, CanBus_GetFaultName(fault.fault_code));
+    const FaultInfo_t *info = CanBus_GetFaultInfo(fault.fault_code);
+    printf("  Fault Code: 0x%02X (%s)\n", fault.fault_code, info->name);
     printf("  Occurrence: %u times\n", fault.occurrence);
     printf("  Failure Level: %s\n", CanBus_GetFailureLevelStr(fault.failure_level));
     printf("  First Time: %u hours\n", fault.first_time_h);
     printf("  Last Time: %u hours\n", fault.last_time_h);
+    printf("  Action: %s%s\n", info->action, info->ac_reset ? " [AC reset required]" : "");
 }
 
 /**
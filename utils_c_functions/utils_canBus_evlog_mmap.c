@@ -0,0 +1,409 @@
+/* =============================================================================
+ *  FILE: utils_canBus_evlog_mmap.c
+ * =============================================================================
+ *
+ *  EVO Charger CAN Bus Utilities - Lettura registrazioni .evlog via mmap
+ *  (tool PC, non firmware). Il file viene mappato in memoria e i frame sono
+ *  letti come view (timestamp + puntatore al payload dentro la mappatura):
+ *  nessuna copia e nessuna allocazione per frame, la page cache del sistema
+ *  fa il resto, per cui la scansione di un archivio di GB va alla velocita'
+ *  del disco (o della RAM se gia' in cache).
+ *
+ *  - EvLog_Open / EvLog_Close: mappatura read-only (POSIX mmap, Win32 MapViewOfFile)
+ *  - EvLog_Next: iterazione a view (EvLogFrame_t), data punta ai record
+ *  - EvLog_Seek: primo record con timestamp >= t (ricerca binaria, record fissi)
+ *  - EvLog_Scan: decodifica ogni frame EVO con CanBus_DecodePacket_* dei
+ *    livelli 1-4, passando direttamente il puntatore della view
+ *
+ *  Formato: vedi charger_gui/recording.py (header 32 byte, record 24 byte
+ *  little endian). Il tool assume un host little endian (x86, ARM).
+ *
+ *  Compilazione su PC: gcc -std=c11 -O2 utils_canBus_evlog_mmap.c -o evlog_scan
+ *  Uso:                ./evlog_scan sessione.evlog [t0_s [t1_s]]
+ *
+ * =============================================================================
+ */
+
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE             /* mmap / madvise con -std=c11 */
+#endif
+
+#define main level1_main
+#include "utils_canBus_charger_level1.c"
+#undef main
+#define main level2_main
+#include "utils_canBus_charger_level2.c"
+#undef main
+#define main level3_main
+#include "utils_canBus_charger_level3.c"
+#undef main
+#define main level4_main
+#include "utils_canBus_charger_level4.c"
+#undef main
+#define main ids_main
+#include "utils_canBus_charger_ids.c"
+#undef main
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/* Formato .evlog (vedi charger_gui/recording.py) */
+#define EVLOG_MAGIC         "EVOCANLG"
+#define EVLOG_VERSION       1
+#define EVLOG_HEADER_SIZE   32
+#define EVLOG_RECORD_SIZE   24
+#define EVLOG_ID_MASK       0x1FFFFFFFUL
+#define EVLOG_ID_EXTENDED   0x80000000UL
+#define EVLOG_ID_TX         0x40000000UL
+
+/* Record .evlog (24 byte, little endian) */
+typedef struct {
+    uint64_t timestamp_us;
+    uint32_t id;            /* ID | bit 31 esteso | bit 30 Tx */
+    uint8_t dlc;
+    uint8_t channel;
+    uint16_t reserved;
+    uint8_t data[8];
+} EvLogRecord_t;
+
+_Static_assert(sizeof(EvLogRecord_t) == EVLOG_RECORD_SIZE, "record .evlog di 24 byte");
+
+/* Registrazione mappata in memoria */
+typedef struct {
+    const uint8_t *base;            /* Inizio della mappatura (header) */
+    size_t size;                    /* Byte mappati */
+    const EvLogRecord_t *records;   /* Primo record (offset 32: allineato a 8) */
+    size_t count;                   /* Record completi (un ultimo record troncato e' ignorato) */
+    uint64_t start_unix_us;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} EvLogMap_t;
+
+/* View di un frame: punta dentro la mappatura, valida fino a EvLog_Close */
+typedef struct {
+    uint64_t timestamp_us;          /* Dall'inizio della sessione */
+    uint32_t id;                    /* ID senza flag */
+    bool extended;
+    bool tx;
+    uint8_t dlc;
+    const uint8_t *data;            /* 8 byte (zero dopo DLC) */
+} EvLogFrame_t;
+
+/* Risultato della scansione */
+typedef struct {
+    uint64_t frames;
+    uint64_t decoded;               /* Frame EVO passati al decoder */
+    uint64_t per_msg[CAN_MSG_COUNT];
+    uint64_t first_us;
+    uint64_t last_us;
+    float vout_max_V;               /* ACT1 */
+    float iout_max_A;               /* ACT1 */
+    float temp_max_C;               /* Max di ACT1 e TEMP */
+    uint32_t error_latch;           /* Frame STAT con error latch */
+    uint32_t faults;                /* Frame FLTA/FLTP con un fault */
+} EvLogScan_t;
+
+
+/* ============================================================================
+ * MAPPATURA
+ * ============================================================================ */
+
+void EvLog_Close(EvLogMap_t *map);
+
+/**
+ * @brief Mappa una registrazione .evlog in sola lettura e ne verifica l'header
+ * @param map Mappatura (output)
+ * @param path File .evlog
+ * @return true se il file e' una registrazione valida
+ */
+bool EvLog_Open(EvLogMap_t *map, const char *path) {
+    memset(map, 0, sizeof(*map));
+
+#ifdef _WIN32
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (map->file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(map->file, &size) || size.QuadPart < EVLOG_HEADER_SIZE) {
+        CloseHandle(map->file);
+        return false;
+    }
+    map->size = (size_t)size.QuadPart;
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map->mapping == NULL) {
+        CloseHandle(map->file);
+        return false;
+    }
+    map->base = (const uint8_t *)MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (map->base == NULL) {
+        CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        return false;
+    }
+#else
+    map->fd = open(path, O_RDONLY);
+    if (map->fd < 0) return false;
+    struct stat st;
+    if (fstat(map->fd, &st) != 0 || st.st_size < EVLOG_HEADER_SIZE) {
+        close(map->fd);
+        return false;
+    }
+    map->size = (size_t)st.st_size;
+    void *p = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+    if (p == MAP_FAILED) {
+        close(map->fd);
+        return false;
+    }
+    madvise(p, map->size, MADV_SEQUENTIAL);     /* Read-ahead aggressivo */
+    map->base = (const uint8_t *)p;
+#endif
+
+    const uint8_t *h = map->base;
+    if (memcmp(h, EVLOG_MAGIC, 8) != 0 ||
+        (h[8] | (h[9] << 8)) != EVLOG_VERSION ||
+        (h[10] | (h[11] << 8)) != EVLOG_RECORD_SIZE) {
+        EvLog_Close(map);
+        return false;
+    }
+    memcpy(&map->start_unix_us, h + 16, sizeof(uint64_t));
+    map->records = (const EvLogRecord_t *)(h + EVLOG_HEADER_SIZE);
+    map->count = (map->size - EVLOG_HEADER_SIZE) / EVLOG_RECORD_SIZE;
+    return true;
+}
+
+/**
+ * @brief Rilascia la mappatura (le view diventano non valide)
+ */
+void EvLog_Close(EvLogMap_t *map) {
+    if (map->base == NULL) return;
+#ifdef _WIN32
+    UnmapViewOfFile(map->base);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+#else
+    munmap((void *)map->base, map->size);
+    close(map->fd);
+#endif
+    map->base = NULL;
+    map->records = NULL;
+    map->count = 0;
+}
+
+
+/* ============================================================================
+ * ITERAZIONE
+ * ============================================================================ */
+
+/**
+ * @brief Frame successivo come view
+ * @param map Mappatura
+ * @param cursor Indice del record (avanza di 1)
+ * @param frame View (output)
+ * @return false a fine registrazione
+ */
+static inline bool EvLog_Next(const EvLogMap_t *map, size_t *cursor, EvLogFrame_t *frame) {
+    if (*cursor >= map->count) return false;
+    const EvLogRecord_t *r = &map->records[(*cursor)++];
+    frame->timestamp_us = r->timestamp_us;
+    frame->id = r->id & EVLOG_ID_MASK;
+    frame->extended = (r->id & EVLOG_ID_EXTENDED) != 0;
+    frame->tx = (r->id & EVLOG_ID_TX) != 0;
+    frame->dlc = r->dlc;
+    frame->data = r->data;
+    return true;
+}
+
+/**
+ * @brief Primo record con timestamp >= t_us (timestamp non decrescenti)
+ * @return Indice del record, count se tutti precedono t_us
+ */
+size_t EvLog_Seek(const EvLogMap_t *map, uint64_t t_us) {
+    size_t lo = 0, hi = map->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (map->records[mid].timestamp_us < t_us) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+
+/* ============================================================================
+ * SCANSIONE CON I DECODER DI RIFERIMENTO
+ * ============================================================================ */
+
+/**
+ * @brief Decodifica un frame EVO direttamente dalla view
+ */
+static void EvLog_DecodeFrame(CanMsg_t msg, const uint8_t *data, EvLogScan_t *s) {
+    switch (msg) {
+        case CAN_MSG_STAT: {
+            CanPacket_Stat_t p;
+            CanBus_DecodePacket_Stat(data, &p);
+            s->error_latch += p.error_latch;
+            break;
+        }
+        case CAN_MSG_ACT1: {
+            CanPacket_Act1_t p;
+            CanBus_DecodePacket_Act1(data, &p);
+            if (p.vout_V > s->vout_max_V) s->vout_max_V = p.vout_V;
+            if (p.iout_A > s->iout_max_A) s->iout_max_A = p.iout_A;
+            if (p.temp_C > s->temp_max_C) s->temp_max_C = p.temp_C;
+            break;
+        }
+        case CAN_MSG_ACT2: {
+            CanPacket_Act2_t p;
+            CanBus_DecodePacket_Act2(data, &p);
+            break;
+        }
+        case CAN_MSG_TST1: {
+            CanPacket_Tst1_t p;
+            CanBus_DecodePacket_Tst1(data, &p);
+            break;
+        }
+        case CAN_MSG_TST2: {
+            CanPacket_Tst2_t p;
+            CanBus_DecodePacket_Tst2(data, &p);
+            break;
+        }
+        case CAN_MSG_FLTA:
+        case CAN_MSG_FLTP: {
+            if (CanBus_IsNoFaultDetected(data)) break;
+            CanPacket_Fault_t p;
+            CanBus_DecodePacket_Fault(data, &p);
+            s->faults++;
+            break;
+        }
+        case CAN_MSG_SW: {
+            CanPacket_Software_t p;
+            CanBus_DecodePacket_Software(data, &p);
+            break;
+        }
+        case CAN_MSG_SN: {
+            CanPacket_SerialNumber_t p;
+            CanBus_DecodePacket_SerialNumber(data, &p);
+            break;
+        }
+        case CAN_MSG_ACT3: {
+            CanPacket_Act3_t p;
+            CanBus_DecodePacket_Act3(data, &p);
+            break;
+        }
+        case CAN_MSG_TEMP: {
+            CanPacket_Temp_t p;
+            CanBus_DecodePacket_Temp(data, &p);
+            if (p.temp_power1_C > s->temp_max_C) s->temp_max_C = p.temp_power1_C;
+            if (p.temp_power2_C > s->temp_max_C) s->temp_max_C = p.temp_power2_C;
+            if (p.temp_power3_C > s->temp_max_C) s->temp_max_C = p.temp_power3_C;
+            break;
+        }
+        case CAN_MSG_ACT4: {
+            CanPacket_Act4_t p;
+            CanBus_DecodePacket_Act4(data, &p);
+            break;
+        }
+        case CAN_MSG_STST1: {
+            CanPacket_Stst1_t p;
+            CanBus_DecodePacket_Stst1(data, &p);
+            break;
+        }
+        default:
+            break;      /* CTL / REQ: trasmessi dal BMS, nessun decoder nel firmware */
+    }
+}
+
+/**
+ * @brief Scansione dei record [from, to) con decodifica di ogni frame EVO
+ * @param map Mappatura
+ * @param ids Mappa ID bus → (messaggio, charger)
+ * @param from Primo record
+ * @param to Record di fine (escluso)
+ * @param s Risultato (output)
+ */
+void EvLog_Scan(const EvLogMap_t *map, const CanIdMap_t *ids, size_t from, size_t to, EvLogScan_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->temp_max_C = -1000.0f;
+
+    EvLogFrame_t f;
+    size_t cursor = from;
+    while (cursor < to && EvLog_Next(map, &cursor, &f)) {
+        if (s->frames++ == 0) s->first_us = f.timestamp_us;
+        s->last_us = f.timestamp_us;
+
+        CanMsg_t msg;
+        if (!CanIdMap_Lookup(ids, f.id, f.extended, &msg, NULL)) continue;
+        s->per_msg[msg]++;
+        s->decoded++;
+        EvLog_DecodeFrame(msg, f.data, s);
+    }
+}
+
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+static double EvLog_Now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <registrazione.evlog> [t0_s [t1_s]]\n", argv[0]);
+        return 2;
+    }
+
+    EvLogMap_t map;
+    if (!EvLog_Open(&map, argv[1])) {
+        fprintf(stderr, "%s: registrazione .evlog non valida\n", argv[1]);
+        return 1;
+    }
+    static CanIdMap_t ids;
+    if (!CanIdMap_Build(&ids, true, true)) {
+        fprintf(stderr, "Costruzione mappa ID fallita\n");
+        EvLog_Close(&map);
+        return 1;
+    }
+
+    size_t from = argc > 2 ? EvLog_Seek(&map, (uint64_t)(atof(argv[2]) * 1e6)) : 0;
+    size_t to = argc > 3 ? EvLog_Seek(&map, (uint64_t)(atof(argv[3]) * 1e6)) : map.count;
+
+    EvLogScan_t s;
+    double start = EvLog_Now();
+    EvLog_Scan(&map, &ids, from, to, &s);
+    double elapsed = EvLog_Now() - start;
+    double mb = (double)s.frames * EVLOG_RECORD_SIZE / 1e6;
+
+    printf("%s: %zu record, scansione [%zu, %zu)\n", argv[1], map.count, from, to);
+    printf("  %llu frame (%llu EVO) in %.3f s, %.0f MB/s, %.1f Mframe/s\n",
+           (unsigned long long)s.frames, (unsigned long long)s.decoded, elapsed,
+           elapsed > 0 ? mb / elapsed : 0.0, elapsed > 0 ? s.frames / elapsed / 1e6 : 0.0);
+    if (s.frames) {
+        printf("  tempo %.1f - %.1f s\n", s.first_us / 1e6, s.last_us / 1e6);
+    }
+    for (int m = 0; m < CAN_MSG_COUNT; m++) {
+        if (s.per_msg[m]) printf("  %-6s %10llu\n", CAN_MSG_NAME[m], (unsigned long long)s.per_msg[m]);
+    }
+    if (s.per_msg[CAN_MSG_ACT1]) {
+        printf("  ACT1 Vout max %.1f V, Iout max %.1f A\n", s.vout_max_V, s.iout_max_A);
+    }
+    if (s.temp_max_C > -1000.0f) printf("  temperatura max %.1f C\n", s.temp_max_C);
+    printf("  STAT error latch %u, frame fault %u\n", s.error_latch, s.faults);
+
+    EvLog_Close(&map);
+    return 0;
+}
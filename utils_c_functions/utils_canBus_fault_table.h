@@ -0,0 +1,311 @@
+/* =============================================================================
+ *  FILE: utils_canBus_fault_table.h
+ * =============================================================================
+ *
+ *  EVO Charger fault code metadata (Table 4.6), 256 entries indexed by code
+ *
+ *  GENERATED by charger_gui/fault_table.py (python -m charger_gui.fault_table --write)
+ *  Do not edit: change FAULT_SPECS and regenerate.
+ *
+ * =============================================================================
+ */
+
+#ifndef UTILS_CANBUS_FAULT_TABLE_H
+#define UTILS_CANBUS_FAULT_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Fault codes (from Table 4.6) */
+typedef enum {
+    FAULT_A0_BULK1_VOLTAGE      = 0xA0,
+    FAULT_A1_BULK2_VOLTAGE      = 0xA1,
+    FAULT_A2_BULK3_VOLTAGE      = 0xA2,
+    FAULT_A3_BULK_ERROR         = 0xA3,
+    FAULT_A4_CAN_REGISTERS      = 0xA4,
+    FAULT_A5_CAN_COMMAND        = 0xA5,
+    FAULT_A6_TEMP_LOW           = 0xA6,
+    FAULT_A7_TEMP_DERATING      = 0xA7,
+    FAULT_A8_TEMP_HIGH          = 0xA8,
+    FAULT_A9_TEMP_FAILED        = 0xA9,
+    FAULT_AA_INPUT_CURRENT_MAX  = 0xAA,
+    FAULT_AB_HVIL_INTERLOCK     = 0xAB,
+    FAULT_AC_LOGIC_TEMP         = 0xAC,
+    FAULT_AD_OUTPUT_OVERVOLT    = 0xAD
+} FaultCode_t;
+
+/* Failure type of the fault (same values as FailureLevel_t, 0 = not in the table) */
+typedef enum {
+    FAULT_SEV_UNKNOWN = 0,
+    FAULT_SEV_WARNING = 1,     /* charger works, output de-rated */
+    FAULT_SEV_SOFT    = 10,    /* charger stops, restarts when the fault clears */
+    FAULT_SEV_HARD    = 11     /* charger stops until AC mains is cycled */
+} FaultSeverity_t;
+
+typedef struct {
+    const char *name;
+    const char *action;          /* Recommended action */
+    uint8_t severity;            /* FaultSeverity_t */
+    bool ac_reset;               /* Clears only with AC disconnect/reconnect */
+} FaultInfo_t;
+
+static const FaultInfo_t FAULT_TABLE[256] = {
+    /* 0x00 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x01 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x02 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x03 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x04 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x05 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x06 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x07 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x08 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x09 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x0A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x0B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x0C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x0D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x0E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x0F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x10 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x11 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x12 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x13 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x14 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x15 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x16 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x17 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x18 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x19 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x1A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x1B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x1C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x1D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x1E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x1F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x20 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x21 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x22 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x23 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x24 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x25 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x26 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x27 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x28 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x29 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x2A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x2B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x2C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x2D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x2E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x2F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x30 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x31 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x32 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x33 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x34 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x35 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x36 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x37 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x38 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x39 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x3A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x3B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x3C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x3D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x3E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x3F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x40 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x41 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x42 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x43 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x44 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x45 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x46 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x47 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x48 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x49 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x4A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x4B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x4C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x4D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x4E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x4F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x50 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x51 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x52 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x53 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x54 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x55 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x56 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x57 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x58 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x59 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x5A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x5B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x5C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x5D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x5E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x5F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x60 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x61 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x62 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x63 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x64 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x65 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x66 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x67 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x68 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x69 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x6A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x6B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x6C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x6D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x6E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x6F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x70 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x71 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x72 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x73 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x74 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x75 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x76 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x77 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x78 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x79 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x7A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x7B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x7C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x7D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x7E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x7F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x80 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x81 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x82 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x83 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x84 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x85 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x86 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x87 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x88 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x89 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x8A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x8B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x8C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x8D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x8E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x8F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x90 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x91 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x92 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x93 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x94 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x95 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x96 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x97 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x98 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x99 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x9A */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x9B */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x9C */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x9D */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x9E */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0x9F */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xA0 */ { "Bulk 1 Voltage", "Check AC mains supply; clears when bulk > 360 V for 1 s", FAULT_SEV_SOFT, false },
+    /* 0xA1 */ { "Bulk 2 Voltage", "Check AC mains supply; clears when bulk > 360 V for 1 s", FAULT_SEV_SOFT, false },
+    /* 0xA2 */ { "Bulk 3 Voltage", "Check AC mains supply; clears when bulk > 360 V for 1 s", FAULT_SEV_SOFT, false },
+    /* 0xA3 */ { "Bulk Error", "Bulk voltage low for more than 1 min: check mains, then cycle AC", FAULT_SEV_HARD, true },
+    /* 0xA4 */ { "CAN Registers", "Check CAN wiring, termination and bus load", FAULT_SEV_WARNING, false },
+    /* 0xA5 */ { "CAN Command", "CTL not received for 600 ms: check BMS CTL transmission (100 ms)", FAULT_SEV_SOFT, false },
+    /* 0xA6 */ { "Cold Plate Temp LOW", "Cold plate below -30 C: warm up; clears above -25 C", FAULT_SEV_SOFT, false },
+    /* 0xA7 */ { "Cold Plate Temp DERATING", "Cold plate above 65 C, output derated: check coolant flow", FAULT_SEV_WARNING, false },
+    /* 0xA8 */ { "Cold Plate Temp HIGH", "Cold plate over maximum: check cooling; clears below max for 1 s", FAULT_SEV_SOFT, false },
+    /* 0xA9 */ { "Cold Plate Temp FAILED", "Over temperature while still running: check cooling, then cycle AC", FAULT_SEV_HARD, true },
+    /* 0xAA */ { "Input Current MAX", "Input current > 16.5 A for 1 min: lower CTL IacMax, then cycle AC", FAULT_SEV_HARD, true },
+    /* 0xAB */ { "HVIL Interlock Loop", "HVIL loop open: check HV connectors; clears when the loop closes", FAULT_SEV_SOFT, false },
+    /* 0xAC */ { "Logic Temperature", "Logic board over temperature: check cooling and ventilation", FAULT_SEV_SOFT, false },
+    /* 0xAD */ { "Output Overvoltage", "Output over the voltage limit: check CTL VoutMax and pack, then cycle AC", FAULT_SEV_HARD, true },
+    /* 0xAE */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xAF */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB0 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB1 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB2 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB3 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB4 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB5 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB6 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB7 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB8 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xB9 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xBA */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xBB */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xBC */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xBD */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xBE */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xBF */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC0 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC1 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC2 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC3 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC4 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC5 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC6 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC7 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC8 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xC9 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xCA */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xCB */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xCC */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xCD */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xCE */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xCF */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD0 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD1 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD2 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD3 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD4 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD5 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD6 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD7 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD8 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xD9 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xDA */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xDB */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xDC */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xDD */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xDE */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xDF */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE0 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE1 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE2 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE3 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE4 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE5 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE6 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE7 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE8 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xE9 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xEA */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xEB */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xEC */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xED */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xEE */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xEF */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF0 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF1 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF2 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF3 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF4 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF5 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF6 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF7 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF8 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xF9 */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xFA */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xFB */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xFC */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xFD */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xFE */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+    /* 0xFF */ { "Unknown Fault", "Code not in Table 4.6: check charger firmware and manual", FAULT_SEV_UNKNOWN, false },
+};
+
+#endif /* UTILS_CANBUS_FAULT_TABLE_H */
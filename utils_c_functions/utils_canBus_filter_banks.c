@@ -0,0 +1,554 @@
+/* =============================================================================
+ *  FILE: utils_canBus_filter_banks.c
+ * =============================================================================
+ *
+ *  EVO Charger CAN Bus Utilities - Generatore filtri di accettazione
+ *  Calcola un insieme piccolo di coppie ID/maschera per i filtri hardware
+ *  bxCAN / FDCAN a partire dagli ID usati, cosi' la CPU del gateway non
+ *  riceve il resto del traffico della macchina.
+ *
+ *  Algoritmo:
+ *   1. Quine-McCluskey sugli ID: genera tutti gli implicanti primi
+ *      (coppie ID/maschera che accettano SOLO ID voluti)
+ *   2. Copertura: greedy come prima soluzione, poi branch and bound sugli
+ *      implicanti primi; entro FILTER_BNB_NODES nodi il numero di coppie
+ *      e' dimostrato minimo, altrimenti resta la migliore trovata
+ *   3. Se i banchi superano il limite hardware, fonde (greedy) le coppie
+ *      che lasciano passare meno ID indesiderati: qui nessuna garanzia
+ *  Se la tabella degli implicanti si riempie, gli ID rimasti scoperti
+ *  ricevono una coppia esatta (ID/maschera piena); il risultato viene
+ *  comunque verificato: nessun ID richiesto puo' restare fuori dai filtri.
+ *  Il tool stampa se il risultato e' minimo o no.
+ *
+ *  Uso (tool da PC):
+ *      ./filter_banks                        ID del charger e della flotta, 14 e 2 banchi
+ *      ./filter_banks 2                      ID del charger, max 2 banchi
+ *      ./filter_banks -f 14                  ID di tutti i charger (tabella ID del manuale)
+ *      ./filter_banks 4 0x610 0x611 0x712    ID personalizzati
+ *      ./filter_banks -x 4 0x18FF50E5 ...    ID estesi (29 bit)
+ *
+ * =============================================================================
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "utils_canBus_charger_id_table.h"   /* ID di tutti i charger (flotta) */
+
+
+#define FILTER_MAX_IDS      512   /* ID in ingresso (flotta completa: 158 ID) */
+#define FILTER_MAX_CUBES    4096  /* Implicanti intermedi di Quine-McCluskey */
+#define FILTER_MAX_BANKS    28    /* bxCAN: 14 (28 dual CAN), FDCAN: 28 std */
+#define FILTER_BNB_NODES    200000UL  /* Nodi massimi del branch and bound */
+#define FILTER_ID_WORDS     ((FILTER_MAX_IDS + 31) / 32)
+
+#define CAN_STD_ID_BITS     11
+#define CAN_EXT_ID_BITS     29
+
+/* ID del charger ricevuti/trasmessi dal BMS (livelli 1-4) */
+static const uint32_t CHARGER_IDS[] = {
+    0x610, 0x611, 0x612, 0x613, 0x614, 0x615, 0x616, 0x617,
+    0x618, 0x619, 0x61A, 0x61B, 0x61C, 0x61D, 0x61E, 0x61F,
+    0x712, 0x713, 0x714, 0x715, 0x716
+};
+
+/* Flotta: charger 1-12, 15, 16 (LEVEL 1, 2, 4) + LEVEL 3 = 158 ID */
+#define FLEET_MAX_IDS   (CAN_CHARGER_SLOTS * CAN_MSG_SERVICE_FIRST + CAN_MSG_COUNT - CAN_MSG_SERVICE_FIRST)
+
+/* Coppia ID/maschera: un ID passa se (rx_id & mask) == (id & mask) */
+typedef struct {
+    uint32_t id;
+    uint32_t mask;      /* 1 = bit confrontato, 0 = bit indifferente */
+} CanFilter_t;
+
+/* Risultato del generatore */
+typedef struct {
+    CanFilter_t filters[FILTER_MAX_BANKS];
+    uint8_t count;              /* Coppie ID/maschera generate */
+    uint8_t id_bits;            /* 11 o 29 */
+    uint32_t unwanted_pass;     /* ID non richiesti che superano i filtri */
+    bool cubes_full;            /* Tabella implicanti piena: copertura con coppie esatte, non minima */
+    uint16_t cover_count;       /* Coppie della copertura senza ID indesiderati (prima delle fusioni) */
+    bool cover_minimal;         /* ... dimostrate minime dal branch and bound */
+    bool merged;                /* Coppie fuse per stare nei banchi (greedy, ID indesiderati) */
+} CanFilterSet_t;
+
+/* ID voluti accettati da un implicante: bit i = ids[i] */
+typedef struct {
+    uint32_t w[FILTER_ID_WORDS];
+} IdSet_t;
+
+
+/* ============================================================================
+ * FUNZIONI DI SUPPORTO
+ * ============================================================================ */
+
+static uint32_t IdSpaceMask(uint8_t id_bits) {
+    return (id_bits >= 32) ? 0xFFFFFFFFUL : ((1UL << id_bits) - 1UL);
+}
+
+static uint8_t PopCount(uint32_t v) {
+    uint8_t n = 0;
+    while (v) { v &= v - 1; n++; }
+    return n;
+}
+
+/** ID accettato dalla coppia ID/maschera? */
+static bool Filter_Match(const CanFilter_t *f, uint32_t id) {
+    return (id & f->mask) == (f->id & f->mask);
+}
+
+/** Numero di ID voluti accettati dalla coppia */
+static uint32_t Filter_CountWanted(const CanFilter_t *f, const uint32_t *ids, uint32_t n_ids) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < n_ids; i++) {
+        if (Filter_Match(f, ids[i])) n++;
+    }
+    return n;
+}
+
+/** Numero totale di ID accettati da una coppia (2^bit indifferenti) */
+static uint64_t Filter_Span(const CanFilter_t *f, uint8_t id_bits) {
+    uint8_t free_bits = id_bits - PopCount(f->mask & IdSpaceMask(id_bits));
+    return 1ULL << free_bits;
+}
+
+/** Fusione di due coppie: confronta solo i bit uguali in entrambe */
+static CanFilter_t Filter_Merge(const CanFilter_t *a, const CanFilter_t *b) {
+    CanFilter_t m;
+    m.mask = a->mask & b->mask & ~(a->id ^ b->id);
+    m.id = a->id & m.mask;
+    return m;
+}
+
+
+/* ============================================================================
+ * GENERATORE
+ * ============================================================================ */
+
+/**
+ * @brief Implicanti primi degli ID (Quine-McCluskey)
+ * Ogni implicante accetta solo ID presenti nell'insieme
+ * @param full true se qualche implicante e' stato scartato (tabelle piene)
+ * @return numero di implicanti scritti in primes
+ */
+static uint32_t Filter_PrimeImplicants(const uint32_t *ids, uint32_t n_ids, uint8_t id_bits,
+                                       CanFilter_t *primes, uint32_t max_primes, bool *full) {
+    static CanFilter_t level[FILTER_MAX_CUBES], next[FILTER_MAX_CUBES];
+    static bool used[FILTER_MAX_CUBES];
+    uint32_t n_level = 0, n_primes = 0;
+    uint32_t space = IdSpaceMask(id_bits);
+
+    *full = (n_ids > FILTER_MAX_CUBES);
+    for (uint32_t i = 0; i < n_ids && n_level < FILTER_MAX_CUBES; i++) {
+        bool dup = false;
+        for (uint32_t k = 0; k < n_level; k++) {
+            if (level[k].id == (ids[i] & space)) { dup = true; break; }
+        }
+        if (!dup) {
+            level[n_level].id = ids[i] & space;
+            level[n_level].mask = space;
+            n_level++;
+        }
+    }
+
+    while (n_level > 0) {
+        uint32_t n_next = 0;
+        memset(used, 0, n_level * sizeof(bool));
+
+        for (uint32_t i = 0; i < n_level; i++) {
+            for (uint32_t j = i + 1; j < n_level; j++) {
+                if (level[i].mask != level[j].mask) continue;
+                uint32_t diff = (level[i].id ^ level[j].id) & level[i].mask;
+                if (PopCount(diff) != 1) continue;
+
+                used[i] = used[j] = true;
+                CanFilter_t c = { level[i].id & ~diff, level[i].mask & ~diff };
+                bool dup = false;
+                for (uint32_t k = 0; k < n_next; k++) {
+                    if (next[k].id == c.id && next[k].mask == c.mask) { dup = true; break; }
+                }
+                if (dup) continue;
+                if (n_next < FILTER_MAX_CUBES) next[n_next++] = c;
+                else *full = true;
+            }
+        }
+
+        for (uint32_t i = 0; i < n_level; i++) {
+            if (used[i]) continue;
+            if (n_primes < max_primes) primes[n_primes++] = level[i];
+            else *full = true;
+        }
+
+        memcpy(level, next, n_next * sizeof(CanFilter_t));
+        n_level = n_next;
+    }
+    return n_primes;
+}
+
+/* Stato del branch and bound (uno alla volta, tool da PC) */
+static struct {
+    IdSet_t sets[FILTER_MAX_CUBES];     /* ID coperti da ogni implicante */
+    uint32_t size[FILTER_MAX_CUBES];    /* ... e quanti */
+    uint32_t order[FILTER_MAX_CUBES];   /* Implicanti dal piu' grande */
+    uint32_t covers[FILTER_MAX_IDS];    /* Implicanti che coprono ogni ID */
+    uint32_t n_primes, n_words, max_size;
+    uint32_t stack[FILTER_MAX_IDS], depth;
+    uint32_t best[FILTER_MAX_IDS], n_best;
+    bool improved;
+    unsigned long nodes;
+} bnb;
+
+static int Cover_CompareSize(const void *a, const void *b) {
+    uint32_t sa = bnb.size[*(const uint32_t *)a], sb = bnb.size[*(const uint32_t *)b];
+    return (sa < sb) - (sa > sb);
+}
+
+/**
+ * @brief Ricerca ricorsiva di una copertura con meno di n_best implicanti
+ *
+ * Si ramifica sull'ID scoperto con meno implicanti; il limite inferiore e'
+ * ID scoperti / implicante piu' grande.
+ */
+static void Cover_Search(const IdSet_t *uncovered, uint32_t n_uncovered) {
+    if (n_uncovered == 0) {
+        memcpy(bnb.best, bnb.stack, bnb.depth * sizeof(uint32_t));
+        bnb.n_best = bnb.depth;
+        bnb.improved = true;
+        return;
+    }
+    if (bnb.depth + (n_uncovered + bnb.max_size - 1) / bnb.max_size >= bnb.n_best) return;
+    if (++bnb.nodes > FILTER_BNB_NODES) return;
+
+    uint32_t id = 0, fewest = UINT32_MAX;
+    for (uint32_t k = 0; k < bnb.n_words; k++) {
+        for (uint32_t bits = uncovered->w[k]; bits; bits &= bits - 1) {
+            uint32_t i = k * 32;
+            for (uint32_t b = bits & -bits; b > 1; b >>= 1) i++;
+            if (bnb.covers[i] < fewest) { fewest = bnb.covers[i]; id = i; }
+        }
+    }
+
+    for (uint32_t o = 0; o < bnb.n_primes && bnb.nodes <= FILTER_BNB_NODES; o++) {
+        uint32_t p = bnb.order[o];
+        if (!(bnb.sets[p].w[id / 32] & (1UL << (id % 32)))) continue;
+        IdSet_t rest;
+        uint32_t n_rest = 0;
+        for (uint32_t k = 0; k < bnb.n_words; k++) {
+            rest.w[k] = uncovered->w[k] & ~bnb.sets[p].w[k];
+            n_rest += PopCount(rest.w[k]);
+        }
+        bnb.stack[bnb.depth++] = p;
+        Cover_Search(&rest, n_rest);
+        bnb.depth--;
+    }
+}
+
+/**
+ * @brief Copertura minima degli ID con gli implicanti primi (branch and bound)
+ *
+ * Parte dalla soluzione in chosen (greedy) e la sostituisce solo con una
+ * copertura con meno coppie.
+ * @return true se il numero di coppie in chosen e' dimostrato minimo,
+ *         false se la ricerca ha superato FILTER_BNB_NODES nodi
+ */
+static bool Filter_MinimumCover(const uint32_t *ids, uint32_t n_ids, const CanFilter_t *primes,
+                                uint32_t n_primes, CanFilter_t *chosen, uint32_t *n_chosen) {
+    memset(&bnb, 0, sizeof(bnb));
+    bnb.n_primes = n_primes;
+    bnb.n_words = (n_ids + 31) / 32;
+    bnb.n_best = *n_chosen;
+
+    IdSet_t all;
+    memset(&all, 0, sizeof(all));
+    for (uint32_t i = 0; i < n_ids; i++) all.w[i / 32] |= 1UL << (i % 32);
+    for (uint32_t p = 0; p < n_primes; p++) {
+        for (uint32_t i = 0; i < n_ids; i++) {
+            if (!Filter_Match(&primes[p], ids[i])) continue;
+            bnb.sets[p].w[i / 32] |= 1UL << (i % 32);
+            bnb.size[p]++;
+            bnb.covers[i]++;
+        }
+        if (bnb.size[p] > bnb.max_size) bnb.max_size = bnb.size[p];
+        bnb.order[p] = p;
+    }
+    if (bnb.max_size == 0) return false;
+    qsort(bnb.order, n_primes, sizeof(uint32_t), Cover_CompareSize);
+
+    Cover_Search(&all, n_ids);
+    if (bnb.improved) {
+        for (uint32_t k = 0; k < bnb.n_best; k++) chosen[k] = primes[bnb.best[k]];
+        *n_chosen = bnb.n_best;
+    }
+    return bnb.nodes <= FILTER_BNB_NODES;
+}
+
+/**
+ * @brief Calcola le coppie ID/maschera per un insieme di ID
+ *
+ * @param ids ID da accettare
+ * @param n_ids Numero di ID (max FILTER_MAX_IDS)
+ * @param id_bits 11 (standard) o 29 (esteso)
+ * @param max_banks Numero massimo di coppie disponibili nell'hardware
+ * @param out Risultato
+ * @return true se ogni ID e' accettato dai filtri; false con argomenti
+ *         non validi (n_ids > FILTER_MAX_IDS) o copertura incompleta
+ */
+bool CanBus_ComputeFilterBanks(const uint32_t *ids, uint32_t n_ids, uint8_t id_bits,
+                               uint8_t max_banks, CanFilterSet_t *out) {
+    static CanFilter_t primes[FILTER_MAX_CUBES];
+    static bool covered[FILTER_MAX_IDS];
+
+    if (ids == NULL || out == NULL || n_ids == 0 || n_ids > FILTER_MAX_IDS) return false;
+    if (id_bits != CAN_STD_ID_BITS && id_bits != CAN_EXT_ID_BITS) return false;
+    if (max_banks == 0 || max_banks > FILTER_MAX_BANKS) max_banks = FILTER_MAX_BANKS;
+
+    memset(out, 0, sizeof(*out));
+    out->id_bits = id_bits;
+
+    /* 1. Implicanti primi: nessun ID indesiderato */
+    uint32_t n_primes = Filter_PrimeImplicants(ids, n_ids, id_bits, primes, FILTER_MAX_CUBES, &out->cubes_full);
+
+    /* 2. Copertura greedy (ad ogni passo l'implicante che copre piu' ID scoperti),
+     *    poi migliorata e dimostrata minima dal branch and bound */
+    memset(covered, 0, sizeof(covered));
+    uint32_t n_covered = 0;
+    CanFilter_t chosen[FILTER_MAX_IDS];
+    uint32_t n_chosen = 0;
+
+    while (n_covered < n_ids) {
+        uint32_t best = 0, best_gain = 0;
+        for (uint32_t p = 0; p < n_primes; p++) {
+            uint32_t gain = 0;
+            for (uint32_t i = 0; i < n_ids; i++) {
+                if (!covered[i] && Filter_Match(&primes[p], ids[i])) gain++;
+            }
+            if (gain > best_gain) { best_gain = gain; best = p; }
+        }
+        if (best_gain == 0) break;
+        for (uint32_t i = 0; i < n_ids; i++) {
+            if (!covered[i] && Filter_Match(&primes[best], ids[i])) {
+                covered[i] = true;
+                n_covered++;
+            }
+        }
+        chosen[n_chosen++] = primes[best];
+    }
+
+    /* ID senza implicante (tabelle piene): coppia esatta, sempre valida */
+    for (uint32_t i = 0; i < n_ids && n_covered < n_ids; i++) {
+        if (covered[i]) continue;
+        CanFilter_t exact = { ids[i] & IdSpaceMask(id_bits), IdSpaceMask(id_bits) };
+        for (uint32_t k = i; k < n_ids; k++) {
+            if (!covered[k] && Filter_Match(&exact, ids[k])) {
+                covered[k] = true;
+                n_covered++;
+            }
+        }
+        chosen[n_chosen++] = exact;
+    }
+
+    if (!out->cubes_full) {
+        out->cover_minimal = Filter_MinimumCover(ids, n_ids, primes, n_primes, chosen, &n_chosen);
+    }
+
+    out->cover_count = (uint16_t)n_chosen;
+
+    /* 3. Troppi banchi: fonde la coppia che fa passare meno ID indesiderati */
+    out->merged = (n_chosen > max_banks);
+    while (n_chosen > max_banks) {
+        uint32_t bi = 0, bj = 1;
+        uint64_t best_cost = UINT64_MAX;
+        for (uint32_t i = 0; i < n_chosen; i++) {
+            for (uint32_t j = i + 1; j < n_chosen; j++) {
+                CanFilter_t m = Filter_Merge(&chosen[i], &chosen[j]);
+                uint64_t cost = Filter_Span(&m, id_bits) - Filter_CountWanted(&m, ids, n_ids);
+                if (cost < best_cost) { best_cost = cost; bi = i; bj = j; }
+            }
+        }
+        chosen[bi] = Filter_Merge(&chosen[bi], &chosen[bj]);
+        chosen[bj] = chosen[--n_chosen];
+    }
+
+    memcpy(out->filters, chosen, n_chosen * sizeof(CanFilter_t));
+    out->count = (uint8_t)n_chosen;
+
+    /* Verifica finale: un ID richiesto scartato dall'hardware non deve mai passare inosservato */
+    for (uint32_t i = 0; i < n_ids; i++) {
+        bool pass = false;
+        for (uint8_t f = 0; f < out->count && !pass; f++) pass = Filter_Match(&out->filters[f], ids[i]);
+        if (!pass) return false;
+    }
+
+    /* ID indesiderati che passano: conteggio esatto per 11 bit,
+     * somma per banco (limite superiore) per 29 bit */
+    if (id_bits == CAN_STD_ID_BITS) {
+        for (uint32_t rx = 0; rx <= IdSpaceMask(id_bits); rx++) {
+            bool pass = false;
+            for (uint8_t f = 0; f < out->count && !pass; f++) pass = Filter_Match(&out->filters[f], rx);
+            if (!pass) continue;
+            bool wanted = false;
+            for (uint32_t i = 0; i < n_ids && !wanted; i++) wanted = (ids[i] == rx);
+            if (!wanted) out->unwanted_pass++;
+        }
+    } else {
+        for (uint8_t f = 0; f < out->count; f++) {
+            uint64_t extra = Filter_Span(&out->filters[f], id_bits) -
+                             Filter_CountWanted(&out->filters[f], ids, n_ids);
+            out->unwanted_pass += (extra > UINT32_MAX) ? UINT32_MAX : (uint32_t)extra;
+        }
+    }
+    return true;
+}
+
+
+/* ============================================================================
+ * DEBUG FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * @brief Stampa le coppie ID/maschera e la configurazione HAL bxCAN
+ *
+ * bxCAN 32 bit mask mode:
+ *   - Standard: FilterIdHigh = ID << 5
+ *   - Esteso:   FilterId = (ID << 3) | IDE (0x4)
+ * bxCAN 16 bit mask mode (solo ID standard): 2 coppie per banco
+ */
+void CanBus_Debug_PrintFilterBanks(const CanFilterSet_t *set, uint32_t n_ids) {
+    bool ext = (set->id_bits == CAN_EXT_ID_BITS);
+    int w = ext ? 8 : 3;
+
+    printf("\n\rFilter banks (%u-bit IDs, %lu IDs requested):\n", set->id_bits, (unsigned long)n_ids);
+    for (uint8_t f = 0; f < set->count; f++) {
+        printf("  [%2u] ID 0x%0*lX  MASK 0x%0*lX  (accepts %llu IDs)\n", f,
+               w, (unsigned long)set->filters[f].id, w, (unsigned long)set->filters[f].mask,
+               (unsigned long long)Filter_Span(&set->filters[f], set->id_bits));
+    }
+    printf("  Unwanted IDs passing: %lu%s\n", (unsigned long)set->unwanted_pass,
+           ext ? " (upper bound)" : "");
+    if (set->cubes_full) printf("  Implicant table full: exact pairs added, result not minimal\n");
+    else printf("  Cover without unwanted IDs: %u pairs, %s\n", set->cover_count,
+                set->cover_minimal ? "minimal (branch and bound)" : "not proven minimal (search limit)");
+    if (set->merged) printf("  Merged into %u pairs (greedy): unwanted IDs not proven minimal\n", set->count);
+    printf("  bxCAN banks: %u (32-bit mask mode)", set->count);
+    if (!ext) printf(", %u (16-bit mask mode)", (set->count + 1) / 2);
+    printf("\n  FDCAN elements: %u (classic filter, %s)\n", set->count, ext ? "extended" : "standard");
+
+    printf("\n  /* HAL bxCAN, 32-bit mask mode */\n");
+    for (uint8_t f = 0; f < set->count; f++) {
+        uint32_t id = set->filters[f].id, mask = set->filters[f].mask;
+        uint32_t fid = ext ? ((id << 3) | 0x4) : (id << 21);
+        uint32_t fmask = ext ? ((mask << 3) | 0x4) : ((mask << 21) | 0x4);
+        printf("  sFilter.FilterBank = %u; sFilter.FilterIdHigh = 0x%04lX; sFilter.FilterIdLow = 0x%04lX;\n",
+               f, (unsigned long)(fid >> 16), (unsigned long)(fid & 0xFFFF));
+        printf("  sFilter.FilterMaskIdHigh = 0x%04lX; sFilter.FilterMaskIdLow = 0x%04lX;\n",
+               (unsigned long)(fmask >> 16), (unsigned long)(fmask & 0xFFFF));
+        printf("  HAL_CAN_ConfigFilter(&hcan, &sFilter);\n");
+    }
+}
+
+
+/* ============================================================================
+ * EXAMPLES
+ * ============================================================================ */
+
+/** ID di tutti i charger della tabella del manuale, LEVEL 3 una volta sola */
+static uint32_t FleetIds(uint32_t *ids) {
+    uint32_t n = 0;
+    for (uint8_t col = 0; col < CAN_CHARGER_SLOTS; col++) {
+        for (uint8_t m = 0; m < CAN_MSG_COUNT; m++) {
+            if (m >= CAN_MSG_SERVICE_FIRST && col > 0) continue;
+            ids[n++] = CAN_CHARGER_BUS_ID[m][col];
+        }
+    }
+    return n;
+}
+
+/**
+ * ESEMPIO 1: ID del charger senza limite pratico di banchi (nessun ID indesiderato)
+ */
+void Example_ChargerFilters(uint8_t max_banks) {
+    CanFilterSet_t set;
+    uint32_t n = sizeof(CHARGER_IDS) / sizeof(CHARGER_IDS[0]);
+
+    CanBus_ComputeFilterBanks(CHARGER_IDS, n, CAN_STD_ID_BITS, max_banks, &set);
+
+    printf("\n\r=== CHARGER IDS, MAX %u BANKS ===\n", max_banks);
+    CanBus_Debug_PrintFilterBanks(&set, n);
+    /* Risultato atteso con 14 banchi: 4 coppie, nessun ID indesiderato
+     * (0x610/0x7F0 + 3 coppie per 0x712-0x716 che sfruttano anche 0x61x)
+     * Con 2 banchi: 0x610/0x7F0 e 0x610/0x6F8 (passano anche 0x710, 0x711, 0x717) */
+}
+
+/**
+ * ESEMPIO 2: flotta completa (tutti i charger della tabella ID)
+ */
+void Example_FleetFilters(uint8_t max_banks) {
+    CanFilterSet_t set;
+    uint32_t ids[FLEET_MAX_IDS];
+    uint32_t n = FleetIds(ids);
+
+    printf("\n\r=== FLEET IDS (%lu), MAX %u BANKS ===\n", (unsigned long)n, max_banks);
+    if (!CanBus_ComputeFilterBanks(ids, n, CAN_STD_ID_BITS, max_banks, &set)) {
+        printf("  Coverage incomplete: FAIL\n");
+        return;
+    }
+    CanBus_Debug_PrintFilterBanks(&set, n);
+}
+
+
+int main(int argc, char *argv[]) {
+    uint32_t ids[FILTER_MAX_IDS];
+    uint32_t n_ids = 0;
+    uint8_t id_bits = CAN_STD_ID_BITS;
+    bool fleet = false;
+    int arg = 1;
+
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-x") == 0) id_bits = CAN_EXT_ID_BITS;
+        else if (strcmp(argv[arg], "-f") == 0) fleet = true;
+        else break;
+    }
+
+    if (arg >= argc) {
+        printf("\n\r========================================\n");
+        printf("  EVO Charger - CAN Filter Bank Generator\n");
+        printf("========================================\n");
+        Example_ChargerFilters(14);
+        printf("\n\r###########################\n");
+        Example_ChargerFilters(2);
+        printf("\n\r###########################\n");
+        Example_FleetFilters(14);
+        printf("\n\r###########################\n");
+        Example_FleetFilters(2);
+        return 0;
+    }
+
+    uint8_t max_banks = (uint8_t)strtoul(argv[arg++], NULL, 0);
+    if (argc - arg > FILTER_MAX_IDS) {
+        fprintf(stderr, "Too many IDs: %d (max %d)\n", argc - arg, FILTER_MAX_IDS);
+        return 1;
+    }
+    for (; arg < argc; arg++) {
+        ids[n_ids++] = (uint32_t)strtoul(argv[arg], NULL, 16);
+    }
+    if (n_ids == 0 && fleet) {
+        n_ids = FleetIds(ids);
+    } else if (n_ids == 0) {
+        n_ids = sizeof(CHARGER_IDS) / sizeof(CHARGER_IDS[0]);
+        memcpy(ids, CHARGER_IDS, sizeof(CHARGER_IDS));
+    }
+
+    CanFilterSet_t set;
+    if (!CanBus_ComputeFilterBanks(ids, n_ids, id_bits, max_banks, &set)) {
+        fprintf(stderr, "Coverage incomplete or invalid arguments (%lu IDs, %u-bit)\n",
+                (unsigned long)n_ids, id_bits);
+        return 1;
+    }
+    CanBus_Debug_PrintFilterBanks(&set, n_ids);
+    return 0;
+}
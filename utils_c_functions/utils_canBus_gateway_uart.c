@@ -0,0 +1,418 @@
+/* =============================================================================
+ *  FILE: utils_canBus_gateway_uart.c
+ * =============================================================================
+ *
+ *  EVO Charger CAN Bus Utilities - Gateway CAN → Seriale
+ *  Formattazione veloce delle righe "CanBus Rx 0x610 12 34 .." e invio su
+ *  UART tramite DMA con doppio buffer (nessuna printf nel percorso CAN RX)
+ *
+ *  Il formato prodotto e' esattamente quello letto dalla GUI
+ *  (vedi charger_gui/serial_handler.py):
+ *      "CanBus Rx 0x610 12 34 56 78 9A BC DE F0\n"
+ *
+ *  Su STM32 (USE_HAL_DRIVER definito) il trasferimento usa
+ *  HAL_UART_Transmit_DMA() e il contatore di cicli DWT->CYCCNT.
+ *  Su PC il DMA e' simulato per poter provare il modulo con gcc.
+ *
+ *  Compilazione su PC: gcc -std=c11 -Wall -Wextra utils_canBus_gateway_uart.c
+ *
+ * =============================================================================
+ */
+
+
+#ifndef USE_HAL_DRIVER
+#define _POSIX_C_SOURCE 199309L     /* clock_gettime / CLOCK_MONOTONIC con -std=c11 */
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef USE_HAL_DRIVER
+#include "main.h"               /* huart, DWT, __disable_irq() */
+extern UART_HandleTypeDef huart2;
+#define GATEWAY_UART_HANDLE     (&huart2)
+#else
+#include <time.h>
+#endif
+
+
+/* Dimensione di ciascuno dei due buffer TX (byte) */
+#define GATEWAY_UART_TX_BUF_SIZE   512
+
+/* Lunghezza massima di una riga: "CanBus Rx 0x1FFFFFFF " + 8 x "XX " + "\n" */
+#define GATEWAY_LINE_MAX_LEN       48
+
+/* Sezione critica: il buffer viene riempito dal callback CAN RX (ISR)
+ * e scambiato dal callback di fine DMA (altra ISR) */
+#ifdef USE_HAL_DRIVER
+#define GATEWAY_ENTER_CRITICAL()   uint32_t primask__ = __get_PRIMASK(); __disable_irq()
+#define GATEWAY_EXIT_CRITICAL()    __set_PRIMASK(primask__)
+#else
+#define GATEWAY_ENTER_CRITICAL()   do { } while (0)
+#define GATEWAY_EXIT_CRITICAL()    do { } while (0)
+#endif
+
+/* Direzione del frame inoltrato */
+typedef enum {
+    GATEWAY_DIR_RX = 0,  /* Charger → BMS (ricevuto dal bus) */
+    GATEWAY_DIR_TX = 1   /* BMS → Charger (trasmesso sul bus) */
+} GatewayDir_t;
+
+/* Statistiche del forwarder */
+typedef struct {
+    uint32_t frames_forwarded;   /* Righe accodate con successo */
+    uint32_t frames_dropped;     /* Righe scartate (buffer pieno) */
+    uint32_t dma_transfers;      /* Trasferimenti DMA avviati */
+    uint32_t max_fill_bytes;     /* Massimo riempimento raggiunto dal buffer attivo */
+    uint64_t cycles_total;       /* Cicli CPU spesi in Gateway_ForwardFrame */
+    uint32_t cycles_max;         /* Cicli CPU del frame piu' lento */
+} GatewayStats_t;
+
+/* Stato del doppio buffer: uno viene riempito, l'altro e' in trasmissione */
+typedef struct {
+    uint8_t buf[2][GATEWAY_UART_TX_BUF_SIZE];
+    volatile uint16_t fill_len;      /* Byte gia' scritti nel buffer di riempimento */
+    volatile uint8_t fill_idx;       /* Indice del buffer di riempimento (0/1) */
+    volatile bool dma_busy;          /* true se l'altro buffer e' in trasmissione */
+    GatewayStats_t stats;
+} GatewayUart_t;
+
+static GatewayUart_t gw;
+
+/* Tabella nibble → carattere ASCII */
+static const char HEX_DIGITS[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+
+/* ============================================================================
+ * CONTATORE DI CICLI
+ * ============================================================================ */
+
+/**
+ * @brief Abilita il contatore di cicli (DWT su Cortex-M3/M4/M7)
+ */
+static void Gateway_CycleCounterInit(void) {
+#ifdef USE_HAL_DRIVER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief Legge il contatore di cicli
+ * Su PC restituisce nanosecondi: i valori vanno letti come "ns" e non cicli
+ */
+static inline uint32_t Gateway_CycleCounterRead(void) {
+#ifdef USE_HAL_DRIVER
+    return DWT->CYCCNT;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+
+/* ============================================================================
+ * FORMATTAZIONE HEX
+ * ============================================================================ */
+
+/**
+ * @brief Scrive un byte come due cifre hex maiuscole
+ * @return puntatore al carattere successivo
+ */
+static inline char *Hex_PutByte(char *p, uint8_t value) {
+    p[0] = HEX_DIGITS[value >> 4];
+    p[1] = HEX_DIGITS[value & 0x0F];
+    return p + 2;
+}
+
+/**
+ * @brief Lunghezza della riga di un frame, senza formattarla
+ * "CanBus Rx 0x" + ID (3 o 8 cifre) + " XX" per byte + "\n"
+ */
+static inline uint16_t Gateway_LineLength(bool extended, uint8_t dlc) {
+    return (uint16_t)(12 + (extended ? 8 : 3) + 3 * dlc + 1);
+}
+
+/**
+ * @brief Costruisce la riga seriale di un frame CAN senza printf
+ *
+ * Formato: "CanBus Rx 0x610 12 34 56 78 9A BC DE F0\n"
+ *   - ID a 3 cifre per frame standard (11 bit), 8 cifre per frame estesi
+ *   - Un byte hex per ogni byte di payload (DLC 0-8)
+ *
+ * @param dir Direzione (GATEWAY_DIR_RX / GATEWAY_DIR_TX)
+ * @param can_id ID CAN (11 o 29 bit)
+ * @param extended true se frame esteso (29 bit)
+ * @param data Payload
+ * @param dlc Numero di byte del payload (0-8)
+ * @param line Buffer di uscita (almeno GATEWAY_LINE_MAX_LEN byte)
+ * @return numero di caratteri scritti (0 se parametri non validi)
+ */
+uint16_t Gateway_FormatLine(GatewayDir_t dir, uint32_t can_id, bool extended,
+                            const uint8_t *data, uint8_t dlc, char *line) {
+    if (line == NULL || dlc > 8 || (dlc > 0 && data == NULL)) return 0;
+
+    char *p = line;
+    memcpy(p, (dir == GATEWAY_DIR_RX) ? "CanBus Rx 0x" : "CanBus Tx 0x", 12);
+    p += 12;
+
+    if (extended) {
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            *p++ = HEX_DIGITS[(can_id >> shift) & 0x0F];
+        }
+    } else {
+        *p++ = HEX_DIGITS[(can_id >> 8) & 0x07];
+        *p++ = HEX_DIGITS[(can_id >> 4) & 0x0F];
+        *p++ = HEX_DIGITS[can_id & 0x0F];
+    }
+
+    for (uint8_t i = 0; i < dlc; i++) {
+        *p++ = ' ';
+        p = Hex_PutByte(p, data[i]);
+    }
+    *p++ = '\n';
+
+    return (uint16_t)(p - line);
+}
+
+
+/* ============================================================================
+ * DOPPIO BUFFER DMA
+ * ============================================================================ */
+
+/**
+ * @brief Avvia il trasferimento DMA di un buffer pieno
+ */
+static void Gateway_StartDma(const uint8_t *buf, uint16_t len) {
+    gw.stats.dma_transfers++;
+#ifdef USE_HAL_DRIVER
+    HAL_UART_Transmit_DMA(GATEWAY_UART_HANDLE, (uint8_t *)buf, len);
+#else
+    (void)buf;
+    (void)len;
+#endif
+}
+
+/**
+ * @brief Se il DMA e' libero e ci sono dati, scambia i buffer e trasmette
+ * Da chiamare con interrupt disabilitati
+ */
+static void Gateway_KickLocked(void) {
+    if (gw.dma_busy || gw.fill_len == 0) return;
+
+    uint8_t tx_idx = gw.fill_idx;
+    uint16_t tx_len = gw.fill_len;
+
+    gw.fill_idx ^= 1;
+    gw.fill_len = 0;
+    gw.dma_busy = true;
+
+    Gateway_StartDma(gw.buf[tx_idx], tx_len);
+}
+
+/**
+ * @brief Inizializza il forwarder (buffer, statistiche, contatore cicli)
+ */
+void Gateway_Init(void) {
+    memset(&gw, 0, sizeof(gw));
+    Gateway_CycleCounterInit();
+}
+
+/**
+ * @brief Inoltra un frame CAN sulla seriale
+ *
+ * Riserva la lunghezza della riga nel buffer di riempimento e la formatta
+ * direttamente li', poi, se il DMA e' fermo, avvia subito la trasmissione.
+ * La formattazione resta nella sezione critica: costa quanto la memcpy di
+ * una riga gia' pronta (circa 40 byte) e il DMA non puo' partire su una riga
+ * scritta a meta'. Non attende mai la UART: se il buffer e' pieno il frame
+ * viene scartato e conteggiato in frames_dropped.
+ * Puo' essere chiamata da HAL_CAN_RxFifo0MsgPendingCallback().
+ *
+ * @return true se il frame e' stato accodato
+ */
+bool Gateway_ForwardFrame(GatewayDir_t dir, uint32_t can_id, bool extended,
+                          const uint8_t *data, uint8_t dlc) {
+    uint32_t t0 = Gateway_CycleCounterRead();
+    bool queued = false;
+
+    if (dlc > 8 || (dlc > 0 && data == NULL)) return false;
+    uint16_t len = Gateway_LineLength(extended, dlc);
+
+    GATEWAY_ENTER_CRITICAL();
+    if (gw.fill_len + len <= GATEWAY_UART_TX_BUF_SIZE) {
+        Gateway_FormatLine(dir, can_id, extended, data, dlc,
+                           (char *)&gw.buf[gw.fill_idx][gw.fill_len]);
+        gw.fill_len += len;
+        if (gw.fill_len > gw.stats.max_fill_bytes) {
+            gw.stats.max_fill_bytes = gw.fill_len;
+        }
+        gw.stats.frames_forwarded++;
+        queued = true;
+        Gateway_KickLocked();
+    } else {
+        gw.stats.frames_dropped++;
+    }
+    GATEWAY_EXIT_CRITICAL();
+
+    uint32_t cycles = Gateway_CycleCounterRead() - t0;
+    gw.stats.cycles_total += cycles;
+    if (cycles > gw.stats.cycles_max) gw.stats.cycles_max = cycles;
+
+    return queued;
+}
+
+/**
+ * @brief Da chiamare a fine trasferimento DMA (HAL_UART_TxCpltCallback)
+ * Libera il buffer trasmesso e parte subito con quello riempito nel frattempo
+ */
+void Gateway_OnDmaComplete(void) {
+    GATEWAY_ENTER_CRITICAL();
+    gw.dma_busy = false;
+    Gateway_KickLocked();
+    GATEWAY_EXIT_CRITICAL();
+}
+
+#ifdef USE_HAL_DRIVER
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart == GATEWAY_UART_HANDLE) {
+        Gateway_OnDmaComplete();
+    }
+}
+#endif
+
+/**
+ * @brief Restituisce una copia delle statistiche
+ */
+GatewayStats_t Gateway_GetStats(void) {
+    GatewayStats_t copy;
+    GATEWAY_ENTER_CRITICAL();
+    copy = gw.stats;
+    GATEWAY_EXIT_CRITICAL();
+    return copy;
+}
+
+
+/* ============================================================================
+ * CALCOLO THROUGHPUT
+ * ============================================================================ */
+
+/**
+ * @brief Frame/s massimi sostenibili da un link seriale
+ *
+ * @param line_len Lunghezza della riga in caratteri (40 per un frame da 8 byte)
+ * @param bit_rate Bit/s del link (115200, 921600, ...)
+ * @param bits_per_char Bit per carattere: 10 per UART 8N1, 8 per USB-CDC
+ * @return frame al secondo
+ */
+uint32_t Gateway_MaxFrameRate(uint16_t line_len, uint32_t bit_rate, uint8_t bits_per_char) {
+    if (line_len == 0 || bits_per_char == 0) return 0;
+    return bit_rate / ((uint32_t)line_len * bits_per_char);
+}
+
+
+/* ============================================================================
+ * DEBUG FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * @brief Stampa statistiche e frame rate massimi per i link tipici
+ */
+void Gateway_Debug_PrintStats(void) {
+    GatewayStats_t s = Gateway_GetStats();
+    uint8_t act1[8] = {0};
+    char line[GATEWAY_LINE_MAX_LEN];
+    uint16_t len = Gateway_FormatLine(GATEWAY_DIR_RX, 0x611, false, act1, 8, line);
+
+    printf("\n\rGateway UART Stats:\n");
+    printf("  Frames forwarded: %lu\n", (unsigned long)s.frames_forwarded);
+    printf("  Frames dropped: %lu\n", (unsigned long)s.frames_dropped);
+    printf("  DMA transfers: %lu\n", (unsigned long)s.dma_transfers);
+    printf("  Max buffer fill: %lu / %u bytes\n", (unsigned long)s.max_fill_bytes, GATEWAY_UART_TX_BUF_SIZE);
+#ifdef USE_HAL_DRIVER
+    const char *unit = "cycles";
+#else
+    const char *unit = "ns (host)";
+#endif
+    if (s.frames_forwarded + s.frames_dropped > 0) {
+        printf("  Avg per frame: %lu %s\n",
+               (unsigned long)(s.cycles_total / (s.frames_forwarded + s.frames_dropped)), unit);
+    }
+    printf("  Max per frame: %lu %s\n", (unsigned long)s.cycles_max, unit);
+
+    printf("  === Max frame rate (%u chars/frame) ===\n", len);
+    printf("  UART 115200 8N1: %lu frame/s\n", (unsigned long)Gateway_MaxFrameRate(len, 115200, 10));
+    printf("  UART 921600 8N1: %lu frame/s\n", (unsigned long)Gateway_MaxFrameRate(len, 921600, 10));
+    printf("  USB-CDC FS (~8 Mbit/s utili): %lu frame/s\n", (unsigned long)Gateway_MaxFrameRate(len, 8000000, 8));
+}
+
+
+/* ============================================================================
+ * EXAMPLES
+ * ============================================================================ */
+
+/**
+ * ESEMPIO 1: Formattazione di una riga ACT1
+ */
+void Example_FormatLine(void) {
+    uint8_t act1[8] = {0x00, 0xA0, 0x30, 0xF7, 0x0E, 0x10, 0x00, 0xAA};
+    char line[GATEWAY_LINE_MAX_LEN + 1];
+
+    uint16_t len = Gateway_FormatLine(GATEWAY_DIR_RX, 0x611, false, act1, 8, line);
+    line[len] = '\0';
+
+    printf("\n\r=== FORMAT LINE EXAMPLE ===\n");
+    printf("  %s", line);
+    /* Risultato atteso: "CanBus Rx 0x611 00 A0 30 F7 0E 10 00 AA" */
+
+    /* Lo spazio riservato nel buffer DMA deve essere esattamente la riga scritta */
+    int errors = 0;
+    for (uint8_t dlc = 0; dlc <= 8; dlc++) {
+        uint16_t std_len = Gateway_FormatLine(GATEWAY_DIR_TX, 0x618, false, act1, dlc, line);
+        uint16_t ext_len = Gateway_FormatLine(GATEWAY_DIR_RX, 0x18FF50E5, true, act1, dlc, line);
+        if (std_len != Gateway_LineLength(false, dlc)) errors++;
+        if (ext_len != Gateway_LineLength(true, dlc)) errors++;
+    }
+    printf("  Line length (DLC 0-8, 11/29 bit): %s\n", errors == 0 ? "PASS" : "FAIL");
+}
+
+/**
+ * ESEMPIO 2: Raffica di frame con DMA simulato
+ * Il DMA "completa" un trasferimento ogni 4 frame ricevuti
+ */
+void Example_ForwardBurst(void) {
+    uint8_t data[8] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0};
+
+    Gateway_Init();
+    for (int i = 0; i < 100000; i++) {
+        data[7] = (uint8_t)i;
+        Gateway_ForwardFrame(GATEWAY_DIR_RX, 0x610 + (i % 6), false, data, 8);
+        if ((i % 4) == 3) {
+            Gateway_OnDmaComplete();
+        }
+    }
+
+    printf("\n\r=== FORWARD BURST EXAMPLE ===\n");
+    Gateway_Debug_PrintStats();
+}
+
+
+int main(void) {
+    printf("\n\r========================================\n");
+    printf("  EVO Charger - Gateway UART Forwarder\n");
+    printf("========================================\n");
+
+    Example_FormatLine();
+    printf("\n\r###########################\n");
+
+    Example_ForwardBurst();
+
+    return 0;
+}
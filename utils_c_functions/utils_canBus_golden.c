@@ -0,0 +1,289 @@
+/* =============================================================================
+ *  FILE: utils_canBus_golden.c
+ * =============================================================================
+ *
+ *  EVO Charger CAN Bus Utilities - Harness del golden corpus
+ *  Decodifica una registrazione .evlog (charger_gui/recording.py) con i
+ *  decoder di riferimento CanBus_DecodePacket_* dei livelli 1-4 e scrive i
+ *  valori decodificati, che la suite Python confronta con i propri decoder.
+ *
+ *  - Include i quattro file di livello cosi' come sono (main rinominato)
+ *  - Per ogni frame con ID base EVO: un double per campo, nell'ordine dei
+ *    campi di charger_gui/signals.py (SIGNALS)
+ *  - Fault "No Fault Detected": tutti i campi NaN
+ *  - SW / SN: 8 valori, uno per byte
+ *  - Frame con ID non EVO: nessun valore
+ *
+ *  Compilazione su PC: gcc -std=c11 -O2 utils_canBus_golden.c -o golden
+ *  Uso:                ./golden corpus.evlog valori.bin
+ *
+ * =============================================================================
+ */
+
+
+#define main level1_main
+#include "utils_canBus_charger_level1.c"
+#undef main
+#define main level2_main
+#include "utils_canBus_charger_level2.c"
+#undef main
+#define main level3_main
+#include "utils_canBus_charger_level3.c"
+#undef main
+#define main level4_main
+#include "utils_canBus_charger_level4.c"
+#undef main
+
+#include <math.h>
+
+
+/* Formato .evlog (vedi charger_gui/recording.py) */
+#define EVLOG_MAGIC         "EVOCANLG"
+#define EVLOG_VERSION       1
+#define EVLOG_HEADER_SIZE   32
+#define EVLOG_RECORD_SIZE   24
+#define EVLOG_ID_MASK       0x1FFFFFFFUL
+#define EVLOG_ID_EXTENDED   0x80000000UL
+
+#define GOLDEN_MAX_VALUES   32
+#define GOLDEN_BATCH        4096  /* Record letti per fread */
+
+/* Record .evlog (24 byte, little endian) */
+typedef struct {
+    uint64_t timestamp_us;
+    uint32_t id;            /* ID | bit 31 esteso | bit 30 Tx */
+    uint8_t dlc;
+    uint8_t channel;
+    uint16_t reserved;
+    uint8_t data[8];
+} EvLogRecord_t;
+
+_Static_assert(sizeof(EvLogRecord_t) == EVLOG_RECORD_SIZE, "record .evlog di 24 byte");
+
+
+/* ============================================================================
+ * DECODER MANCANTI (BMS → Charger)
+ * ============================================================================ */
+
+/* Il firmware costruisce CTL e REQ ma non li decodifica: qui il layout
+ * e' quello di CanBus_CreatePacket_Ctl / CanBus_CreatePacket_Req */
+static void Golden_DecodeCtl(const uint8_t data[8], double *v) {
+    v[0] = (data[0] & 0x80) != 0;                               /* CanEnable */
+    v[1] = (data[0] & 0x08) != 0;                               /* LED3_A */
+    v[2] = (uint16_t)((data[1] << 8) | data[2]) / 10.0f;        /* IacMaxSet */
+    v[3] = (uint16_t)((data[3] << 8) | data[4]) / 10.0f;        /* VoutMaxSet */
+    v[4] = (uint16_t)((data[5] << 8) | data[6]) / 10.0f;        /* IoutMaxSet */
+}
+
+static void Golden_DecodeReq(const uint8_t data[8], double *v) {
+    v[0] = (data[0] & 0x80) != 0;
+    v[1] = (uint16_t)((data[2] << 8) | data[3]);
+}
+
+
+/* ============================================================================
+ * DECODIFICA DI UN FRAME
+ * ============================================================================ */
+
+/**
+ * @brief Decodifica un frame con il decoder di riferimento del suo ID
+ * @param id ID base (charger 1, 11 bit)
+ * @param data Payload
+ * @param v Valori in uscita (almeno GOLDEN_MAX_VALUES)
+ * @return Numero di valori scritti, 0 se l'ID non e' un ID EVO
+ */
+static int Golden_DecodeFrame(uint32_t id, const uint8_t data[8], double *v) {
+    int n = 0;
+
+    switch (id) {
+        case CAN_ID_CTL:
+            Golden_DecodeCtl(data, v);
+            return 5;
+
+        case CAN_ID_STAT: {
+            CanPacket_Stat_t p;
+            CanBus_DecodePacket_Stat(data, &p);
+            v[n++] = p.power_enable; v[n++] = p.error_latch; v[n++] = p.warn_limit;
+            v[n++] = p.lim_temp; v[n++] = p.warning_hv; v[n++] = p.bulks;
+            return n;
+        }
+
+        case CAN_ID_ACT1: {
+            CanPacket_Act1_t p;
+            CanBus_DecodePacket_Act1(data, &p);
+            v[n++] = p.iac_A; v[n++] = p.temp_C; v[n++] = p.vout_V; v[n++] = p.iout_A;
+            return n;
+        }
+
+        case CAN_ID_ACT2: {
+            CanPacket_Act2_t p;
+            CanBus_DecodePacket_Act2(data, &p);
+            v[n++] = p.temp_loglv_C; v[n++] = p.ac_power_kW;
+            v[n++] = p.prox_limit_A; v[n++] = p.pilot_limit_A;
+            return n;
+        }
+
+        case CAN_ID_TST1: {
+            CanPacket_Tst1_t p;
+            CanBus_DecodePacket_Tst1(data, &p);
+            v[n++] = p.ack; v[n++] = p.pr_compl; v[n++] = p.pwr_ok; v[n++] = p.vout_ok;
+            v[n++] = p.neutral; v[n++] = p.led3; v[n++] = p.led618;
+            v[n++] = p.ovp; v[n++] = p.conn_open; v[n++] = p.ther_fail; v[n++] = p.rx618_fail;
+            v[n++] = p.bulk1_fail; v[n++] = p.bulk2_fail; v[n++] = p.bulk3_fail;
+            v[n++] = p.pump_on; v[n++] = p.fan_on; v[n++] = p.hv_rx_fail;
+            v[n++] = p.cooling_fail; v[n++] = p.rx619_fail;
+            v[n++] = p.neutro1; v[n++] = p.neutro2; v[n++] = p.three_phase;
+            v[n++] = p.iac_fail; v[n++] = p.ignition; v[n++] = p.lv_battery_np;
+            v[n++] = p.prox_ok; v[n++] = p.pilot_ok; v[n++] = p.s2_ok;
+            v[n++] = p.cnt_hours;
+            return n;
+        }
+
+        case CAN_ID_REQ:
+            Golden_DecodeReq(data, v);
+            return 2;
+
+        case CAN_ID_FLTA:
+        case CAN_ID_FLTP: {
+            if (CanBus_IsNoFaultDetected(data)) {
+                for (n = 0; n < 8; n++) v[n] = NAN;
+                return n;
+            }
+            CanPacket_Fault_t p;
+            CanBus_DecodePacket_Fault(data, &p);
+            v[n++] = p.frame_type; v[n++] = p.total_errors; v[n++] = p.frame_number;
+            v[n++] = p.fault_code; v[n++] = p.occurrence; v[n++] = p.failure_level;
+            v[n++] = p.first_time_h; v[n++] = p.last_time_h;
+            return n;
+        }
+
+        case CAN_ID_SW: {
+            CanPacket_Software_t p;
+            CanBus_DecodePacket_Software(data, &p);
+            for (n = 0; n < 8; n++) v[n] = (uint8_t)p.version[n];
+            return n;
+        }
+
+        case CAN_ID_SN: {
+            CanPacket_SerialNumber_t p;
+            CanBus_DecodePacket_SerialNumber(data, &p);
+            for (n = 0; n < 8; n++) v[n] = (uint8_t)p.serial[n];
+            return n;
+        }
+
+        case CAN_ID_TST2: {
+            CanPacket_Tst2_t p;
+            CanBus_DecodePacket_Tst2(data, &p);
+            v[n++] = p.baudrate; v[n++] = p.id_type; v[n++] = p.iac_control; v[n++] = p.range;
+            v[n++] = p.three_phase; v[n++] = p.slave; v[n++] = p.evc_model;
+            v[n++] = p.id_setting; v[n++] = p.air_cooler; v[n++] = p.parallel_ctrl;
+            v[n++] = p.iacm_max_set_A; v[n++] = p.vout_max_set_V; v[n++] = p.iout_max_set_A;
+            v[n++] = p.password;
+            return n;
+        }
+
+        case CAN_ID_ACT3: {
+            CanPacket_Act3_t p;
+            CanBus_DecodePacket_Act3(data, &p);
+            v[n++] = p.fan_voltage_V; v[n++] = p.iacm1_A; v[n++] = p.iacm2_A; v[n++] = p.iacm3_A;
+            return n;
+        }
+
+        case CAN_ID_TEMP: {
+            CanPacket_Temp_t p;
+            CanBus_DecodePacket_Temp(data, &p);
+            v[n++] = p.temp_loghv_C; v[n++] = p.temp_power1_C;
+            v[n++] = p.temp_power2_C; v[n++] = p.temp_power3_C;
+            return n;
+        }
+
+        case CAN_ID_ACT4: {
+            CanPacket_Act4_t p;
+            CanBus_DecodePacket_Act4(data, &p);
+            v[n++] = p.temp_logfan_C; v[n++] = p.iout1_raw; v[n++] = p.iout2_raw; v[n++] = p.iout3_raw;
+            return n;
+        }
+
+        case CAN_ID_STST1: {
+            CanPacket_Stst1_t p;
+            CanBus_DecodePacket_Stst1(data, &p);
+            v[n++] = p.pfc_enable; v[n++] = p.log_temp_high; v[n++] = p.log_temp_low;
+            v[n++] = p.uvlo_log; v[n++] = p.ther_low_fail; v[n++] = p.rx618_fail;
+            v[n++] = p.bulk1_fail; v[n++] = p.bulk2_fail; v[n++] = p.bulk3_fail;
+            v[n++] = p.cooling_fail1; v[n++] = p.cooling_fail2; v[n++] = p.cooling_fail3;
+            v[n++] = p.uvlo_log_lv; v[n++] = p.bat_over; v[n++] = p.bat_under;
+            return n;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+
+/* ============================================================================
+ * MAIN
+ * ============================================================================ */
+
+/**
+ * @brief Decodifica tutta la registrazione in blocchi di GOLDEN_BATCH record
+ * @return Numero di frame decodificati, -1 se il file non e' valido
+ */
+static long Golden_Run(FILE *in, FILE *out) {
+    static EvLogRecord_t batch[GOLDEN_BATCH];
+    static double values[GOLDEN_BATCH * GOLDEN_MAX_VALUES];
+    uint8_t header[EVLOG_HEADER_SIZE];
+    long decoded = 0;
+
+    if (fread(header, 1, EVLOG_HEADER_SIZE, in) != EVLOG_HEADER_SIZE) return -1;
+    if (memcmp(header, EVLOG_MAGIC, 8) != 0) return -1;
+    if ((header[8] | (header[9] << 8)) != EVLOG_VERSION) return -1;
+    if ((header[10] | (header[11] << 8)) != EVLOG_RECORD_SIZE) return -1;
+
+    size_t n;
+    while ((n = fread(batch, EVLOG_RECORD_SIZE, GOLDEN_BATCH, in)) > 0) {
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) {
+            /* Solo frame standard: il corpus usa gli ID base del charger 1 */
+            if (batch[i].id & EVLOG_ID_EXTENDED) continue;
+            int k = Golden_DecodeFrame(batch[i].id & EVLOG_ID_MASK, batch[i].data, &values[count]);
+            if (k > 0) decoded++;
+            count += (size_t)k;
+        }
+        fwrite(values, sizeof(double), count, out);
+    }
+    return decoded;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s <registrazione.evlog> [valori.bin | -]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    FILE *out = (argc > 2 && strcmp(argv[2], "-") != 0) ? fopen(argv[2], "wb") : stdout;
+    if (out == NULL) {
+        perror(argv[2]);
+        fclose(in);
+        return 2;
+    }
+
+    clock_t start = clock();
+    long decoded = Golden_Run(in, out);
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    fclose(in);
+    if (out != stdout) fclose(out);
+
+    if (decoded < 0) {
+        fprintf(stderr, "%s: registrazione .evlog non valida\n", argv[1]);
+        return 1;
+    }
+    fprintf(stderr, "Golden: %ld frame decodificati in %.3f s\n", decoded, elapsed);
+    return 0;
+}
@@ -0,0 +1,354 @@
+/* =============================================================================
+ *  FILE: utils_canBus_rx_fifo.c
+ * =============================================================================
+ *
+ *  EVO Charger CAN Bus Utilities - FIFO di ricezione CAN
+ *  Coda lock-free single-producer / single-consumer tra interrupt CAN RX
+ *  (producer) e main loop (consumer), in C11 atomics
+ *
+ *  - Push dall'ISR: O(1), nessun lock, nessuna disabilitazione interrupt
+ *  - Pop a blocchi dal main loop: O(1) di overhead + copia dei record
+ *  - Statistiche: high-water mark e numero di overflow
+ *
+ *  I record contengono ID, DLC, timestamp e payload, pronti da passare ai
+ *  decoder CanBus_DecodePacket_*(const uint8_t data[8], ...).
+ *  Su PC l'esempio usa un thread POSIX come "ISR" per provare la coda.
+ *
+ *  Compilazione su PC: gcc -std=c11 -pthread utils_canBus_rx_fifo.c
+ *
+ * =============================================================================
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#ifdef USE_HAL_DRIVER
+#include "main.h"               /* hcan, HAL_GetTick() */
+#endif
+
+
+/* Capacita' della coda (record): deve essere una potenza di 2 */
+#define CAN_RX_FIFO_SIZE   64
+#define CAN_RX_FIFO_MASK   (CAN_RX_FIFO_SIZE - 1)
+
+#if (CAN_RX_FIFO_SIZE & CAN_RX_FIFO_MASK) != 0
+#error "CAN_RX_FIFO_SIZE deve essere una potenza di 2"
+#endif
+
+/* Flag nel campo id del record */
+#define CAN_RX_ID_EXTENDED  0x80000000UL  /* Frame esteso (29 bit) */
+#define CAN_RX_ID_MASK      0x1FFFFFFFUL
+
+/* Record di un frame CAN ricevuto (20 byte) */
+typedef struct {
+    uint32_t id;            /* ID CAN (bit 31 = esteso) */
+    uint32_t timestamp_ms;  /* Istante di ricezione [ms] */
+    uint8_t dlc;            /* Numero di byte validi (0-8) */
+    uint8_t reserved[3];
+    uint8_t data[8];        /* Payload */
+} CanRxFrame_t;
+
+/* Coda SPSC
+ * head: scritto solo dal consumer, tail: scritto solo dal producer.
+ * Gli indici crescono liberamente e vengono mascherati all'accesso,
+ * cosi' pieno (tail - head == SIZE) e vuoto (tail == head) si distinguono. */
+typedef struct {
+    CanRxFrame_t frames[CAN_RX_FIFO_SIZE];
+    atomic_uint_fast32_t head;        /* Prossimo record da leggere */
+    atomic_uint_fast32_t tail;        /* Prossimo record da scrivere */
+    atomic_uint_fast32_t overflows;   /* Frame scartati a coda piena (solo producer) */
+    atomic_uint_fast32_t high_water;  /* Massima occupazione osservata (solo producer) */
+} CanRxFifo_t;
+
+
+/* ============================================================================
+ * FIFO FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * @brief Inizializza (svuota) la coda e azzera le statistiche
+ * Da chiamare prima di abilitare l'interrupt CAN RX
+ */
+void CanRxFifo_Init(CanRxFifo_t *fifo) {
+    if (fifo == NULL) return;
+    atomic_init(&fifo->head, 0);
+    atomic_init(&fifo->tail, 0);
+    atomic_init(&fifo->overflows, 0);
+    atomic_init(&fifo->high_water, 0);
+}
+
+/**
+ * @brief Inserisce un frame (lato ISR, unico producer)
+ *
+ * @param fifo Coda
+ * @param id ID CAN, eventualmente con CAN_RX_ID_EXTENDED
+ * @param data Payload (dlc byte)
+ * @param dlc Numero di byte (0-8)
+ * @param timestamp_ms Istante di ricezione
+ * @return true se inserito, false se coda piena (overflow conteggiato)
+ */
+bool CanRxFifo_Push(CanRxFifo_t *fifo, uint32_t id, const uint8_t *data,
+                    uint8_t dlc, uint32_t timestamp_ms) {
+    if (dlc > 8) dlc = 8;
+
+    uint_fast32_t tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+    uint_fast32_t head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+    uint_fast32_t used = (uint_fast32_t)(tail - head);
+
+    if (used >= CAN_RX_FIFO_SIZE) {
+        atomic_store_explicit(&fifo->overflows,
+                              atomic_load_explicit(&fifo->overflows, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+
+    CanRxFrame_t *slot = &fifo->frames[tail & CAN_RX_FIFO_MASK];
+    slot->id = id;
+    slot->timestamp_ms = timestamp_ms;
+    slot->dlc = dlc;
+    memset(slot->data, 0, 8);
+    if (dlc > 0 && data != NULL) {
+        memcpy(slot->data, data, dlc);
+    }
+
+    /* Release: il record e' visibile prima del nuovo tail */
+    atomic_store_explicit(&fifo->tail, tail + 1, memory_order_release);
+
+    if (used + 1 > atomic_load_explicit(&fifo->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&fifo->high_water, used + 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+/**
+ * @brief Estrae fino a max_frames record in un colpo solo (lato main loop)
+ *
+ * Legge tail una sola volta e libera tutti i record con un'unica store di
+ * head: il costo fisso non dipende dal numero di frame estratti.
+ *
+ * @param fifo Coda
+ * @param out Array di destinazione
+ * @param max_frames Dimensione di out
+ * @return numero di record copiati in out
+ */
+uint32_t CanRxFifo_PopBulk(CanRxFifo_t *fifo, CanRxFrame_t *out, uint32_t max_frames) {
+    if (fifo == NULL || out == NULL || max_frames == 0) return 0;
+
+    uint_fast32_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+    uint32_t count = (uint32_t)(tail - head);
+    if (count > max_frames) count = max_frames;
+    if (count == 0) return 0;
+
+    /* Al massimo due memcpy: fino a fine array e dopo il wrap */
+    uint32_t start = (uint32_t)(head & CAN_RX_FIFO_MASK);
+    uint32_t first = CAN_RX_FIFO_SIZE - start;
+    if (first > count) first = count;
+    memcpy(out, &fifo->frames[start], first * sizeof(CanRxFrame_t));
+    if (count > first) {
+        memcpy(out + first, &fifo->frames[0], (count - first) * sizeof(CanRxFrame_t));
+    }
+
+    atomic_store_explicit(&fifo->head, head + count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief Restituisce i record contigui disponibili senza copiarli
+ *
+ * Il chiamante elabora frames[0..n-1] sul posto e poi chiama
+ * CanRxFifo_Release(fifo, n). Dopo un wrap servono due chiamate.
+ *
+ * @return numero di record contigui a partire da *frames
+ */
+uint32_t CanRxFifo_PeekSpan(CanRxFifo_t *fifo, const CanRxFrame_t **frames) {
+    if (fifo == NULL || frames == NULL) return 0;
+
+    uint_fast32_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    uint_fast32_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+    uint32_t count = (uint32_t)(tail - head);
+    uint32_t start = (uint32_t)(head & CAN_RX_FIFO_MASK);
+
+    if (count > CAN_RX_FIFO_SIZE - start) count = CAN_RX_FIFO_SIZE - start;
+    *frames = &fifo->frames[start];
+    return count;
+}
+
+/**
+ * @brief Libera n record ottenuti con CanRxFifo_PeekSpan
+ */
+void CanRxFifo_Release(CanRxFifo_t *fifo, uint32_t n) {
+    uint_fast32_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    atomic_store_explicit(&fifo->head, head + n, memory_order_release);
+}
+
+/**
+ * @brief Numero di record in coda (valore indicativo se letto durante un push)
+ */
+uint32_t CanRxFifo_Count(CanRxFifo_t *fifo) {
+    uint_fast32_t head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+    uint_fast32_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+    return (uint32_t)(tail - head);
+}
+
+/**
+ * @brief Numero di frame scartati per coda piena
+ */
+uint32_t CanRxFifo_GetOverflows(CanRxFifo_t *fifo) {
+    return (uint32_t)atomic_load_explicit(&fifo->overflows, memory_order_relaxed);
+}
+
+/**
+ * @brief Massima occupazione raggiunta dalla coda
+ */
+uint32_t CanRxFifo_GetHighWater(CanRxFifo_t *fifo) {
+    return (uint32_t)atomic_load_explicit(&fifo->high_water, memory_order_relaxed);
+}
+
+
+/* ============================================================================
+ * INTEGRAZIONE STM32 (HAL bxCAN)
+ * ============================================================================ */
+
+#ifdef USE_HAL_DRIVER
+CanRxFifo_t can_rx_fifo;
+
+/**
+ * @brief Callback HAL: sposta il frame dalla FIFO hardware alla coda software
+ */
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
+    CAN_RxHeaderTypeDef header;
+    uint8_t data[8];
+
+    if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &header, data) != HAL_OK) return;
+
+    uint32_t id = (header.IDE == CAN_ID_EXT) ? (header.ExtId | CAN_RX_ID_EXTENDED) : header.StdId;
+    CanRxFifo_Push(&can_rx_fifo, id, data, (uint8_t)header.DLC, HAL_GetTick());
+}
+#endif
+
+
+/* ============================================================================
+ * DEBUG FUNCTIONS
+ * ============================================================================ */
+
+/**
+ * @brief Stampa lo stato della coda
+ */
+void CanRxFifo_Debug_PrintStats(CanRxFifo_t *fifo) {
+    printf("\n\rCAN RX FIFO Stats:\n");
+    printf("  Capacity: %u frames (%u bytes)\n", CAN_RX_FIFO_SIZE,
+           (unsigned)(CAN_RX_FIFO_SIZE * sizeof(CanRxFrame_t)));
+    printf("  In queue: %lu\n", (unsigned long)CanRxFifo_Count(fifo));
+    printf("  High-water mark: %lu\n", (unsigned long)CanRxFifo_GetHighWater(fifo));
+    printf("  Overflows: %lu\n", (unsigned long)CanRxFifo_GetOverflows(fifo));
+}
+
+
+/* ============================================================================
+ * EXAMPLES
+ * ============================================================================ */
+
+/**
+ * ESEMPIO 1: Push e pop a blocchi nello stesso thread
+ * 70 push su una coda da 64: gli ultimi 6 vanno in overflow
+ */
+void Example_PushPopBulk(void) {
+    static CanRxFifo_t fifo;
+    CanRxFrame_t batch[16];
+    uint8_t act1[8] = {0x00, 0xA0, 0x30, 0xF7, 0x0E, 0x10, 0x00, 0xAA};
+
+    CanRxFifo_Init(&fifo);
+    for (uint32_t i = 0; i < 70; i++) {
+        CanRxFifo_Push(&fifo, 0x611, act1, 8, i * 100);
+    }
+
+    uint32_t total = 0, n;
+    while ((n = CanRxFifo_PopBulk(&fifo, batch, 16)) > 0) {
+        total += n;
+    }
+
+    printf("\n\r=== PUSH / POP BULK EXAMPLE ===\n");
+    printf("  Popped: %lu frames\n", (unsigned long)total);
+    CanRxFifo_Debug_PrintStats(&fifo);
+}
+
+#if defined(__linux__) && !defined(USE_HAL_DRIVER)
+#include <pthread.h>
+#include <sched.h>
+
+#define STRESS_FRAMES  1000000UL
+
+static CanRxFifo_t stress_fifo;
+
+/* "ISR" simulata: scrive un contatore a 32 bit nei primi 4 byte */
+static void *Stress_Producer(void *arg) {
+    (void)arg;
+    uint8_t data[8] = {0};
+    for (uint32_t seq = 0; seq < STRESS_FRAMES; ) {
+        data[0] = (uint8_t)(seq >> 24);
+        data[1] = (uint8_t)(seq >> 16);
+        data[2] = (uint8_t)(seq >> 8);
+        data[3] = (uint8_t)seq;
+        if (CanRxFifo_Push(&stress_fifo, 0x610 + (seq & 0x0F), data, 8, seq)) {
+            seq++;
+        } else {
+            sched_yield();  /* Coda piena: lascia lavorare il consumer */
+        }
+    }
+    return NULL;
+}
+
+/**
+ * ESEMPIO 2: Verifica su Linux con producer e consumer su thread diversi
+ * Ogni frame deve arrivare una volta sola e in ordine.
+ * Qui il producer ritenta a coda piena, quindi "Overflows" conta i tentativi
+ * respinti (su STM32 sarebbero frame persi).
+ */
+void Example_ThreadedStress(void) {
+    pthread_t producer;
+    CanRxFrame_t batch[32];
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+
+    CanRxFifo_Init(&stress_fifo);
+    pthread_create(&producer, NULL, Stress_Producer, NULL);
+
+    while (expected < STRESS_FRAMES) {
+        uint32_t n = CanRxFifo_PopBulk(&stress_fifo, batch, 32);
+        if (n == 0) sched_yield();
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t seq = ((uint32_t)batch[i].data[0] << 24) | ((uint32_t)batch[i].data[1] << 16) |
+                           ((uint32_t)batch[i].data[2] << 8) | batch[i].data[3];
+            if (seq != expected || batch[i].id != 0x610 + (seq & 0x0F)) errors++;
+            expected++;
+        }
+    }
+    pthread_join(producer, NULL);
+
+    printf("\n\r=== THREADED STRESS EXAMPLE ===\n");
+    printf("  Frames checked: %lu\n", (unsigned long)expected);
+    printf("  Sequence errors: %lu  -> %s\n", (unsigned long)errors, errors == 0 ? "PASS" : "FAIL");
+    CanRxFifo_Debug_PrintStats(&stress_fifo);
+}
+#endif
+
+
+int main(void) {
+    printf("\n\r========================================\n");
+    printf("  EVO Charger - CAN RX FIFO Test\n");
+    printf("========================================\n");
+
+    Example_PushPopBulk();
+
+#if defined(__linux__) && !defined(USE_HAL_DRIVER)
+    printf("\n\r###########################\n");
+    Example_ThreadedStress();
+#endif
+
+    return 0;
+}